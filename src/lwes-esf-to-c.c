@@ -0,0 +1,816 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include "lwes_event_type_db.h"
+#include "lwes_hash.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char help[] =
+  "lwes-esf-to-c <esf_file> <output>"                                  "\n"
+  ""                                                                   "\n"
+  "  Writes <output>.h and <output>.c, which hold a struct for each"   "\n"
+  "  event in <esf_file> along with functions to serialize it to and"  "\n"
+  "  deserialize it from the same bytes lwes_event_to_bytes and"       "\n"
+  "  lwes_event_from_bytes use.  The identifiers are prefixed with"    "\n"
+  "  the last part of <output>."                                       "\n"
+  ""                                                                   "\n";
+
+/* an attribute of an event as the code is generated for it */
+struct esf_attribute
+{
+  LWES_CONST_SHORT_STRING name;
+  LWES_BYTE               type;
+};
+
+/* an event as the code is generated for it */
+struct esf_event
+{
+  LWES_CONST_SHORT_STRING  name;
+  struct esf_attribute    *attributes;
+  int                      number_of_attributes;
+};
+
+static int
+compare_attributes
+  (const void *a,
+   const void *b)
+{
+  return strcmp (((const struct esf_attribute *)a)->name,
+                 ((const struct esf_attribute *)b)->name);
+}
+
+static int
+compare_events
+  (const void *a,
+   const void *b)
+{
+  return strcmp (((const struct esf_event *)a)->name,
+                 ((const struct esf_event *)b)->name);
+}
+
+/* write a name as a C identifier */
+static void
+write_identifier
+  (FILE *stream,
+   const char *name)
+{
+  if (isdigit ((unsigned char)name[0]))
+    {
+      fputc ('_', stream);
+    }
+  for (; *name != '\0'; name++)
+    {
+      fputc (isalnum ((unsigned char)*name) ? *name : '_', stream);
+    }
+}
+
+/* write a name as an upper case C identifier */
+static void
+write_macro
+  (FILE *stream,
+   const char *name)
+{
+  if (isdigit ((unsigned char)name[0]))
+    {
+      fputc ('_', stream);
+    }
+  for (; *name != '\0'; name++)
+    {
+      fputc (isalnum ((unsigned char)*name) ? toupper ((unsigned char)*name)
+                                            : '_',
+             stream);
+    }
+}
+
+/* write bytes as the contents of a C string */
+static void
+write_bytes
+  (FILE *stream,
+   const unsigned char *bytes,
+   size_t length)
+{
+  size_t i;
+
+  for (i = 0; i < length; i++)
+    {
+      fprintf (stream, "\\%03o", bytes[i]);
+    }
+}
+
+/* write the length and name of an attribute along with its type, which
+ * come ahead of its value in the serialized event */
+static void
+write_attribute_prefix
+  (FILE *stream,
+   const struct esf_attribute *attribute)
+{
+  unsigned char length = (unsigned char)strlen (attribute->name);
+
+  fputc ('"', stream);
+  write_bytes (stream, &length, 1);
+  write_bytes (stream, (const unsigned char *)attribute->name, length);
+  write_bytes (stream, &(attribute->type), 1);
+  fputc ('"', stream);
+}
+
+static const char *
+c_type
+  (LWES_BYTE type)
+{
+  if (type == LWES_U_INT_16_TOKEN)
+    {
+      return "LWES_U_INT_16";
+    }
+  else if (type == LWES_INT_16_TOKEN)
+    {
+      return "LWES_INT_16";
+    }
+  else if (type == LWES_U_INT_32_TOKEN)
+    {
+      return "LWES_U_INT_32";
+    }
+  else if (type == LWES_INT_32_TOKEN)
+    {
+      return "LWES_INT_32";
+    }
+  else if (type == LWES_U_INT_64_TOKEN)
+    {
+      return "LWES_U_INT_64";
+    }
+  else if (type == LWES_INT_64_TOKEN)
+    {
+      return "LWES_INT_64";
+    }
+  else if (type == LWES_BOOLEAN_TOKEN)
+    {
+      return "LWES_BOOLEAN";
+    }
+  else if (type == LWES_IP_ADDR_TOKEN)
+    {
+      return "LWES_IP_ADDR";
+    }
+  return "LWES_CONST_LONG_STRING";
+}
+
+static const char *
+marshall_type
+  (LWES_BYTE type)
+{
+  if (type == LWES_U_INT_16_TOKEN)
+    {
+      return "U_INT_16";
+    }
+  else if (type == LWES_INT_16_TOKEN)
+    {
+      return "INT_16";
+    }
+  else if (type == LWES_U_INT_32_TOKEN)
+    {
+      return "U_INT_32";
+    }
+  else if (type == LWES_INT_32_TOKEN)
+    {
+      return "INT_32";
+    }
+  else if (type == LWES_U_INT_64_TOKEN)
+    {
+      return "U_INT_64";
+    }
+  else if (type == LWES_INT_64_TOKEN)
+    {
+      return "INT_64";
+    }
+  else if (type == LWES_BOOLEAN_TOKEN)
+    {
+      return "BOOLEAN";
+    }
+  else if (type == LWES_IP_ADDR_TOKEN)
+    {
+      return "IP_ADDR";
+    }
+  return "LONG_STRING";
+}
+
+/* the most bytes a value of a type serializes to */
+static size_t
+value_size
+  (LWES_BYTE type)
+{
+  if (type == LWES_U_INT_16_TOKEN || type == LWES_INT_16_TOKEN)
+    {
+      return 2;
+    }
+  if (type == LWES_U_INT_32_TOKEN || type == LWES_INT_32_TOKEN
+      || type == LWES_IP_ADDR_TOKEN)
+    {
+      return 4;
+    }
+  if (type == LWES_U_INT_64_TOKEN || type == LWES_INT_64_TOKEN)
+    {
+      return 8;
+    }
+  if (type == LWES_BOOLEAN_TOKEN)
+    {
+      return 1;
+    }
+  return 2 + LONG_STRING_MAX;
+}
+
+/* gather the events of the db, each with its own attributes along with
+ * those of the meta event it doesn't have itself, sorted by name */
+static struct esf_event *
+gather_events
+  (struct lwes_event_type_db *db,
+   int *number_of_events)
+{
+  struct lwes_hash_enumeration e;
+  struct lwes_hash_enumeration e2;
+  struct esf_event *events;
+  struct lwes_hash *meta;
+  struct lwes_hash *attributes;
+  LWES_SHORT_STRING name;
+  int count = 0;
+  int i;
+
+  meta = (struct lwes_hash *)lwes_hash_get (db->events,
+                                            LWES_META_INFO_STRING);
+  events = (struct esf_event *)
+    malloc (sizeof (struct esf_event) * (lwes_hash_size (db->events) + 1));
+  if (events == NULL || ! lwes_hash_keys (db->events, &e))
+    {
+      free (events);
+      return NULL;
+    }
+
+  while (lwes_hash_enumeration_has_more_elements (&e))
+    {
+      name = lwes_hash_enumeration_next_element (&e);
+      if (strcmp (name, LWES_META_INFO_STRING) == 0)
+        {
+          continue;
+        }
+      attributes = (struct lwes_hash *)lwes_hash_get (db->events, name);
+
+      events[count].name = name;
+      events[count].number_of_attributes = 0;
+      events[count].attributes = (struct esf_attribute *)
+        malloc (sizeof (struct esf_attribute)
+                * (lwes_hash_size (attributes)
+                   + (meta != NULL ? lwes_hash_size (meta) : 0) + 1));
+      if (events[count].attributes == NULL)
+        {
+          return NULL;
+        }
+
+      if (lwes_hash_keys (attributes, &e2))
+        {
+          while (lwes_hash_enumeration_has_more_elements (&e2))
+            {
+              i = events[count].number_of_attributes++;
+              events[count].attributes[i].name =
+                lwes_hash_enumeration_next_element (&e2);
+              events[count].attributes[i].type =
+                *(LWES_BYTE *)lwes_hash_get
+                                (attributes,
+                                 events[count].attributes[i].name);
+            }
+        }
+      if (meta != NULL && lwes_hash_keys (meta, &e2))
+        {
+          while (lwes_hash_enumeration_has_more_elements (&e2))
+            {
+              name = lwes_hash_enumeration_next_element (&e2);
+              if (lwes_hash_contains_key (attributes, name))
+                {
+                  continue;
+                }
+              i = events[count].number_of_attributes++;
+              events[count].attributes[i].name = name;
+              events[count].attributes[i].type =
+                *(LWES_BYTE *)lwes_hash_get (meta, name);
+            }
+        }
+
+      qsort (events[count].attributes,
+             events[count].number_of_attributes,
+             sizeof (struct esf_attribute),
+             compare_attributes);
+      count++;
+    }
+
+  qsort (events, count, sizeof (struct esf_event), compare_events);
+  *number_of_events = count;
+
+  return events;
+}
+
+static void
+write_header
+  (FILE *stream,
+   const char *prefix,
+   struct esf_event *events,
+   int number_of_events)
+{
+  struct esf_attribute *attribute;
+  size_t max_size;
+  int i;
+  int j;
+
+  fprintf (stream, "/* Automatically generated by lwes-esf-to-c */\n\n");
+  fprintf (stream, "#ifndef __");
+  write_macro (stream, prefix);
+  fprintf (stream, "_H\n#define __");
+  write_macro (stream, prefix);
+  fprintf (stream, "_H\n\n");
+  fprintf (stream, "#include <stddef.h>\n\n#include \"lwes_types.h\"\n\n");
+  fprintf (stream, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n");
+
+  for (i = 0; i < number_of_events; i++)
+    {
+      max_size = 1 + strlen (events[i].name) + 2;
+      for (j = 0; j < events[i].number_of_attributes; j++)
+        {
+          attribute = &(events[i].attributes[j]);
+          max_size += 1 + strlen (attribute->name) + 1
+                      + value_size (attribute->type);
+        }
+
+      fprintf (stream,
+               "\n/*! the most bytes an event named %s serializes to */\n",
+               events[i].name);
+      fprintf (stream, "#define ");
+      write_macro (stream, prefix);
+      fputc ('_', stream);
+      write_macro (stream, events[i].name);
+      fprintf (stream, "_MAX_SIZE %lu\n\n", (unsigned long)max_size);
+
+      fprintf (stream, "/*! \\brief An event named %s\n", events[i].name);
+      fprintf (stream,
+               " *\n"
+               " *  Only the attributes whose has_ member is set are"
+               " serialized.  Strings\n"
+               " *  are not nul terminated, their length is given along"
+               " with them.\n"
+               " */\n");
+      fprintf (stream, "struct %s_", prefix);
+      write_identifier (stream, events[i].name);
+      fprintf (stream, "\n{\n");
+      for (j = 0; j < events[i].number_of_attributes; j++)
+        {
+          attribute = &(events[i].attributes[j]);
+          fprintf (stream, "  %-24s ", c_type (attribute->type));
+          write_identifier (stream, attribute->name);
+          fprintf (stream, ";\n");
+          if (attribute->type == LWES_STRING_TOKEN)
+            {
+              fprintf (stream, "  %-24s ", "LWES_U_INT_16");
+              write_identifier (stream, attribute->name);
+              fprintf (stream, "_length;\n");
+            }
+          fprintf (stream, "  %-24s has_", "LWES_BOOLEAN");
+          write_identifier (stream, attribute->name);
+          fprintf (stream, ";\n");
+        }
+      if (events[i].number_of_attributes == 0)
+        {
+          fprintf (stream, "  %-24s unused;\n", "LWES_BYTE");
+        }
+      fprintf (stream, "};\n\n");
+
+      fprintf (stream,
+               "/*! \\brief Serialize an event named %s\n"
+               " *\n"
+               " *  \\return the number of bytes written on success, -1 for"
+               " bad arguments,\n"
+               " *          -2 if the array is too small\n"
+               " */\n"
+               "int\n%s_", events[i].name, prefix);
+      write_identifier (stream, events[i].name);
+      fprintf (stream, "_to_bytes\n  (const struct %s_", prefix);
+      write_identifier (stream, events[i].name);
+      fprintf (stream,
+               " *event,\n"
+               "   LWES_BYTE_P bytes,\n"
+               "   size_t num_bytes,\n"
+               "   size_t offset);\n\n");
+
+      fprintf (stream,
+               "/*! \\brief Deserialize an event named %s\n"
+               " *\n"
+               " *  Strings point into the bytes, which have to outlast"
+               " the event.\n"
+               " *  Attributes not in the esf file, or of another type,"
+               " are skipped.\n"
+               " *\n"
+               " *  \\return the number of bytes read on success, -1 for"
+               " bad arguments,\n"
+               " *          -2 if the bytes hold another event, -3 if they"
+               " do not hold\n"
+               " *          a whole event, -4 for an unknown type\n"
+               " */\n"
+               "int\n%s_", events[i].name, prefix);
+      write_identifier (stream, events[i].name);
+      fprintf (stream, "_from_bytes\n  (struct %s_", prefix);
+      write_identifier (stream, events[i].name);
+      fprintf (stream,
+               " *event,\n"
+               "   LWES_BYTE_P bytes,\n"
+               "   size_t num_bytes,\n"
+               "   size_t offset);\n");
+    }
+
+  fprintf (stream, "\n#ifdef __cplusplus\n}\n#endif\n\n#endif\n");
+}
+
+static void
+write_to_bytes
+  (FILE *stream,
+   const char *prefix,
+   struct esf_event *event)
+{
+  struct esf_attribute *attribute;
+  unsigned char length = (unsigned char)strlen (event->name);
+  int j;
+
+  fprintf (stream, "int\n%s_", prefix);
+  write_identifier (stream, event->name);
+  fprintf (stream, "_to_bytes\n  (const struct %s_", prefix);
+  write_identifier (stream, event->name);
+  fprintf (stream,
+           " *event,\n"
+           "   LWES_BYTE_P bytes,\n"
+           "   size_t num_bytes,\n"
+           "   size_t offset)\n"
+           "{\n"
+           "  size_t size = %u;\n"
+           "  size_t tmpOffset = offset;\n"
+           "  LWES_U_INT_16 count = 0;\n\n"
+           "  if (event == NULL || bytes == NULL || offset > num_bytes)\n"
+           "    {\n"
+           "      return -1;\n"
+           "    }\n\n",
+           (unsigned int)(1 + length + 2));
+
+  /* the size is known before anything is written */
+  for (j = 0; j < event->number_of_attributes; j++)
+    {
+      attribute = &(event->attributes[j]);
+      fprintf (stream, "  if (event->has_");
+      write_identifier (stream, attribute->name);
+      fprintf (stream, ")\n    {\n      size += %lu",
+               (unsigned long)(1 + strlen (attribute->name) + 1
+                               + ((attribute->type == LWES_STRING_TOKEN)
+                                    ? 2 : value_size (attribute->type))));
+      if (attribute->type == LWES_STRING_TOKEN)
+        {
+          fprintf (stream, " + event->");
+          write_identifier (stream, attribute->name);
+          fprintf (stream, "_length");
+        }
+      fprintf (stream, ";\n      count++;\n    }\n");
+    }
+  fprintf (stream,
+           "  if (num_bytes - offset < size)\n"
+           "    {\n"
+           "      return -2;\n"
+           "    }\n\n");
+
+  fprintf (stream, "  memcpy (bytes + tmpOffset, \"");
+  write_bytes (stream, &length, 1);
+  write_bytes (stream, (const unsigned char *)event->name, length);
+  fprintf (stream, "\", %u);\n  tmpOffset += %u;\n",
+           (unsigned int)(1 + length), (unsigned int)(1 + length));
+  fprintf (stream,
+           "  marshall_U_INT_16 (count, bytes, num_bytes, &tmpOffset);\n");
+
+  for (j = 0; j < event->number_of_attributes; j++)
+    {
+      attribute = &(event->attributes[j]);
+      fprintf (stream, "  if (event->has_");
+      write_identifier (stream, attribute->name);
+      fprintf (stream, ")\n    {\n      memcpy (bytes + tmpOffset, ");
+      write_attribute_prefix (stream, attribute);
+      fprintf (stream, ", %lu);\n      tmpOffset += %lu;\n",
+               (unsigned long)(strlen (attribute->name) + 2),
+               (unsigned long)(strlen (attribute->name) + 2));
+      if (attribute->type == LWES_STRING_TOKEN)
+        {
+          fprintf (stream, "      marshall_U_INT_16 (event->");
+          write_identifier (stream, attribute->name);
+          fprintf (stream, "_length,\n"
+                           "                         bytes, num_bytes,"
+                           " &tmpOffset);\n"
+                           "      memcpy (bytes + tmpOffset, event->");
+          write_identifier (stream, attribute->name);
+          fprintf (stream, ", event->");
+          write_identifier (stream, attribute->name);
+          fprintf (stream, "_length);\n      tmpOffset += event->");
+          write_identifier (stream, attribute->name);
+          fprintf (stream, "_length;\n");
+        }
+      else
+        {
+          fprintf (stream, "      marshall_%s (event->",
+                   marshall_type (attribute->type));
+          write_identifier (stream, attribute->name);
+          fprintf (stream, ", bytes, num_bytes, &tmpOffset);\n");
+        }
+      fprintf (stream, "    }\n");
+    }
+
+  fprintf (stream, "\n  return (int)(tmpOffset - offset);\n}\n\n");
+}
+
+static void
+write_from_bytes
+  (FILE *stream,
+   const char *prefix,
+   struct esf_event *event)
+{
+  struct esf_attribute *attribute;
+  unsigned char length = (unsigned char)strlen (event->name);
+  int j;
+
+  fprintf (stream, "int\n%s_", prefix);
+  write_identifier (stream, event->name);
+  fprintf (stream, "_from_bytes\n  (struct %s_", prefix);
+  write_identifier (stream, event->name);
+  fprintf (stream,
+           " *event,\n"
+           "   LWES_BYTE_P bytes,\n"
+           "   size_t num_bytes,\n"
+           "   size_t offset)\n"
+           "{\n"
+           "  size_t tmpOffset = offset;\n"
+           "  LWES_U_INT_16 count;\n"
+           "  LWES_U_INT_16 i;\n"
+           "  LWES_BYTE name_length;\n"
+           "  LWES_BYTE_P name;\n"
+           "  LWES_BYTE type;\n"
+           "  LWES_U_INT_16 string_length;\n"
+           "  int ret;\n\n"
+           "  if (event == NULL || bytes == NULL || offset >= num_bytes)\n"
+           "    {\n"
+           "      return -1;\n"
+           "    }\n"
+           "  memset (event, 0, sizeof (*event));\n\n"
+           "  if (num_bytes - tmpOffset < %u\n"
+           "      || memcmp (bytes + tmpOffset, \"",
+           (unsigned int)(1 + length));
+  write_bytes (stream, &length, 1);
+  write_bytes (stream, (const unsigned char *)event->name, length);
+  fprintf (stream,
+           "\", %u) != 0)\n"
+           "    {\n"
+           "      return -2;\n"
+           "    }\n"
+           "  tmpOffset += %u;\n\n"
+           "  if (unmarshall_U_INT_16 (&count, bytes, num_bytes,"
+           " &tmpOffset) == 0)\n"
+           "    {\n"
+           "      return -3;\n"
+           "    }\n\n"
+           "  for (i = 0; i < count; i++)\n"
+           "    {\n"
+           "      if (unmarshall_BYTE (&name_length, bytes, num_bytes,"
+           " &tmpOffset) == 0\n"
+           "          || num_bytes - tmpOffset < name_length)\n"
+           "        {\n"
+           "          return -3;\n"
+           "        }\n"
+           "      name = bytes + tmpOffset;\n"
+           "      tmpOffset += name_length;\n"
+           "      if (unmarshall_BYTE (&type, bytes, num_bytes,"
+           " &tmpOffset) == 0)\n"
+           "        {\n"
+           "          return -3;\n"
+           "        }\n\n"
+           "      ",
+           (unsigned int)(1 + length), (unsigned int)(1 + length));
+
+  for (j = 0; j < event->number_of_attributes; j++)
+    {
+      attribute = &(event->attributes[j]);
+      fprintf (stream,
+               "if (name_length == %u && type == %u\n"
+               "          && memcmp (name, \"%s\", %u) == 0)\n"
+               "        {\n",
+               (unsigned int)strlen (attribute->name),
+               (unsigned int)attribute->type,
+               attribute->name,
+               (unsigned int)strlen (attribute->name));
+      if (attribute->type == LWES_STRING_TOKEN)
+        {
+          fprintf (stream,
+                   "          if (unmarshall_U_INT_16 (&string_length,"
+                   " bytes, num_bytes,\n"
+                   "                                   &tmpOffset) == 0\n"
+                   "              || num_bytes - tmpOffset <"
+                   " string_length)\n"
+                   "            {\n"
+                   "              return -3;\n"
+                   "            }\n"
+                   "          event->");
+          write_identifier (stream, attribute->name);
+          fprintf (stream,
+                   " = (LWES_CONST_LONG_STRING)(bytes + tmpOffset);\n"
+                   "          event->");
+          write_identifier (stream, attribute->name);
+          fprintf (stream,
+                   "_length = string_length;\n"
+                   "          tmpOffset += string_length;\n");
+        }
+      else
+        {
+          fprintf (stream, "          if (unmarshall_%s (&(event->",
+                   marshall_type (attribute->type));
+          write_identifier (stream, attribute->name);
+          fprintf (stream,
+                   "), bytes, num_bytes,\n"
+                   "                                &tmpOffset) == 0)\n"
+                   "            {\n"
+                   "              return -3;\n"
+                   "            }\n");
+        }
+      fprintf (stream, "          event->has_");
+      write_identifier (stream, attribute->name);
+      fprintf (stream, " = 1;\n        }\n      else ");
+    }
+
+  fprintf (stream,
+           "if ((ret = %s_skip (type, bytes, num_bytes,"
+           " &tmpOffset)) < 0)\n"
+           "        {\n"
+           "          return ret;\n"
+           "        }\n"
+           "    }\n\n"
+           "  return (int)(tmpOffset - offset);\n"
+           "}\n\n",
+           prefix);
+}
+
+static void
+write_source
+  (FILE *stream,
+   const char *prefix,
+   const char *header,
+   struct esf_event *events,
+   int number_of_events)
+{
+  int i;
+
+  fprintf (stream, "/* Automatically generated by lwes-esf-to-c */\n\n");
+  fprintf (stream, "#include \"%s\"\n", header);
+  fprintf (stream, "#include \"lwes_marshall_functions.h\"\n\n");
+  fprintf (stream, "#include <string.h>\n\n");
+
+  /* values of attributes which aren't wanted are skipped over */
+  fprintf (stream,
+           "static int\n"
+           "%s_skip\n"
+           "  (LWES_BYTE type,\n"
+           "   LWES_BYTE_P bytes,\n"
+           "   size_t num_bytes,\n"
+           "   size_t *offset)\n"
+           "{\n"
+           "  LWES_U_INT_16 length;\n"
+           "  size_t size;\n\n"
+           "  switch (type)\n"
+           "    {\n"
+           "      case %u: case %u:\n"
+           "        size = 2;\n"
+           "        break;\n"
+           "      case %u: case %u: case %u:\n"
+           "        size = 4;\n"
+           "        break;\n"
+           "      case %u: case %u:\n"
+           "        size = 8;\n"
+           "        break;\n"
+           "      case %u:\n"
+           "        size = 1;\n"
+           "        break;\n"
+           "      case %u:\n"
+           "        if (unmarshall_U_INT_16 (&length, bytes, num_bytes,"
+           " offset) == 0)\n"
+           "          {\n"
+           "            return -3;\n"
+           "          }\n"
+           "        size = length;\n"
+           "        break;\n"
+           "      default:\n"
+           "        return -4;\n"
+           "    }\n\n"
+           "  if (num_bytes - (*offset) < size)\n"
+           "    {\n"
+           "      return -3;\n"
+           "    }\n"
+           "  (*offset) += size;\n"
+           "  return 0;\n"
+           "}\n\n",
+           prefix,
+           (unsigned int)LWES_U_INT_16_TOKEN,
+           (unsigned int)LWES_INT_16_TOKEN,
+           (unsigned int)LWES_U_INT_32_TOKEN,
+           (unsigned int)LWES_INT_32_TOKEN,
+           (unsigned int)LWES_IP_ADDR_TOKEN,
+           (unsigned int)LWES_U_INT_64_TOKEN,
+           (unsigned int)LWES_INT_64_TOKEN,
+           (unsigned int)LWES_BOOLEAN_TOKEN,
+           (unsigned int)LWES_STRING_TOKEN);
+
+  for (i = 0; i < number_of_events; i++)
+    {
+      write_to_bytes (stream, prefix, &(events[i]));
+      write_from_bytes (stream, prefix, &(events[i]));
+    }
+}
+
+int main (int   argc,
+          char *argv[])
+{
+  struct lwes_event_type_db *db;
+  struct esf_event *events;
+  int number_of_events = 0;
+  const char *base;
+  char prefix[FILENAME_MAX];
+  char header[FILENAME_MAX];
+  char source[FILENAME_MAX];
+  FILE *stream;
+  int i;
+
+  if (argc != 3)
+    {
+      fprintf (stderr, "%s", help);
+      return 1;
+    }
+
+  db = lwes_event_type_db_create (argv[1]);
+  if (db == NULL)
+    {
+      fprintf (stderr, "error: unable to read %s\n", argv[1]);
+      return 1;
+    }
+
+  events = gather_events (db, &number_of_events);
+  if (events == NULL)
+    {
+      fprintf (stderr, "error: out of memory\n");
+      return 1;
+    }
+
+  /* identifiers are prefixed with the last part of the output */
+  base = strrchr (argv[2], '/');
+  base = (base == NULL) ? argv[2] : base + 1;
+  snprintf (prefix, sizeof (prefix), "%s", base);
+  for (i = 0; prefix[i] != '\0'; i++)
+    {
+      if (! isalnum ((unsigned char)prefix[i]))
+        {
+          prefix[i] = '_';
+        }
+    }
+  snprintf (header, sizeof (header), "%s.h", argv[2]);
+  snprintf (source, sizeof (source), "%s.c", argv[2]);
+
+  stream = fopen (header, "w");
+  if (stream == NULL)
+    {
+      fprintf (stderr, "error: unable to write %s\n", header);
+      return 1;
+    }
+  write_header (stream, prefix, events, number_of_events);
+  fclose (stream);
+
+  stream = fopen (source, "w");
+  if (stream == NULL)
+    {
+      fprintf (stderr, "error: unable to write %s\n", source);
+      return 1;
+    }
+  /* the source sits beside the header */
+  snprintf (header, sizeof (header), "%s.h", base);
+  write_source (stream, prefix, header, events, number_of_events);
+  fclose (stream);
+
+  for (i = 0; i < number_of_events; i++)
+    {
+      free (events[i].attributes);
+    }
+  free (events);
+  lwes_event_type_db_destroy (db);
+
+  return 0;
+}
@@ -159,39 +159,39 @@ lwes_event_attribute_to_stream
 {
   if (attribute->type == LWES_U_INT_16_TOKEN)
   {
-    lwes_U_INT_16_to_stream (*((LWES_U_INT_16 *)attribute->value),stream);
+    lwes_U_INT_16_to_stream (attribute->value.u_int_16,stream);
   }
   else if (attribute->type == LWES_INT_16_TOKEN)
   {
-    lwes_INT_16_to_stream (*((LWES_INT_16 *)attribute->value),stream);
+    lwes_INT_16_to_stream (attribute->value.int_16,stream);
   }
   else if (attribute->type == LWES_U_INT_32_TOKEN)
   {
-    lwes_U_INT_32_to_stream (*((LWES_U_INT_32 *)attribute->value),stream);
+    lwes_U_INT_32_to_stream (attribute->value.u_int_32,stream);
   }
   else if (attribute->type == LWES_INT_32_TOKEN)
   {
-    lwes_INT_32_to_stream (*((LWES_INT_32 *)attribute->value),stream);
+    lwes_INT_32_to_stream (attribute->value.int_32,stream);
   }
   else if (attribute->type == LWES_U_INT_64_TOKEN)
   {
-    lwes_U_INT_64_to_stream (*((LWES_U_INT_64 *)attribute->value),stream);
+    lwes_U_INT_64_to_stream (attribute->value.u_int_64,stream);
   }
   else if (attribute->type == LWES_INT_64_TOKEN)
   {
-    lwes_INT_64_to_stream (*((LWES_INT_64 *)attribute->value),stream);
+    lwes_INT_64_to_stream (attribute->value.int_64,stream);
   }
   else if (attribute->type == LWES_BOOLEAN_TOKEN)
   {
-    lwes_BOOLEAN_to_stream (*((LWES_BOOLEAN *)attribute->value),stream);
+    lwes_BOOLEAN_to_stream (attribute->value.boolean,stream);
   }
   else if (attribute->type == LWES_IP_ADDR_TOKEN)
   {
-    lwes_IP_ADDR_to_stream (*((LWES_IP_ADDR *)attribute->value),stream);
+    lwes_IP_ADDR_to_stream (attribute->value.ip_addr,stream);
   }
   else if (attribute->type == LWES_STRING_TOKEN)
   {
-    lwes_LONG_STRING_to_stream ((LWES_LONG_STRING)attribute->value,stream);
+    lwes_LONG_STRING_to_stream (attribute->value.string,stream);
   }
   else
   {
@@ -207,7 +207,9 @@ lwes_event_to_stream
    FILE *stream)
 {
   struct lwes_event_attribute *tmp;
-  struct lwes_hash_enumeration e;
+  struct lwes_event_enumeration e;
+  LWES_CONST_SHORT_STRING tmpAttrName;
+  LWES_TYPE tmpAttrType;
 
   lwes_SHORT_STRING_to_stream (event->eventName,stream);
   fprintf (stream,"[");
@@ -220,20 +222,16 @@ lwes_event_to_stream
   fprintf (stream,"{\n");
   fflush (stream);
 
-  if (lwes_hash_keys (event->attributes, &e))
+  if (lwes_event_keys (event, &e))
     {
-      while (lwes_hash_enumeration_has_more_elements (&e))
+      while (lwes_event_enumeration_next_element (&e, &tmpAttrName,
+                                                  &tmpAttrType))
         {
-          LWES_SHORT_STRING tmpAttrName =
-            lwes_hash_enumeration_next_element (&e);
-
-          tmp =
-            (struct lwes_event_attribute *)lwes_hash_get (event->attributes,
-                                                          tmpAttrName);
+          tmp = lwes_event_get_attribute (event, tmpAttrName);
 
           fprintf (stream,"\t");
           fflush (stream);
-          lwes_SHORT_STRING_to_stream (tmpAttrName,stream);
+          lwes_SHORT_STRING_to_stream ((LWES_SHORT_STRING)tmpAttrName,stream);
           fflush (stream);
           fprintf (stream," = ");
           fflush (stream);
@@ -261,6 +259,7 @@ int main (int   argc,
   struct sigaction act;
 
   struct lwes_listener * listener;
+  struct lwes_event *event;
   int event_count = 0;
   time_t start_time = time (NULL);
   int frequency = 1;
@@ -336,10 +335,11 @@ int main (int   argc,
                                     (LWES_SHORT_STRING) mcast_iface,
                                     (LWES_U_INT_32)     mcast_port );
 
+  /* the listener resets the event on each receive, so one will do */
+  event = lwes_event_create_no_name ( NULL );
+
   while ( ! done )
     {
-      struct lwes_event *event = lwes_event_create_no_name ( NULL );
-
       if ( event != NULL )
         {
           time_t current_time;
@@ -373,9 +373,9 @@ int main (int   argc,
                 }
             }
         }
-      lwes_event_destroy (event);
     }
 
+  lwes_event_destroy (event);
   lwes_listener_destroy (listener);
 
   return 0;
@@ -166,6 +166,37 @@ int main (int   argc,
 
   assert (emitter != NULL);
 
+  /* the event is filled in once, then the values which change are set
+     over the old ones before each emit */
+  event  = lwes_event_create (NULL, "MyEvent");
+  assert (event != NULL);
+
+  assert
+    (lwes_event_set_STRING   (event, "field", "hello world") == 1 );
+  assert
+    (lwes_event_set_INT_32   (event, "count", 0) == 2);
+  assert
+    (lwes_event_set_INT_32   (event, "run", 0) == 3);
+  assert
+    (lwes_event_set_STRING (event, "prog_id","12345") == 4);
+  assert
+    (lwes_event_set_INT_16 (event,"num", 2) == 5);
+  assert
+    (lwes_event_set_STRING (event,"k0", "a-key.count") == 6);
+  assert
+    (lwes_event_set_INT_16 (event,"v0", 1) == 7);
+  assert
+    (lwes_event_set_STRING (event,"k1", "b-key.count") == 8);
+  assert
+    (lwes_event_set_INT_16 (event,"v1", 2) == 9);
+  assert
+    (lwes_event_set_U_INT_64(event, "global_count", 0) == 10);
+  assert
+    (lwes_event_set_INT_64 (event,"SentTime", 0) == 11);
+  if (pad>0) {
+    assert(lwes_event_set_STRING (event,"pad",pad_string) == 12);
+  }
+
   {
     int i,s,n;
     LWES_INT_64 start  = 0LL;
@@ -177,38 +208,17 @@ int main (int   argc,
         stop  = start;
         for (i = 0; i < number; ++i, ++n)
           {
-            event  = lwes_event_create (NULL, "MyEvent");
-            assert (event != NULL);
-
-            assert
-              (lwes_event_set_STRING   (event, "field", "hello world") == 1 );
-            assert
-              (lwes_event_set_INT_32   (event, "count", i) == 2);
-            assert
-              (lwes_event_set_INT_32   (event, "run", s) == 3);
-            assert
-              (lwes_event_set_STRING (event, "prog_id","12345") == 4);
-            assert
-              (lwes_event_set_INT_16 (event,"num", 2) == 5);
-            assert
-              (lwes_event_set_STRING (event,"k0", "a-key.count") == 6);
-            assert
-              (lwes_event_set_INT_16 (event,"v0", 1) == 7);
             assert
-              (lwes_event_set_STRING (event,"k1", "b-key.count") == 8);
+              (lwes_event_set_INT_32   (event, "count", i) > 0);
             assert
-              (lwes_event_set_INT_16 (event,"v1", 2) == 9);
+              (lwes_event_set_INT_32   (event, "run", s) > 0);
             assert
-              (lwes_event_set_U_INT_64(event, "global_count", n) == 10);
+              (lwes_event_set_U_INT_64(event, "global_count", n) > 0);
             assert
-              (lwes_event_set_INT_64 (event,"SentTime", stop) == 11);
-            if (pad>0) {
-              assert(lwes_event_set_STRING (event,"pad",pad_string) == 12);
-            }
+              (lwes_event_set_INT_64 (event,"SentTime", stop) > 0);
 
             assert (lwes_emitter_emit (emitter, event) == 0);
 
-            lwes_event_destroy(event);
             stop = currentTimeMillisLongLong ();
 
             /* if we are going over our total time, bail out */
@@ -247,6 +257,7 @@ int main (int   argc,
 
         sleep (pause);
       }
+    lwes_event_destroy(event);
     lwes_emitter_destroy(emitter);
     if (pad_string!=NULL) free(pad_string);
   }
@@ -0,0 +1,617 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include "lwes_async_emitter.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+/* number of events the sender thread sends at once */
+#define LWES_ASYNC_EMITTER_BATCH_SIZE 64
+
+/* milliseconds a waiting thread sleeps before it looks again, in case it
+   missed being woken */
+#define LWES_ASYNC_EMITTER_WAIT_MS 100
+
+/* the queue is shared between threads without a lock, so its positions
+   are read and written with these */
+#define LWES_ATOMIC_LOAD_RELAXED(p) __atomic_load_n ((p), __ATOMIC_RELAXED)
+#define LWES_ATOMIC_LOAD(p)         __atomic_load_n ((p), __ATOMIC_ACQUIRE)
+#define LWES_ATOMIC_STORE(p, v)     __atomic_store_n ((p), (v), \
+                                                      __ATOMIC_RELEASE)
+#define LWES_ATOMIC_CAS(p, e, d) \
+  __atomic_compare_exchange_n ((p), (e), (d), 1, \
+                               __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define LWES_ATOMIC_ADD(p, v)       __atomic_add_fetch ((p), (v), \
+                                                        __ATOMIC_SEQ_CST)
+#define LWES_ATOMIC_EXCHANGE(p, v)  __atomic_exchange_n ((p), (v), \
+                                                         __ATOMIC_ACQUIRE)
+#define LWES_ATOMIC_FENCE()         __atomic_thread_fence (__ATOMIC_SEQ_CST)
+
+/*************************************************************************
+  PRIVATE API prototypes, shouldn't be called by a user of the library.
+ *************************************************************************/
+int
+lwes_async_emitter_queue_init
+  (struct lwes_async_emitter_queue *queue,
+   size_t size);
+
+int
+lwes_async_emitter_queue_add
+  (struct lwes_async_emitter_queue *queue,
+   struct lwes_async_emitter_buffer *buffer);
+
+struct lwes_async_emitter_buffer *
+lwes_async_emitter_queue_take
+  (struct lwes_async_emitter_queue *queue);
+
+int
+lwes_async_emitter_queue_is_empty
+  (struct lwes_async_emitter_queue *queue);
+
+void
+lwes_async_emitter_enqueue
+  (struct lwes_async_emitter *emitter,
+   struct lwes_async_emitter_buffer *buffer);
+
+int
+lwes_async_emitter_emit_over_oldest
+  (struct lwes_async_emitter *emitter,
+   struct lwes_event *event);
+
+void
+lwes_async_emitter_wait
+  (struct lwes_async_emitter *emitter,
+   pthread_cond_t *cond);
+
+void *
+lwes_async_emitter_run
+  (void *arg);
+
+/*************************************************************************
+  PUBLIC API
+ *************************************************************************/
+struct lwes_async_emitter *
+lwes_async_emitter_create
+  (LWES_CONST_SHORT_STRING address,
+   LWES_CONST_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   LWES_BOOLEAN emit_heartbeat,
+   LWES_INT_16 freq,
+   size_t queue_size,
+   size_t buffer_size,
+   enum lwes_async_emitter_policy policy)
+{
+  struct lwes_async_emitter *emitter;
+  LWES_BYTE_P slab;
+  size_t size;
+  size_t count;
+  size_t i;
+
+  if (queue_size == 0)
+    {
+      queue_size = MAX_QUEUED_ELEMENTS;
+    }
+  if (buffer_size == 0)
+    {
+      buffer_size = MAX_MSG_SIZE;
+    }
+  if (buffer_size > MAX_MSG_SIZE
+      || queue_size > ((size_t)-1) / 2 / buffer_size
+      || (policy != LWES_ASYNC_EMITTER_DROP_NEWEST
+          && policy != LWES_ASYNC_EMITTER_DROP_OLDEST
+          && policy != LWES_ASYNC_EMITTER_BLOCK))
+    {
+      return NULL;
+    }
+
+  /* the position of a cell in a queue is found by masking */
+  for (size = 1; size < queue_size; size <<= 1)
+    ;
+
+  /* dropping the oldest needs a spare buffer beyond those of the queues */
+  count = size + ((policy == LWES_ASYNC_EMITTER_DROP_OLDEST) ? 1 : 0);
+
+  emitter =
+    (struct lwes_async_emitter *) malloc (sizeof (struct lwes_async_emitter));
+  if (emitter == NULL)
+    {
+      return NULL;
+    }
+  memset (emitter, 0, sizeof (struct lwes_async_emitter));
+
+  emitter->buffers =
+    (struct lwes_async_emitter_buffer *)
+      malloc (sizeof (struct lwes_async_emitter_buffer)*count);
+  if (emitter->buffers == NULL)
+    {
+      free (emitter);
+      return NULL;
+    }
+
+  /* the buffers all share one slab */
+  slab = (LWES_BYTE_P) malloc (sizeof (LWES_BYTE)*buffer_size*count);
+  if (slab == NULL)
+    {
+      free (emitter->buffers);
+      free (emitter);
+      return NULL;
+    }
+
+  /* both queues have room for every buffer, so adding never fails for
+     want of room */
+  if (lwes_async_emitter_queue_init (&(emitter->pool), size) < 0)
+    {
+      free (slab);
+      free (emitter->buffers);
+      free (emitter);
+      return NULL;
+    }
+  if (lwes_async_emitter_queue_init (&(emitter->queued), size) < 0)
+    {
+      free (emitter->pool.cells);
+      free (slab);
+      free (emitter->buffers);
+      free (emitter);
+      return NULL;
+    }
+  for (i = 0; i < count; i++)
+    {
+      emitter->buffers[i].bytes  = slab + buffer_size*i;
+      emitter->buffers[i].length = 0;
+    }
+  for (i = 0; i < size; i++)
+    {
+      lwes_async_emitter_queue_add (&(emitter->pool), &(emitter->buffers[i]));
+    }
+  emitter->spare = (count > size) ? &(emitter->buffers[size]) : NULL;
+
+  emitter->buffer_size = buffer_size;
+  emitter->policy      = policy;
+  emitter->running     = 1;
+
+  emitter->emitter = lwes_emitter_create (address, iface, port,
+                                          emit_heartbeat, freq);
+  if (emitter->emitter == NULL)
+    {
+      free (emitter->queued.cells);
+      free (emitter->pool.cells);
+      free (slab);
+      free (emitter->buffers);
+      free (emitter);
+      return NULL;
+    }
+
+  pthread_mutex_init (&(emitter->mutex), NULL);
+  pthread_cond_init (&(emitter->added), NULL);
+  pthread_cond_init (&(emitter->room), NULL);
+
+  if (pthread_create (&(emitter->thread), NULL,
+                      lwes_async_emitter_run, emitter) != 0)
+    {
+      pthread_cond_destroy (&(emitter->room));
+      pthread_cond_destroy (&(emitter->added));
+      pthread_mutex_destroy (&(emitter->mutex));
+      lwes_emitter_destroy (emitter->emitter);
+      free (emitter->queued.cells);
+      free (emitter->pool.cells);
+      free (slab);
+      free (emitter->buffers);
+      free (emitter);
+      return NULL;
+    }
+
+  return emitter;
+}
+
+int
+lwes_async_emitter_emit
+  (struct lwes_async_emitter *emitter,
+   struct lwes_event *event)
+{
+  struct lwes_async_emitter_buffer *buffer;
+  size_t size;
+  int length;
+
+  if (emitter == NULL || event == NULL)
+    {
+      return -1;
+    }
+
+  /* don't take a buffer for an event which won't fit in it */
+  if (lwes_event_get_serialized_size (event, &size) != 0
+      || size > emitter->buffer_size)
+    {
+      return -2;
+    }
+
+  while ((buffer = lwes_async_emitter_queue_take (&(emitter->pool))) == NULL)
+    {
+      if (emitter->policy == LWES_ASYNC_EMITTER_BLOCK)
+        {
+          LWES_ATOMIC_ADD (&(emitter->producers_waiting), 1);
+          lwes_async_emitter_wait (emitter, &(emitter->room));
+          LWES_ATOMIC_ADD (&(emitter->producers_waiting), -1);
+          continue;
+        }
+
+      if (emitter->policy == LWES_ASYNC_EMITTER_DROP_OLDEST)
+        {
+          return lwes_async_emitter_emit_over_oldest (emitter, event);
+        }
+
+      LWES_ATOMIC_ADD (&(emitter->dropped), 1);
+      return -3;
+    }
+
+  if ((length = lwes_event_to_bytes (event, buffer->bytes,
+                                     emitter->buffer_size, 0)) < 0)
+    {
+      lwes_async_emitter_queue_add (&(emitter->pool), buffer);
+      return -2;
+    }
+  buffer->length = length;
+  lwes_async_emitter_enqueue (emitter, buffer);
+
+  return 0;
+}
+
+int
+lwes_async_emitter_get_dropped
+  (struct lwes_async_emitter *emitter,
+   LWES_U_INT_64 *dropped,
+   LWES_U_INT_64 *failed)
+{
+  if (emitter == NULL)
+    {
+      return -1;
+    }
+
+  if (dropped != NULL)
+    {
+      *dropped = LWES_ATOMIC_LOAD (&(emitter->dropped));
+    }
+  if (failed != NULL)
+    {
+      *failed = LWES_ATOMIC_LOAD (&(emitter->failed));
+    }
+
+  return 0;
+}
+
+int
+lwes_async_emitter_destroy
+  (struct lwes_async_emitter *emitter)
+{
+  if (emitter == NULL)
+    {
+      return 0;
+    }
+
+  /* the sender thread stops once the queue is empty */
+  pthread_mutex_lock (&(emitter->mutex));
+  LWES_ATOMIC_STORE (&(emitter->running), 0);
+  pthread_cond_signal (&(emitter->added));
+  pthread_mutex_unlock (&(emitter->mutex));
+  pthread_join (emitter->thread, NULL);
+
+  lwes_emitter_destroy (emitter->emitter);
+
+  pthread_cond_destroy (&(emitter->room));
+  pthread_cond_destroy (&(emitter->added));
+  pthread_mutex_destroy (&(emitter->mutex));
+
+  free (emitter->queued.cells);
+  free (emitter->pool.cells);
+  free (emitter->buffers[0].bytes);
+  free (emitter->buffers);
+  free (emitter);
+
+  return 0;
+}
+
+/*************************************************************************
+  PRIVATE API
+ *************************************************************************/
+
+/* A queue is bounded, and each of its cells has a sequence, which is the
+   position it can next be added at when it is free, or one past that when
+   a buffer has been added to it.  Threads claim positions by moving
+   enqueue_pos or dequeue_pos along, so any number of them can add and take
+   buffers without a lock. */
+
+int
+lwes_async_emitter_queue_init
+  (struct lwes_async_emitter_queue *queue,
+   size_t size)
+{
+  size_t i;
+
+  queue->cells =
+    (struct lwes_async_emitter_cell *)
+      malloc (sizeof (struct lwes_async_emitter_cell)*size);
+  if (queue->cells == NULL)
+    {
+      return -3;
+    }
+  for (i = 0; i < size; i++)
+    {
+      queue->cells[i].sequence = i;
+      queue->cells[i].buffer   = NULL;
+    }
+  queue->mask        = size - 1;
+  queue->enqueue_pos = 0;
+  queue->dequeue_pos = 0;
+
+  return 0;
+}
+
+int
+lwes_async_emitter_queue_add
+  (struct lwes_async_emitter_queue *queue,
+   struct lwes_async_emitter_buffer *buffer)
+{
+  struct lwes_async_emitter_cell *cell;
+  size_t position = LWES_ATOMIC_LOAD_RELAXED (&(queue->enqueue_pos));
+  size_t sequence;
+
+  for (;;)
+    {
+      cell     = &(queue->cells[position & queue->mask]);
+      sequence = LWES_ATOMIC_LOAD (&(cell->sequence));
+      if (sequence == position)
+        {
+          if (LWES_ATOMIC_CAS (&(queue->enqueue_pos),
+                               &position, position + 1))
+            {
+              break;
+            }
+        }
+      else if ((long)(sequence - position) < 0)
+        {
+          /* there is room for every buffer, so this cell is just still
+             being taken from */
+          sched_yield ();
+          position = LWES_ATOMIC_LOAD_RELAXED (&(queue->enqueue_pos));
+        }
+      else
+        {
+          position = LWES_ATOMIC_LOAD_RELAXED (&(queue->enqueue_pos));
+        }
+    }
+
+  cell->buffer = buffer;
+  LWES_ATOMIC_STORE (&(cell->sequence), position + 1);
+
+  return 0;
+}
+
+struct lwes_async_emitter_buffer *
+lwes_async_emitter_queue_take
+  (struct lwes_async_emitter_queue *queue)
+{
+  struct lwes_async_emitter_buffer *buffer;
+  struct lwes_async_emitter_cell *cell;
+  size_t position = LWES_ATOMIC_LOAD_RELAXED (&(queue->dequeue_pos));
+  size_t sequence;
+
+  for (;;)
+    {
+      cell     = &(queue->cells[position & queue->mask]);
+      sequence = LWES_ATOMIC_LOAD (&(cell->sequence));
+      if (sequence == position + 1)
+        {
+          if (LWES_ATOMIC_CAS (&(queue->dequeue_pos),
+                               &position, position + 1))
+            {
+              break;
+            }
+        }
+      else if ((long)(sequence - (position + 1)) < 0)
+        {
+          /* nothing has been added to the cell yet */
+          return NULL;
+        }
+      else
+        {
+          position = LWES_ATOMIC_LOAD_RELAXED (&(queue->dequeue_pos));
+        }
+    }
+
+  buffer = cell->buffer;
+  LWES_ATOMIC_STORE (&(cell->sequence), position + queue->mask + 1);
+
+  return buffer;
+}
+
+int
+lwes_async_emitter_queue_is_empty
+  (struct lwes_async_emitter_queue *queue)
+{
+  size_t position = LWES_ATOMIC_LOAD_RELAXED (&(queue->dequeue_pos));
+
+  return LWES_ATOMIC_LOAD (&(queue->cells[position & queue->mask].sequence))
+         != position + 1;
+}
+
+/* Queue a buffer an event has been serialized into, and wake the sender
+   thread if it is waiting for it */
+void
+lwes_async_emitter_enqueue
+  (struct lwes_async_emitter *emitter,
+   struct lwes_async_emitter_buffer *buffer)
+{
+  lwes_async_emitter_queue_add (&(emitter->queued), buffer);
+
+  LWES_ATOMIC_FENCE ();
+  if (LWES_ATOMIC_LOAD_RELAXED (&(emitter->sender_waiting)))
+    {
+      pthread_mutex_lock (&(emitter->mutex));
+      pthread_cond_signal (&(emitter->added));
+      pthread_mutex_unlock (&(emitter->mutex));
+    }
+}
+
+/* Emit an event in place of the oldest one waiting to be sent.  The event
+   is serialized into the spare buffer first, so the oldest is only dropped
+   for one which can be sent, and the buffer taken from it becomes the
+   spare. */
+int
+lwes_async_emitter_emit_over_oldest
+  (struct lwes_async_emitter *emitter,
+   struct lwes_event *event)
+{
+  struct lwes_async_emitter_buffer *spare;
+  struct lwes_async_emitter_buffer *taken;
+  int length;
+
+  /* one thread at a time has the spare, and not for long */
+  while ((spare = LWES_ATOMIC_EXCHANGE (&(emitter->spare), NULL)) == NULL)
+    {
+      sched_yield ();
+    }
+
+  if ((length = lwes_event_to_bytes (event, spare->bytes,
+                                     emitter->buffer_size, 0)) < 0)
+    {
+      LWES_ATOMIC_STORE (&(emitter->spare), spare);
+      return -2;
+    }
+  spare->length = length;
+
+  /* a buffer may have been freed in the meantime, otherwise take that of
+     the oldest event waiting to be sent, unless every buffer is being
+     sent or serialized into */
+  if ((taken = lwes_async_emitter_queue_take (&(emitter->pool))) == NULL)
+    {
+      taken = lwes_async_emitter_queue_take (&(emitter->queued));
+      LWES_ATOMIC_ADD (&(emitter->dropped), 1);
+      if (taken == NULL)
+        {
+          LWES_ATOMIC_STORE (&(emitter->spare), spare);
+          return -3;
+        }
+    }
+
+  LWES_ATOMIC_STORE (&(emitter->spare), taken);
+  lwes_async_emitter_enqueue (emitter, spare);
+
+  return 0;
+}
+
+/* wait for cond to be signalled, unless what it is signalled for has
+   already happened */
+void
+lwes_async_emitter_wait
+  (struct lwes_async_emitter *emitter,
+   pthread_cond_t *cond)
+{
+  struct timeval now;
+  struct timespec until;
+  int ready;
+
+  gettimeofday (&now, NULL);
+  until.tv_sec  = now.tv_sec + LWES_ASYNC_EMITTER_WAIT_MS / 1000;
+  until.tv_nsec = now.tv_usec * 1000
+                  + (LWES_ASYNC_EMITTER_WAIT_MS % 1000) * 1000000;
+  if (until.tv_nsec >= 1000000000)
+    {
+      until.tv_sec++;
+      until.tv_nsec -= 1000000000;
+    }
+
+  pthread_mutex_lock (&(emitter->mutex));
+  LWES_ATOMIC_FENCE ();
+  if (cond == &(emitter->added))
+    {
+      ready = ! lwes_async_emitter_queue_is_empty (&(emitter->queued))
+              || ! LWES_ATOMIC_LOAD (&(emitter->running));
+    }
+  else
+    {
+      ready = ! lwes_async_emitter_queue_is_empty (&(emitter->pool));
+    }
+  if (! ready)
+    {
+      pthread_cond_timedwait (cond, &(emitter->mutex), &until);
+    }
+  pthread_mutex_unlock (&(emitter->mutex));
+}
+
+void *
+lwes_async_emitter_run
+  (void *arg)
+{
+  struct lwes_async_emitter *emitter = (struct lwes_async_emitter *) arg;
+  struct lwes_async_emitter_buffer *buffers[LWES_ASYNC_EMITTER_BATCH_SIZE];
+  LWES_BYTE_P bytes[LWES_ASYNC_EMITTER_BATCH_SIZE];
+  size_t lens[LWES_ASYNC_EMITTER_BATCH_SIZE];
+  int count;
+  int sent;
+  int i;
+
+  for (;;)
+    {
+      /* take as much as there is, up to a batch */
+      for (count = 0; count < LWES_ASYNC_EMITTER_BATCH_SIZE; count++)
+        {
+          buffers[count] = lwes_async_emitter_queue_take (&(emitter->queued));
+          if (buffers[count] == NULL)
+            {
+              break;
+            }
+          bytes[count] = buffers[count]->bytes;
+          lens[count]  = buffers[count]->length;
+        }
+
+      if (count == 0)
+        {
+          /* only stop once everything queued has been sent */
+          if (! LWES_ATOMIC_LOAD (&(emitter->running)))
+            {
+              break;
+            }
+          LWES_ATOMIC_STORE (&(emitter->sender_waiting), 1);
+          lwes_async_emitter_wait (emitter, &(emitter->added));
+          LWES_ATOMIC_STORE (&(emitter->sender_waiting), 0);
+          continue;
+        }
+
+      sent = lwes_emitter_emit_bytes_batch (emitter->emitter,
+                                            bytes, lens, count);
+      if (sent < count)
+        {
+          LWES_ATOMIC_ADD (&(emitter->failed),
+                           (LWES_U_INT_64)(count - (sent < 0 ? 0 : sent)));
+        }
+
+      /* give the buffers back */
+      for (i = 0; i < count; i++)
+        {
+          lwes_async_emitter_queue_add (&(emitter->pool), buffers[i]);
+        }
+
+      /* and wake anything waiting for them */
+      LWES_ATOMIC_FENCE ();
+      if (LWES_ATOMIC_LOAD_RELAXED (&(emitter->producers_waiting)) > 0)
+        {
+          pthread_mutex_lock (&(emitter->mutex));
+          pthread_cond_broadcast (&(emitter->room));
+          pthread_mutex_unlock (&(emitter->mutex));
+        }
+    }
+
+  return NULL;
+}
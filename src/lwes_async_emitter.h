@@ -0,0 +1,221 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#ifndef __LWES_ASYNC_EMITTER_H
+#define __LWES_ASYNC_EMITTER_H
+
+#include "lwes_types.h"
+#include "lwes_emitter.h"
+#include "lwes_event.h"
+
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lwes_async_emitter.h
+ *  \brief Functions for emitting LWES events from a thread of their own
+ */
+
+/*! \brief What is done with an event when there is no room for it */
+enum lwes_async_emitter_policy
+{
+  /*! The event being emitted is dropped */
+  LWES_ASYNC_EMITTER_DROP_NEWEST = 0,
+  /*! The oldest event waiting to be sent is dropped to make room, once
+      the event being emitted has been serialized */
+  LWES_ASYNC_EMITTER_DROP_OLDEST = 1,
+  /*! Emitting waits for there to be room */
+  LWES_ASYNC_EMITTER_BLOCK       = 2
+};
+
+/*! \struct lwes_async_emitter_buffer lwes_async_emitter.h
+ *  \brief A buffer an event is serialized into
+ */
+struct lwes_async_emitter_buffer
+{
+  /*! The serialized event */
+  LWES_BYTE_P bytes;
+  /*! Number of bytes the event takes up */
+  size_t      length;
+};
+
+/*! \struct lwes_async_emitter_cell lwes_async_emitter.h
+ *  \brief A place in a queue of buffers
+ */
+struct lwes_async_emitter_cell
+{
+  /*! Position in the queue the cell can next be added at when it is free,
+      or one past that when a buffer has been added to it */
+  size_t                            sequence;
+  /*! The buffer in the cell */
+  struct lwes_async_emitter_buffer *buffer;
+};
+
+/*! \struct lwes_async_emitter_queue lwes_async_emitter.h
+ *  \brief A bounded queue of buffers which needs no lock
+ */
+struct lwes_async_emitter_queue
+{
+  /*! The cells of the queue, whose number is a power of two */
+  struct lwes_async_emitter_cell *cells;
+  /*! One less than the number of cells */
+  size_t                          mask;
+  /*! Keeps the positions apart, as they are written by different threads */
+  char                            pad0[64];
+  /*! Position the next buffer is added at */
+  size_t                          enqueue_pos;
+  /*! Keeps the positions apart, as they are written by different threads */
+  char                            pad1[64];
+  /*! Position the next buffer is taken from */
+  size_t                          dequeue_pos;
+  /*! Keeps the positions apart from whatever comes next */
+  char                            pad2[64];
+};
+
+/*! \struct lwes_async_emitter lwes_async_emitter.h
+ *  \brief Emits LWES events from a thread of its own
+ *
+ *  Events are serialized on the thread emitting them into a buffer taken
+ *  from a pool, and the buffer is added to a bounded queue, both without
+ *  taking a lock.  A sender thread sends what is in the queue in batches
+ *  and gives the buffers back to the pool.  So emitting an event never
+ *  waits on the network, only on the pool being empty if that is the
+ *  policy.
+ */
+struct lwes_async_emitter
+{
+  /*! the emitter the sender thread sends with */
+  struct lwes_emitter              *emitter;
+  /*! the buffers of the pool */
+  struct lwes_async_emitter_buffer *buffers;
+  /*! size of each buffer */
+  size_t                            buffer_size;
+  /*! what is done when the pool is empty */
+  enum lwes_async_emitter_policy    policy;
+  /*! the buffers which are free to serialize into */
+  struct lwes_async_emitter_queue   pool;
+  /*! the buffers waiting to be sent */
+  struct lwes_async_emitter_queue   queued;
+  /*! with LWES_ASYNC_EMITTER_DROP_OLDEST, the buffer an event is
+      serialized into before the oldest is dropped for it, NULL while a
+      thread has it */
+  struct lwes_async_emitter_buffer *spare;
+  /*! number of events dropped because there was no room for them */
+  LWES_U_INT_64                     dropped;
+  /*! number of events the sender thread could not send */
+  LWES_U_INT_64                     failed;
+  /*! whether the sender thread should keep going */
+  int                               running;
+  /*! whether the sender thread is waiting for an event */
+  int                               sender_waiting;
+  /*! number of threads waiting for a free buffer */
+  int                               producers_waiting;
+  /*! the sender thread */
+  pthread_t                         thread;
+  /*! lock for waiting on the conditions below */
+  pthread_mutex_t                   mutex;
+  /*! signalled when an event has been queued */
+  pthread_cond_t                    added;
+  /*! signalled when buffers have been freed */
+  pthread_cond_t                    room;
+};
+
+/*! \brief Create an asynchronous Emitter
+ *
+ *  \param[in] address        The multicast ip address as a dotted quad string
+ *                            of the channel to emit to.
+ *  \param[in] iface          The dotted quad ip address of the interface to
+ *                            send messages on, can be NULL to use default.
+ *  \param[in] port           The port of the channel to emit to.
+ *  \param[in] emit_heartbeat Set to 1 to emit heartbeats, set to 0 to not
+ *                            emit heartbeats.
+ *  \param[in] freq           Number of seconds between heartbeats.
+ *  \param[in] queue_size     Number of buffers in the pool, which is the
+ *                            most events which can be waiting to be sent,
+ *                            rounded up to a power of two, 0 for
+ *                            MAX_QUEUED_ELEMENTS.
+ *  \param[in] buffer_size    Largest serialized event which can be queued,
+ *                            0 for MAX_MSG_SIZE.
+ *  \param[in] policy         What is done with an event when there is no
+ *                            free buffer for it.
+ *
+ *  \see lwes_async_emitter_destroy
+ *
+ *  \return A newly created emitter, use lwes_async_emitter_destroy to free
+ */
+struct lwes_async_emitter *
+lwes_async_emitter_create
+  (LWES_CONST_SHORT_STRING address,
+   LWES_CONST_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   LWES_BOOLEAN emit_heartbeat,
+   LWES_INT_16 freq,
+   size_t queue_size,
+   size_t buffer_size,
+   enum lwes_async_emitter_policy policy);
+
+/*! \brief Queue an event to be emitted
+ *
+ *  The event is serialized before this returns, so it can be changed or
+ *  destroyed straight away.  Any number of threads can emit at once, but
+ *  each must emit its own event, as serializing an event keeps the bytes
+ *  in it (see lwes_event_to_bytes).
+ *
+ *  \param[in] emitter The emitter to emit to
+ *  \param[in] event   The event to emit
+ *
+ *  \return 0 on success, -1 for bad arguments, -2 if the event could not be
+ *          serialized into a buffer, -3 if there was no room and the event
+ *          was dropped
+ */
+int
+lwes_async_emitter_emit
+  (struct lwes_async_emitter *emitter,
+   struct lwes_event *event);
+
+/*! \brief Get the number of events which were not emitted
+ *
+ *  \param[in] emitter The emitter
+ *  \param[out] dropped The number of events dropped because there was no
+ *                      room for them, can be NULL
+ *  \param[out] failed The number of events which could not be sent, can be
+ *                     NULL
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_async_emitter_get_dropped
+  (struct lwes_async_emitter *emitter,
+   LWES_U_INT_64 *dropped,
+   LWES_U_INT_64 *failed);
+
+/*! \brief Destroy an asynchronous Emitter
+ *
+ *  Events still in the queue are sent before the sender thread stops.
+ *  Nothing may be emitting at the time.
+ *
+ * \param[in] emitter The emitter to destroy by freeing all of it's used
+ *                    memory.
+ *
+ * \return 0 on success, negative number on failure
+ */
+int
+lwes_async_emitter_destroy
+  (struct lwes_async_emitter *emitter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LWES_ASYNC_EMITTER_H */
@@ -12,6 +12,11 @@
 
 #include "lwes_emitter.h"
 
+/* number of events serialized before a batch is sent */
+#define LWES_EMITTER_BATCH_SIZE 64
+/* size of the slab a batch is serialized into */
+#define LWES_EMITTER_BATCH_BYTES (4 * MAX_MSG_SIZE)
+
 /*************************************************************************
   PRIVATE API prototypes, shouldn't be called by a user of the library.
  *************************************************************************/
@@ -20,9 +25,17 @@ lwes_emitter_emit_event
   (struct lwes_emitter *emitter,
    struct lwes_event *event);
 
+int
+lwes_emitter_send_batch
+  (struct lwes_emitter *emitter,
+   LWES_BYTE_P *bytes,
+   size_t *lens,
+   int count);
+
 int
 lwes_emitter_collect_statistics
-  (struct lwes_emitter *emitter);
+  (struct lwes_emitter *emitter,
+   LWES_INT_64 count);
 
 void lwes_emitter_calculate_and_send_statistics
   (struct lwes_emitter *emitter,
@@ -90,6 +103,7 @@ lwes_emitter_create_with_ttl
   emitter->sequence = 0;
   emitter->frequency = freq;
   emitter->emitHeartbeat = emit_heartbeat;
+  emitter->batch_buffer = NULL;
 
   /* Send an event saying we are starting up */
   if (emitter->emitHeartbeat)
@@ -121,11 +135,83 @@ lwes_emitter_emit
   /* Send an event */
   error = lwes_emitter_emit_event (emitter,event);
 
-  lwes_emitter_collect_statistics (emitter);
+  lwes_emitter_collect_statistics (emitter, 1);
 
   return error;
 }
 
+int
+lwes_emitter_emit_batch
+  (struct lwes_emitter *emitter,
+   struct lwes_event **events,
+   int n)
+{
+  LWES_BYTE_P bytes[LWES_EMITTER_BATCH_SIZE];
+  size_t lens[LWES_EMITTER_BATCH_SIZE];
+  size_t offset = 0;
+  size_t size;
+  int queued = 0;
+  int sent = 0;
+  int length;
+  int i;
+
+  if (emitter == NULL || events == NULL || n < 0)
+    {
+      return -1;
+    }
+
+  if (emitter->batch_buffer == NULL)
+    {
+      emitter->batch_buffer =
+        (LWES_BYTE_P) malloc (sizeof (LWES_BYTE)*LWES_EMITTER_BATCH_BYTES);
+      if (emitter->batch_buffer == NULL)
+        {
+          return -3;
+        }
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      if (lwes_event_get_serialized_size (events[i], &size) != 0
+          || size > MAX_MSG_SIZE)
+        {
+          continue;
+        }
+
+      /* send what is there when the slab is full */
+      if (offset + size > LWES_EMITTER_BATCH_BYTES)
+        {
+          sent += lwes_emitter_send_batch (emitter, bytes, lens, queued);
+          queued = 0;
+          offset = 0;
+        }
+
+      if ((length = lwes_event_to_bytes (events[i],
+                                         emitter->batch_buffer,
+                                         LWES_EMITTER_BATCH_BYTES,
+                                         offset)) < 0)
+        {
+          continue;
+        }
+      bytes[queued] = emitter->batch_buffer + offset;
+      lens[queued]  = length;
+      queued++;
+      offset += length;
+
+      if (queued == LWES_EMITTER_BATCH_SIZE)
+        {
+          sent += lwes_emitter_send_batch (emitter, bytes, lens, queued);
+          queued = 0;
+          offset = 0;
+        }
+    }
+  sent += lwes_emitter_send_batch (emitter, bytes, lens, queued);
+
+  lwes_emitter_collect_statistics (emitter, n);
+
+  return sent;
+}
+
 int
 lwes_emitter_emitto
   (LWES_SHORT_STRING address,
@@ -184,6 +270,10 @@ lwes_emitter_destroy
     {
       free(emitter->buffer);
     }
+  if ( emitter != NULL && emitter->batch_buffer != NULL )
+    {
+      free(emitter->batch_buffer);
+    }
   if ( emitter != NULL )
     {
       free(emitter);
@@ -201,6 +291,27 @@ lwes_emitter_emit_bytes
   return lwes_net_send_bytes (&(emitter->connection), bytes ,length);
 }
 
+int
+lwes_emitter_emit_bytes_batch
+  (struct lwes_emitter *emitter,
+   LWES_BYTE_P *bytes,
+   size_t *lens,
+   int n)
+{
+  int sent;
+
+  if (emitter == NULL || bytes == NULL || lens == NULL || n < 0)
+    {
+      return -1;
+    }
+
+  sent = lwes_emitter_send_batch (emitter, bytes, lens, n);
+
+  lwes_emitter_collect_statistics (emitter, n);
+
+  return sent;
+}
+
 /*************************************************************************
   PRIVATE API
  *************************************************************************/
@@ -224,6 +335,26 @@ lwes_emitter_emit_event
   return 0;
 }
 
+int
+lwes_emitter_send_batch
+  (struct lwes_emitter *emitter,
+   LWES_BYTE_P *bytes,
+   size_t *lens,
+   int count)
+{
+  int sent;
+
+  if (count == 0)
+    {
+      return 0;
+    }
+
+  sent = lwes_net_send_bytes_batch (&(emitter->connection),
+                                    bytes, lens, NULL, count);
+
+  return (sent < 0) ? 0 : sent;
+}
+
 void lwes_emitter_calculate_and_send_statistics
   (struct lwes_emitter *emitter,
    struct lwes_event *stats_event,
@@ -261,13 +392,14 @@ void lwes_emitter_calculate_and_send_statistics
 
 int
 lwes_emitter_collect_statistics
-  (struct lwes_emitter *emitter)
+  (struct lwes_emitter *emitter,
+   LWES_INT_64 count)
 {
   time_t current_time = time (NULL);
 
-  /* Count it */
-  emitter->count++;
-  emitter->count_since_last_beat++;
+  /* Count them, a batch all at once */
+  emitter->count += count;
+  emitter->count_since_last_beat += count;
 
   /* Send a heartbeat event */
   if ( emitter->emitHeartbeat 
@@ -49,6 +49,9 @@ struct lwes_emitter
   LWES_BOOLEAN emitHeartbeat;
   /*! time of last heartbeat */
   time_t last_beat_time;
+  /*! slab batches of events are serialized into, allocated the first time
+      a batch is emitted */
+  LWES_BYTE_P batch_buffer;
 };
 
 /*! \brief Create an Emitter
@@ -111,6 +114,26 @@ lwes_emitter_emit
   (struct lwes_emitter *emitter,
    struct lwes_event *event);
 
+/*! \brief Emit many events to the multicast channel defined in the emitter
+ *
+ *  The events are serialized one after another and sent with as few system
+ *  calls as the system allows.  Events which can't be serialized or sent
+ *  are skipped, but all of them are counted towards heartbeats, as with
+ *  lwes_emitter_emit.
+ *
+ *  \param[in] emitter The emitter to emit to
+ *  \param[in] events  The events to emit
+ *  \param[in] n       The number of events
+ *
+ *  \return the number of events sent on success, a negative number on
+ *          failure
+ */
+int
+lwes_emitter_emit_batch
+  (struct lwes_emitter *emitter,
+   struct lwes_event **events,
+   int n);
+
 /*! \brief Emit an event to a different multicast channel
  *
  *  \param[in] address The multicast ip address as a dotted quad string
@@ -148,6 +171,26 @@ lwes_emitter_emit_bytes
    LWES_BYTE_P bytes,
    size_t length);
 
+/*! \brief Emit many serialized events to a multicast channel
+ *
+ *  Unlike lwes_emitter_emit_bytes, the bytes are taken to be events, so
+ *  they are counted towards heartbeats, all of them at once.
+ *
+ *  \param[in] emitter The emitter to emit to
+ *  \param[in] bytes   The bytes of each event
+ *  \param[in] lens    The number of bytes in each event
+ *  \param[in] n       The number of events
+ *
+ *  \return the number of events sent on success, a negative number on
+ *          failure
+ */
+int
+lwes_emitter_emit_bytes_batch
+  (struct lwes_emitter *emitter,
+   LWES_BYTE_P *bytes,
+   size_t *lens,
+   int n);
+
 /*! \brief Destroy an Emitter
  *
  * \param[in] emitter The emitter to destroy by freeing all of it's used
@@ -17,26 +17,296 @@
 #include <limits.h>
 #include <errno.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "lwes_event.h"
 #include "lwes_hash.h"
+#include "lwes_intern.h"
 #include "lwes_marshall_functions.h"
 
 /*************************************************************************
   PRIVATE API prototypes, shouldn't be called by a user of the library.
  *************************************************************************/
 
-/* Create the memory for an event attribute */
+/* round sizes handed out of the storage of an event up to this alignment */
+#define LWES_EVENT_ARENA_ALIGN(size) \
+  (((size) + sizeof (LWES_U_INT_64) - 1) & ~(sizeof (LWES_U_INT_64) - 1))
+
+#define LWES_EVENT_ARENA_HEADER_SIZE \
+  LWES_EVENT_ARENA_ALIGN (sizeof (struct lwes_event_arena_block))
+
+/* the block of storage allocated along with an event follows it */
+#define LWES_EVENT_ARENA_FIRST_BLOCK(event) \
+  ((struct lwes_event_arena_block *) \
+     ((char *)(event) + LWES_EVENT_ARENA_ALIGN (sizeof (struct lwes_event))))
+
+/* an empty name and the number of attributes */
+#define LWES_EVENT_EMPTY_SIZE \
+  (sizeof (LWES_BYTE) + sizeof (LWES_U_INT_16))
+
+/* the hash of an event holds the position of each attribute in its
+ * entries, offset by one so that no attribute is told apart from NULL */
+#define LWES_EVENT_INDEX_TO_VALUE(index) \
+  ((void *)((size_t)(index) + 1))
+#define LWES_EVENT_VALUE_TO_INDEX(value) \
+  ((int)((size_t)(value)) - 1)
+
+/* Carve memory out of the storage of an event */
+static void *
+lwes_event_arena_alloc
+  (struct lwes_event *event,
+   size_t size);
+
+/* Move the attributes of a small event into a hash of at least bins
+ * slots carved out of its storage */
+static int
+lwes_event_attributes_init
+  (struct lwes_event *event,
+   int bins);
+
+/* Make room for at least size attributes in the entries of an event */
+static int
+lwes_event_entries_grow
+  (struct lwes_event *event,
+   int size);
+
+/* Find an attribute of an event by name */
+static struct lwes_event_attribute *
+lwes_event_find
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name);
+
+/* Find the position of an attribute in the entries of an event, or -1 */
+static int
+lwes_event_index
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name);
+
+/* Find an attribute of an event by the key of its name */
 static struct lwes_event_attribute *
-lwes_event_attribute_create
-  (LWES_BYTE attrType,
-   void *    attrValue);
+lwes_event_find_key
+  (struct lwes_event *event,
+   const struct lwes_attr_key *key);
+
+/* Find the position of an attribute by the key of its name, or -1 */
+static int
+lwes_event_index_key
+  (struct lwes_event *event,
+   const struct lwes_attr_key *key);
+
+/* Scan the entries of an event with few attributes for a name */
+static int
+lwes_event_scan
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name,
+   size_t length,
+   LWES_U_INT_64 prefix);
+
+/* The first bytes of a name, used to tell names apart quickly */
+static LWES_U_INT_64
+lwes_event_name_prefix
+  (LWES_CONST_SHORT_STRING name,
+   size_t length);
+
+/* The shared copy of a name, or one out of the storage of the event,
+ * only interning it if intern is set */
+static LWES_SHORT_STRING
+lwes_event_name
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name,
+   size_t length,
+   int intern);
+
+/* Deserialize an event, skipping any attributes not wanted */
+static int
+lwes_event_deserialize
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset,
+   struct lwes_event_deserialize_tmp *dtmp,
+   struct lwes_event_projection *projection);
+
+/* Find a string in bytes following its length, which takes up
+ * length_size bytes, the length found stops short of any nul in it */
+static int
+lwes_event_string_in_bytes
+  (LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t *offset,
+   size_t length_size,
+   LWES_CONST_LONG_STRING *string,
+   size_t *length);
+
+/* Set the name of an event from one which needn't be nul terminated */
+static int
+lwes_event_name_set
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name,
+   size_t length,
+   int intern);
+
+/* Add a decoded attribute to an event, the name needn't be nul terminated */
+static int
+lwes_event_add_from_bytes
+  (struct lwes_event*                      event,
+   LWES_CONST_SHORT_STRING                 attrName,
+   size_t                                  length,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue);
+
+/* Add an attribute to an event under a name it can keep, the key of
+ * which is given if there is one */
+static int
+lwes_event_add_name
+  (struct lwes_event*                      event,
+   LWES_SHORT_STRING                       attrName,
+   size_t                                  length,
+   const struct lwes_attr_key             *key,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue);
+
+/* Check an attribute against the event db, 0 if it can be set, -1 if the
+ * event can't have it and -2 if it is of the wrong type */
+static int
+lwes_event_check
+  (struct lwes_event*                      event,
+   LWES_CONST_SHORT_STRING                 attrName,
+   const struct lwes_attr_key             *key,
+   LWES_BYTE                               attrType);
+
+/* Add an attribute to an event under a name it can keep, as
+ * lwes_event_add_name, once it has been checked against the event db */
+static int
+lwes_event_put
+  (struct lwes_event*                      event,
+   LWES_SHORT_STRING                       attrName,
+   size_t                                  length,
+   const struct lwes_attr_key             *key,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue);
+
+/* Skip over the next attribute in bytes if a projection doesn't want it,
+ * returning 1 if it was skipped and 0 if it is wanted */
+static int
+lwes_event_projection_skip
+  (struct lwes_event_projection *projection,
+   struct lwes_hash *wanted,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t *offset);
+
+/* Serialize the event into a byte array, every attribute of it */
+static int
+lwes_event_marshall
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset);
+
+/* Serialize the event into a byte array known to have room for all of it */
+static int
+lwes_event_marshall_unchecked
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t offset);
+
+/* Bring the bytes the event last serialized to up to date */
+static int
+lwes_event_serialize
+  (struct lwes_event *event);
+
+/* Serialize a single attribute of an event, start being where the event
+ * begins in bytes */
+static int
+lwes_event_attribute_to_bytes
+  (LWES_CONST_SHORT_STRING name,
+   struct lwes_event_attribute *attribute,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t *offset,
+   size_t start);
+
+/* Serialize the value of an attribute of an event */
+static int
+lwes_event_value_to_bytes
+  (struct lwes_event_attribute *attribute,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t *offset);
+
+/* Serialize a single attribute of an event into bytes which have room for
+ * it, start being where the event begins in bytes */
+static int
+lwes_event_attribute_to_bytes_unchecked
+  (LWES_CONST_SHORT_STRING name,
+   struct lwes_event_attribute *attribute,
+   LWES_BYTE_P bytes,
+   size_t *offset,
+   size_t start);
+
+/* Serialize the value of an attribute of an event into bytes which have
+ * room for it */
+static int
+lwes_event_value_to_bytes_unchecked
+  (struct lwes_event_attribute *attribute,
+   LWES_BYTE_P bytes,
+   size_t *offset);
+
+/* Serialize a name into bytes which have room for it, as long as it is
+ * one a short string can hold */
+static int
+lwes_event_name_to_bytes_unchecked
+  (LWES_CONST_SHORT_STRING name,
+   LWES_BYTE_P bytes,
+   size_t *offset);
+
+/* Copy a string over the value of a string attribute of an event if it
+ * fits there, returning 1 if it did and 0 if it has to be stored anew */
+static int
+lwes_event_update_string
+  (struct lwes_event *event,
+   int index,
+   LWES_CONST_LONG_STRING value,
+   size_t length);
+
+/* Take size bytes out of the room lwes_event_set_many made for the copies
+ * it needs, or out of the storage of the event should that run out */
+static void *
+lwes_event_set_many_room
+  (struct lwes_event *event,
+   char **room,
+   size_t *room_size,
+   size_t size);
+
+/* The number of bytes a value of an attribute serializes to */
+static size_t
+lwes_event_value_size
+  (LWES_BYTE type,
+   const union lwes_event_attribute_value *value);
+
+static LWES_U_INT_16
+lwes_event_value_capacity
+  (LWES_BYTE type,
+   size_t size);
 
 static int
 lwes_event_add
-  (struct lwes_event*       event,
-   LWES_CONST_SHORT_STRING  attrNameIn,
-   LWES_BYTE                attrType,
-   void*                    attrValue);
+  (struct lwes_event*                      event,
+   LWES_CONST_SHORT_STRING                 attrNameIn,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue);
+
+static int
+lwes_event_update
+  (struct lwes_event*                      event,
+   int                                     index,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue);
 
 int
 lwes_INT_64_from_hex_string
@@ -55,8 +325,14 @@ struct lwes_event *
 lwes_event_create_no_name
   (struct lwes_event_type_db *db)
 {
-  struct lwes_event *event =
-     (struct lwes_event *)malloc (sizeof (struct lwes_event));
+  struct lwes_event *event;
+
+  /* the event and its first block of storage are a single allocation */
+  event =
+    (struct lwes_event *)
+      malloc (LWES_EVENT_ARENA_ALIGN (sizeof (struct lwes_event))
+              + LWES_EVENT_ARENA_HEADER_SIZE
+              + LWES_EVENT_ARENA_SIZE);
 
   if (event == NULL)
     {
@@ -65,13 +341,27 @@ lwes_event_create_no_name
 
   event->eventName            = NULL;
   event->number_of_attributes = 0;
+  event->serialized_size      = LWES_EVENT_EMPTY_SIZE;
   event->type_db              = db;
-  event->attributes           = lwes_hash_create ();
-  if (event->attributes == NULL)
-    {
-      free(event);
-      return NULL;
-    }
+  event->schema               = NULL;
+  event->schema_generation    = 0;
+  event->arena                = LWES_EVENT_ARENA_FIRST_BLOCK (event);
+  event->arena->next          = NULL;
+  event->arena->size          = LWES_EVENT_ARENA_SIZE;
+  event->arena->used          = 0;
+  event->entries              = event->small_attributes;
+  event->entries_size         = LWES_EVENT_SMALL_ATTRIBUTES;
+  event->large_entries        = NULL;
+  event->large_entries_size   = 0;
+  event->attributes           = NULL;
+  event->attribute_hash.owns_slots = 0;
+  event->serialized           = NULL;
+  event->serialized_capacity  = 0;
+  event->serialized_length    = 0;
+  event->serialized_attributes = 0;
+  event->serialized_valid     = 0;
+  event->serialized_before    = 0;
+  event->dirty_attributes     = 0;
 
   return event;
 }
@@ -89,28 +379,17 @@ lwes_event_create
       return NULL;
     }
 
-  event = (struct lwes_event *)malloc (sizeof (struct lwes_event));
+  event = lwes_event_create_no_name (db);
 
   if (event == NULL)
     {
       return NULL;
     }
 
-  event->eventName            = NULL;
-  event->number_of_attributes = 0;
-  event->type_db              = db;
-  event->attributes           = lwes_hash_create ();
-  if (event->attributes == NULL)
-    {
-      free(event);
-      return NULL;
-    }
-
   if (lwes_event_set_name (event,name) < 0)
     {
       /* Having problems, bail and return NULL */
-      lwes_hash_destroy (event->attributes);
-      free (event);
+      lwes_event_destroy (event);
       return NULL;
     }
 
@@ -125,46 +404,17 @@ lwes_event_create_with_encoding
 {
   struct lwes_event *event;
 
-  if (name == NULL)
-    {
-      return NULL;
-    }
-
-  event = (struct lwes_event *)malloc(sizeof(struct lwes_event));
+  event = lwes_event_create (db, name);
 
   if (event == NULL)
     {
       return NULL;
     }
 
-  event->eventName            = NULL;
-  event->number_of_attributes = 0;
-  event->type_db              = db;
-  event->attributes           = lwes_hash_create ();
-
-  if (event->attributes == NULL)
-    {
-      free (event);
-      return NULL;
-    }
-
-  if (lwes_event_set_name(event,name) < 0)
-    {
-      /* Having memory problems, bail */
-      lwes_hash_destroy (event->attributes);
-      free (event);
-      return NULL;
-    }
-
   if (lwes_event_set_encoding (event,encoding) < 0)
     {
       /* problem setting encoding, free up memory and bail */
-      lwes_hash_destroy (event->attributes);
-      if (event->eventName != NULL)
-        {
-          free (event->eventName);
-        }
-      free (event);
+      lwes_event_destroy (event);
       return NULL;
     }
 
@@ -181,17 +431,7 @@ lwes_event_set_name
       return -1;
     }
 
-  event->eventName =
-    (LWES_SHORT_STRING) malloc (sizeof (LWES_CHAR)*(strlen (name)+1));
-
-  if (event->eventName == NULL)
-    {
-      return -3;
-    }
-
-  strcpy (event->eventName,name);
-
-  return 0;
+  return lwes_event_name_set (event, name, strlen (name), 1);
 }
 
 int
@@ -239,6 +479,19 @@ lwes_event_get_number_of_attributes
   return 0;
 }
 
+int
+lwes_event_get_serialized_size
+  (struct lwes_event *event,
+   size_t *size)
+{
+  if (event == NULL || size == NULL)
+    {
+      return -1;
+    }
+  *size = event->serialized_size;
+  return 0;
+}
+
 int
 lwes_event_get_encoding
   (struct lwes_event *event,
@@ -259,52 +512,80 @@ int
 lwes_event_destroy
   (struct lwes_event *event)
 {
-  struct lwes_event_attribute *tmp = NULL;
-  struct lwes_hash_enumeration e;
+  struct lwes_event_arena_block *block;
+  struct lwes_event_arena_block *next;
 
   if (event == NULL)
     {
       return 0;
     }
 
-  /* free the parts of the event */
-  if (event->eventName != NULL)
+  /* everything hangs off the storage of the event, so free any blocks
+   * added after the first, then the event along with its first block,
+   * except the large entries, the serialized bytes and the slots of an
+   * attribute hash which outgrew its own */
+  free (event->large_entries);
+  free (event->serialized);
+  lwes_hash_release (&(event->attribute_hash));
+  for (block = event->arena; block != NULL; block = next)
+    {
+      next = block->next;
+      if (block != LWES_EVENT_ARENA_FIRST_BLOCK (event))
+        {
+          free (block);
+        }
+    }
+  free (event);
+
+  return 0;
+}
+
+/* PUBLIC : Empty an event, keeping its storage for reuse */
+int
+lwes_event_reset
+  (struct lwes_event *event)
+{
+  struct lwes_event_arena_block *first;
+  struct lwes_event_arena_block *block;
+  struct lwes_event_arena_block *next;
+
+  if (event == NULL)
     {
-      free(event->eventName);
+      return -1;
     }
 
-  /* clear out the hash */
-  if (lwes_hash_keys (event->attributes, &e))
+  /* keep the block in use, which is the largest one, along with the
+   * first block which is part of the event, the rest only held values
+   * too large to share a block or were outgrown */
+  first = LWES_EVENT_ARENA_FIRST_BLOCK (event);
+  for (block = event->arena->next; block != NULL; block = next)
     {
-      while (lwes_hash_enumeration_has_more_elements (&e))
+      next = block->next;
+      if (block != first)
         {
-          LWES_SHORT_STRING tmpAttrName =
-            lwes_hash_enumeration_next_element (&e);
-          tmp =
-            (struct lwes_event_attribute *)lwes_hash_remove (event->attributes,
-                                                             tmpAttrName);
-          /* free the attribute name and value*/
-          if (tmpAttrName != NULL)
-            {
-              free(tmpAttrName);
-            }
-          if (tmp->value != NULL)
-            {
-              free(tmp->value);
-            }
-          /* free the attribute itself*/
-          if (tmp != NULL)
-            {
-              free(tmp);
-            }
+          free (block);
         }
     }
+  first->next = NULL;
+  if (event->arena != first)
+    {
+      event->arena->next = first;
+    }
+  event->arena->used = 0;
 
-  /* free the now empty hash */
-  lwes_hash_destroy (event->attributes);
-
-  /* finally free the event structure */
-  free (event);
+  /* a hash, if there was one, was carved out of the storage as well
+   * unless it grew, in which case its slots are kept for next time, as
+   * are the large entries */
+  event->entries      = event->small_attributes;
+  event->entries_size = LWES_EVENT_SMALL_ATTRIBUTES;
+  event->attributes   = NULL;
+  event->eventName            = NULL;
+  event->schema               = NULL;
+  event->number_of_attributes = 0;
+  event->serialized_size      = LWES_EVENT_EMPTY_SIZE;
+  event->serialized_valid     = 0;
+  event->serialized_before    = 0;
+  event->dirty_attributes     = 0;
 
   return 0;
 }
@@ -317,11 +598,7 @@ lwes_event_to_bytes
    size_t num_bytes,
    size_t offset)
 {
-  struct lwes_event_attribute *tmp;
-  struct lwes_event_attribute *encodingAttr;
-  size_t tmpOffset = offset;
-  struct lwes_hash_enumeration e;
-  int ret = 0;
+  int ret;
 
   if (   event == NULL
       || bytes == NULL
@@ -331,238 +608,1429 @@ lwes_event_to_bytes
       return -1;
     }
 
-  /* start with the event name */
-  if (marshall_SHORT_STRING (event->eventName,
-                              bytes,
-                              num_bytes,
-                              &tmpOffset))
+  /* an event serialized before is likely to be serialized again, so it
+   * keeps its bytes and brings them up to date, which leaves anything
+   * going wrong to be reported by serializing it the long way */
+  if (event->serialized_before
+      && num_bytes - offset >= event->serialized_size
+      && lwes_event_serialize (event) == 0)
     {
-      /* then the number of attributes */
-      if (marshall_U_INT_16     (event->number_of_attributes,
-                                  bytes,
-                                  num_bytes,
-                                  &tmpOffset))
-        {
-          /* handle encoding first if it is set */
-          encodingAttr =
-            (struct lwes_event_attribute *)
-              lwes_hash_get (event->attributes,
-                             (LWES_SHORT_STRING)LWES_ENCODING);
+      memcpy (bytes + offset, event->serialized, event->serialized_length);
+      return (int)event->serialized_length;
+    }
 
-          if (encodingAttr)
-            {
-              void* encodingValue = encodingAttr->value;
-              LWES_BYTE encodingType = encodingAttr->type;
-              if (encodingValue)
-                {
-                  if (encodingType == LWES_INT_16_TOKEN)
-                    {
-                      if (marshall_SHORT_STRING
-                            ((LWES_SHORT_STRING)LWES_ENCODING,
-                             bytes,
-                             num_bytes,
-                             &tmpOffset) == 0
-                          ||
-                          marshall_BYTE
-                            (encodingType,
-                             bytes,
-                             num_bytes,
-                             &tmpOffset) == 0
-                          ||
-                          marshall_INT_16
-                            (*((LWES_INT_16 *)encodingValue),
-                             bytes,
-                             num_bytes,
-                             &tmpOffset) == 0)
-                        {
-                          return -2;
-                        }
-                    }
-                  else
-                    {
-                      return -3;
-                    }
-                }
-              else
-                {
-                  return -4;
-                }
-            }
+  ret = lwes_event_marshall (event, bytes, num_bytes, offset);
+  if (ret >= 0)
+    {
+      event->serialized_before = 1;
+    }
 
-          /* now iterate over all the other values in the hash */
-          if (lwes_hash_keys (event->attributes, &e))
-            {
-              while (lwes_hash_enumeration_has_more_elements (&e) && ret == 0)
-                {
-                  LWES_SHORT_STRING tmpAttrName =
-                    lwes_hash_enumeration_next_element (&e);
+  /* serializing the long way notes where the values went in bytes rather
+   * than in the bytes kept, and marks them clean without those having
+   * been rewritten, so the kept bytes are built afresh next time */
+  event->serialized_valid = 0;
+  event->dirty_attributes = 0;
 
-                  /* skip encoding as we've dealt with it above */
-                  if (! strcmp(tmpAttrName, LWES_ENCODING))
-                    {
-                      continue;
-                    }
+  return ret;
+}
 
-                  tmp =
-                    (struct lwes_event_attribute *)
-                      lwes_hash_get (event->attributes, tmpAttrName);
+/* PUBLIC : deserialize the event from a byte array and into an event */
+int
+lwes_event_from_bytes
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset,
+   struct lwes_event_deserialize_tmp *dtmp)
+{
+  return lwes_event_deserialize (event, bytes, num_bytes, offset, dtmp, NULL);
+}
 
-                  if (marshall_SHORT_STRING (tmpAttrName,
-                                             bytes,
-                                             num_bytes,
-                                             &tmpOffset) == 0)
-                    {
-                      ret = -5;
-                    }
-                  else
-                    {
-                      if (marshall_BYTE (tmp->type,
-                                         bytes,
-                                         num_bytes,
-                                         &tmpOffset) == 0)
-                        {
-                          ret = -6;
-                        }
-                      else
-                        {
-                          if (tmp->type == LWES_U_INT_16_TOKEN)
-                            {
-                              if (marshall_U_INT_16 (*((LWES_U_INT_16 *)tmp->value),
-                                                     bytes,
-                                                     num_bytes,
-                                                     &tmpOffset) == 0)
-                                {
-                                  ret = -7;
-                                }
-                            }
-                          else if (tmp->type == LWES_INT_16_TOKEN)
-                            {
-                              if (marshall_INT_16 (*((LWES_INT_16 *)tmp->value),
-                                                   bytes,
-                                                   num_bytes,
-                                                   &tmpOffset) == 0)
-                                {
-                                  ret = -8;
-                                }
-                            }
-                          else if (tmp->type == LWES_U_INT_32_TOKEN)
-                            {
-                              if (marshall_U_INT_32 (*((LWES_U_INT_32 *)tmp->value),
-                                                     bytes,
-                                                     num_bytes,
-                                                     &tmpOffset) == 0)
-                                {
-                                  ret = -9;
-                                }
-                            }
-                          else if (tmp->type == LWES_INT_32_TOKEN)
-                            {
-                              if (marshall_INT_32 (*((LWES_INT_32 *)tmp->value),
-                                                   bytes,
-                                                   num_bytes,
-                                                   &tmpOffset) == 0)
-                                {
-                                  ret = -10;
-                                }
-                            }
-                          else if (tmp->type == LWES_U_INT_64_TOKEN)
-                            {
-                              if (marshall_U_INT_64 (*((LWES_U_INT_64 *)tmp->value),
-                                                     bytes,
-                                                     num_bytes,
-                                                     &tmpOffset) == 0)
-                                {
-                                  ret = -11;
-                                }
-                            }
-                          else if (tmp->type == LWES_INT_64_TOKEN)
-                            {
-                              if (marshall_INT_64 (*((LWES_INT_64 *)tmp->value),
-                                                   bytes,
-                                                   num_bytes,
-                                                   &tmpOffset) == 0)
-                                {
-                                  ret = -12;
-                                }
-                            }
-                          else if (tmp->type == LWES_BOOLEAN_TOKEN)
-                            {
-                              if (marshall_BOOLEAN (*((LWES_BOOLEAN *)tmp->value),
-                                                    bytes,
-                                                    num_bytes,
-                                                    &tmpOffset) == 0)
-                                {
-                                  ret = -13;
-                                }
-                            }
-                          else if (tmp->type == LWES_IP_ADDR_TOKEN)
-                            {
-                              if (marshall_IP_ADDR (*((LWES_IP_ADDR *)tmp->value),
-                                                    bytes,
-                                                    num_bytes,
-                                                    &tmpOffset) == 0)
-                                {
-                                  ret = -14;
-                                }
-                            }
-                          else if (tmp->type == LWES_STRING_TOKEN)
-                            {
-                              if (marshall_LONG_STRING ((LWES_LONG_STRING)tmp->value,
-                                                        bytes,
-                                                        num_bytes,
-                                                        &tmpOffset) == 0)
-                                {
-                                  ret = -15;
-                                }
-                            }
-                          else
-                            {
-                              /* should never be reached, but if it does,
-                               * there's some sort of  corruption with this
-                               * attribute of the event, so skip it */
-                            }
-                        }
-                    }
+/* PUBLIC : deserialize the wanted attributes of an event */
+int
+lwes_event_from_bytes_projected
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset,
+   struct lwes_event_deserialize_tmp *dtmp,
+   struct lwes_event_projection *projection)
+{
+  if (projection == NULL)
+    {
+      return -1;
+    }
+  return lwes_event_deserialize (event, bytes, num_bytes, offset, dtmp,
+                                 projection);
+}
+
+/* PUBLIC : create a projection which wants no attributes */
+struct lwes_event_projection *
+lwes_event_projection_create
+  (void)
+{
+  struct lwes_event_projection *projection =
+    (struct lwes_event_projection *)
+      malloc (sizeof (struct lwes_event_projection));
+
+  if (projection == NULL)
+    {
+      return NULL;
+    }
+
+  projection->attributes = lwes_hash_create ();
+  if (projection->attributes == NULL)
+    {
+      free (projection);
+      return NULL;
+    }
+  projection->events = lwes_hash_create ();
+  if (projection->events == NULL)
+    {
+      lwes_hash_destroy (projection->attributes);
+      free (projection);
+      return NULL;
+    }
+
+  return projection;
+}
+
+/* PUBLIC : cleanup a projection */
+int
+lwes_event_projection_destroy
+  (struct lwes_event_projection *projection)
+{
+  struct lwes_hash_enumeration e;
+  struct lwes_hash *wanted;
+
+  if (projection == NULL)
+    {
+      return 0;
+    }
+
+  /* the names belong to the shared table, only the hashes are freed */
+  if (lwes_hash_keys (projection->events, &e))
+    {
+      while (lwes_hash_enumeration_has_more_elements (&e))
+        {
+          wanted = (struct lwes_hash *)
+            lwes_hash_get (projection->events,
+                           lwes_hash_enumeration_next_element (&e));
+          lwes_hash_clear (wanted);
+          lwes_hash_destroy (wanted);
+        }
+    }
+  lwes_hash_clear (projection->events);
+  lwes_hash_destroy (projection->events);
+  lwes_hash_clear (projection->attributes);
+  lwes_hash_destroy (projection->attributes);
+  free (projection);
+
+  return 0;
+}
+
+/* PUBLIC : add an attribute to those wanted by a projection */
+int
+lwes_event_projection_add
+  (struct lwes_event_projection *projection,
+   LWES_CONST_SHORT_STRING event_name,
+   LWES_CONST_SHORT_STRING attribute_name)
+{
+  struct lwes_hash *wanted;
+  LWES_SHORT_STRING name;
+  LWES_SHORT_STRING key;
+  size_t length;
+
+  if (projection == NULL || attribute_name == NULL)
+    {
+      return -1;
+    }
+  length = strlen (attribute_name);
+  if (length > SHORT_STRING_MAX
+      || (event_name != NULL && strlen (event_name) > SHORT_STRING_MAX))
+    {
+      return -1;
+    }
+
+  name = lwes_intern (attribute_name, length);
+  if (name == NULL)
+    {
+      return -3;
+    }
+
+  wanted = projection->attributes;
+  if (event_name != NULL)
+    {
+      key = lwes_intern (event_name, strlen (event_name));
+      if (key == NULL)
+        {
+          return -3;
+        }
+      wanted = (struct lwes_hash *) lwes_hash_get (projection->events, key);
+      if (wanted == NULL)
+        {
+          wanted = lwes_hash_create ();
+          if (wanted == NULL)
+            {
+              return -3;
+            }
+          if (lwes_hash_put (projection->events, key, wanted) < 0)
+            {
+              lwes_hash_destroy (wanted);
+              return -3;
+            }
+        }
+    }
+
+  if (lwes_hash_contains_key (wanted, name))
+    {
+      return 0;
+    }
+  if (lwes_hash_put (wanted, name, name) < 0)
+    {
+      return -3;
+    }
+
+  return 0;
+}
+
+int lwes_event_set_U_INT_16 (struct lwes_event *       event,
+                             LWES_CONST_SHORT_STRING   attrName,
+                             LWES_U_INT_16             value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.u_int_16 = value;
+
+  return lwes_event_add (event, attrName, LWES_U_INT_16_TOKEN, &attrValue);
+}
+
+int lwes_event_set_INT_16 (struct lwes_event *       event,
+                           LWES_CONST_SHORT_STRING   attrName,
+                           LWES_INT_16               value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.int_16 = value;
+
+  return lwes_event_add (event, attrName, LWES_INT_16_TOKEN, &attrValue);
+}
+
+int lwes_event_set_U_INT_32 (struct lwes_event *       event,
+                             LWES_CONST_SHORT_STRING   attrName,
+                             LWES_U_INT_32             value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.u_int_32 = value;
+
+  return lwes_event_add (event, attrName, LWES_U_INT_32_TOKEN, &attrValue);
+}
+
+int lwes_event_set_INT_32 (struct lwes_event *       event,
+                           LWES_CONST_SHORT_STRING   attrName,
+                           LWES_INT_32               value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.int_32 = value;
+
+  return lwes_event_add (event, attrName, LWES_INT_32_TOKEN, &attrValue);
+}
+
+int lwes_event_set_U_INT_64 (struct lwes_event *       event,
+                             LWES_CONST_SHORT_STRING   attrName,
+                             LWES_U_INT_64             value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.u_int_64 = value;
+
+  return lwes_event_add (event, attrName, LWES_U_INT_64_TOKEN, &attrValue);
+}
+
+int lwes_event_set_U_INT_64_w_string (struct lwes_event *     event,
+                                      LWES_CONST_SHORT_STRING attrName,
+                                      LWES_CONST_SHORT_STRING uint64_string)
+{
+  LWES_INT_64 u_int_64;
+  if (event == NULL || attrName == NULL || uint64_string == NULL)
+    {
+      return -1;
+    }
+  if (lwes_INT_64_from_hex_string (uint64_string, &u_int_64) < 0)
+    {
+      return -2;
+    }
+  return lwes_event_set_U_INT_64 (event, attrName, u_int_64);
+}
+
+int lwes_event_set_INT_64 (struct lwes_event *       event,
+                           LWES_CONST_SHORT_STRING   attrName,
+                           LWES_INT_64               value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.int_64 = value;
+
+  return lwes_event_add (event, attrName, LWES_INT_64_TOKEN, &attrValue);
+}
+
+int lwes_event_set_INT_64_w_string (struct lwes_event       *event,
+                                    LWES_CONST_SHORT_STRING  attrName,
+                                    LWES_CONST_SHORT_STRING  int64_string)
+{
+  LWES_INT_64 int_64;
+
+  if (event == NULL || attrName == NULL || int64_string == NULL)
+    {
+      return -1;
+    }
+
+  if (lwes_INT_64_from_hex_string (int64_string,&int_64) < 0)
+    {
+      return -2;
+    }
+  return lwes_event_set_INT_64 (event, attrName, int_64);
+}
+
+int lwes_event_set_STRING (struct lwes_event *       event,
+                           LWES_CONST_SHORT_STRING   attrName,
+                           LWES_CONST_LONG_STRING    value)
+{
+  size_t length;
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  /* strings are the one value kept outside the attribute, one which is
+   * already set is copied over if it fits */
+  length = strlen (value) + 1;
+  if (lwes_event_update_string (event, lwes_event_index (event, attrName),
+                                value, length))
+    {
+      return event->number_of_attributes;
+    }
+  attrValue.string =
+    (LWES_LONG_STRING)lwes_event_arena_alloc (event, sizeof (LWES_CHAR)*length);
+  if (attrValue.string == NULL)
+    {
+      return -3;
+    }
+  memcpy (attrValue.string, value, length);
+
+  return lwes_event_add (event, attrName, LWES_STRING_TOKEN, &attrValue);
+}
+
+int lwes_event_set_IP_ADDR (struct lwes_event *       event,
+                            LWES_CONST_SHORT_STRING   attrName,
+                            LWES_IP_ADDR              value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.ip_addr = value;
+
+  return lwes_event_add (event, attrName, LWES_IP_ADDR_TOKEN, &attrValue);
+}
+
+int lwes_event_set_IP_ADDR_w_string (struct lwes_event *       event,
+                                     LWES_CONST_SHORT_STRING   attrName,
+                                     LWES_CONST_SHORT_STRING  value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.ip_addr.s_addr = inet_addr (value);
+
+  return lwes_event_add (event, attrName, LWES_IP_ADDR_TOKEN, &attrValue);
+}
+
+int lwes_event_set_BOOLEAN (struct lwes_event       * event,
+                            LWES_CONST_SHORT_STRING   attrName,
+                            LWES_BOOLEAN              value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || attrName == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.boolean = value;
+
+  return lwes_event_add (event, attrName, LWES_BOOLEAN_TOKEN, &attrValue);
+}
+
+
+/* ACCESSOR METHODS */
+
+int lwes_event_get_U_INT_16 (struct lwes_event       *event,
+                             LWES_CONST_SHORT_STRING  name,
+                             LWES_U_INT_16           *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_U_INT_16_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.u_int_16;
+      return 0;
+    }
+
+  return -1;
+}
+
+int lwes_event_get_INT_16 (struct lwes_event       *event,
+                           LWES_CONST_SHORT_STRING  name,
+                           LWES_INT_16             *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_INT_16_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.int_16;
+      return 0;
+    }
+  return -1;
+}
+
+int lwes_event_get_U_INT_32 (struct lwes_event       *event,
+                             LWES_CONST_SHORT_STRING  name,
+                             LWES_U_INT_32           *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_U_INT_32_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.u_int_32;
+      return 0;
+    }
+
+  return -1;
+}
+
+int lwes_event_get_INT_32 (struct lwes_event       *event,
+                           LWES_CONST_SHORT_STRING  name,
+                           LWES_INT_32             *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_INT_32_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.int_32;
+      return 0;
+    }
+
+  return -1;
+}
+
+int lwes_event_get_U_INT_64 (struct lwes_event       *event,
+                             LWES_CONST_SHORT_STRING  name,
+                             LWES_U_INT_64           *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_U_INT_64_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.u_int_64;
+      return 0;
+    }
+
+  return -1;
+}
+
+int lwes_event_get_INT_64 (struct lwes_event       *event,
+                           LWES_CONST_SHORT_STRING  name,
+                           LWES_INT_64             *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_INT_64_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.int_64;
+      return 0;
+    }
+
+  return -1;
+}
+
+int lwes_event_get_STRING (struct lwes_event       *event,
+                           LWES_CONST_SHORT_STRING  name,
+                           LWES_LONG_STRING        *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_STRING_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.string;
+      return 0;
+    }
+
+  return -1;
+}
+int lwes_event_get_IP_ADDR (struct lwes_event       *event,
+                            LWES_CONST_SHORT_STRING  name,
+                            LWES_IP_ADDR            *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_IP_ADDR_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.ip_addr;
+      return 0;
+    }
+  return -1;
+}
+
+int lwes_event_get_BOOLEAN (struct lwes_event       *event,
+                            LWES_CONST_SHORT_STRING  name,
+                            LWES_BOOLEAN            *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || name == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find (event, name);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_BOOLEAN_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.boolean;
+      return 0;
+    }
+  return -1;
+}
+
+struct lwes_event_attribute *
+lwes_event_get_attribute
+  (struct lwes_event       *event,
+   LWES_CONST_SHORT_STRING  name)
+{
+  if (event == NULL || name == NULL)
+    {
+      return NULL;
+    }
+
+  return lwes_event_find (event, name);
+}
+
+/* KEYS */
+
+int
+lwes_attr_key_init
+  (struct lwes_attr_key *key,
+   LWES_CONST_SHORT_STRING name)
+{
+  if (key == NULL || name == NULL)
+    {
+      return -1;
+    }
+
+  /* the shared copy lives as long as the process, so the key can too */
+  key->length = strlen (name);
+  key->name   = lwes_intern (name, key->length);
+  if (key->name == NULL)
+    {
+      return -3;
+    }
+  key->prefix = lwes_event_name_prefix (key->name, key->length);
+  key->hash   = lwes_hash (key->name);
+
+  return 0;
+}
+
+int
+lwes_event_set_U_INT_16_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_16               value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.u_int_16 = value;
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_U_INT_16_TOKEN, &attrValue);
+}
+
+int
+lwes_event_set_INT_16_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_16                 value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.int_16 = value;
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_INT_16_TOKEN, &attrValue);
+}
+
+int
+lwes_event_set_U_INT_32_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_32               value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.u_int_32 = value;
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_U_INT_32_TOKEN, &attrValue);
+}
+
+int
+lwes_event_set_INT_32_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_32                 value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.int_32 = value;
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_INT_32_TOKEN, &attrValue);
+}
+
+int
+lwes_event_set_U_INT_64_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_64               value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.u_int_64 = value;
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_U_INT_64_TOKEN, &attrValue);
+}
+
+int
+lwes_event_set_INT_64_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_64                 value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.int_64 = value;
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_INT_64_TOKEN, &attrValue);
+}
+
+int
+lwes_event_set_STRING_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_CONST_LONG_STRING      value)
+{
+  size_t length;
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  length = strlen (value) + 1;
+  if (lwes_event_update_string (event, lwes_event_index_key (event, key),
+                                value, length))
+    {
+      return event->number_of_attributes;
+    }
+  attrValue.string =
+    (LWES_LONG_STRING)lwes_event_arena_alloc (event, sizeof (LWES_CHAR)*length);
+  if (attrValue.string == NULL)
+    {
+      return -3;
+    }
+  memcpy (attrValue.string, value, length);
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_STRING_TOKEN, &attrValue);
+}
+
+int
+lwes_event_set_IP_ADDR_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_IP_ADDR                value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.ip_addr = value;
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_IP_ADDR_TOKEN, &attrValue);
+}
+
+int
+lwes_event_set_BOOLEAN_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_BOOLEAN                value)
+{
+  union lwes_event_attribute_value attrValue;
+
+  if (event == NULL || key == NULL)
+    {
+      return -1;
+    }
+
+  attrValue.boolean = value;
+
+  return lwes_event_add_name (event, key->name, key->length, key,
+                              LWES_BOOLEAN_TOKEN, &attrValue);
+}
+
+/* MANY AT ONCE */
+
+int
+lwes_event_set_many
+  (struct lwes_event           *event,
+   const struct lwes_attr_desc *descs,
+   size_t                       n)
+{
+  const struct lwes_attr_desc *desc;
+  struct lwes_event_attribute *attribute;
+  union lwes_event_attribute_value attrValue;
+  LWES_SHORT_STRING name;
+  char *room        = NULL;
+  size_t room_size  = 0;
+  size_t added      = 0;
+  size_t length;
+  size_t size;
+  size_t i;
+  int total;
+  int index;
+  int ret;
+
+  if (event == NULL || (descs == NULL && n > 0))
+    {
+      return -1;
+    }
+
+  /* check them all before setting any, so that bad arguments leave the
+   * event as it was, working out what will be added and what copied */
+  for (i = 0; i < n; i++)
+    {
+      desc = &(descs[i]);
+      if (desc->key == NULL && desc->name == NULL)
+        {
+          return -1;
+        }
+      if (desc->type == LWES_STRING_TOKEN && desc->value.string == NULL)
+        {
+          return -1;
+        }
+      /* only the types there are have a size */
+      if (lwes_event_value_size (desc->type, &(desc->value)) == 0)
+        {
+          return -1;
+        }
+      /* and those the event db has for the event */
+      ret = lwes_event_check (event,
+                              (desc->key != NULL) ? desc->key->name
+                                                  : desc->name,
+                              desc->key, desc->type);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* a name given twice is counted twice, which only errs on the side
+       * of making too much room */
+      index = (desc->key != NULL)
+                ? lwes_event_index_key (event, desc->key)
+                : lwes_event_index (event, desc->name);
+      if (index < 0)
+        {
+          added++;
+          if (desc->key == NULL
+              && lwes_intern (desc->name, strlen (desc->name)) == NULL)
+            {
+              room_size +=
+                LWES_EVENT_ARENA_ALIGN (strlen (desc->name) + 1);
+            }
+        }
+      if (desc->type == LWES_STRING_TOKEN)
+        {
+          length    = strlen (desc->value.string) + 1;
+          attribute = (index < 0) ? NULL : &(event->entries[index].attribute);
+          if (attribute == NULL
+              || attribute->type != LWES_STRING_TOKEN
+              || attribute->capacity < length)
+            {
+              room_size += LWES_EVENT_ARENA_ALIGN (length);
+            }
+        }
+    }
+  if (added > (size_t)(USHRT_MAX - event->number_of_attributes))
+    {
+      return -1;
+    }
+
+  /* then make room for them all in one go, rather than growing the
+   * entries and the hash and taking copies as they are added, so that
+   * running out of memory leaves the event as it was too */
+  if (room_size > 0)
+    {
+      room = (char *)lwes_event_arena_alloc (event, room_size);
+      if (room == NULL)
+        {
+          return -3;
+        }
+    }
+  total = event->number_of_attributes + (int)added;
+  if (total > event->entries_size
+      && lwes_event_entries_grow (event, total) < 0)
+    {
+      return -3;
+    }
+  if (total > LWES_EVENT_SMALL_ATTRIBUTES
+      && event->attributes == NULL
+      && lwes_event_attributes_init (event, 2 * total) < 0)
+    {
+      return -3;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      desc      = &(descs[i]);
+      attrValue = desc->value;
+      index     = (desc->key != NULL)
+                    ? lwes_event_index_key (event, desc->key)
+                    : lwes_event_index (event, desc->name);
+      if (desc->type == LWES_STRING_TOKEN)
+        {
+          length = strlen (desc->value.string) + 1;
+          if (lwes_event_update_string (event, index,
+                                        desc->value.string, length))
+            {
+              continue;
+            }
+          attrValue.string =
+            (LWES_LONG_STRING)lwes_event_set_many_room (event, &room,
+                                                        &room_size,
+                                                        sizeof (LWES_CHAR)
+                                                          * length);
+          if (attrValue.string == NULL)
+            {
+              return -3;
+            }
+          memcpy (attrValue.string, desc->value.string, length);
+        }
+
+      /* which were all checked above */
+      if (desc->key != NULL)
+        {
+          ret = lwes_event_put (event, desc->key->name, desc->key->length,
+                                desc->key, desc->type, &attrValue);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          continue;
+        }
+
+      length = strlen (desc->name);
+      if (index >= 0)
+        {
+          name = event->entries[index].name;
+        }
+      else
+        {
+          name = lwes_intern (desc->name, length);
+          if (name == NULL)
+            {
+              size = sizeof (LWES_CHAR) * (length + 1);
+              name = (LWES_SHORT_STRING)
+                       lwes_event_set_many_room (event, &room, &room_size,
+                                                 size);
+              if (name == NULL)
+                {
+                  return -3;
                 }
+              memcpy (name, desc->name, length);
+              name[length] = '\0';
             }
         }
-      else
+      ret = lwes_event_put (event, name, length, NULL,
+                            desc->type, &attrValue);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return event->number_of_attributes;
+}
+
+int
+lwes_event_get_U_INT_16_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_16              *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_U_INT_16_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.u_int_16;
+      return 0;
+    }
+
+  return -1;
+}
+
+int
+lwes_event_get_INT_16_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_16                *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_INT_16_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.int_16;
+      return 0;
+    }
+
+  return -1;
+}
+
+int
+lwes_event_get_U_INT_32_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_32              *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_U_INT_32_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.u_int_32;
+      return 0;
+    }
+
+  return -1;
+}
+
+int
+lwes_event_get_INT_32_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_32                *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_INT_32_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.int_32;
+      return 0;
+    }
+
+  return -1;
+}
+
+int
+lwes_event_get_U_INT_64_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_64              *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_U_INT_64_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.u_int_64;
+      return 0;
+    }
+
+  return -1;
+}
+
+int
+lwes_event_get_INT_64_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_64                *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_INT_64_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.int_64;
+      return 0;
+    }
+
+  return -1;
+}
+
+int
+lwes_event_get_STRING_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_LONG_STRING           *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_STRING_TOKEN)
         {
-          ret = -16;
+          return -2;
         }
+      *value = tmp->value.string;
+      return 0;
     }
-  else
+
+  return -1;
+}
+
+int
+lwes_event_get_IP_ADDR_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_IP_ADDR               *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
     {
-      ret = -17;
+      return -1;
     }
 
-  return ((ret < 0) ? ret : (int)(tmpOffset-offset));
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_IP_ADDR_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.ip_addr;
+      return 0;
+    }
+
+  return -1;
 }
 
-/* PUBLIC : deserialize the event from a byte array and into an event */
 int
-lwes_event_from_bytes
+lwes_event_get_BOOLEAN_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_BOOLEAN               *value)
+{
+  struct lwes_event_attribute *tmp;
+
+  if (event == NULL || key == NULL || value == NULL)
+    {
+      return -1;
+    }
+
+  tmp = lwes_event_find_key (event, key);
+
+  if (tmp)
+    {
+      if (tmp->type != LWES_BOOLEAN_TOKEN)
+        {
+          return -2;
+        }
+      *value = tmp->value.boolean;
+      return 0;
+    }
+
+  return -1;
+}
+
+/*************************************************************************
+  PRIVATE API
+ *************************************************************************/
+/* The shared copy of a name, or one out of the storage of the event.
+ * Names off the network are only looked up, as interning them would fill
+ * the table for good with whatever senders make up */
+static LWES_SHORT_STRING
+lwes_event_name
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name,
+   size_t length,
+   int intern)
+{
+  LWES_SHORT_STRING copy = intern ? lwes_intern (name, length)
+                                  : lwes_intern_lookup (name, length);
+
+  /* names which can't be interned are copied as before */
+  if (copy == NULL)
+    {
+      copy =
+        (LWES_SHORT_STRING) lwes_event_arena_alloc (event,
+                                                    sizeof (LWES_CHAR)
+                                                      * (length + 1));
+      if (copy != NULL)
+        {
+          memcpy (copy, name, length);
+          copy[length] = '\0';
+        }
+    }
+
+  return copy;
+}
+
+static int
+lwes_event_name_set
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name,
+   size_t length,
+   int intern)
+{
+  LWES_SHORT_STRING copy;
+
+  if (event->eventName != NULL)
+    {
+      return -1;
+    }
+
+  copy = lwes_event_name (event, name, length, intern);
+  if (copy == NULL)
+    {
+      return -3;
+    }
+
+  /* what the db allows is looked up once for all the attributes */
+  if (event->type_db != NULL)
+    {
+      event->schema = lwes_event_type_db_get_schema (event->type_db, copy);
+      if (event->schema == NULL)
+        {
+          return -3;
+        }
+      event->schema_generation = event->type_db->generation;
+    }
+  event->eventName = copy;
+  event->serialized_size += length;
+
+  return 0;
+}
+
+static int
+lwes_event_string_in_bytes
+  (LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t *offset,
+   size_t length_size,
+   LWES_CONST_LONG_STRING *string,
+   size_t *length)
+{
+  const void *nul;
+  size_t data_length;
+  LWES_BYTE tmp_byte;
+  LWES_U_INT_16 tmp_uint16;
+
+  if (length_size == sizeof (LWES_BYTE))
+    {
+      if (unmarshall_BYTE (&tmp_byte, bytes, num_bytes, offset) == 0)
+        {
+          return 0;
+        }
+      data_length = tmp_byte;
+    }
+  else
+    {
+      if (unmarshall_U_INT_16 (&tmp_uint16, bytes, num_bytes, offset) == 0)
+        {
+          return 0;
+        }
+      data_length = tmp_uint16;
+    }
+
+  if (num_bytes - (*offset) < data_length)
+    {
+      return 0;
+    }
+
+  /* a nul in the bytes ends the string, as it would once copied */
+  *string = (LWES_CONST_LONG_STRING)(bytes + (*offset));
+  nul     = memchr (*string, '\0', data_length);
+  *length = (nul == NULL) ? data_length
+                          : (size_t)((const char *)nul - *string);
+  (*offset) += data_length;
+
+  return 1;
+}
+
+/* Deserialize an event, skipping any attributes not wanted */
+static int
+lwes_event_deserialize
   (struct lwes_event *event,
    LWES_BYTE_P bytes,
    size_t num_bytes,
    size_t offset,
-   struct lwes_event_deserialize_tmp *dtmp)
+   struct lwes_event_deserialize_tmp *dtmp,
+   struct lwes_event_projection *projection)
 {
   int i;
   LWES_U_INT_16 tmp_number_of_attributes = 0;
   size_t tmpOffset = offset;
+  struct lwes_hash *wanted = NULL;
+  int ret;
 
-  LWES_BYTE         tmp_byte;
-  LWES_U_INT_16     tmp_uint16;
-  LWES_INT_16       tmp_int16;
-  LWES_U_INT_32     tmp_uint32;
-  LWES_INT_32       tmp_int32;
-  LWES_U_INT_64     tmp_uint64;
-  LWES_INT_64       tmp_int64;
-  LWES_BOOLEAN      tmp_boolean;
-  LWES_IP_ADDR      tmp_ip_addr;
-  LWES_SHORT_STRING tmp_short_str;
-  LWES_LONG_STRING  tmp_long_str;
+  LWES_BYTE                        tmp_byte;
+  LWES_U_INT_16                    tmp_uint16;
+  LWES_CONST_SHORT_STRING          name;
+  size_t                           name_length;
+  LWES_CONST_LONG_STRING           string;
+  size_t                           string_length;
+  union lwes_event_attribute_value value;
 
   if (   event == NULL
       || bytes == NULL
@@ -573,32 +2041,55 @@ lwes_event_from_bytes
       return -1;
     }
 
-  tmp_short_str = dtmp->tmp_string;
-  tmp_long_str  = dtmp->tmp_string_long;
+  /* names and strings are copied straight out of the bytes and into the
+   * event, or shared, rather than going through dtmp first */
 
   /* unmarshall the event name */
-  if (unmarshall_SHORT_STRING (tmp_short_str,
-                                (SHORT_STRING_MAX+1),
-                                bytes,
-                                num_bytes,
-                                &tmpOffset))
+  if (lwes_event_string_in_bytes (bytes,
+                                  num_bytes,
+                                  &tmpOffset,
+                                  sizeof (LWES_BYTE),
+                                  &name,
+                                  &name_length))
     {
-      /* copies the data out of tmp_short_str */
-      if (lwes_event_set_name (event, tmp_short_str) == 0)
+      if (lwes_event_name_set (event, name, name_length, 0) == 0)
         {
           /* unmarshall the number of elements */
           if (unmarshall_U_INT_16 (&tmp_uint16,bytes,num_bytes,&tmpOffset))
             {
               tmp_number_of_attributes = tmp_uint16;
 
+              if (projection != NULL)
+                {
+                  wanted = (struct lwes_hash *)
+                    lwes_hash_get (projection->events, event->eventName);
+                }
+
               for (i = 0; i < tmp_number_of_attributes; i++)
                 {
-                  /* unmarshall the attribute name */
-                  if (unmarshall_SHORT_STRING (tmp_short_str,
-                                                (SHORT_STRING_MAX+1),
-                                                bytes,
-                                                num_bytes,
-                                                &tmpOffset))
+                  if (projection != NULL)
+                    {
+                      ret = lwes_event_projection_skip (projection, wanted,
+                                                        bytes, num_bytes,
+                                                        &tmpOffset);
+                      if (ret < 0)
+                        {
+                          return ret;
+                        }
+                      if (ret > 0)
+                        {
+                          continue;
+                        }
+                    }
+
+                  /* find the attribute name, it is only copied once its
+                   * value has been read */
+                  if (lwes_event_string_in_bytes (bytes,
+                                                  num_bytes,
+                                                  &tmpOffset,
+                                                  sizeof (LWES_BYTE),
+                                                  &name,
+                                                  &name_length))
                     {
                       /* unmarshall the type id */
                       if (unmarshall_BYTE         (&tmp_byte,
@@ -608,14 +2099,16 @@ lwes_event_from_bytes
                         {
                           if (tmp_byte == LWES_U_INT_16_TOKEN)
                             {
-                              if (unmarshall_U_INT_16     (&tmp_uint16,
-                                                            bytes,
-                                                            num_bytes,
-                                                            &tmpOffset))
+                              if (unmarshall_U_INT_16 (&(value.u_int_16),
+                                                 bytes,
+                                                 num_bytes,
+                                                 &tmpOffset))
                                 {
-                                  if (lwes_event_set_U_INT_16 (event,
-                                                                tmp_short_str,
-                                                                tmp_uint16)
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -2;
@@ -628,19 +2121,21 @@ lwes_event_from_bytes
                             }
                           else if (tmp_byte == LWES_INT_16_TOKEN)
                             {
-                              if (unmarshall_INT_16       (&tmp_int16,
-                                                            bytes,
-                                                            num_bytes,
-                                                            &tmpOffset))
+                              if (unmarshall_INT_16 (&(value.int_16),
+                                                 bytes,
+                                                 num_bytes,
+                                                 &tmpOffset))
                                 {
-                                  if (lwes_event_set_INT_16   (event,
-                                                                tmp_short_str,
-                                                                tmp_int16)
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -4;
                                     }
-                                 }
+                                }
                               else
                                 {
                                   return -5;
@@ -648,14 +2143,16 @@ lwes_event_from_bytes
                             }
                           else if (tmp_byte == LWES_U_INT_32_TOKEN)
                             {
-                              if (unmarshall_U_INT_32     (&tmp_uint32,
-                                                            bytes,
-                                                            num_bytes,
-                                                            &tmpOffset))
+                              if (unmarshall_U_INT_32 (&(value.u_int_32),
+                                                 bytes,
+                                                 num_bytes,
+                                                 &tmpOffset))
                                 {
-                                  if (lwes_event_set_U_INT_32 (event,
-                                                                tmp_short_str,
-                                                                tmp_uint32)
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -6;
@@ -668,14 +2165,16 @@ lwes_event_from_bytes
                             }
                           else if (tmp_byte == LWES_INT_32_TOKEN)
                             {
-                              if (unmarshall_INT_32       (&tmp_int32,
-                                                            bytes,
-                                                            num_bytes,
-                                                            &tmpOffset))
+                              if (unmarshall_INT_32 (&(value.int_32),
+                                                 bytes,
+                                                 num_bytes,
+                                                 &tmpOffset))
                                 {
-                                  if (lwes_event_set_INT_32   (event,
-                                                                tmp_short_str,
-                                                                tmp_int32)
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -8;
@@ -688,14 +2187,16 @@ lwes_event_from_bytes
                             }
                           else if (tmp_byte == LWES_U_INT_64_TOKEN)
                             {
-                              if (unmarshall_U_INT_64     (&tmp_uint64,
-                                                            bytes,
-                                                            num_bytes,
-                                                            &tmpOffset))
+                              if (unmarshall_U_INT_64 (&(value.u_int_64),
+                                                 bytes,
+                                                 num_bytes,
+                                                 &tmpOffset))
                                 {
-                                  if (lwes_event_set_U_INT_64 (event,
-                                                                tmp_short_str,
-                                                                tmp_uint64)
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -10;
@@ -708,14 +2209,16 @@ lwes_event_from_bytes
                             }
                           else if (tmp_byte == LWES_INT_64_TOKEN)
                             {
-                              if (unmarshall_INT_64         (&tmp_int64,
-                                                              bytes,
-                                                              num_bytes,
-                                                              &tmpOffset))
+                              if (unmarshall_INT_64 (&(value.int_64),
+                                                 bytes,
+                                                 num_bytes,
+                                                 &tmpOffset))
                                 {
-                                  if (lwes_event_set_INT_64     (event,
-                                                                  tmp_short_str,
-                                                                  tmp_int64)
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -12;
@@ -728,14 +2231,16 @@ lwes_event_from_bytes
                             }
                           else if (tmp_byte == LWES_BOOLEAN_TOKEN)
                             {
-                              if (unmarshall_BOOLEAN        (&tmp_boolean,
-                                                              bytes,
-                                                              num_bytes,
-                                                              &tmpOffset))
+                              if (unmarshall_BOOLEAN (&(value.boolean),
+                                                 bytes,
+                                                 num_bytes,
+                                                 &tmpOffset))
                                 {
-                                  if (lwes_event_set_BOOLEAN    (event,
-                                                                  tmp_short_str,
-                                                                  tmp_boolean)
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -14;
@@ -748,14 +2253,16 @@ lwes_event_from_bytes
                             }
                           else if (tmp_byte == LWES_IP_ADDR_TOKEN)
                             {
-                              if (unmarshall_IP_ADDR        (&tmp_ip_addr,
-                                                              bytes,
-                                                              num_bytes,
-                                                              &tmpOffset))
+                              if (unmarshall_IP_ADDR (&(value.ip_addr),
+                                                 bytes,
+                                                 num_bytes,
+                                                 &tmpOffset))
                                 {
-                                  if (lwes_event_set_IP_ADDR (event,
-                                                               tmp_short_str,
-                                                               tmp_ip_addr)
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -16;
@@ -768,15 +2275,31 @@ lwes_event_from_bytes
                             }
                           else if (tmp_byte == LWES_STRING_TOKEN)
                             {
-                              if (unmarshall_LONG_STRING (tmp_long_str,
-                                                           (LONG_STRING_MAX+1),
-                                                           bytes,
-                                                           num_bytes,
-                                                           &tmpOffset))
+                              if (lwes_event_string_in_bytes (bytes,
+                                                              num_bytes,
+                                                              &tmpOffset,
+                                                              sizeof
+                                                                (LWES_U_INT_16),
+                                                              &string,
+                                                              &string_length))
                                 {
-                                  if (lwes_event_set_STRING (event,
-                                                              tmp_short_str,
-                                                              tmp_long_str)
+                                  value.string =
+                                    (LWES_LONG_STRING)
+                                      lwes_event_arena_alloc
+                                        (event,
+                                         sizeof (LWES_CHAR)
+                                           * (string_length + 1));
+                                  if (value.string == NULL)
+                                    {
+                                      return -18;
+                                    }
+                                  memcpy (value.string, string, string_length);
+                                  value.string[string_length] = '\0';
+                                  if (lwes_event_add_from_bytes (event,
+                                                                 name,
+                                                                 name_length,
+                                                                 tmp_byte,
+                                                                 &value)
                                        < 0)
                                     {
                                       return -18;
@@ -812,606 +2335,1321 @@ lwes_event_from_bytes
         {
           return -24;
         }
-     }
-   else
-     {
-       return -25;
-     }
+     }
+   else
+     {
+       return -25;
+     }
+
+  return (int)(tmpOffset-offset);
+}
+
+static int
+lwes_event_projection_skip
+  (struct lwes_event_projection *projection,
+   struct lwes_hash *wanted,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t *offset)
+{
+  LWES_SHORT_STRING name;
+  LWES_BYTE     length;
+  LWES_BYTE     type;
+  LWES_U_INT_16 string_length;
+  size_t tmpOffset = *offset;
+  size_t size;
+  int error;
+
+  if (unmarshall_BYTE (&length, bytes, num_bytes, &tmpOffset) == 0
+      || num_bytes - tmpOffset < length)
+    {
+      return -22;
+    }
+
+  /* every wanted name has been interned, so a name which hasn't been
+   * can't be wanted */
+  name = lwes_intern_lookup ((LWES_CONST_SHORT_STRING)(bytes + tmpOffset),
+                             length);
+  if (name != NULL
+      && ((wanted != NULL && lwes_hash_contains_key (wanted, name))
+          || lwes_hash_contains_key (projection->attributes, name)))
+    {
+      return 0;
+    }
+  tmpOffset += length;
+
+  if (unmarshall_BYTE (&type, bytes, num_bytes, &tmpOffset) == 0)
+    {
+      return -21;
+    }
+
+  /* skip over the value without decoding it, failing as deserializing
+   * it would have */
+  if (type == LWES_U_INT_16_TOKEN)
+    {
+      size  = sizeof (LWES_U_INT_16);
+      error = -3;
+    }
+  else if (type == LWES_INT_16_TOKEN)
+    {
+      size  = sizeof (LWES_INT_16);
+      error = -5;
+    }
+  else if (type == LWES_U_INT_32_TOKEN)
+    {
+      size  = sizeof (LWES_U_INT_32);
+      error = -7;
+    }
+  else if (type == LWES_INT_32_TOKEN)
+    {
+      size  = sizeof (LWES_INT_32);
+      error = -9;
+    }
+  else if (type == LWES_U_INT_64_TOKEN)
+    {
+      size  = sizeof (LWES_U_INT_64);
+      error = -11;
+    }
+  else if (type == LWES_INT_64_TOKEN)
+    {
+      size  = sizeof (LWES_INT_64);
+      error = -13;
+    }
+  else if (type == LWES_BOOLEAN_TOKEN)
+    {
+      size  = sizeof (LWES_BYTE);
+      error = -15;
+    }
+  else if (type == LWES_IP_ADDR_TOKEN)
+    {
+      size  = sizeof (LWES_U_INT_32);
+      error = -17;
+    }
+  else if (type == LWES_STRING_TOKEN)
+    {
+      if (unmarshall_U_INT_16 (&string_length,
+                               bytes, num_bytes, &tmpOffset) == 0)
+        {
+          return -19;
+        }
+      size  = string_length;
+      error = -19;
+    }
+  else
+    {
+      return -20;
+    }
+
+  if (num_bytes - tmpOffset < size)
+    {
+      return error;
+    }
+
+  *offset = tmpOffset + size;
+  return 1;
+}
+
+/* Serialize the event into a byte array, every attribute of it */
+static int
+lwes_event_marshall
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset)
+{
+  struct lwes_event_attribute *encodingAttr;
+  struct lwes_event_attribute_entry *entry;
+  size_t tmpOffset = offset;
+  int ret = 0;
+  int i;
+
+  /* the event knows how many bytes it serializes to, so once there is
+   * room for them there is no need to check for room along the way, this
+   * goes on to find where it runs out for the error to return */
+  if (num_bytes - offset >= event->serialized_size)
+    {
+      return lwes_event_marshall_unchecked (event, bytes, offset);
+    }
+
+  /* start with the event name */
+  if (marshall_SHORT_STRING (event->eventName,
+                              bytes,
+                              num_bytes,
+                              &tmpOffset))
+    {
+      /* then the number of attributes */
+      if (marshall_U_INT_16     (event->number_of_attributes,
+                                  bytes,
+                                  num_bytes,
+                                  &tmpOffset))
+        {
+          /* handle encoding first if it is set */
+          encodingAttr =
+            lwes_event_find (event, (LWES_SHORT_STRING)LWES_ENCODING);
+
+          if (encodingAttr)
+            {
+              LWES_BYTE encodingType = encodingAttr->type;
+              if (encodingType == LWES_INT_16_TOKEN)
+                {
+                  if (marshall_SHORT_STRING
+                        ((LWES_SHORT_STRING)LWES_ENCODING,
+                         bytes,
+                         num_bytes,
+                         &tmpOffset) == 0
+                      ||
+                      marshall_BYTE
+                        (encodingType,
+                         bytes,
+                         num_bytes,
+                         &tmpOffset) == 0
+                      ||
+                      marshall_INT_16
+                        (encodingAttr->value.int_16,
+                         bytes,
+                         num_bytes,
+                         &tmpOffset) == 0)
+                    {
+                      return -2;
+                    }
+                  encodingAttr->offset =
+                    (LWES_U_INT_32)(tmpOffset - offset - sizeof (LWES_INT_16));
+                  encodingAttr->dirty  = 0;
+                }
+              else
+                {
+                  return -3;
+                }
+            }
+
+          /* then the rest of the attributes in the order they were set */
+          for (i = 0; i < event->number_of_attributes && ret == 0; i++)
+            {
+              entry = &(event->entries[i]);
+
+              /* skip encoding as we've dealt with it above */
+              if (! strcmp (entry->name, LWES_ENCODING))
+                {
+                  continue;
+                }
+
+              ret = lwes_event_attribute_to_bytes (entry->name,
+                                                   &(entry->attribute),
+                                                   bytes,
+                                                   num_bytes,
+                                                   &tmpOffset,
+                                                   offset);
+            }
+        }
+      else
+        {
+          ret = -16;
+        }
+    }
+  else
+    {
+      ret = -17;
+    }
 
-  return (int)(tmpOffset-offset);
+  return ((ret < 0) ? ret : (int)(tmpOffset-offset));
 }
 
-int lwes_event_set_U_INT_16 (struct lwes_event *       event,
-                             LWES_CONST_SHORT_STRING   attrName,
-                             LWES_U_INT_16             value)
+/* Serialize the event into a byte array known to have room for all of it,
+ * returning the same errors as lwes_event_marshall for what can still go
+ * wrong */
+static int
+lwes_event_marshall_unchecked
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t offset)
 {
-  int ret = 0;
-  LWES_U_INT_16 *attrValue;
+  struct lwes_event_attribute *encodingAttr;
+  struct lwes_event_attribute_entry *entry;
+  size_t tmpOffset = offset;
+  int ret;
+  int i;
 
-  if (event == NULL || attrName == NULL)
+  /* the event name, then the number of attributes */
+  if (lwes_event_name_to_bytes_unchecked (event->eventName,
+                                          bytes, &tmpOffset) < 0)
     {
-      return -1;
+      return -17;
     }
+  marshall_U_INT_16_unchecked (event->number_of_attributes,
+                               bytes, &tmpOffset);
 
-  attrValue = (LWES_U_INT_16 *)malloc (sizeof (LWES_U_INT_16));
-
-  if (attrValue == NULL)
+  /* then the encoding if it is set, ahead of everything else */
+  encodingAttr = lwes_event_find (event, (LWES_SHORT_STRING)LWES_ENCODING);
+  if (encodingAttr != NULL)
     {
-      return -3;
+      if (encodingAttr->type != LWES_INT_16_TOKEN)
+        {
+          return -3;
+        }
+      lwes_event_name_to_bytes_unchecked (LWES_ENCODING, bytes, &tmpOffset);
+      marshall_BYTE_unchecked (encodingAttr->type, bytes, &tmpOffset);
+      encodingAttr->offset = (LWES_U_INT_32)(tmpOffset - offset);
+      encodingAttr->dirty  = 0;
+      marshall_INT_16_unchecked (encodingAttr->value.int_16,
+                                 bytes, &tmpOffset);
     }
-  *attrValue = value;
 
-  ret = lwes_event_add (event, attrName, LWES_U_INT_16_TOKEN, attrValue);
-  if (ret < 0)
+  /* then the rest of the attributes in the order they were set */
+  for (i = 0; i < event->number_of_attributes; i++)
     {
-      free (attrValue);
+      entry = &(event->entries[i]);
+      if (&(entry->attribute) == encodingAttr)
+        {
+          continue;
+        }
+      ret = lwes_event_attribute_to_bytes_unchecked (entry->name,
+                                                     &(entry->attribute),
+                                                     bytes,
+                                                     &tmpOffset,
+                                                     offset);
+      if (ret < 0)
+        {
+          return ret;
+        }
     }
-  return ret;
+
+  return (int)(tmpOffset - offset);
 }
 
-int lwes_event_set_INT_16 (struct lwes_event *       event,
-                           LWES_CONST_SHORT_STRING   attrName,
-                           LWES_INT_16               value)
+/* Bring the bytes the event last serialized to up to date */
+static int
+lwes_event_serialize
+  (struct lwes_event *event)
 {
-  int ret = 0;
-  LWES_INT_16 *attrValue;
+  struct lwes_event_attribute_entry *entry;
+  LWES_BYTE_P serialized;
+  size_t capacity;
+  size_t tmpOffset;
+  int ret;
+  int i;
 
-  if (event == NULL || attrName == NULL)
+  /* make room for all of it, keeping what is there */
+  if (event->serialized_capacity < event->serialized_size)
     {
-      return -1;
+      capacity = 2 * event->serialized_capacity;
+      if (capacity < event->serialized_size)
+        {
+          capacity = event->serialized_size;
+        }
+      serialized = (LWES_BYTE_P) malloc (capacity);
+      if (serialized == NULL)
+        {
+          return -3;
+        }
+      if (event->serialized_valid)
+        {
+          memcpy (serialized, event->serialized, event->serialized_length);
+        }
+      free (event->serialized);
+      event->serialized          = serialized;
+      event->serialized_capacity = capacity;
     }
 
-  attrValue = (LWES_INT_16 *)malloc (sizeof (LWES_INT_16));
-
-  if (attrValue == NULL)
+  if (! event->serialized_valid)
     {
-      return -3;
+      ret = lwes_event_marshall (event,
+                                 event->serialized,
+                                 event->serialized_capacity,
+                                 0);
+      if (ret < 0)
+        {
+          return ret;
+        }
+      event->serialized_length     = (size_t)ret;
+      event->serialized_attributes = event->number_of_attributes;
+      event->serialized_valid      = 1;
+      event->dirty_attributes      = 0;
+      return 0;
     }
-  *attrValue = value;
 
-  ret = lwes_event_add (event, attrName, LWES_INT_16_TOKEN, attrValue);
-  if (ret < 0)
+  /* rewrite the values which changed, they are the same size as before */
+  for (i = 0;
+       i < event->number_of_attributes && event->dirty_attributes > 0;
+       i++)
     {
-      free(attrValue);
+      entry = &(event->entries[i]);
+      if (entry->attribute.dirty)
+        {
+          tmpOffset = entry->attribute.offset;
+          lwes_event_value_to_bytes_unchecked (&(entry->attribute),
+                                               event->serialized,
+                                               &tmpOffset);
+          entry->attribute.dirty = 0;
+          event->dirty_attributes--;
+        }
     }
-  return ret;
-}
-
-int lwes_event_set_U_INT_32 (struct lwes_event *       event,
-                             LWES_CONST_SHORT_STRING   attrName,
-                             LWES_U_INT_32             value)
-{
-  int ret = 0;
-  LWES_U_INT_32 *attrValue;
 
-  if (event == NULL || attrName == NULL)
+  /* then add on the attributes set since, and count them */
+  if (event->serialized_attributes < event->number_of_attributes)
     {
-      return -1;
+      tmpOffset = event->serialized_length;
+      for (i = event->serialized_attributes;
+           i < event->number_of_attributes;
+           i++)
+        {
+          entry = &(event->entries[i]);
+          ret = lwes_event_attribute_to_bytes_unchecked (entry->name,
+                                                         &(entry->attribute),
+                                                         event->serialized,
+                                                         &tmpOffset,
+                                                         0);
+          if (ret < 0)
+            {
+              event->serialized_valid = 0;
+              return ret;
+            }
+        }
+      event->serialized_length     = tmpOffset;
+      event->serialized_attributes = event->number_of_attributes;
+
+      /* the count follows the name, which starts with its length */
+      tmpOffset = sizeof (LWES_BYTE) + event->serialized[0];
+      marshall_U_INT_16_unchecked (event->number_of_attributes,
+                                   event->serialized,
+                                   &tmpOffset);
     }
 
-  attrValue = (LWES_U_INT_32 *)malloc(sizeof(LWES_U_INT_32));
+  return 0;
+}
 
-  if (attrValue == NULL)
+/* Serialize a single attribute of an event */
+static int
+lwes_event_attribute_to_bytes
+  (LWES_CONST_SHORT_STRING name,
+   struct lwes_event_attribute *attribute,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t *offset,
+   size_t start)
+{
+  if (marshall_SHORT_STRING ((LWES_SHORT_STRING)name,
+                             bytes,
+                             num_bytes,
+                             offset) == 0)
     {
-      return -3;
+      return -5;
     }
-  *attrValue = value;
-
-  ret = lwes_event_add (event, attrName, LWES_U_INT_32_TOKEN, attrValue);
-  if (ret < 0)
+  if (marshall_BYTE (attribute->type,
+                     bytes,
+                     num_bytes,
+                     offset) == 0)
     {
-      free (attrValue);
+      return -6;
     }
-  return ret;
+
+  /* note where the value goes, in case it changes later */
+  attribute->offset = (LWES_U_INT_32)(*offset - start);
+  attribute->dirty  = 0;
+
+  return lwes_event_value_to_bytes (attribute, bytes, num_bytes, offset);
 }
 
-int lwes_event_set_INT_32 (struct lwes_event *       event,
-                           LWES_CONST_SHORT_STRING   attrName,
-                           LWES_INT_32               value)
+/* Serialize the value of an attribute of an event */
+static int
+lwes_event_value_to_bytes
+  (struct lwes_event_attribute *attribute,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t *offset)
 {
   int ret = 0;
-  LWES_INT_32 *attrValue;
 
-  if (event == NULL || attrName == NULL)
+  if (attribute->type == LWES_U_INT_16_TOKEN)
     {
-      return -1;
+      if (marshall_U_INT_16 (attribute->value.u_int_16,
+                             bytes,
+                             num_bytes,
+                             offset) == 0)
+        {
+          ret = -7;
+        }
     }
-
-  attrValue = (LWES_INT_32 *)malloc (sizeof (LWES_INT_32));
-
-  if (attrValue == NULL)
+  else if (attribute->type == LWES_INT_16_TOKEN)
     {
-      return -3;
+      if (marshall_INT_16 (attribute->value.int_16,
+                           bytes,
+                           num_bytes,
+                           offset) == 0)
+        {
+          ret = -8;
+        }
     }
-  *attrValue = value;
-
-  ret = lwes_event_add (event, attrName, LWES_INT_32_TOKEN, attrValue);
-  if (ret < 0)
+  else if (attribute->type == LWES_U_INT_32_TOKEN)
     {
-      free(attrValue);
+      if (marshall_U_INT_32 (attribute->value.u_int_32,
+                             bytes,
+                             num_bytes,
+                             offset) == 0)
+        {
+          ret = -9;
+        }
     }
-  return ret;
-}
-
-int lwes_event_set_U_INT_64 (struct lwes_event *       event,
-                             LWES_CONST_SHORT_STRING   attrName,
-                             LWES_U_INT_64             value)
-{
-  int ret = 0;
-  LWES_U_INT_64 *attrValue;
-
-  if (event == NULL || attrName == NULL)
+  else if (attribute->type == LWES_INT_32_TOKEN)
     {
-      return -1;
+      if (marshall_INT_32 (attribute->value.int_32,
+                           bytes,
+                           num_bytes,
+                           offset) == 0)
+        {
+          ret = -10;
+        }
     }
-
-  attrValue = (LWES_U_INT_64 *)malloc (sizeof (LWES_U_INT_64));
-
-  if (attrValue == NULL)
+  else if (attribute->type == LWES_U_INT_64_TOKEN)
     {
-      return -3;
+      if (marshall_U_INT_64 (attribute->value.u_int_64,
+                             bytes,
+                             num_bytes,
+                             offset) == 0)
+        {
+          ret = -11;
+        }
     }
-  *attrValue = value;
-
-  ret = lwes_event_add (event, attrName, LWES_U_INT_64_TOKEN, attrValue);
-  if (ret < 0)
+  else if (attribute->type == LWES_INT_64_TOKEN)
     {
-      free (attrValue);
+      if (marshall_INT_64 (attribute->value.int_64,
+                           bytes,
+                           num_bytes,
+                           offset) == 0)
+        {
+          ret = -12;
+        }
     }
-  return ret;
-}
-
-int lwes_event_set_U_INT_64_w_string (struct lwes_event *     event,
-                                      LWES_CONST_SHORT_STRING attrName,
-                                      LWES_CONST_SHORT_STRING uint64_string)
-{
-  LWES_INT_64 u_int_64;
-  if (event == NULL || attrName == NULL || uint64_string == NULL)
+  else if (attribute->type == LWES_BOOLEAN_TOKEN)
     {
-      return -1;
+      if (marshall_BOOLEAN (attribute->value.boolean,
+                            bytes,
+                            num_bytes,
+                            offset) == 0)
+        {
+          ret = -13;
+        }
     }
-  if (lwes_INT_64_from_hex_string (uint64_string, &u_int_64) < 0)
+  else if (attribute->type == LWES_IP_ADDR_TOKEN)
     {
-      return -2;
+      if (marshall_IP_ADDR (attribute->value.ip_addr,
+                            bytes,
+                            num_bytes,
+                            offset) == 0)
+        {
+          ret = -14;
+        }
     }
-  return lwes_event_set_U_INT_64 (event, attrName, u_int_64);
-}
-
-int lwes_event_set_INT_64 (struct lwes_event *       event,
-                           LWES_CONST_SHORT_STRING   attrName,
-                           LWES_INT_64               value)
-{
-  int ret = 0;
-  LWES_INT_64 *attrValue;
-
-  if (event == NULL || attrName == NULL)
+  else if (attribute->type == LWES_STRING_TOKEN)
     {
-      return -1;
+      if (marshall_LONG_STRING (attribute->value.string,
+                                bytes,
+                                num_bytes,
+                                offset) == 0)
+        {
+          ret = -15;
+        }
     }
-
-  attrValue = (LWES_INT_64 *)malloc (sizeof (LWES_INT_64));
-
-  if (attrValue == NULL)
+  else
     {
-      return -3;
+      /* should never be reached, but if it does, there's some sort of
+       * corruption with this attribute of the event, so skip it */
     }
-  *attrValue = value;
 
-  ret = lwes_event_add (event, attrName, LWES_INT_64_TOKEN, attrValue);
-  if (ret < 0)
-    {
-      free (attrValue);
-    }
   return ret;
 }
 
-int lwes_event_set_INT_64_w_string (struct lwes_event       *event,
-                                    LWES_CONST_SHORT_STRING  attrName,
-                                    LWES_CONST_SHORT_STRING  int64_string)
+/* Serialize a single attribute of an event into bytes which have room for
+ * it */
+static int
+lwes_event_attribute_to_bytes_unchecked
+  (LWES_CONST_SHORT_STRING name,
+   struct lwes_event_attribute *attribute,
+   LWES_BYTE_P bytes,
+   size_t *offset,
+   size_t start)
 {
-  LWES_INT_64 int_64;
-
-  if (event == NULL || attrName == NULL || int64_string == NULL)
+  if (lwes_event_name_to_bytes_unchecked (name, bytes, offset) < 0)
     {
-      return -1;
+      return -5;
     }
+  marshall_BYTE_unchecked (attribute->type, bytes, offset);
 
-  if (lwes_INT_64_from_hex_string (int64_string,&int_64) < 0)
-    {
-      return -2;
-    }
-  return lwes_event_set_INT_64 (event, attrName, int_64);
+  /* note where the value goes, in case it changes later */
+  attribute->offset = (LWES_U_INT_32)(*offset - start);
+  attribute->dirty  = 0;
+
+  return lwes_event_value_to_bytes_unchecked (attribute, bytes, offset);
 }
 
-int lwes_event_set_STRING (struct lwes_event *       event,
-                           LWES_CONST_SHORT_STRING   attrName,
-                           LWES_CONST_LONG_STRING    value)
+/* Serialize the value of an attribute of an event into bytes which have
+ * room for it, only a string too long for its length can't be */
+static int
+lwes_event_value_to_bytes_unchecked
+  (struct lwes_event_attribute *attribute,
+   LWES_BYTE_P bytes,
+   size_t *offset)
 {
-  int ret = 0;
-  LWES_LONG_STRING attrValue;
+  size_t length;
 
-  if (event == NULL || attrName == NULL || value == NULL)
+  if (attribute->type == LWES_U_INT_16_TOKEN)
     {
-      return -1;
+      marshall_U_INT_16_unchecked (attribute->value.u_int_16, bytes, offset);
     }
-
-  attrValue = (LWES_LONG_STRING)malloc (sizeof (LWES_CHAR)*(strlen (value)+1));
-  if (attrValue == NULL)
+  else if (attribute->type == LWES_INT_16_TOKEN)
     {
-      return -3;
+      marshall_INT_16_unchecked (attribute->value.int_16, bytes, offset);
     }
-  strcpy(attrValue,value);
-
-  ret = lwes_event_add (event, attrName, LWES_STRING_TOKEN, (void*)attrValue);
-  if (ret < 0)
+  else if (attribute->type == LWES_U_INT_32_TOKEN)
     {
-      free (attrValue);
+      marshall_U_INT_32_unchecked (attribute->value.u_int_32, bytes, offset);
     }
-  return ret;
+  else if (attribute->type == LWES_INT_32_TOKEN)
+    {
+      marshall_INT_32_unchecked (attribute->value.int_32, bytes, offset);
+    }
+  else if (attribute->type == LWES_U_INT_64_TOKEN)
+    {
+      marshall_U_INT_64_unchecked (attribute->value.u_int_64, bytes, offset);
+    }
+  else if (attribute->type == LWES_INT_64_TOKEN)
+    {
+      marshall_INT_64_unchecked (attribute->value.int_64, bytes, offset);
+    }
+  else if (attribute->type == LWES_BOOLEAN_TOKEN)
+    {
+      marshall_BOOLEAN_unchecked (attribute->value.boolean, bytes, offset);
+    }
+  else if (attribute->type == LWES_IP_ADDR_TOKEN)
+    {
+      marshall_IP_ADDR_unchecked (attribute->value.ip_addr, bytes, offset);
+    }
+  else if (attribute->type == LWES_STRING_TOKEN)
+    {
+      length = strlen (attribute->value.string);
+      if (length >= LONG_STRING_MAX)
+        {
+          return -15;
+        }
+      marshall_U_INT_16_unchecked ((LWES_U_INT_16)length, bytes, offset);
+      memcpy (bytes + *offset, attribute->value.string, length);
+      *offset += length;
+    }
+
+  return 0;
 }
 
-int lwes_event_set_IP_ADDR (struct lwes_event *       event,
-                            LWES_CONST_SHORT_STRING   attrName,
-                            LWES_IP_ADDR              value)
+/* Serialize a name into bytes which have room for it */
+static int
+lwes_event_name_to_bytes_unchecked
+  (LWES_CONST_SHORT_STRING name,
+   LWES_BYTE_P bytes,
+   size_t *offset)
 {
-  int ret = 0;
-  LWES_IP_ADDR *attrValue;
+  size_t length;
 
-  if (event == NULL || attrName == NULL)
+  if (name == NULL)
+    {
+      return -1;
+    }
+  length = strlen (name);
+  if (length == 0 || length >= SHORT_STRING_MAX)
     {
       return -1;
     }
+  marshall_BYTE_unchecked ((LWES_BYTE)length, bytes, offset);
+  memcpy (bytes + *offset, name, length);
+  *offset += length;
 
-  attrValue = (LWES_IP_ADDR *)malloc (sizeof (LWES_IP_ADDR));
+  return 0;
+}
+
+/* Carve size bytes out of the storage of the event */
+static void *
+lwes_event_arena_alloc
+  (struct lwes_event *event,
+   size_t size)
+{
+  struct lwes_event_arena_block *block = event->arena;
+  void *ret;
+
+  size = LWES_EVENT_ARENA_ALIGN (size);
 
-  if (attrValue == NULL)
+  if (size > block->size)
     {
-      return -3;
+      /* too large to share a block, so give it one of its own behind the
+       * current block, which carries on being used for smaller things */
+      block =
+        (struct lwes_event_arena_block *)
+          malloc (LWES_EVENT_ARENA_HEADER_SIZE + size);
+      if (block == NULL)
+        {
+          return NULL;
+        }
+      block->next        = event->arena->next;
+      block->size        = size;
+      block->used        = size;
+      event->arena->next = block;
+
+      return (char *)block + LWES_EVENT_ARENA_HEADER_SIZE;
     }
-  *attrValue = value;
 
-  ret = lwes_event_add (event, attrName, LWES_IP_ADDR_TOKEN, attrValue);
-  if (ret < 0)
+  if (block->size - block->used < size)
     {
-      free (attrValue);
+      /* out of room, so chain on a block twice as large, the rest of
+       * the current block is left unused until the event goes */
+      block =
+        (struct lwes_event_arena_block *)
+          malloc (LWES_EVENT_ARENA_HEADER_SIZE + 2 * event->arena->size);
+      if (block == NULL)
+        {
+          return NULL;
+        }
+      block->next  = event->arena;
+      block->size  = 2 * event->arena->size;
+      block->used  = 0;
+      event->arena = block;
     }
+
+  ret = (char *)block + LWES_EVENT_ARENA_HEADER_SIZE + block->used;
+  block->used += size;
+
   return ret;
 }
 
-int lwes_event_set_IP_ADDR_w_string (struct lwes_event *       event,
-                                     LWES_CONST_SHORT_STRING   attrName,
-                                     LWES_CONST_SHORT_STRING  value)
+/* Make room for at least size attributes in the entries of an event,
+ * doubling them so that adding one at a time stays cheap */
+static int
+lwes_event_entries_grow
+  (struct lwes_event *event,
+   int size)
 {
-  int ret = 0;
-  struct in_addr *attrValue;
+  struct lwes_event_attribute_entry *entries;
 
-  if (event == NULL || attrName == NULL || value == NULL)
+  if (event->entries == event->small_attributes
+      && event->large_entries_size >= size)
+    {
+      /* the large entries from before the event was last reset will do */
+      entries = event->large_entries;
+      size    = event->large_entries_size;
+    }
+  else
     {
-      return -1;
+      if (size < 2 * event->entries_size)
+        {
+          size = 2 * event->entries_size;
+        }
+      entries =
+        (struct lwes_event_attribute_entry *)
+          malloc (sizeof (struct lwes_event_attribute_entry) * size);
+      if (entries == NULL)
+        {
+          return -3;
+        }
     }
 
-  attrValue = (LWES_IP_ADDR *)malloc (sizeof (LWES_IP_ADDR));
-  if (attrValue == NULL)
+  /* keep them in order, then let go of any array that was outgrown */
+  if (entries != event->entries)
     {
-      return -3;
+      memcpy (entries,
+              event->entries,
+              sizeof (struct lwes_event_attribute_entry)
+                * event->number_of_attributes);
     }
-  attrValue->s_addr = inet_addr (value);
-
-  ret = lwes_event_add (event, attrName, LWES_IP_ADDR_TOKEN, attrValue);
-  if (ret < 0)
+  if (event->large_entries != entries)
     {
-      free (attrValue);
+      free (event->large_entries);
     }
-  return ret;
+  event->entries            = entries;
+  event->entries_size       = size;
+  event->large_entries      = entries;
+  event->large_entries_size = size;
+
+  return 0;
 }
 
-int lwes_event_set_BOOLEAN (struct lwes_event       * event,
-                            LWES_CONST_SHORT_STRING   attrName,
-                            LWES_BOOLEAN              value)
+/* Move the attributes of a small event into a hash of at least bins
+ * slots carved out of its storage */
+static int
+lwes_event_attributes_init
+  (struct lwes_event *event,
+   int bins)
 {
-  int ret = 0;
-  LWES_BOOLEAN *attrValue;
+  struct lwes_hash      *hash = &(event->attribute_hash);
+  struct lwes_hash_slot *slots;
+  int total;
+  int i;
 
-  if (event == NULL || attrName == NULL)
+  if (hash->owns_slots && hash->total_bins >= bins)
     {
-      return -1;
+      /* slots the hash grew into before the event was last reset */
+      lwes_hash_clear (hash);
     }
-
-  attrValue = (LWES_BOOLEAN *)malloc (sizeof (LWES_BOOLEAN));
-  if (attrValue == NULL)
+  else
     {
-      return -3;
+      total = LWES_EVENT_HASH_BINS;
+      while (total < bins)
+        {
+          total *= 2;
+        }
+      slots =
+        (struct lwes_hash_slot *)
+          lwes_event_arena_alloc (event,
+                                  sizeof (struct lwes_hash_slot) * total);
+      if (slots == NULL)
+        {
+          return -3;
+        }
+      lwes_hash_release (hash);
+      lwes_hash_init_with_slots (hash, slots, total);
     }
-  *attrValue = value;
 
-  ret = lwes_event_add (event, attrName, LWES_BOOLEAN_TOKEN, attrValue);
-  if (ret < 0)
+  /* there are slots to spare for these, so none of the puts can fail */
+  for (i = 0; i < event->number_of_attributes; i++)
     {
-      free (attrValue);
+      lwes_hash_put (hash,
+                     event->entries[i].name,
+                     LWES_EVENT_INDEX_TO_VALUE (i));
     }
-  return ret;
+  event->attributes = hash;
+
+  return 0;
 }
 
+/* Find an attribute of an event by name */
+static struct lwes_event_attribute *
+lwes_event_find
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name)
+{
+  int i = lwes_event_index (event, name);
 
-/* ACCESSOR METHODS */
+  return (i < 0) ? NULL : &(event->entries[i].attribute);
+}
 
-int lwes_event_get_U_INT_16 (struct lwes_event       *event,
-                             LWES_CONST_SHORT_STRING  name,
-                             LWES_U_INT_16           *value)
+/* Find the position of an attribute in the entries of an event */
+static int
+lwes_event_index
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name)
 {
-  struct lwes_event_attribute *tmp;
+  size_t length;
 
-  if (event == NULL || name == NULL || value == NULL)
+  if (event->attributes != NULL)
     {
-      return -1;
+      return LWES_EVENT_VALUE_TO_INDEX (lwes_hash_get (event->attributes,
+                                                      name));
     }
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get (event->attributes, name);
+  length = strlen (name);
+  return lwes_event_scan (event, name, length,
+                          lwes_event_name_prefix (name, length));
+}
 
-  if (tmp)
-    {
-      *value = (*((LWES_U_INT_16 *)tmp->value));
-      return 0;
-    }
+/* Find an attribute of an event by the key of its name */
+static struct lwes_event_attribute *
+lwes_event_find_key
+  (struct lwes_event *event,
+   const struct lwes_attr_key *key)
+{
+  int i = lwes_event_index_key (event, key);
 
-  return -1;
+  return (i < 0) ? NULL : &(event->entries[i].attribute);
 }
 
-int lwes_event_get_INT_16 (struct lwes_event       *event,
-                           LWES_CONST_SHORT_STRING  name,
-                           LWES_INT_16             *value)
+/* Find the position of an attribute by the key of its name, nothing
+ * about the name has to be worked out again */
+static int
+lwes_event_index_key
+  (struct lwes_event *event,
+   const struct lwes_attr_key *key)
 {
-  struct lwes_event_attribute *tmp;
-
-  if (event == NULL || name == NULL || value == NULL)
+  if (event->attributes != NULL)
     {
-      return -1;
+      return
+        LWES_EVENT_VALUE_TO_INDEX (lwes_hash_get_with_hash (event->attributes,
+                                                           key->name,
+                                                           key->hash));
     }
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get (event->attributes, name);
+  return lwes_event_scan (event, key->name, key->length, key->prefix);
+}
 
-  if (tmp)
+/* Scan the entries of an event with few attributes for a name */
+static int
+lwes_event_scan
+  (struct lwes_event *event,
+   LWES_CONST_SHORT_STRING name,
+   size_t length,
+   LWES_U_INT_64 prefix)
+{
+  unsigned int matches;
+  unsigned int same;
+  int i;
+#if defined(__AVX2__)
+  __m256i prefixes;
+  __m256i wanted;
+#endif
+#if defined(__SSE2__)
+  __m128i lengths;
+#endif
+#if defined(__SSE2__) && ! defined(__AVX2__)
+  __m128i prefixes;
+  __m128i wanted;
+#endif
+
+  if (length > UCHAR_MAX)
+    {
+      length = UCHAR_MAX;
+    }
+
+  /* find the attributes with names of the same length, all at once when
+   * the lengths can be compared as one vector */
+#if defined(__SSE2__)
+  lengths = _mm_loadu_si128 ((const __m128i *)event->name_lengths);
+  matches =
+    (unsigned int)
+      _mm_movemask_epi8 (_mm_cmpeq_epi8 (lengths,
+                                         _mm_set1_epi8 ((char)length)));
+#else
+  matches = 0;
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES; i++)
+    {
+      if (event->name_lengths[i] == length)
+        {
+          matches |= (1U << i);
+        }
+    }
+#endif
+  matches &= (1U << event->number_of_attributes) - 1;
+
+  /* and of those the ones with the same prefix, four or two prefixes at
+   * a time when they can be compared as vectors, SSE2 having only a 32 bit
+   * compare, so that each half of a prefix has to match the other */
+  same = 0;
+#if defined(__AVX2__)
+  wanted = _mm256_set1_epi64x ((long long)prefix);
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES; i += 4)
+    {
+      prefixes =
+        _mm256_cmpeq_epi64 (_mm256_loadu_si256 ((const __m256i *)
+                                                  (event->name_prefixes + i)),
+                            wanted);
+      same |= (unsigned int)
+                _mm256_movemask_pd (_mm256_castsi256_pd (prefixes)) << i;
+    }
+#elif defined(__SSE2__)
+  wanted = _mm_set_epi32 ((int)(prefix >> 32), (int)prefix,
+                          (int)(prefix >> 32), (int)prefix);
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES; i += 2)
+    {
+      prefixes =
+        _mm_cmpeq_epi32 (_mm_loadu_si128 ((const __m128i *)
+                                            (event->name_prefixes + i)),
+                         wanted);
+      prefixes = _mm_and_si128 (prefixes,
+                                _mm_shuffle_epi32 (prefixes,
+                                                   _MM_SHUFFLE (2, 3, 0, 1)));
+      same |= (unsigned int)
+                _mm_movemask_pd (_mm_castsi128_pd (prefixes)) << i;
+    }
+#else
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES; i++)
+    {
+      if (event->name_prefixes[i] == prefix)
+        {
+          same |= (1U << i);
+        }
+    }
+#endif
+  matches &= same;
+
+  /* leaving just the whole names of those to compare, a name which is
+   * shared being the same pointer */
+  for (i = 0; matches != 0; i++, matches >>= 1)
     {
-      *value = (*((LWES_INT_16 *)tmp->value));
-      return 0;
+      if ((matches & 1)
+          && (event->entries[i].name == name
+              || strcmp (event->entries[i].name, name) == 0))
+        {
+          return i;
+        }
     }
+
   return -1;
 }
 
-int lwes_event_get_U_INT_32 (struct lwes_event       *event,
-                             LWES_CONST_SHORT_STRING  name,
-                             LWES_U_INT_32           *value)
+/* The first bytes of a name, used to tell names apart quickly */
+static LWES_U_INT_64
+lwes_event_name_prefix
+  (LWES_CONST_SHORT_STRING name,
+   size_t length)
 {
-  struct lwes_event_attribute *tmp;
+  LWES_U_INT_64 prefix = 0;
 
-  if (event == NULL || name == NULL || value == NULL)
+  memcpy (&prefix, name,
+          (length < sizeof (prefix)) ? length : sizeof (prefix));
+
+  return prefix;
+}
+
+/* add an attribute to an event */
+static int
+lwes_event_add (struct lwes_event*                      event,
+                LWES_CONST_SHORT_STRING                 attrNameIn,
+                LWES_BYTE                               attrType,
+                const union lwes_event_attribute_value *attrValue)
+{
+  LWES_SHORT_STRING attrName = NULL;
+  size_t length = strlen (attrNameIn);
+
+  attrName = lwes_event_name (event, attrNameIn, length, 1);
+  if (attrName == NULL)
     {
-      return -1;
+      return -3;
     }
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get (event->attributes, name);
+  return lwes_event_add_name (event, attrName, length, NULL,
+                              attrType, attrValue);
+}
 
-  if (tmp)
+/* add a decoded attribute to an event, the name is checked against the
+ * event db once there is a nul terminated copy of it */
+static int
+lwes_event_add_from_bytes
+  (struct lwes_event*                      event,
+   LWES_CONST_SHORT_STRING                 attrNameIn,
+   size_t                                  length,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue)
+{
+  LWES_SHORT_STRING attrName = NULL;
+
+  /* the attribute name is shared rather than copied where it already
+   * can be */
+  attrName = lwes_event_name (event, attrNameIn, length, 0);
+  if (attrName == NULL)
     {
-      *value = (*((LWES_U_INT_32 *)tmp->value));
-      return 0;
+      return -3;
     }
 
-  return -1;
+  return lwes_event_add_name (event, attrName, length, NULL,
+                              attrType, attrValue);
 }
 
-int lwes_event_get_INT_32 (struct lwes_event       *event,
-                           LWES_CONST_SHORT_STRING  name,
-                           LWES_INT_32             *value)
+/* add an attribute to an event, the hash of the name being taken from its
+ * key rather than worked out again if there is one */
+static int
+lwes_event_add_name
+  (struct lwes_event*                      event,
+   LWES_SHORT_STRING                       attrName,
+   size_t                                  length,
+   const struct lwes_attr_key             *key,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue)
 {
-  struct lwes_event_attribute *tmp;
+  int ret;
 
-  if (event == NULL || name == NULL || value == NULL)
+  ret = lwes_event_check (event, attrName, key, attrType);
+  if (ret < 0)
     {
-      return -1;
+      return ret;
     }
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get (event->attributes, name);
+  return lwes_event_put (event, attrName, length, key, attrType, attrValue);
+}
 
-  if (tmp)
+static int
+lwes_event_check
+  (struct lwes_event*                      event,
+   LWES_CONST_SHORT_STRING                 attrName,
+   const struct lwes_attr_key             *key,
+   LWES_BYTE                               attrType)
+{
+  /* a single lookup once the event has a name, in the schema the db has
+   * for it now should events have been added to the db since */
+  if (event->schema != NULL)
     {
-      *value = (*((LWES_INT_32 *)tmp->value));
-      return 0;
+      if (event->schema_generation != event->type_db->generation)
+        {
+          event->schema =
+            lwes_event_type_db_get_schema (event->type_db, event->eventName);
+          event->schema_generation = event->type_db->generation;
+        }
+      return (key != NULL)
+        ? lwes_event_type_db_schema_check_with_hash (event->schema,
+                                                     attrType,
+                                                     attrName,
+                                                     key->hash)
+        : lwes_event_type_db_schema_check (event->schema,
+                                           attrType,
+                                           attrName);
+    }
+  else if (event->type_db != NULL)
+    {
+      if (lwes_event_type_db_check_for_attribute (event->type_db,
+                                                  attrName,
+                                                  event->eventName) == 0)
+        {
+          return -1;
+        }
+      if (lwes_event_type_db_check_for_type (event->type_db,
+                                             attrType,
+                                             attrName,
+                                             event->eventName) == 0)
+        {
+          return -2;
+        }
     }
 
-  return -1;
+  return 0;
 }
 
-int lwes_event_get_U_INT_64 (struct lwes_event       *event,
-                             LWES_CONST_SHORT_STRING  name,
-                             LWES_U_INT_64           *value)
+static int
+lwes_event_put
+  (struct lwes_event*                      event,
+   LWES_SHORT_STRING                       attrName,
+   size_t                                  length,
+   const struct lwes_attr_key             *key,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue)
 {
-  struct lwes_event_attribute *tmp;
+  struct lwes_event_attribute_entry* entry     = NULL;
+  size_t value_size;
+  int index;
+  int ret                                      = 0;
 
-  if (event == NULL || name == NULL || value == NULL)
+  /* an attribute which is already set has its value replaced where it
+   * is, rather than being set again */
+  index = (key != NULL) ? lwes_event_index_key (event, key)
+                        : lwes_event_index (event, attrName);
+  if (index >= 0)
     {
-      return -1;
+      ret = lwes_event_update (event, index, attrType, attrValue);
+      return (ret < 0) ? ret : event->number_of_attributes;
     }
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get (event->attributes, name);
-
-  if (tmp)
+  if (event->number_of_attributes == event->entries_size
+      && lwes_event_entries_grow (event,
+                                  event->number_of_attributes + 1) < 0)
     {
-      *value = (*((LWES_U_INT_64 *)tmp->value));
-      return 0;
+      return -3;
     }
 
-  return -1;
-}
-
-int lwes_event_get_INT_64 (struct lwes_event       *event,
-                           LWES_CONST_SHORT_STRING  name,
-                           LWES_INT_64             *value)
-{
-  struct lwes_event_attribute *tmp;
-
-  if (event == NULL || name == NULL || value == NULL)
+  if (event->attributes == NULL
+      && event->number_of_attributes < LWES_EVENT_SMALL_ATTRIBUTES)
     {
-      return -1;
+      /* still few enough to scan */
+      event->name_lengths[event->number_of_attributes] =
+        (LWES_BYTE)((length > UCHAR_MAX) ? UCHAR_MAX : length);
+      event->name_prefixes[event->number_of_attributes] =
+        (key != NULL) ? key->prefix
+                      : lwes_event_name_prefix (attrName, length);
     }
+  else
+    {
+      /* too many to scan, so look them up in a hash */
+      if (event->attributes == NULL
+          && lwes_event_attributes_init (event, LWES_EVENT_HASH_BINS) < 0)
+        {
+          return -3;
+        }
+      ret = lwes_hash_put_with_hash (event->attributes,
+                                     attrName,
+                                     LWES_EVENT_INDEX_TO_VALUE
+                                       (event->number_of_attributes),
+                                     (key != NULL) ? key->hash
+                                                   : lwes_hash (attrName));
+    }
+  entry = &(event->entries[event->number_of_attributes]);
+
+  value_size = lwes_event_value_size (attrType, attrValue);
+  entry->name               = attrName;
+  entry->attribute.type     = attrType;
+  entry->attribute.dirty    = 0;
+  entry->attribute.capacity = lwes_event_value_capacity (attrType, value_size);
+  entry->attribute.offset   = 0;
+  entry->attribute.value    = *attrValue;
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get (event->attributes, name);
+  /* return code greater than or equal to 0 is okay, so increment the
+   * number_of_attributes, otherwise, send out the failure value, anything
+   * taken from the storage of the event is reclaimed when it is destroyed
+   */
+  if (ret < 0)
+    {
+      return ret;
+    }
+  event->number_of_attributes++;
+  event->serialized_size += sizeof (LWES_BYTE) + length
+                            + sizeof (LWES_BYTE)
+                            + value_size;
 
-  if (tmp)
+  /* the encoding is serialized ahead of the rest, so can't be added on */
+  if (strcmp (attrName, LWES_ENCODING) == 0)
     {
-      *value = (*((LWES_INT_64 *)tmp->value));
-      return 0;
+      event->serialized_valid = 0;
     }
 
-  return -1;
+  return event->number_of_attributes;
 }
 
-int lwes_event_get_STRING (struct lwes_event       *event,
-                           LWES_CONST_SHORT_STRING  name,
-                           LWES_LONG_STRING        *value)
+/* Change the value of an attribute of an event, rewriting just the value
+ * when it is next serialized as long as its size stays the same */
+static int
+lwes_event_update
+  (struct lwes_event*                      event,
+   int                                     index,
+   LWES_BYTE                               attrType,
+   const union lwes_event_attribute_value *attrValue)
 {
-  struct lwes_event_attribute *tmp;
+  struct lwes_event_attribute *attribute;
+  size_t old_size;
+  size_t new_size;
 
-  if (event == NULL || name == NULL || value == NULL)
+  if (event == NULL || attrValue == NULL
+      || index < 0 || index >= event->number_of_attributes)
     {
       return -1;
     }
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get (event->attributes, name);
+  attribute = &(event->entries[index].attribute);
+  old_size  = lwes_event_value_size (attribute->type, &(attribute->value));
+  new_size  = lwes_event_value_size (attrType, attrValue);
+  event->serialized_size += new_size - old_size;
 
-  if (tmp)
+  if (attrType != attribute->type || new_size != old_size)
     {
-      *value = (((LWES_LONG_STRING)tmp->value));
-      return 0;
+      /* everything after it moves, so it all has to be serialized again */
+      event->serialized_valid = 0;
     }
-
-  return -1;
-}
-int lwes_event_get_IP_ADDR (struct lwes_event       *event,
-                            LWES_CONST_SHORT_STRING  name,
-                            LWES_IP_ADDR            *value)
-{
-  struct lwes_event_attribute *tmp;
-
-  if (event == NULL || name == NULL || value == NULL)
+  else if (event->serialized_valid
+           && index < event->serialized_attributes
+           && ! attribute->dirty)
     {
-      return -1;
+      attribute->dirty = 1;
+      event->dirty_attributes++;
     }
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get (event->attributes, name);
+  attribute->type     = attrType;
+  attribute->value    = *attrValue;
+  attribute->capacity = lwes_event_value_capacity (attrType, new_size);
 
-  if (tmp)
+  return 0;
+}
+
+/* The room a string value of the given serialized size was copied into,
+ * every string being copied into storage of the event just big enough for
+ * it, and no more than can be kept */
+static LWES_U_INT_16
+lwes_event_value_capacity
+  (LWES_BYTE type,
+   size_t size)
+{
+  if (type != LWES_STRING_TOKEN)
     {
-      *value = (*((LWES_IP_ADDR *)tmp->value));
       return 0;
     }
-  return -1;
+  size = size - sizeof (LWES_U_INT_16) + 1;
+  return (LWES_U_INT_16)((size > USHRT_MAX) ? USHRT_MAX : size);
 }
 
-int lwes_event_get_BOOLEAN (struct lwes_event       *event,
-                            LWES_CONST_SHORT_STRING  name,
-                            LWES_BOOLEAN            *value)
+static void *
+lwes_event_set_many_room
+  (struct lwes_event *event,
+   char **room,
+   size_t *room_size,
+   size_t size)
 {
-  struct lwes_event_attribute *tmp;
+  void *ret;
 
-  if (event == NULL || name == NULL || value == NULL)
+  size = LWES_EVENT_ARENA_ALIGN (size);
+
+  /* only an attribute given more than once, changing its type, can need
+   * more than was worked out */
+  if (*room_size < size)
     {
-      return -1;
+      return lwes_event_arena_alloc (event, size);
     }
 
-  tmp = (struct lwes_event_attribute *)lwes_hash_get(event->attributes, name);
+  ret         = *room;
+  *room      += size;
+  *room_size -= size;
 
-  if (tmp)
-    {
-      *value = (*((LWES_BOOLEAN *)tmp->value));
-      return 0;
-    }
-  return -1;
+  return ret;
 }
 
-/*************************************************************************
-  PRIVATE API
- *************************************************************************/
-/* Create the memory for an attribute */
-static struct lwes_event_attribute *
-lwes_event_attribute_create (LWES_BYTE attrType, void *attrValue)
+/* Copy a string over the value of a string attribute of an event if it
+ * fits there, so that setting it again needn't take more storage */
+static int
+lwes_event_update_string
+  (struct lwes_event *event,
+   int index,
+   LWES_CONST_LONG_STRING value,
+   size_t length)
 {
-  struct lwes_event_attribute *attribute =
-    (struct lwes_event_attribute *)
-      malloc (sizeof (struct lwes_event_attribute));
+  struct lwes_event_attribute *attribute;
+  union lwes_event_attribute_value attrValue;
+  LWES_LONG_STRING old;
+  LWES_U_INT_16 capacity;
 
-  if (attribute == NULL)
+  if (index < 0)
     {
-      return NULL;
+      return 0;
+    }
+  attribute = &(event->entries[index].attribute);
+  if (attribute->type != LWES_STRING_TOKEN
+      || attribute->capacity < length)
+    {
+      return 0;
     }
 
-  attribute->type  = attrType;
-  attribute->value = attrValue;
+  /* the sizes are worked out from both strings before the new one is
+   * copied over the old, which keeps all of its room however short the
+   * new one is */
+  old              = attribute->value.string;
+  capacity         = attribute->capacity;
+  attrValue.string = (LWES_LONG_STRING)value;
+  if (lwes_event_update (event, index, LWES_STRING_TOKEN, &attrValue) < 0)
+    {
+      return 0;
+    }
+  memmove (old, value, length);
+  attribute->value.string = old;
+  attribute->capacity     = capacity;
 
-  return attribute;
+  return 1;
 }
 
-/* add an attribute to an event */
-static int
-lwes_event_add (struct lwes_event*       event,
-                LWES_CONST_SHORT_STRING  attrNameIn,
-                LWES_BYTE                attrType,
-                void*                    attrValue)
-{
-  struct lwes_event_attribute* attribute = NULL;
-  LWES_SHORT_STRING            attrName  = NULL;
-  int ret                                = 0;
-
-  /* check against the event db */
-  if (event->type_db != NULL
-       && lwes_event_type_db_check_for_attribute (event->type_db,
-                                                  attrNameIn,
-                                                  event->eventName) == 0)
+static size_t
+lwes_event_value_size
+  (LWES_BYTE type,
+   const union lwes_event_attribute_value *value)
+{
+  if (type == LWES_U_INT_16_TOKEN || type == LWES_INT_16_TOKEN)
     {
-      return -1;
+      return sizeof (LWES_U_INT_16);
     }
-  if (event->type_db != NULL
-       && lwes_event_type_db_check_for_type (event->type_db,
-                                             attrType,
-                                             attrNameIn,
-                                             event->eventName) == 0)
+  else if (type == LWES_U_INT_32_TOKEN || type == LWES_INT_32_TOKEN)
     {
-      return -2;
+      return sizeof (LWES_U_INT_32);
     }
-
-  /* copy the attribute name */
-  attrName =
-      (LWES_SHORT_STRING) malloc( sizeof(LWES_CHAR)*(strlen (attrNameIn)+1));
-  if (attrName == NULL)
+  else if (type == LWES_U_INT_64_TOKEN || type == LWES_INT_64_TOKEN)
     {
-      return -3;
+      return sizeof (LWES_U_INT_64);
     }
-  attrName[0] = '\0';
-  strcat (attrName,attrNameIn);
-
-  /* create the attribute */
-  attribute = lwes_event_attribute_create (attrType, attrValue);
-  if (attribute == NULL)
+  else if (type == LWES_BOOLEAN_TOKEN)
     {
-      free (attrName);
-      return -3;
+      return sizeof (LWES_BYTE);
     }
-
-  /* Try and put something into the hash */
-  ret = lwes_hash_put (event->attributes, attrName, attribute);
-
-  /* return code greater than or equal to 0 is okay, so increment the
-   * number_of_attributes, otherwise, send out the failure value
-   */
-  if (ret < 0)
+  else if (type == LWES_IP_ADDR_TOKEN)
     {
-      free (attribute);
-      free (attrName);
-      return ret;
+      return sizeof (LWES_U_INT_32);
     }
-  event->number_of_attributes++;
-
-  return event->number_of_attributes;
+  else if (type == LWES_STRING_TOKEN)
+    {
+      /* the length comes before the string */
+      return sizeof (LWES_U_INT_16) + strlen (value->string);
+    }
+  return 0;
 }
 
 int
@@ -1470,7 +3708,14 @@ lwes_event_keys
   (struct lwes_event * event,
    struct lwes_event_enumeration *enumeration)
 {
-  return lwes_hash_keys (event->attributes, &(enumeration->hash_enum));
+  if (event == NULL || enumeration == NULL)
+    {
+      return 0;
+    }
+
+  enumeration->event = event;
+  enumeration->index = 0;
+  return 1;
 }
 
 int
@@ -1479,22 +3724,19 @@ lwes_event_enumeration_next_element
    LWES_CONST_SHORT_STRING *key,
    LWES_TYPE *type)
 {
-  LWES_SHORT_STRING tmpAttrName =
-     lwes_hash_enumeration_next_element (&(enumeration->hash_enum));
+  struct lwes_event *event = enumeration->event;
+  struct lwes_event_attribute_entry *entry;
+
   (*key) = NULL;
   (*type) = LWES_TYPE_UNDEFINED;
-  
-  if ( tmpAttrName != NULL)
+
+  /* the attributes come out in the order they were set */
+  if (enumeration->index < event->number_of_attributes)
     {
-      struct lwes_event_attribute *tmp =
-         (struct lwes_event_attribute *)
-           lwes_hash_get (enumeration->hash_enum.enum_hash, (tmpAttrName));
-      if (tmp != NULL)
-        {
-          (*type) = (LWES_TYPE) (tmp->type);
-          (*key) = tmpAttrName;
-          return 1;
-        }
+      entry = &(event->entries[enumeration->index++]);
+      (*type) = (LWES_TYPE) (entry->attribute.type);
+      (*key) = entry->name;
+      return 1;
     }
   return 0;
 }
@@ -21,6 +21,18 @@
 
 #define LWES_ENCODING "enc"
 
+/* number of bytes of storage allocated along with each event, enough
+ * for the name and attributes of a typical event */
+#define LWES_EVENT_ARENA_SIZE 2048
+
+/* number of attributes an event holds before switching to a hash */
+#define LWES_EVENT_SMALL_ATTRIBUTES 16
+
+/* number of hash slots carved out of the storage of an event once it
+ * switches to a hash, a power of two, events with more attributes than
+ * fit grow their hash */
+#define LWES_EVENT_HASH_BINS 64
+
 #ifdef __cplusplus
 extern "C" {
 #endif 
@@ -42,8 +54,91 @@ struct lwes_event_deserialize_tmp
   LWES_CHAR     tmp_string_long[LONG_STRING_MAX+1];
 };
 
+/*! \struct lwes_event_arena_block lwes_event.h
+ *  \brief A block of storage owned by an event
+ *
+ *  The name, attributes, values and hash nodes of an event are carved out
+ *  of a chain of these blocks.  The first block is allocated together with
+ *  the event, further blocks are only allocated when it runs out or for
+ *  values too large to share a block, and all of them are released at
+ *  once when the event is destroyed.
+ */
+struct lwes_event_arena_block
+{
+  /*! The next block in the chain, or NULL for the last one */
+  struct lwes_event_arena_block *next;
+  /*! Number of usable bytes following this header */
+  size_t                         size;
+  /*! Number of those bytes already handed out */
+  size_t                         used;
+};
+
+/*! \union lwes_event_attribute_value lwes_event.h
+ *  \brief The value of an attribute, which member is valid depends on the
+ *         type of the attribute
+ */
+union lwes_event_attribute_value
+{
+  /*! value of a LWES_U_INT_16_TOKEN attribute */
+  LWES_U_INT_16     u_int_16;
+  /*! value of a LWES_INT_16_TOKEN attribute */
+  LWES_INT_16       int_16;
+  /*! value of a LWES_U_INT_32_TOKEN attribute */
+  LWES_U_INT_32     u_int_32;
+  /*! value of a LWES_INT_32_TOKEN attribute */
+  LWES_INT_32       int_32;
+  /*! value of a LWES_U_INT_64_TOKEN attribute */
+  LWES_U_INT_64     u_int_64;
+  /*! value of a LWES_INT_64_TOKEN attribute */
+  LWES_INT_64       int_64;
+  /*! value of a LWES_BOOLEAN_TOKEN attribute */
+  LWES_BOOLEAN      boolean;
+  /*! value of a LWES_IP_ADDR_TOKEN attribute */
+  LWES_IP_ADDR      ip_addr;
+  /*! value of a LWES_STRING_TOKEN attribute, the only one not held in
+   *  the attribute itself */
+  LWES_LONG_STRING  string;
+};
+
+/*! \struct lwes_event_attribute lwes_event.h
+ *  \brief Structure representing an attribute
+ */
+struct lwes_event_attribute
+{
+  /*! The type of the attribute */
+  LWES_BYTE                        type;
+  /*! Whether the value changed since the event was last serialized */
+  LWES_BYTE                        dirty;
+  /*! The room there is for a string value, which a shorter one can be
+      copied into */
+  LWES_U_INT_16                    capacity;
+  /*! Where the value was last serialized to, from the start of the event */
+  LWES_U_INT_32                    offset;
+  /*! The value of the attribute */
+  union lwes_event_attribute_value value;
+};
+
+/*! \struct lwes_event_attribute_entry lwes_event.h
+ *  \brief An attribute of an event along with its name
+ */
+struct lwes_event_attribute_entry
+{
+  /*! Name of the attribute */
+  LWES_SHORT_STRING            name;
+  /*! The attribute */
+  struct lwes_event_attribute  attribute;
+};
+
 /*! \struct lwes_event lwes_event.h
  *  \brief Structure representing an event
+ *
+ *  Attributes are kept in the entries array in the order they were set,
+ *  which is also the order they are serialized in.  The array starts out
+ *  as small_attributes, which is scanned to find them, and past
+ *  LWES_EVENT_SMALL_ATTRIBUTES it is moved into large_entries and indexed
+ *  by a hash keyed by attribute name.  Setting an attribute which is
+ *  already set replaces its value where it is, so an event can be kept
+ *  and set again for each time it is emitted.
  */
 struct lwes_event
 {
@@ -51,34 +146,122 @@ struct lwes_event
   LWES_SHORT_STRING            eventName;
   /*! Number of attributes that have been set in the event */
   LWES_U_INT_16                number_of_attributes;
+  /*! Number of bytes the event serializes to, kept up to date as the
+   *  name and attributes are set */
+  size_t                       serialized_size;
   /*! DB used for validating this event */
   struct lwes_event_type_db *  type_db;
-  /*! The attributes which have been set in the event.  This is a hash
-   *   keyed by attribute name with a value of struct lwes_event_attribute
+  /*! The attributes the DB allows in an event of this name, looked up
+   *  when the name is set */
+  struct lwes_event_type_db_schema *schema;
+  /*! The generation of the DB the schema was looked up in, it is looked
+   *  up again should events have been added to the DB since */
+  unsigned int                 schema_generation;
+  /*! The first bytes of the names of the small_attributes, zero padded,
+   *  compared before the names themselves */
+  LWES_U_INT_64                name_prefixes[LWES_EVENT_SMALL_ATTRIBUTES];
+  /*! Lengths of the names of the small_attributes, capped at 255 */
+  LWES_BYTE                    name_lengths[LWES_EVENT_SMALL_ATTRIBUTES];
+  /*! Room for the attributes of a small event */
+  struct lwes_event_attribute_entry
+                               small_attributes[LWES_EVENT_SMALL_ATTRIBUTES];
+  /*! The attributes which have been set in the event, in the order they
+   *  were set, either small_attributes or large_entries */
+  struct lwes_event_attribute_entry *entries;
+  /*! Number of attributes there is room for in entries */
+  int                          entries_size;
+  /*! Room for the attributes once there are too many for
+   *  small_attributes, kept when the event is reset, otherwise NULL */
+  struct lwes_event_attribute_entry *large_entries;
+  /*! Number of attributes there is room for in large_entries */
+  int                          large_entries_size;
+  /*! The index of the attributes once the event has more than
+   *  LWES_EVENT_SMALL_ATTRIBUTES, otherwise NULL.  This is a hash keyed
+   *  by attribute name with a value of one more than the position of the
+   *  attribute in entries
    */
   struct lwes_hash *           attributes;
+  /*! The hash attributes points to, which holds on to slots it grew into
+   *  when the event is reset */
+  struct lwes_hash             attribute_hash;
+  /*! The bytes the event last serialized to, kept when the event is
+   *  reset, otherwise NULL */
+  LWES_BYTE_P                  serialized;
+  /*! Number of bytes there is room for in serialized */
+  size_t                       serialized_capacity;
+  /*! Number of bytes of serialized in use */
+  size_t                       serialized_length;
+  /*! Number of attributes serialized holds */
+  LWES_U_INT_16                serialized_attributes;
+  /*! Whether serialized holds the event, but for the dirty values and the
+   *  attributes set since */
+  LWES_BYTE                    serialized_valid;
+  /*! Whether the event has been serialized since it was created or reset */
+  LWES_BYTE                    serialized_before;
+  /*! Number of attributes whose values are dirty */
+  int                          dirty_attributes;
+  /*! The block storage is currently being carved out of */
+  struct lwes_event_arena_block *arena;
 };
 
-/*! \struct lwes_event_attribute lwes_event.h
- *  \brief Structure representing an attribute
+/*! \struct lwes_event_enumeration lwes_event.h
+ *  \brief Structure for enumerating over the values in the event
  */
-struct lwes_event_attribute
+struct lwes_event_enumeration
 {
-  /*! The type of the attribute */
-  LWES_BYTE         type;
-  /*! The value of the attribute */
-  void             *value;
+  /*! the event being enumerated */
+  struct lwes_event *          event;
+  /*! index of the next of the entries of the event */
+  int                          index;
 };
 
-/*! \struct lwes_event_enumeration lwes_event.h
- *  \brief Structure for enumerating over the values in the event
+/*! \struct lwes_event_projection lwes_event.h
+ *  \brief The attributes wanted when deserializing events
+ *
+ *  An event deserialized with a projection gets the attributes wanted
+ *  from every event along with those wanted from events of its name, the
+ *  rest are skipped over.  Names are kept as their shared copies.
  */
-struct lwes_event_enumeration
+struct lwes_event_projection
 {
-  /*! enumeration for the underlying hash */
-  struct lwes_hash_enumeration hash_enum;
+  /*! the attributes wanted from every event, keyed by name */
+  struct lwes_hash *attributes;
+  /*! the attributes wanted from particular events, keyed by event name
+   *  with a value of a hash keyed by attribute name */
+  struct lwes_hash *events;
 };
- 
+
+/*! \struct lwes_attr_key lwes_event.h
+ *  \brief The name of an attribute worked out once, for getting and
+ *         setting it in many events without going over the name each time
+ */
+struct lwes_attr_key
+{
+  /*! the shared copy of the name */
+  LWES_SHORT_STRING name;
+  /*! length of the name */
+  size_t            length;
+  /*! the first bytes of the name, zero padded, as kept in entries */
+  LWES_U_INT_64     prefix;
+  /*! the hash of the name, as lwes_hash works it out */
+  unsigned int      hash;
+};
+
+/*! \struct lwes_attr_desc lwes_event.h
+ *  \brief An attribute to be set along with others by lwes_event_set_many
+ */
+struct lwes_attr_desc
+{
+  /*! the name of the attribute, used when there is no key */
+  LWES_CONST_SHORT_STRING           name;
+  /*! the key of the name of the attribute, or NULL */
+  const struct lwes_attr_key       *key;
+  /*! the type of the attribute */
+  LWES_BYTE                         type;
+  /*! the value of the attribute, strings are copied into the event */
+  union lwes_event_attribute_value  value;
+};
+
 /*! \brief Create the memory for an event with no name
  *
  *  This is used when deserializing an event from a byte array
@@ -127,6 +310,9 @@ lwes_event_create_with_encoding
    LWES_INT_16 encoding);
 
 /*! \brief Cleanup the memory for an event 
+ *
+ * All the storage of the event is released at once, including the
+ * name, attribute names and values handed out by the accessors.
  *
  * \param[in] event the event to free
  *
@@ -136,6 +322,23 @@ int
 lwes_event_destroy
   (struct lwes_event *event);
 
+/*! \brief Empty an event so it can be filled again
+ *
+ * The name and all the attributes are removed, but the storage of the
+ * event is kept, so a loop which resets and refills the same event,
+ * for instance by deserializing into it, does not allocate once the
+ * storage has grown to fit the events seen, other than for values too
+ * large to share a block of storage.  Anything previously
+ * returned by the accessors is no longer valid.
+ *
+ * \param[in] event the event to empty
+ *
+ * \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_reset
+  (struct lwes_event *event);
+
 /*! \brief Set the name of the event
  *
  *  Usually only used when lwes_event_create_no_name is used.
@@ -361,6 +564,7 @@ lwes_event_set_BOOLEAN
  *
  *  \param[in] event the event to get the name of
  *  \param[in] name the name of the event, this should be treated as const
+ *                  as it is usually the copy shared by all events
  *
  *  \return 0 on success, a negative number on failure
  */
@@ -369,6 +573,22 @@ lwes_event_get_name
   (struct lwes_event *event,
    LWES_SHORT_STRING *name);
 
+/*! \brief Get the number of bytes the event serializes to
+ *
+ *  This is kept up to date as the name and attributes are set, so it
+ *  can be used to size a buffer for lwes_event_to_bytes, or to tell
+ *  whether the event fits in a datagram, without serializing it.
+ *
+ *  \param[in] event the event to get the serialized size of
+ *  \param[out] size the number of bytes lwes_event_to_bytes will write
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_serialized_size
+  (struct lwes_event *event,
+   size_t *size);
+
 /*! \brief Get the number of attributes in the event
  *
  *  \param[in] event the event to get the number of attributes from
@@ -524,6 +744,343 @@ lwes_event_get_BOOLEAN
    LWES_CONST_SHORT_STRING  name,
    LWES_BOOLEAN            *value);
 
+/*! \brief Get an attribute from the event, whatever its type
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] name the name of the attribute
+ *
+ *  \return the attribute, which should be treated as const, and stays
+ *          valid until another attribute is added or the event is reset
+ *          or destroyed, or NULL if the event has no attribute of that name
+ */
+struct lwes_event_attribute *
+lwes_event_get_attribute
+  (struct lwes_event       *event,
+   LWES_CONST_SHORT_STRING  name);
+
+/*! \brief Work out the key of an attribute name
+ *
+ *  The key can then be used in place of the name with any event, for as
+ *  long as the process runs.
+ *
+ *  \param[out] key the key to fill in
+ *  \param[in] name the name of the attribute
+ *
+ *  \return 0 on success, -1 for bad arguments, -3 if the name could not
+ *          be shared
+ */
+int
+lwes_attr_key_init
+  (struct lwes_attr_key *key,
+   LWES_CONST_SHORT_STRING name);
+
+/*! \brief Add a LWES_U_INT_16 attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_U_INT_16
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_U_INT_16_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_16 value);
+
+/*! \brief Add a LWES_INT_16 attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_INT_16
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_INT_16_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_16 value);
+
+/*! \brief Add a LWES_U_INT_32 attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_U_INT_32
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_U_INT_32_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_32 value);
+
+/*! \brief Add a LWES_INT_32 attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_INT_32
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_INT_32_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_32 value);
+
+/*! \brief Add a LWES_U_INT_64 attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_U_INT_64
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_U_INT_64_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_64 value);
+
+/*! \brief Add a LWES_INT_64 attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_INT_64
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_INT_64_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_64 value);
+
+/*! \brief Add an LWES_LONG_STRING attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_STRING
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_STRING_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_CONST_LONG_STRING value);
+
+/*! \brief Add an LWES_IP_ADDR attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_IP_ADDR
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_IP_ADDR_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_IP_ADDR value);
+
+/*! \brief Add an LWES_BOOLEAN attribute to the event by its key
+ *
+ *  \param[in] event the event to add the attribute to
+ *  \param[in] key the key of the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \see lwes_event_set_BOOLEAN
+ *  \return the new number of attributes on success, a negative number on
+ *          failure
+ */
+int
+lwes_event_set_BOOLEAN_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_BOOLEAN value);
+
+/*! \brief Add many attributes to the event at once
+ *
+ *  All of the descriptions are checked, the type db included, before any
+ *  attribute is set, and room is made for all of them, copies of their
+ *  names and strings included, before the first is added, so that the
+ *  event grows once rather than attribute by attribute.  An attribute
+ *  which is already set has its value replaced, as with the single set
+ *  functions.
+ *
+ *  \param[in] event the event to add the attributes to
+ *  \param[in] descs the attributes to add, in order
+ *  \param[in] n the number of attributes in descs
+ *
+ *  \see lwes_event_set_STRING
+ *  \see lwes_event_set_STRING_by_key
+ *  \return the new number of attributes on success, -1 for bad arguments,
+ *          an attribute the type db doesn't have or more attributes than
+ *          an event can hold, -2 for one of the wrong type and -3 if there
+ *          wasn't the memory for them, with nothing set (a -3 can only
+ *          leave some set if an attribute is given more than once)
+ */
+int
+lwes_event_set_many
+  (struct lwes_event           *event,
+   const struct lwes_attr_desc *descs,
+   size_t                       n);
+
+/*! \brief Get a LWES_U_INT_16 attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \see lwes_event_get_U_INT_16
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_U_INT_16_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_16 *value);
+
+/*! \brief Get a LWES_INT_16 attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \see lwes_event_get_INT_16
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_INT_16_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_16 *value);
+
+/*! \brief Get a LWES_U_INT_32 attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \see lwes_event_get_U_INT_32
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_U_INT_32_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_32 *value);
+
+/*! \brief Get a LWES_INT_32 attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \see lwes_event_get_INT_32
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_INT_32_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_32 *value);
+
+/*! \brief Get a LWES_U_INT_64 attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \see lwes_event_get_U_INT_64
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_U_INT_64_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_U_INT_64 *value);
+
+/*! \brief Get a LWES_INT_64 attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \see lwes_event_get_INT_64
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_INT_64_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_INT_64 *value);
+
+/*! \brief Get an LWES_LONG_STRING attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute, which should
+ *                   be treated as const
+ *
+ *  \see lwes_event_get_STRING
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_STRING_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_LONG_STRING *value);
+
+/*! \brief Get an LWES_IP_ADDR attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \see lwes_event_get_IP_ADDR
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_IP_ADDR_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_IP_ADDR *value);
+
+/*! \brief Get an LWES_BOOLEAN attribute from the event by its key
+ *
+ *  \param[in] event the event to get the attribute from
+ *  \param[in] key the key of the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \see lwes_event_get_BOOLEAN
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_get_BOOLEAN_by_key
+  (struct lwes_event          *event,
+   const struct lwes_attr_key *key,
+   LWES_BOOLEAN *value);
+
 /*! \brief Serialize an event
  
    Serialization format is 
@@ -644,6 +1201,12 @@ lwes_event_get_BOOLEAN
     total attrs = 33 * 254 + 177 = 8559
     </pre>
 
+    An event serialized more than once keeps the bytes it serialized to,
+    and from then on only rewrites the values which changed and adds the
+    attributes set since, unless the length of a value changed.  Since
+    those bytes are kept in the event, an event must not be serialized
+    from more than one thread at a time, even though it isn't changed.
+
     \param[in] event the event to serialize
     \param[in] bytes the byte array to serialize into
     \param[in] num_bytes the size of the byte array
@@ -665,7 +1228,8 @@ lwes_event_to_bytes
     \param[in] bytes the byte array to serialize into
     \param[in] num_bytes the size of the byte array
     \param[in] offset the offset into the array to start serializing at
-    \param[in] dtmp some temporary space to deserialize strings into
+    \param[in] dtmp some temporary space, names and strings are now
+                    copied straight into the event so it goes unused
 
     \return The number of bytes read from the array on success,
              a negative number on failure
@@ -678,6 +1242,64 @@ lwes_event_from_bytes
    size_t offset,
    struct lwes_event_deserialize_tmp *dtmp);
 
+/*! \brief Create a projection which wants no attributes
+ *
+ *  \see lwes_event_projection_destroy
+ *  \return the newly allocated projection or NULL if an error occurred
+ */
+struct lwes_event_projection *
+lwes_event_projection_create
+  (void);
+
+/*! \brief Cleanup the memory for a projection
+ *
+ *  \param[in] projection the projection to destroy
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_projection_destroy
+  (struct lwes_event_projection *projection);
+
+/*! \brief Add an attribute to those wanted by a projection
+ *
+ *  \param[in] projection the projection to add to
+ *  \param[in] event_name the name of the events to want the attribute
+ *                        from, or NULL for every event
+ *  \param[in] attribute_name the name of the attribute
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_projection_add
+  (struct lwes_event_projection *projection,
+   LWES_CONST_SHORT_STRING event_name,
+   LWES_CONST_SHORT_STRING attribute_name);
+
+/*! \brief Deserialize only the wanted attributes of an event
+ *
+ *  Attributes the projection doesn't want are skipped over without being
+ *  copied or stored in the event, so the event only has the wanted ones.
+ *
+ *  \param[in] event the event to deserialize into
+ *  \param[in] bytes the byte array to deserialize from
+ *  \param[in] num_bytes the size of the byte array
+ *  \param[in] offset the offset into the array to start deserializing at
+ *  \param[in] dtmp some temporary space, which goes unused
+ *  \param[in] projection the attributes wanted
+ *
+ *  \return The number of bytes read from the array on success, which
+ *          includes those skipped over, a negative number on failure
+ */
+int
+lwes_event_from_bytes_projected
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset,
+   struct lwes_event_deserialize_tmp *dtmp,
+   struct lwes_event_projection *projection);
+
 /*! \brief Start an enumeration over the keys of the event
  *
  *  The pattern for enumerating is as follows
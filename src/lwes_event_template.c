@@ -0,0 +1,489 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include "lwes_event_template.h"
+#include "lwes_marshall_functions.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* room for this many attributes is made when a template is created */
+#define LWES_EVENT_TEMPLATE_SLOTS 16
+
+/*************************************************************************
+  PRIVATE API prototypes, shouldn't be called by a user of the library.
+ *************************************************************************/
+
+/* Write the name and type of a new attribute, returning its slot */
+static int
+lwes_event_template_attribute
+  (struct lwes_event_template *template_,
+   LWES_CONST_SHORT_STRING name,
+   LWES_BYTE type);
+
+/* Count a new attribute whose value has been written, or forget it */
+static int
+lwes_event_template_added
+  (struct lwes_event_template *template_,
+   int slot,
+   int written);
+
+/* Find where the value of the attribute in a slot of some type is */
+static int
+lwes_event_template_value
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_BYTE type,
+   size_t *offset);
+
+/*************************************************************************
+  PUBLIC API
+ *************************************************************************/
+struct lwes_event_template *
+lwes_event_template_create
+  (LWES_CONST_SHORT_STRING name)
+{
+  struct lwes_event_template *template_;
+  size_t offset = 0;
+  size_t length;
+
+  if (name == NULL)
+    {
+      return NULL;
+    }
+  length = strlen (name);
+  if (length == 0 || length >= SHORT_STRING_MAX)
+    {
+      return NULL;
+    }
+
+  template_ =
+    (struct lwes_event_template *) malloc (sizeof (struct lwes_event_template));
+  if (template_ == NULL)
+    {
+      return NULL;
+    }
+
+  template_->bytes = (LWES_BYTE_P) malloc (MAX_MSG_SIZE);
+  if (template_->bytes == NULL)
+    {
+      free (template_);
+      return NULL;
+    }
+
+  template_->slots =
+    (struct lwes_event_template_slot *)
+      malloc (sizeof (struct lwes_event_template_slot)
+              * LWES_EVENT_TEMPLATE_SLOTS);
+  if (template_->slots == NULL)
+    {
+      free (template_->bytes);
+      free (template_);
+      return NULL;
+    }
+  template_->slots_size           = LWES_EVENT_TEMPLATE_SLOTS;
+  template_->number_of_attributes = 0;
+
+  /* the name and then the number of attributes, which is patched as
+     attributes are added */
+  marshall_SHORT_STRING ((LWES_SHORT_STRING)name,
+                         template_->bytes, MAX_MSG_SIZE, &offset);
+  marshall_U_INT_16 (0, template_->bytes, MAX_MSG_SIZE, &offset);
+  template_->length = offset;
+
+  return template_;
+}
+
+int
+lwes_event_template_destroy
+  (struct lwes_event_template *template_)
+{
+  if (template_ != NULL)
+    {
+      free (template_->slots);
+      free (template_->bytes);
+      free (template_);
+    }
+  return 0;
+}
+
+int
+lwes_event_template_add
+  (struct lwes_event_template *template_,
+   LWES_CONST_SHORT_STRING name,
+   LWES_BYTE type)
+{
+  size_t offset;
+  int written = 0;
+  int slot;
+
+  /* strings are given their value when added */
+  if (type == LWES_STRING_TOKEN)
+    {
+      return -1;
+    }
+
+  slot = lwes_event_template_attribute (template_, name, type);
+  if (slot < 0)
+    {
+      return slot;
+    }
+
+  offset = template_->length;
+  if (type == LWES_U_INT_16_TOKEN)
+    {
+      written = marshall_U_INT_16 (0, template_->bytes,
+                                   MAX_MSG_SIZE, &offset);
+    }
+  else if (type == LWES_INT_16_TOKEN)
+    {
+      written = marshall_INT_16 (0, template_->bytes,
+                                 MAX_MSG_SIZE, &offset);
+    }
+  else if (type == LWES_U_INT_32_TOKEN)
+    {
+      written = marshall_U_INT_32 (0, template_->bytes,
+                                   MAX_MSG_SIZE, &offset);
+    }
+  else if (type == LWES_INT_32_TOKEN)
+    {
+      written = marshall_INT_32 (0, template_->bytes,
+                                 MAX_MSG_SIZE, &offset);
+    }
+  else if (type == LWES_U_INT_64_TOKEN)
+    {
+      written = marshall_U_INT_64 (0, template_->bytes,
+                                   MAX_MSG_SIZE, &offset);
+    }
+  else if (type == LWES_INT_64_TOKEN)
+    {
+      written = marshall_INT_64 (0, template_->bytes,
+                                 MAX_MSG_SIZE, &offset);
+    }
+  else if (type == LWES_IP_ADDR_TOKEN)
+    {
+      LWES_IP_ADDR ip_addr;
+      ip_addr.s_addr = 0;
+      written = marshall_IP_ADDR (ip_addr, template_->bytes,
+                                  MAX_MSG_SIZE, &offset);
+    }
+  else if (type == LWES_BOOLEAN_TOKEN)
+    {
+      written = marshall_BOOLEAN (0, template_->bytes,
+                                  MAX_MSG_SIZE, &offset);
+    }
+  template_->length = offset;
+
+  return lwes_event_template_added (template_, slot, written);
+}
+
+int
+lwes_event_template_add_STRING
+  (struct lwes_event_template *template_,
+   LWES_CONST_SHORT_STRING name,
+   LWES_CONST_LONG_STRING value)
+{
+  size_t offset;
+  int written;
+  int slot;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+
+  slot = lwes_event_template_attribute (template_, name, LWES_STRING_TOKEN);
+  if (slot < 0)
+    {
+      return slot;
+    }
+
+  offset  = template_->length;
+  written = marshall_LONG_STRING ((LWES_LONG_STRING)value, template_->bytes,
+                                  MAX_MSG_SIZE, &offset);
+  template_->length = offset;
+
+  return lwes_event_template_added (template_, slot, written);
+}
+
+int
+lwes_event_template_set_U_INT_16
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_U_INT_16 value)
+{
+  size_t offset;
+
+  if (lwes_event_template_value (template_, slot,
+                                 LWES_U_INT_16_TOKEN, &offset) < 0)
+    {
+      return -1;
+    }
+  marshall_U_INT_16_unchecked (value, template_->bytes, &offset);
+  return 0;
+}
+
+int
+lwes_event_template_set_INT_16
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_INT_16 value)
+{
+  size_t offset;
+
+  if (lwes_event_template_value (template_, slot,
+                                 LWES_INT_16_TOKEN, &offset) < 0)
+    {
+      return -1;
+    }
+  marshall_INT_16_unchecked (value, template_->bytes, &offset);
+  return 0;
+}
+
+int
+lwes_event_template_set_U_INT_32
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_U_INT_32 value)
+{
+  size_t offset;
+
+  if (lwes_event_template_value (template_, slot,
+                                 LWES_U_INT_32_TOKEN, &offset) < 0)
+    {
+      return -1;
+    }
+  marshall_U_INT_32_unchecked (value, template_->bytes, &offset);
+  return 0;
+}
+
+int
+lwes_event_template_set_INT_32
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_INT_32 value)
+{
+  size_t offset;
+
+  if (lwes_event_template_value (template_, slot,
+                                 LWES_INT_32_TOKEN, &offset) < 0)
+    {
+      return -1;
+    }
+  marshall_INT_32_unchecked (value, template_->bytes, &offset);
+  return 0;
+}
+
+int
+lwes_event_template_set_U_INT_64
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_U_INT_64 value)
+{
+  size_t offset;
+
+  if (lwes_event_template_value (template_, slot,
+                                 LWES_U_INT_64_TOKEN, &offset) < 0)
+    {
+      return -1;
+    }
+  marshall_U_INT_64_unchecked (value, template_->bytes, &offset);
+  return 0;
+}
+
+int
+lwes_event_template_set_INT_64
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_INT_64 value)
+{
+  size_t offset;
+
+  if (lwes_event_template_value (template_, slot,
+                                 LWES_INT_64_TOKEN, &offset) < 0)
+    {
+      return -1;
+    }
+  marshall_INT_64_unchecked (value, template_->bytes, &offset);
+  return 0;
+}
+
+int
+lwes_event_template_set_IP_ADDR
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_IP_ADDR value)
+{
+  size_t offset;
+
+  if (lwes_event_template_value (template_, slot,
+                                 LWES_IP_ADDR_TOKEN, &offset) < 0)
+    {
+      return -1;
+    }
+  marshall_IP_ADDR_unchecked (value, template_->bytes, &offset);
+  return 0;
+}
+
+int
+lwes_event_template_set_BOOLEAN
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_BOOLEAN value)
+{
+  size_t offset;
+
+  if (lwes_event_template_value (template_, slot,
+                                 LWES_BOOLEAN_TOKEN, &offset) < 0)
+    {
+      return -1;
+    }
+  marshall_BOOLEAN_unchecked (value, template_->bytes, &offset);
+  return 0;
+}
+
+int
+lwes_event_template_get_bytes
+  (struct lwes_event_template *template_,
+   LWES_BYTE_P *bytes,
+   size_t *length)
+{
+  if (template_ == NULL || bytes == NULL || length == NULL)
+    {
+      return -1;
+    }
+  *bytes  = template_->bytes;
+  *length = template_->length;
+  return 0;
+}
+
+/*************************************************************************
+  PRIVATE API
+ *************************************************************************/
+static int
+lwes_event_template_attribute
+  (struct lwes_event_template *template_,
+   LWES_CONST_SHORT_STRING name,
+   LWES_BYTE type)
+{
+  struct lwes_event_template_slot *slots;
+  struct lwes_event_template_slot *slot;
+  size_t name_length;
+  size_t offset;
+  int i;
+
+  if (template_ == NULL || name == NULL)
+    {
+      return -1;
+    }
+  name_length = strlen (name);
+  if (name_length == 0 || name_length >= SHORT_STRING_MAX)
+    {
+      return -1;
+    }
+  if (type != LWES_U_INT_16_TOKEN
+      && type != LWES_INT_16_TOKEN
+      && type != LWES_U_INT_32_TOKEN
+      && type != LWES_INT_32_TOKEN
+      && type != LWES_U_INT_64_TOKEN
+      && type != LWES_INT_64_TOKEN
+      && type != LWES_IP_ADDR_TOKEN
+      && type != LWES_BOOLEAN_TOKEN
+      && type != LWES_STRING_TOKEN)
+    {
+      return -1;
+    }
+
+  for (i = 0; i < template_->number_of_attributes; i++)
+    {
+      offset = template_->slots[i].name_offset;
+      if (template_->bytes[offset] == name_length
+          && memcmp (&(template_->bytes[offset + 1]),
+                     name, name_length) == 0)
+        {
+          return -2;
+        }
+    }
+
+  if (template_->number_of_attributes == template_->slots_size)
+    {
+      slots =
+        (struct lwes_event_template_slot *)
+          malloc (sizeof (struct lwes_event_template_slot)
+                  * template_->slots_size * 2);
+      if (slots == NULL)
+        {
+          return -3;
+        }
+      memcpy (slots, template_->slots,
+              sizeof (struct lwes_event_template_slot)
+              * template_->slots_size);
+      free (template_->slots);
+      template_->slots       = slots;
+      template_->slots_size *= 2;
+    }
+
+  slot   = &(template_->slots[template_->number_of_attributes]);
+  offset = template_->length;
+  slot->name_offset = offset;
+  slot->type        = type;
+  if (marshall_SHORT_STRING ((LWES_SHORT_STRING)name, template_->bytes,
+                             MAX_MSG_SIZE, &offset) == 0
+      || marshall_BYTE (type, template_->bytes, MAX_MSG_SIZE, &offset) == 0)
+    {
+      return -4;
+    }
+  slot->value_offset = offset;
+  template_->length  = offset;
+
+  return template_->number_of_attributes;
+}
+
+static int
+lwes_event_template_added
+  (struct lwes_event_template *template_,
+   int slot,
+   int written)
+{
+  size_t offset;
+
+  if (written == 0)
+    {
+      template_->length = template_->slots[slot].name_offset;
+      return -4;
+    }
+
+  template_->number_of_attributes++;
+  offset = 1 + template_->bytes[0];
+  marshall_U_INT_16_unchecked (template_->number_of_attributes,
+                               template_->bytes, &offset);
+
+  return slot;
+}
+
+static int
+lwes_event_template_value
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_BYTE type,
+   size_t *offset)
+{
+  if (template_ == NULL
+      || slot < 0
+      || slot >= template_->number_of_attributes
+      || template_->slots[slot].type != type)
+    {
+      return -1;
+    }
+  *offset = template_->slots[slot].value_offset;
+  return 0;
+}
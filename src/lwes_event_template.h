@@ -0,0 +1,260 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#ifndef __LWES_EVENT_TEMPLATE_H
+#define __LWES_EVENT_TEMPLATE_H
+
+#include <stddef.h>
+
+#include "lwes_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lwes_event_template.h
+ *  \brief Functions for events which are serialized once and then have
+ *         their values changed in place
+ */
+
+/*! \struct lwes_event_template_slot lwes_event_template.h
+ *  \brief Where an attribute is in the bytes of a template
+ */
+struct lwes_event_template_slot
+{
+  /*! Offset of the length of the name of the attribute in the bytes */
+  size_t    name_offset;
+  /*! Offset of the value of the attribute in the bytes */
+  size_t    value_offset;
+  /*! The type of the attribute */
+  LWES_BYTE type;
+};
+
+/*! \struct lwes_event_template lwes_event_template.h
+ *  \brief An event kept serialized
+ *
+ *  The name and attributes of the event are laid out once, after which
+ *  setting a value just writes it where it already is in the bytes, so
+ *  they are always ready to be emitted.  Strings can only be given when
+ *  they are added, since changing one would move everything after it.
+ */
+struct lwes_event_template
+{
+  /*! The serialized event */
+  LWES_BYTE_P                      bytes;
+  /*! Number of bytes the event takes up */
+  size_t                           length;
+  /*! Number of attributes in the event */
+  LWES_U_INT_16                    number_of_attributes;
+  /*! Where each attribute is, in the order they were added */
+  struct lwes_event_template_slot *slots;
+  /*! Number of slots there is room for */
+  int                              slots_size;
+};
+
+/*! \brief Create a template for events of a name
+ *
+ *  \param[in] name the name of the event
+ *
+ *  \see lwes_event_template_destroy
+ *  \return the newly allocated template or NULL if an error occurred
+ */
+struct lwes_event_template *
+lwes_event_template_create
+  (LWES_CONST_SHORT_STRING name);
+
+/*! \brief Cleanup the memory for a template
+ *
+ *  \param[in] template_ the template to destroy
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_template_destroy
+  (struct lwes_event_template *template_);
+
+/*! \brief Add an attribute whose value is set later
+ *
+ *  The value starts out as zero.
+ *
+ *  \param[in] template_ the template to add to
+ *  \param[in] name the name of the attribute
+ *  \param[in] type the type of the attribute, anything but a string
+ *
+ *  \return the slot of the attribute on success, -1 for bad arguments,
+ *          -2 if there already is an attribute of the name, -3 if memory
+ *          could not be allocated, -4 if the event would be too big
+ */
+int
+lwes_event_template_add
+  (struct lwes_event_template *template_,
+   LWES_CONST_SHORT_STRING name,
+   LWES_BYTE type);
+
+/*! \brief Add a string attribute, whose value stays the same
+ *
+ *  \param[in] template_ the template to add to
+ *  \param[in] name the name of the attribute
+ *  \param[in] value the value of the attribute
+ *
+ *  \return the slot of the attribute on success, -1 for bad arguments,
+ *          -2 if there already is an attribute of the name, -3 if memory
+ *          could not be allocated, -4 if the event would be too big
+ */
+int
+lwes_event_template_add_STRING
+  (struct lwes_event_template *template_,
+   LWES_CONST_SHORT_STRING name,
+   LWES_CONST_LONG_STRING value);
+
+/*! \brief Set the value of an uint16 attribute of a template
+ *
+ *  \param[in] template_ the template to set in
+ *  \param[in] slot the slot of the attribute
+ *  \param[in] value the value to set
+ *
+ *  \return 0 on success, -1 if there is no such slot or it is of another
+ *          type
+ */
+int
+lwes_event_template_set_U_INT_16
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_U_INT_16 value);
+
+/*! \brief Set the value of an int16 attribute of a template
+ *
+ *  \param[in] template_ the template to set in
+ *  \param[in] slot the slot of the attribute
+ *  \param[in] value the value to set
+ *
+ *  \return 0 on success, -1 if there is no such slot or it is of another
+ *          type
+ */
+int
+lwes_event_template_set_INT_16
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_INT_16 value);
+
+/*! \brief Set the value of an uint32 attribute of a template
+ *
+ *  \param[in] template_ the template to set in
+ *  \param[in] slot the slot of the attribute
+ *  \param[in] value the value to set
+ *
+ *  \return 0 on success, -1 if there is no such slot or it is of another
+ *          type
+ */
+int
+lwes_event_template_set_U_INT_32
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_U_INT_32 value);
+
+/*! \brief Set the value of an int32 attribute of a template
+ *
+ *  \param[in] template_ the template to set in
+ *  \param[in] slot the slot of the attribute
+ *  \param[in] value the value to set
+ *
+ *  \return 0 on success, -1 if there is no such slot or it is of another
+ *          type
+ */
+int
+lwes_event_template_set_INT_32
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_INT_32 value);
+
+/*! \brief Set the value of an uint64 attribute of a template
+ *
+ *  \param[in] template_ the template to set in
+ *  \param[in] slot the slot of the attribute
+ *  \param[in] value the value to set
+ *
+ *  \return 0 on success, -1 if there is no such slot or it is of another
+ *          type
+ */
+int
+lwes_event_template_set_U_INT_64
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_U_INT_64 value);
+
+/*! \brief Set the value of an int64 attribute of a template
+ *
+ *  \param[in] template_ the template to set in
+ *  \param[in] slot the slot of the attribute
+ *  \param[in] value the value to set
+ *
+ *  \return 0 on success, -1 if there is no such slot or it is of another
+ *          type
+ */
+int
+lwes_event_template_set_INT_64
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_INT_64 value);
+
+/*! \brief Set the value of an ip address attribute of a template
+ *
+ *  \param[in] template_ the template to set in
+ *  \param[in] slot the slot of the attribute
+ *  \param[in] value the value to set
+ *
+ *  \return 0 on success, -1 if there is no such slot or it is of another
+ *          type
+ */
+int
+lwes_event_template_set_IP_ADDR
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_IP_ADDR value);
+
+/*! \brief Set the value of a boolean attribute of a template
+ *
+ *  \param[in] template_ the template to set in
+ *  \param[in] slot the slot of the attribute
+ *  \param[in] value the value to set
+ *
+ *  \return 0 on success, -1 if there is no such slot or it is of another
+ *          type
+ */
+int
+lwes_event_template_set_BOOLEAN
+  (struct lwes_event_template *template_,
+   int slot,
+   LWES_BOOLEAN value);
+
+/*! \brief Get the serialized event, ready to be emitted
+ *
+ *  The bytes belong to the template and change as values are set.
+ *
+ *  \param[in] template_ the template
+ *  \param[out] bytes the serialized event
+ *  \param[out] length the number of bytes it takes up
+ *
+ *  \see lwes_emitter_emit_bytes
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_template_get_bytes
+  (struct lwes_event_template *template_,
+   LWES_BYTE_P *bytes,
+   size_t *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LWES_EVENT_TEMPLATE_H */
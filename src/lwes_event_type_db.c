@@ -14,6 +14,34 @@
 #include "lwes_esf_parser.h"
 #include "lwes_hash.h"
 
+/*************************************************************************
+  PRIVATE API prototypes, shouldn't be called by a user of the library.
+ *************************************************************************/
+
+/* Make a schema out of the attributes of an event and the meta event,
+ * either of which may be NULL */
+static struct lwes_event_type_db_schema *
+lwes_event_type_db_schema_create
+  (struct lwes_hash *eventHash,
+   struct lwes_hash *metaHash);
+
+/* Cleanup the memory for a schema, the names and types belong to the db */
+static void
+lwes_event_type_db_schema_destroy
+  (struct lwes_event_type_db_schema *schema);
+
+/* Put an attribute into a schema, replacing any of the same name if
+ * replace is set */
+static int
+lwes_event_type_db_schema_put
+  (struct lwes_event_type_db_schema *schema,
+   LWES_SHORT_STRING attr_name,
+   LWES_BYTE *type,
+   int replace);
+
+/*************************************************************************
+  PUBLIC API
+ *************************************************************************/
 struct lwes_event_type_db *
 lwes_event_type_db_create
   (const char *filename)
@@ -26,17 +54,38 @@ lwes_event_type_db_create
       db->esf_filename[0] = '\0';
       strcat (db->esf_filename, filename);
 
-      db->events = lwes_hash_create ();
+      /* the schemas are all made as the events are added, so that looking
+       * one up never changes the db and can be done from many threads */
+      db->generation  = 0;
+      db->meta_schema = NULL;
+      db->schemas     = NULL;
+      db->events      = lwes_hash_create ();
       if (db->events != NULL)
+        {
+          db->schemas = lwes_hash_create ();
+        }
+      if (db->schemas != NULL)
+        {
+          db->meta_schema = lwes_event_type_db_schema_create (NULL, NULL);
+        }
+      if (db->meta_schema != NULL)
         {
           if (lwes_parse_esf (db, db->esf_filename) != 0)
             {
-              free (db);
+              lwes_event_type_db_destroy (db);
               db = NULL;
             }
         }
       else
         {
+          if (db->schemas != NULL)
+            {
+              lwes_hash_destroy (db->schemas);
+            }
+          if (db->events != NULL)
+            {
+              lwes_hash_destroy (db->events);
+            }
           free (db);
           db = NULL;
         }
@@ -45,7 +94,6 @@ lwes_event_type_db_create
   return db;
 }
 
-
 int
 lwes_event_type_db_destroy
   (struct lwes_event_type_db *db)
@@ -56,6 +104,22 @@ lwes_event_type_db_destroy
   struct lwes_hash *attrHash  = NULL;
   LWES_SHORT_STRING attrName  = NULL;
   LWES_BYTE        *attrType  = NULL;
+
+  /* the schemas refer to names in the events, so go first */
+  if (lwes_hash_keys (db->schemas, &e))
+    {
+      while (lwes_hash_enumeration_has_more_elements (&e))
+        {
+          eventName = lwes_hash_enumeration_next_element (&e);
+          lwes_event_type_db_schema_destroy
+            ((struct lwes_event_type_db_schema *)
+               lwes_hash_remove (db->schemas, eventName));
+          free (eventName);
+        }
+    }
+  lwes_hash_destroy (db->schemas);
+  lwes_event_type_db_schema_destroy (db->meta_schema);
+
   /* clear out the hash */
   if (lwes_hash_keys (db->events, &e))
     {
@@ -100,6 +164,8 @@ lwes_event_type_db_add_event
 {
   int ret = 0;
   struct lwes_hash *eventHash = NULL;
+  struct lwes_event_type_db_schema *schema = NULL;
+  LWES_SHORT_STRING schemaKey = NULL;
   /* try and allocate the key */
   LWES_SHORT_STRING eventHashKey =
     (LWES_SHORT_STRING)malloc (sizeof (LWES_CHAR)*(strlen (event_name)+1));
@@ -122,8 +188,39 @@ lwes_event_type_db_add_event
     {
       free (eventHashKey);
       lwes_hash_destroy (eventHash);
+      return ret;
+    }
+
+  /* and its schema, which starts with the attributes of the meta event and
+   * has its own put in as they are added, if that fails so does adding the
+   * event */
+  schemaKey =
+    (LWES_SHORT_STRING)malloc (sizeof (LWES_CHAR)*(strlen (event_name)+1));
+  schema =
+    (schemaKey == NULL) ? NULL :
+      lwes_event_type_db_schema_create
+        (eventHash,
+         (struct lwes_hash *)lwes_hash_get (db->events, LWES_META_INFO_STRING));
+  if (schema != NULL)
+    {
+      strcpy (schemaKey, event_name);
+      ret = lwes_hash_put (db->schemas, schemaKey, schema);
+    }
+  if (schema == NULL || ret < 0)
+    {
+      lwes_event_type_db_schema_destroy (schema);
+      if (schemaKey != NULL)
+        free (schemaKey);
+      lwes_hash_remove (db->events, event_name);
+      free (eventHashKey);
+      lwes_hash_destroy (eventHash);
+      return -3;
     }
 
+  /* events which were given the meta schema for this name need to look
+   * theirs up again */
+  db->generation++;
+
   return ret;
 }
 
@@ -139,6 +236,8 @@ lwes_event_type_db_add_attribute
     (struct lwes_hash *)lwes_hash_get (db->events, event_name);
   LWES_SHORT_STRING tmpAttrName = NULL;
   LWES_BYTE        *tmpAttrType = NULL;
+  struct lwes_event_type_db_schema *schema = NULL;
+  struct lwes_hash_enumeration e;
 
   tmpAttrName =
       (LWES_SHORT_STRING)malloc (sizeof (LWES_CHAR)*(strlen (attr_name)+1));
@@ -199,8 +298,41 @@ lwes_event_type_db_add_attribute
   {
     free (tmpAttrName);
     free (tmpAttrType);
+    return ret;
   }
 
+  /* keep any schemas which have been made up to date, an attribute of the
+   * meta event goes in all of them unless an event has its own */
+  if (strcmp (event_name, LWES_META_INFO_STRING) == 0)
+    {
+      if (db->meta_schema != NULL)
+        {
+          ret = lwes_event_type_db_schema_put (db->meta_schema,
+                                               tmpAttrName, tmpAttrType, 0);
+        }
+      if (ret == 0 && lwes_hash_keys (db->schemas, &e))
+        {
+          while (ret == 0 && lwes_hash_enumeration_has_more_elements (&e))
+            {
+              schema = (struct lwes_event_type_db_schema *)
+                lwes_hash_get (db->schemas,
+                               lwes_hash_enumeration_next_element (&e));
+              ret = lwes_event_type_db_schema_put (schema, tmpAttrName,
+                                                   tmpAttrType, 0);
+            }
+        }
+    }
+  else
+    {
+      schema = (struct lwes_event_type_db_schema *)
+        lwes_hash_get (db->schemas, event_name);
+      if (schema != NULL)
+        {
+          ret = lwes_event_type_db_schema_put (schema, tmpAttrName,
+                                               tmpAttrType, 1);
+        }
+    }
+
   return ret;
 }
 
@@ -263,3 +395,151 @@ lwes_event_type_db_check_for_type
 
   return ((*tmp_type)==type_value);
 }
+
+struct lwes_event_type_db_schema *
+lwes_event_type_db_get_schema
+  (struct lwes_event_type_db *db,
+   LWES_CONST_SHORT_STRING event_name)
+{
+  struct lwes_event_type_db_schema *schema;
+
+  if (db == NULL || event_name == NULL)
+    {
+      return NULL;
+    }
+
+  /* events not in the esf file share a schema, so that names which come
+   * off the network can't grow the db */
+  schema = (struct lwes_event_type_db_schema *)
+    lwes_hash_get (db->schemas, event_name);
+
+  return (schema != NULL) ? schema : db->meta_schema;
+}
+
+int
+lwes_event_type_db_schema_check
+  (struct lwes_event_type_db_schema *schema,
+   LWES_BYTE type_value,
+   LWES_CONST_SHORT_STRING attr_name)
+{
+  if (schema == NULL || attr_name == NULL)
+    {
+      return -1;
+    }
+
+  return lwes_event_type_db_schema_check_with_hash (schema, type_value,
+                                                    attr_name,
+                                                    lwes_hash (attr_name));
+}
+
+int
+lwes_event_type_db_schema_check_with_hash
+  (struct lwes_event_type_db_schema *schema,
+   LWES_BYTE type_value,
+   LWES_CONST_SHORT_STRING attr_name,
+   unsigned int hash)
+{
+  LWES_BYTE *tmp_type;
+
+  if (schema == NULL || attr_name == NULL)
+    {
+      return -1;
+    }
+
+  tmp_type = (LWES_BYTE *)lwes_hash_get_with_hash (schema->attributes,
+                                                   attr_name, hash);
+  if (tmp_type == NULL)
+    {
+      return -1;
+    }
+
+  return ((*tmp_type) == type_value) ? 0 : -2;
+}
+
+/*************************************************************************
+  PRIVATE API
+ *************************************************************************/
+static struct lwes_event_type_db_schema *
+lwes_event_type_db_schema_create
+  (struct lwes_hash *eventHash,
+   struct lwes_hash *metaHash)
+{
+  struct lwes_event_type_db_schema *schema;
+  struct lwes_hash_enumeration e;
+  LWES_SHORT_STRING attrName;
+  int ret = 0;
+
+  schema = (struct lwes_event_type_db_schema *)
+    malloc (sizeof (struct lwes_event_type_db_schema));
+  if (schema == NULL)
+    {
+      return NULL;
+    }
+  schema->attributes = lwes_hash_create ();
+  if (schema->attributes == NULL)
+    {
+      free (schema);
+      return NULL;
+    }
+
+  /* the event's own attributes come ahead of those of the meta event */
+  if (eventHash != NULL && lwes_hash_keys (eventHash, &e))
+    {
+      while (ret == 0 && lwes_hash_enumeration_has_more_elements (&e))
+        {
+          attrName = lwes_hash_enumeration_next_element (&e);
+          ret = lwes_event_type_db_schema_put
+                  (schema, attrName,
+                   (LWES_BYTE *)lwes_hash_get (eventHash, attrName), 0);
+        }
+    }
+  if (metaHash != NULL && lwes_hash_keys (metaHash, &e))
+    {
+      while (ret == 0 && lwes_hash_enumeration_has_more_elements (&e))
+        {
+          attrName = lwes_hash_enumeration_next_element (&e);
+          ret = lwes_event_type_db_schema_put
+                  (schema, attrName,
+                   (LWES_BYTE *)lwes_hash_get (metaHash, attrName), 0);
+        }
+    }
+
+  if (ret < 0)
+    {
+      lwes_event_type_db_schema_destroy (schema);
+      return NULL;
+    }
+
+  return schema;
+}
+
+static void
+lwes_event_type_db_schema_destroy
+  (struct lwes_event_type_db_schema *schema)
+{
+  if (schema != NULL)
+    {
+      lwes_hash_clear (schema->attributes);
+      lwes_hash_destroy (schema->attributes);
+      free (schema);
+    }
+}
+
+static int
+lwes_event_type_db_schema_put
+  (struct lwes_event_type_db_schema *schema,
+   LWES_SHORT_STRING attr_name,
+   LWES_BYTE *type,
+   int replace)
+{
+  if (lwes_hash_contains_key (schema->attributes, attr_name))
+    {
+      if (! replace)
+        {
+          return 0;
+        }
+      lwes_hash_remove (schema->attributes, attr_name);
+    }
+
+  return lwes_hash_put (schema->attributes, attr_name, type);
+}
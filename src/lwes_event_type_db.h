@@ -39,6 +39,19 @@ struct lwes_event_type_db_attribute
   struct lwes_event *event;
 };
 
+/*! \struct lwes_event_type_db_schema lwes_event_type_db.h
+ *  \brief The attributes allowed in events of one name
+ *
+ *  The attributes of the event along with those of the meta event, so
+ *  that an attribute is checked with a single lookup.
+ */
+struct lwes_event_type_db_schema
+{
+  /*! holds the type of each allowed attribute by its name, both of which
+      belong to the db */
+  struct lwes_hash *attributes;
+};
+
 /*! \struct lwes_event_type_db lwes_event_type_db.h
  *  \brief The data base itself
  */
@@ -49,6 +62,14 @@ struct lwes_event_type_db
   /*! holds a hash of event descriptions by the event name
       for events which are described in the esf file */
   struct lwes_hash *events;
+  /*! holds the schema of each event described, by the event name */
+  struct lwes_hash *schemas;
+  /*! the schema of events not described in the esf file, which only
+      allows the attributes of the meta event */
+  struct lwes_event_type_db_schema *meta_schema;
+  /*! counts the events added, so that a schema looked up for a name can
+      be told apart from the one it has since */
+  unsigned int generation;
 };
 
 /*! \brief Creates the memory for the event_type_db.
@@ -148,6 +169,56 @@ lwes_event_type_db_check_for_type
    LWES_CONST_SHORT_STRING attr_name,
    LWES_CONST_SHORT_STRING event_name);
 
+/*! \brief Get the schema for events of a name
+ *
+ *  The schemas are made as events are added to the db and kept up to
+ *  date as attributes are, and belong to the db.  Getting one changes
+ *  nothing, so can be done from many threads at once as long as nothing
+ *  is being added.  Events not in the db share the meta event's schema
+ *  until they are added, when the generation of the db changes.
+ *
+ *  \param[in] db the db to get the schema from
+ *  \param[in] event_name the name of an event
+ *
+ *  \return the schema on success, NULL on failure
+ */
+struct lwes_event_type_db_schema *
+lwes_event_type_db_get_schema
+  (struct lwes_event_type_db *db,
+   LWES_CONST_SHORT_STRING event_name);
+
+/*! \brief Check an attribute and its type against a schema
+ *
+ *  \param[in] schema the schema to check against
+ *  \param[in] type_value the type to check for
+ *  \param[in] attr_name the attribute name to check for
+ *
+ *  \return 0 if the attribute is allowed and of the type, -1 if it isn't
+ *          allowed, -2 if it is of another type
+ */
+int
+lwes_event_type_db_schema_check
+  (struct lwes_event_type_db_schema *schema,
+   LWES_BYTE type_value,
+   LWES_CONST_SHORT_STRING attr_name);
+
+/*! \brief Check an attribute whose name is already hashed against a schema
+ *
+ *  \param[in] schema the schema to check against
+ *  \param[in] type_value the type to check for
+ *  \param[in] attr_name the attribute name to check for
+ *  \param[in] hash the hash of attr_name, as lwes_hash returns it
+ *
+ *  \return 0 if the attribute is allowed and of the type, -1 if it isn't
+ *          allowed, -2 if it is of another type
+ */
+int
+lwes_event_type_db_schema_check_with_hash
+  (struct lwes_event_type_db_schema *schema,
+   LWES_BYTE type_value,
+   LWES_CONST_SHORT_STRING attr_name,
+   unsigned int hash);
+
 #ifdef __cplusplus
 }
 #endif 
@@ -0,0 +1,490 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include "lwes_event_view.h"
+#include "lwes_marshall_functions.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* room for this many attributes is made when a view is created */
+#define LWES_EVENT_VIEW_ATTRIBUTES 32
+
+/*************************************************************************
+  PRIVATE API prototypes, shouldn't be called by a user of the library.
+ *************************************************************************/
+
+/* Skip over a name in the bytes, returning it and its length */
+static int
+lwes_event_view_name
+  (struct lwes_event_view *view,
+   size_t *offset,
+   LWES_CONST_SHORT_STRING *name,
+   LWES_BYTE *length);
+
+/* Skip over a value of some type in the bytes */
+static int
+lwes_event_view_skip
+  (struct lwes_event_view *view,
+   LWES_BYTE type,
+   size_t *offset);
+
+/* Find where the value of an attribute of some type is */
+static int
+lwes_event_view_find
+  (struct lwes_event_view *view,
+   LWES_CONST_SHORT_STRING name,
+   LWES_BYTE type,
+   size_t *offset);
+
+/*************************************************************************
+  PUBLIC API
+ *************************************************************************/
+struct lwes_event_view *
+lwes_event_view_create
+  (void)
+{
+  struct lwes_event_view *view =
+    (struct lwes_event_view *) malloc (sizeof (struct lwes_event_view));
+
+  if (view == NULL)
+    {
+      return NULL;
+    }
+
+  view->attributes =
+    (struct lwes_event_view_attribute *)
+      malloc (sizeof (struct lwes_event_view_attribute)
+              * LWES_EVENT_VIEW_ATTRIBUTES);
+  if (view->attributes == NULL)
+    {
+      free (view);
+      return NULL;
+    }
+  view->attributes_size      = LWES_EVENT_VIEW_ATTRIBUTES;
+  view->bytes                = NULL;
+  view->num_bytes            = 0;
+  view->name                 = NULL;
+  view->name_length          = 0;
+  view->number_of_attributes = 0;
+
+  return view;
+}
+
+int
+lwes_event_view_destroy
+  (struct lwes_event_view *view)
+{
+  if (view != NULL)
+    {
+      free (view->attributes);
+      free (view);
+    }
+  return 0;
+}
+
+int
+lwes_event_view_from_bytes
+  (struct lwes_event_view *view,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset)
+{
+  struct lwes_event_view_attribute *attributes;
+  struct lwes_event_view_attribute *attribute;
+  LWES_U_INT_16 number;
+  size_t tmpOffset = offset;
+  int ret;
+  int i;
+
+  if (   view == NULL
+      || bytes == NULL
+      || num_bytes == 0
+      || offset >= num_bytes)
+    {
+      return -1;
+    }
+
+  /* nothing is viewed until the whole event has been gone over */
+  view->bytes                = bytes;
+  view->num_bytes            = num_bytes;
+  view->number_of_attributes = 0;
+
+  if (lwes_event_view_name (view, &tmpOffset,
+                            &(view->name), &(view->name_length)) < 0
+      || unmarshall_U_INT_16 (&number, bytes, num_bytes, &tmpOffset) == 0)
+    {
+      return -2;
+    }
+
+  if (number > view->attributes_size)
+    {
+      attributes =
+        (struct lwes_event_view_attribute *)
+          malloc (sizeof (struct lwes_event_view_attribute) * number);
+      if (attributes == NULL)
+        {
+          return -3;
+        }
+      free (view->attributes);
+      view->attributes      = attributes;
+      view->attributes_size = number;
+    }
+
+  for (i = 0; i < number; i++)
+    {
+      attribute = &(view->attributes[i]);
+      if (lwes_event_view_name (view, &tmpOffset,
+                                &(attribute->name),
+                                &(attribute->name_length)) < 0
+          || unmarshall_BYTE (&(attribute->type),
+                              bytes, num_bytes, &tmpOffset) == 0)
+        {
+          return -2;
+        }
+      attribute->offset = tmpOffset;
+      ret = lwes_event_view_skip (view, attribute->type, &tmpOffset);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+  view->number_of_attributes = number;
+
+  return (int)(tmpOffset - offset);
+}
+
+int
+lwes_event_view_get_name
+  (struct lwes_event_view *view,
+   LWES_CONST_SHORT_STRING *name,
+   size_t *length)
+{
+  if (view == NULL || name == NULL || length == NULL)
+    {
+      return -1;
+    }
+  *name   = view->name;
+  *length = view->name_length;
+  return 0;
+}
+
+int
+lwes_event_view_get_number_of_attributes
+  (struct lwes_event_view *view,
+   LWES_U_INT_16 *number)
+{
+  if (view == NULL || number == NULL)
+    {
+      return -1;
+    }
+  *number = view->number_of_attributes;
+  return 0;
+}
+
+int
+lwes_event_view_get_U_INT_16
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_U_INT_16           *value)
+{
+  size_t offset;
+  int ret;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_U_INT_16_TOKEN, &offset);
+  if (ret == 0)
+    {
+      unmarshall_U_INT_16_unchecked (value, view->bytes, &offset);
+    }
+  return ret;
+}
+
+int
+lwes_event_view_get_INT_16
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_INT_16             *value)
+{
+  size_t offset;
+  int ret;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_INT_16_TOKEN, &offset);
+  if (ret == 0)
+    {
+      unmarshall_INT_16_unchecked (value, view->bytes, &offset);
+    }
+  return ret;
+}
+
+int
+lwes_event_view_get_U_INT_32
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_U_INT_32           *value)
+{
+  size_t offset;
+  int ret;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_U_INT_32_TOKEN, &offset);
+  if (ret == 0)
+    {
+      unmarshall_U_INT_32_unchecked (value, view->bytes, &offset);
+    }
+  return ret;
+}
+
+int
+lwes_event_view_get_INT_32
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_INT_32             *value)
+{
+  size_t offset;
+  int ret;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_INT_32_TOKEN, &offset);
+  if (ret == 0)
+    {
+      unmarshall_INT_32_unchecked (value, view->bytes, &offset);
+    }
+  return ret;
+}
+
+int
+lwes_event_view_get_U_INT_64
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_U_INT_64           *value)
+{
+  size_t offset;
+  int ret;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_U_INT_64_TOKEN, &offset);
+  if (ret == 0)
+    {
+      unmarshall_U_INT_64_unchecked (value, view->bytes, &offset);
+    }
+  return ret;
+}
+
+int
+lwes_event_view_get_INT_64
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_INT_64             *value)
+{
+  size_t offset;
+  int ret;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_INT_64_TOKEN, &offset);
+  if (ret == 0)
+    {
+      unmarshall_INT_64_unchecked (value, view->bytes, &offset);
+    }
+  return ret;
+}
+
+int
+lwes_event_view_get_IP_ADDR
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_IP_ADDR            *value)
+{
+  size_t offset;
+  int ret;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_IP_ADDR_TOKEN, &offset);
+  if (ret == 0)
+    {
+      unmarshall_IP_ADDR_unchecked (value, view->bytes, &offset);
+    }
+  return ret;
+}
+
+int
+lwes_event_view_get_BOOLEAN
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_BOOLEAN            *value)
+{
+  size_t offset;
+  int ret;
+
+  if (value == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_BOOLEAN_TOKEN, &offset);
+  if (ret == 0)
+    {
+      unmarshall_BOOLEAN_unchecked (value, view->bytes, &offset);
+    }
+  return ret;
+}
+
+int
+lwes_event_view_get_STRING
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_CONST_LONG_STRING  *value,
+   size_t                  *length)
+{
+  LWES_U_INT_16 string_length;
+  size_t offset;
+  int ret;
+
+  if (value == NULL || length == NULL)
+    {
+      return -1;
+    }
+  ret = lwes_event_view_find (view, name, LWES_STRING_TOKEN, &offset);
+  if (ret == 0)
+    {
+      /* the string follows its length */
+      unmarshall_U_INT_16_unchecked (&string_length, view->bytes, &offset);
+      *value  = (LWES_CONST_LONG_STRING)(view->bytes + offset);
+      *length = string_length;
+    }
+  return ret;
+}
+
+/*************************************************************************
+  PRIVATE API
+ *************************************************************************/
+static int
+lwes_event_view_name
+  (struct lwes_event_view *view,
+   size_t *offset,
+   LWES_CONST_SHORT_STRING *name,
+   LWES_BYTE *length)
+{
+  if (unmarshall_BYTE (length, view->bytes, view->num_bytes, offset) == 0
+      || view->num_bytes - (*offset) < *length)
+    {
+      return -2;
+    }
+  *name = (LWES_CONST_SHORT_STRING)(view->bytes + (*offset));
+  (*offset) += *length;
+  return 0;
+}
+
+static int
+lwes_event_view_skip
+  (struct lwes_event_view *view,
+   LWES_BYTE type,
+   size_t *offset)
+{
+  LWES_U_INT_16 length;
+  size_t size;
+
+  if (type == LWES_U_INT_16_TOKEN || type == LWES_INT_16_TOKEN)
+    {
+      size = 2;
+    }
+  else if (type == LWES_U_INT_32_TOKEN || type == LWES_INT_32_TOKEN
+           || type == LWES_IP_ADDR_TOKEN)
+    {
+      size = 4;
+    }
+  else if (type == LWES_U_INT_64_TOKEN || type == LWES_INT_64_TOKEN)
+    {
+      size = 8;
+    }
+  else if (type == LWES_BOOLEAN_TOKEN)
+    {
+      size = 1;
+    }
+  else if (type == LWES_STRING_TOKEN)
+    {
+      if (unmarshall_U_INT_16 (&length,
+                               view->bytes, view->num_bytes, offset) == 0)
+        {
+          return -2;
+        }
+      size = length;
+    }
+  else
+    {
+      return -4;
+    }
+
+  if (view->num_bytes - (*offset) < size)
+    {
+      return -2;
+    }
+  (*offset) += size;
+  return 0;
+}
+
+static int
+lwes_event_view_find
+  (struct lwes_event_view *view,
+   LWES_CONST_SHORT_STRING name,
+   LWES_BYTE type,
+   size_t *offset)
+{
+  struct lwes_event_view_attribute *attribute;
+  size_t length;
+  int i;
+
+  if (view == NULL || name == NULL)
+    {
+      return -1;
+    }
+
+  /* only names of the same length need comparing */
+  length = strlen (name);
+  for (i = 0; i < view->number_of_attributes; i++)
+    {
+      attribute = &(view->attributes[i]);
+      if (attribute->name_length == length
+          && memcmp (attribute->name, name, length) == 0)
+        {
+          if (attribute->type != type)
+            {
+              return -2;
+            }
+          *offset = attribute->offset;
+          return 0;
+        }
+    }
+
+  return -1;
+}
@@ -0,0 +1,277 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#ifndef __LWES_EVENT_VIEW_H
+#define __LWES_EVENT_VIEW_H
+
+#include <stddef.h>
+
+#include "lwes_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lwes_event_view.h
+ *  \brief Functions for reading a serialized event without deserializing it
+ */
+
+/*! \struct lwes_event_view_attribute lwes_event_view.h
+ *  \brief Where an attribute is in the bytes of an event
+ */
+struct lwes_event_view_attribute
+{
+  /*! Name of the attribute, in the bytes and not nul terminated */
+  LWES_CONST_SHORT_STRING  name;
+  /*! Length of the name */
+  LWES_BYTE                name_length;
+  /*! The type of the attribute */
+  LWES_BYTE                type;
+  /*! Offset of the value in the bytes */
+  size_t                   offset;
+};
+
+/*! \struct lwes_event_view lwes_event_view.h
+ *  \brief A read only view of a serialized event
+ *
+ *  The view records where the attributes are in the bytes of an event,
+ *  and only decodes a value when it is asked for, so the bytes must stay
+ *  untouched for as long as the view is used.  A view can be used for
+ *  one event after another.
+ */
+struct lwes_event_view
+{
+  /*! The bytes being viewed, which belong to the caller */
+  LWES_BYTE_P                       bytes;
+  /*! Number of bytes in the array being viewed */
+  size_t                            num_bytes;
+  /*! Name of the event, in the bytes and not nul terminated */
+  LWES_CONST_SHORT_STRING           name;
+  /*! Length of the name of the event */
+  LWES_BYTE                         name_length;
+  /*! Number of attributes in the event */
+  LWES_U_INT_16                     number_of_attributes;
+  /*! The attributes of the event, in the order they were serialized */
+  struct lwes_event_view_attribute *attributes;
+  /*! Number of attributes there is room for */
+  int                               attributes_size;
+};
+
+/*! \brief Create a view for reading serialized events
+ *
+ *  \see lwes_event_view_destroy
+ *  \return a newly allocated view or NULL if an error occured
+ */
+struct lwes_event_view *
+lwes_event_view_create
+  (void);
+
+/*! \brief Cleanup the memory for a view
+ *
+ *  \param[in] view the view to destroy
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_view_destroy
+  (struct lwes_event_view *view);
+
+/*! \brief View a serialized event
+ *
+ *  Goes over the event once to find its attributes and check it is
+ *  whole, nothing is copied or decoded.
+ *
+ *  \param[in] view the view to read the event with
+ *  \param[in] bytes the bytes holding the event
+ *  \param[in] num_bytes the number of bytes in the array
+ *  \param[in] offset the offset into the array the event starts at
+ *
+ *  \return the number of bytes the event took up on success, -1 for bad
+ *          arguments, -2 if the bytes do not hold a whole event, -3 if
+ *          memory could not be allocated, -4 for an unknown type
+ */
+int
+lwes_event_view_from_bytes
+  (struct lwes_event_view *view,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset);
+
+/*! \brief Get the name of the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[out] name the name, in the bytes and not nul terminated
+ *  \param[out] length the length of the name
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_view_get_name
+  (struct lwes_event_view *view,
+   LWES_CONST_SHORT_STRING *name,
+   size_t *length);
+
+/*! \brief Get the number of attributes of the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[out] number the number of attributes
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_event_view_get_number_of_attributes
+  (struct lwes_event_view *view,
+   LWES_U_INT_16 *number);
+
+/*! \brief Get an uint16 attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_U_INT_16
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_U_INT_16           *value);
+
+/*! \brief Get an int16 attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_INT_16
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_INT_16             *value);
+
+/*! \brief Get an uint32 attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_U_INT_32
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_U_INT_32           *value);
+
+/*! \brief Get an int32 attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_INT_32
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_INT_32             *value);
+
+/*! \brief Get an uint64 attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_U_INT_64
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_U_INT_64           *value);
+
+/*! \brief Get an int64 attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_INT_64
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_INT_64             *value);
+
+/*! \brief Get an ip address attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_IP_ADDR
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_IP_ADDR            *value);
+
+/*! \brief Get a boolean attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_BOOLEAN
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_BOOLEAN            *value);
+
+/*! \brief Get a string attribute from the viewed event
+ *
+ *  \param[in] view the view of the event
+ *  \param[in] name the name of the attribute
+ *  \param[out] value the value of the attribute, in the bytes and not
+ *                    nul terminated
+ *  \param[out] length the length of the value
+ *
+ *  \return 0 on success, -1 if there is no such attribute, -2 if the
+ *          attribute is of another type
+ */
+int
+lwes_event_view_get_STRING
+  (struct lwes_event_view  *view,
+   LWES_CONST_SHORT_STRING  name,
+   LWES_CONST_LONG_STRING  *value,
+   size_t                  *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LWES_EVENT_VIEW_H */
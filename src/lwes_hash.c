@@ -14,17 +14,23 @@
 
 #include <string.h>
 
+/* marks a slot whose entry was removed, so probing continues past it */
+static char lwes_hash_deleted_key[] = "";
+#define LWES_HASH_DELETED lwes_hash_deleted_key
+
 /*************************************************************************
   PRIVATE API Prototypes, shouldn't be called outside of this file
  *************************************************************************/
 int
-lwes_hash
-  (const char *key);
-
-int
 lwes_hash_init
   (struct lwes_hash *hash, int bins);
 
+static struct lwes_hash_slot *
+lwes_hash_find
+  (struct lwes_hash *hash,
+   const char *key,
+   unsigned int h);
+
 /*************************************************************************
   PUBLIC API
  *************************************************************************/
@@ -32,7 +38,7 @@ struct lwes_hash *
 lwes_hash_create
   (void)
 {
-  return lwes_hash_create_with_bins (10);
+  return lwes_hash_create_with_bins (16);
 }
 
 struct lwes_hash *
@@ -52,6 +58,39 @@ lwes_hash_create_with_bins
   return hash;
 }
 
+int
+lwes_hash_init_with_slots
+  (struct lwes_hash *hash,
+   struct lwes_hash_slot *slots,
+   int total)
+{
+  if ( hash == NULL || slots == NULL || total <= 0
+       || (total & (total - 1)) != 0 )
+    {
+      return -1;
+    }
+
+  hash->total_bins       = total;
+  hash->assigned_entries = 0;
+  hash->deleted_entries  = 0;
+  hash->owns_slots       = 0;
+  hash->slots            = slots;
+  memset (hash->slots, 0, sizeof (struct lwes_hash_slot) * total);
+  return 0;
+}
+
+void
+lwes_hash_release
+  (struct lwes_hash *hash)
+{
+  if ( hash != NULL && hash->owns_slots )
+    {
+      free (hash->slots);
+      hash->slots      = NULL;
+      hash->owns_slots = 0;
+    }
+}
+
 int
 lwes_hash_destroy
   (struct lwes_hash* hash)
@@ -62,13 +101,26 @@ lwes_hash_destroy
    */
   if ( hash->assigned_entries == 0 )
     {
-      free (hash->bins);
+      lwes_hash_release (hash);
       free (hash);
       ret = 0;
     }
   return ret;
 }
 
+void
+lwes_hash_clear
+  (struct lwes_hash* hash)
+{
+  if ( hash == NULL )
+    {
+      return;
+    }
+  memset (hash->slots, 0, sizeof (struct lwes_hash_slot) * hash->total_bins);
+  hash->assigned_entries = 0;
+  hash->deleted_entries  = 0;
+}
+
 int
 lwes_hash_is_empty
   (struct lwes_hash* hash)
@@ -83,46 +135,119 @@ lwes_hash_size
   return hash->assigned_entries;
 }
 
+int
+lwes_hash_rehash
+  (struct lwes_hash* hash)
+{
+  struct lwes_hash_slot *old_slots;
+  struct lwes_hash_slot *new_slots;
+  int old_total;
+  int new_total;
+  int mask;
+  int i;
+  int j;
+
+  if ( hash == NULL )
+    {
+      return -1;
+    }
+
+  old_slots = hash->slots;
+  old_total = hash->total_bins;
+  new_total = old_total;
+  if ( (hash->assigned_entries + 1) * 2 > old_total )
+    {
+      new_total *= 2;
+    }
+
+  new_slots = (struct lwes_hash_slot *)
+    malloc (sizeof (struct lwes_hash_slot) * new_total);
+  if ( new_slots == NULL )
+    {
+      return -3;
+    }
+  memset (new_slots, 0, sizeof (struct lwes_hash_slot) * new_total);
+
+  mask = new_total - 1;
+  for ( i = 0; i < old_total; i++ )
+    {
+      if ( old_slots[i].key == NULL || old_slots[i].key == LWES_HASH_DELETED )
+        {
+          continue;
+        }
+      j = old_slots[i].hash & mask;
+      while ( new_slots[j].key != NULL )
+        {
+          j = (j + 1) & mask;
+        }
+      new_slots[j] = old_slots[i];
+    }
+
+  lwes_hash_release (hash);
+  hash->slots           = new_slots;
+  hash->total_bins      = new_total;
+  hash->deleted_entries = 0;
+  hash->owns_slots      = 1;
+
+  return 0;
+}
+
 int
 lwes_hash_put
   (struct lwes_hash* hash,
    char *key,
    void *value)
 {
+  if ( key == NULL || hash == NULL )
+    {
+      return -1;
+    }
+
+  return lwes_hash_put_with_hash (hash, key, value, lwes_hash (key));
+}
+
+int
+lwes_hash_put_with_hash
+  (struct lwes_hash* hash,
+   char *key,
+   void *value,
+   unsigned int h)
+{
+  int mask;
   int index;
-  struct lwes_hash_element *bin         = NULL;
-  struct lwes_hash_element *new_element = NULL;
+  int ret;
 
   if ( key == NULL || hash == NULL )
     {
       return -1;
     }
 
-  new_element =
-    (struct lwes_hash_element *) malloc (sizeof (struct lwes_hash_element));
-  if ( new_element == NULL )
+  /* keep at least a quarter of the slots empty so probes stay short */
+  if ( (hash->assigned_entries + hash->deleted_entries + 1) * 4
+       > hash->total_bins * 3 )
     {
-      return -3;
+      ret = lwes_hash_rehash (hash);
+      if ( ret < 0 )
+        {
+          return ret;
+        }
     }
-  new_element->key   = key;
-  new_element->value = value;
-  new_element->next  = NULL;
-
-  index = lwes_hash(key)%hash->total_bins;
 
-  if ( hash->bins[index] == NULL )
+  mask  = hash->total_bins - 1;
+  index = h & mask;
+  while ( hash->slots[index].key != NULL
+          && hash->slots[index].key != LWES_HASH_DELETED )
     {
-      hash->bins[index] = (void *)new_element;
+      index = (index + 1) & mask;
     }
-  else
+
+  if ( hash->slots[index].key == LWES_HASH_DELETED )
     {
-      bin = (struct lwes_hash_element *)hash->bins[index];
-      while ( bin->next != NULL )
-        {
-          bin = bin->next;
-        }
-      bin->next     = new_element;
+      hash->deleted_entries--;
     }
+  hash->slots[index].key   = key;
+  hash->slots[index].value = value;
+  hash->slots[index].hash  = h;
   hash->assigned_entries++;
 
   return 0;
@@ -133,23 +258,41 @@ lwes_hash_get
   (struct lwes_hash* hash,
    const char *key)
 {
-  int index;
-  struct lwes_hash_element *bin      = NULL;
-  struct lwes_hash_element *searcher = NULL;
+  if ( hash == NULL || key == NULL )
+    {
+      return NULL;
+    }
 
-  index = lwes_hash (key) % hash->total_bins;
-  bin = hash->bins[index];
-  if ( bin == NULL )
-    return NULL;
-  searcher=bin;
-  while ( searcher != NULL && strcmp (searcher->key, key) != 0 )
+  return lwes_hash_get_with_hash (hash, key, lwes_hash (key));
+}
+
+/* 32 bit FNV-1a */
+unsigned int
+lwes_hash
+  (const char *key)
+{
+  unsigned int h = 2166136261U;
+  int i;
+  for ( i = 0; key[i] != '\0'; i++ )
     {
-      searcher = searcher->next; 
+      h ^= (unsigned char)key[i];
+      h *= 16777619U;
     }
-  if ( searcher == NULL )
+  return h;
+}
+
+void *
+lwes_hash_get_with_hash
+  (struct lwes_hash* hash,
+   const char *key,
+   unsigned int h)
+{
+  struct lwes_hash_slot *slot = lwes_hash_find (hash, key, h);
+
+  if ( slot == NULL )
     return NULL;
 
-  return searcher->value;
+  return slot->value;
 }
 
 void *
@@ -157,73 +300,34 @@ lwes_hash_remove
   (struct lwes_hash* hash,
    const char *key)
 {
-  int index;
-  void *return_value;
-  struct lwes_hash_element *head     = NULL;
-  struct lwes_hash_element *searcher = NULL;
-  struct lwes_hash_element *prev     = NULL;
+  struct lwes_hash_slot *slot;
 
   if ( key == NULL )
     {
       return NULL;
     }
-  index = lwes_hash (key) % hash->total_bins;
-  head = (struct lwes_hash_element *)hash->bins[index];
-  if ( head == NULL )
-    {
-      return NULL;
-    }
-  searcher=head;
-  prev=head;
-  while ( searcher != NULL && strcmp (searcher->key,key) != 0 )
-    {
-      prev     = searcher;
-      searcher = searcher->next; 
-    }
-  /* it's not in the list, so don't do anything, return NULL; */
-  if ( searcher == NULL )
-    return NULL;
 
-  /* else, set the previous next equal to the searcher next */
-  if ( searcher == head )
-    {
-      hash->bins[index] = (void *)searcher->next;
-    }
-  else
-    {
-      prev->next = searcher->next;
-    }
-  searcher->next = NULL;
-  return_value = searcher->value;
-  free (searcher);
+  slot = lwes_hash_find (hash, key, lwes_hash (key));
+  /* it's not in the hash, so don't do anything, return NULL; */
+  if ( slot == NULL )
+    return NULL;
 
+  /* leave a marker rather than emptying the slot, so that entries which
+   * probed past this one can still be found, and enumerations still work
+   */
+  slot->key = LWES_HASH_DELETED;
   hash->assigned_entries--;
-  return return_value;
+  hash->deleted_entries++;
+  return slot->value;
 }
 
 int lwes_hash_contains_key(struct lwes_hash* hash, const char *key)
 {
-  int index;
-  struct lwes_hash_element *bin      = NULL;
-  struct lwes_hash_element *searcher = NULL;
-
-  index = lwes_hash (key) % hash->total_bins;
-  bin = hash->bins[index];
-
-  if ( bin == NULL )
-    return 0;
-
-  searcher=bin;
-
-  while ( searcher != NULL && strcmp (searcher->key,key) != 0 )
+  if ( key == NULL )
     {
-      searcher = searcher->next; 
+      return 0;
     }
-
-  if ( searcher == NULL )
-    return 0;
-
-  return 1;
+  return (lwes_hash_find (hash, key, lwes_hash (key)) != NULL);
 }
 
 int
@@ -240,10 +344,6 @@ lwes_hash_keys
   enumeration->elements_given = 0;
   enumeration->size_at_start = lwes_hash_size (hash);
   enumeration->enum_hash = hash;
-  /* set the current to the first entry of the first list */
-  enumeration->current   =
-    (struct lwes_hash_element *)
-       enumeration->enum_hash->bins[enumeration->index];
 
   return 1;
 }
@@ -261,62 +361,83 @@ char *
 lwes_hash_enumeration_next_element
   (struct lwes_hash_enumeration *enumeration)
 {
-  struct lwes_hash_element *prev;
+  struct lwes_hash_slot *slot;
 
-  /* if the current value pointed at is null (this will most often happen
-   * the first time this is called, or the next value in this list is null,
-   * increment the index and check again.
+  /* skip over the empty and removed slots, which takes care of the case
+   * where we ask beyond the end
    */
-  while ( enumeration->current == NULL )
+  while ( enumeration->index < enumeration->enum_hash->total_bins )
   {
+    slot = &(enumeration->enum_hash->slots[enumeration->index]);
     enumeration->index++;
-    /* takes care of the case where we ask beyond the end */
-    if ( enumeration->index >= enumeration->enum_hash->total_bins )
+    if ( slot->key != NULL && slot->key != LWES_HASH_DELETED )
     {
-      return NULL;
+      enumeration->elements_given++;
+      return slot->key;
     }
-    enumeration->current = enumeration->enum_hash->bins[enumeration->index];
   }
 
-  prev = enumeration->current;
-  enumeration->current = enumeration->current->next;
-  enumeration->elements_given++;
-  return prev->key;
+  return NULL;
 }
 
 /*************************************************************************
   PRIVATE API, shouldn't be called by a user of the library.
  *************************************************************************/
-int
-lwes_hash
-  (const char *key)
-{
-  int sum = 0;
-  int i;
-  for ( i = 0; key[i] != '\0'; i++ )
-    sum += ((int)key[i])*((int)key[i]);
-  return sum;
-}
 
 int
 lwes_hash_init
   (struct lwes_hash *hash,
    int total)
 {
-  int i;
   int ret = -3;
-  hash->total_bins       = total;
+  int bins = 1;
+
+  while ( bins < total )
+    {
+      bins <<= 1;
+    }
+  hash->total_bins       = bins;
   hash->assigned_entries = 0;
-  hash->bins             =
-    (void **)malloc(sizeof(void *) * hash->total_bins);
-  if ( hash->bins != NULL )
+  hash->deleted_entries  = 0;
+  hash->owns_slots       = 1;
+  hash->slots            = (struct lwes_hash_slot *)
+    malloc (sizeof (struct lwes_hash_slot) * bins);
+  if ( hash->slots != NULL )
     {
-      for ( i = 0; i < hash->total_bins; i++)
-      {
-        hash->bins[i] = NULL;
-      }
+      memset (hash->slots, 0, sizeof (struct lwes_hash_slot) * bins);
       ret = 0;
     }
   return ret;
 }
 
+static struct lwes_hash_slot *
+lwes_hash_find
+  (struct lwes_hash *hash,
+   const char *key,
+   unsigned int h)
+{
+  int mask;
+  int index;
+  struct lwes_hash_slot *slot;
+
+  if ( hash == NULL || key == NULL )
+    {
+      return NULL;
+    }
+
+  mask  = hash->total_bins - 1;
+  index = h & mask;
+  /* at least one slot is always empty, so this terminates */
+  for ( slot = &(hash->slots[index]);
+        slot->key != NULL;
+        index = (index + 1) & mask, slot = &(hash->slots[index]) )
+    {
+      if ( slot->hash == h
+           && slot->key != LWES_HASH_DELETED
+           && (slot->key == key || strcmp (slot->key, key) == 0) )
+        {
+          return slot;
+        }
+    }
+  return NULL;
+}
@@ -24,22 +24,32 @@ extern "C" {
  *  \brief Functions for dealing with the hash which is in the event
  */
 
+/*! \struct lwes_hash_slot lwes_hash.h
+ *  \brief A slot in the hashtable, holding a key and value inline.  This
+ *         is opaque in case of future extension.
+ */
+struct lwes_hash_slot
+{
+  char *       key;
+  void *       value;
+  unsigned int hash;
+};
+
 /*! \struct lwes_hash lwes_hash.h
  *  \brief Structure containing a hashtable, used to store key value
  *         pairs in the event.  This is opaque in case of future extension.
+ *
+ *  The table is open addressed with linear probing over a power of two
+ *  number of slots, and is rehashed into twice as many slots once more
+ *  than three quarters of them are in use.
  */
 struct lwes_hash
 {
-  void **bins;
+  struct lwes_hash_slot *slots;
   int total_bins;
   int assigned_entries;
-};
-
-struct lwes_hash_element
-{
-  char * key;
-  void * value;
-  struct lwes_hash_element *next;
+  int deleted_entries;  /* removed entries still taking up a slot */
+  int owns_slots;       /* whether the slots were allocated by the hash */
 };
 
 /*! \struct lwes_hash_enumeration lwes_hash.h
@@ -53,7 +63,6 @@ struct lwes_hash_enumeration
   int size_at_start;  /* in case we are using this enumeration to remove all the
                          elements in the hash */
   struct lwes_hash *enum_hash;
-  struct lwes_hash_element *current;
 };
 
 /*! \brief Create the memory for a hashtable
@@ -67,14 +76,61 @@ struct lwes_hash *
 lwes_hash_create
   (void);
 
+/*! \brief Create the memory for a hashtable with room for some entries
+ *
+ *  \param[in] total_bins the number of slots to start with, rounded up
+ *                        to a power of two
+ *
+ *  \see lwes_hash_destroy
+ *  \return a newly allocated hash or NULL if an error occured
+ */
 struct lwes_hash *
 lwes_hash_create_with_bins
   (int total_bins);
 
+/*! \brief Initialize a hash over storage supplied by the caller
+ *
+ *  The hash structure and the slots are owned by the caller, so
+ *  lwes_hash_destroy must not be called on a hash initialized this way.
+ *  Should the hash outgrow the slots given it allocates slots of its own,
+ *  which lwes_hash_release frees.  This is used by the event to keep its
+ *  attributes in its own storage.
+ *
+ *  \param[in] hash the hash to initialize
+ *  \param[in] slots an array of total_slots slots
+ *  \param[in] total_slots the number of slots, a power of two
+ *
+ *  \see lwes_hash_release
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_hash_init_with_slots
+  (struct lwes_hash *hash,
+   struct lwes_hash_slot *slots,
+   int total_slots);
+
+/*! \brief Free any slots allocated by a hash initialized over caller storage
+ *
+ *  \param[in] hash the hash initialized with lwes_hash_init_with_slots
+ *
+ *  \see lwes_hash_init_with_slots
+ */
+void
+lwes_hash_release
+  (struct lwes_hash *hash);
+
 int
 lwes_hash_destroy
   (struct lwes_hash* hash);
 
+/*! \brief Remove all the entries from the hash, keeping its slots
+ *
+ *  \param[in] hash the hash to empty
+ */
+void
+lwes_hash_clear
+  (struct lwes_hash* hash);
+
 int
 lwes_hash_is_empty
   (struct lwes_hash* hash);
@@ -83,6 +139,16 @@ int
 lwes_hash_size
   (struct lwes_hash* hash);
 
+/*! \brief Rehash the entries into a fresh set of slots
+ *
+ *  The new slots are twice as many if the hash is more than half full.
+ *  This happens automatically as entries are put into the hash, and also
+ *  drops the slots taken up by removed entries.
+ *
+ *  \param[in] hash the hash to rehash
+ *
+ *  \return 0 on success, a negative number on failure
+ */
 int
 lwes_hash_rehash
   (struct lwes_hash* hash);
@@ -98,6 +164,49 @@ lwes_hash_get
   (struct lwes_hash* hash,
    const char *key);
 
+/*! \brief Hash a key the way the hashtable does
+ *
+ *  \param[in] key the nul terminated key to hash
+ *
+ *  \return the hash of the key
+ */
+unsigned int
+lwes_hash
+  (const char *key);
+
+/*! \brief Put a key and value in the hash, the key already being hashed
+ *
+ *  \param[in] hash the hash to put into
+ *  \param[in] key the key, which must stay around as long as the hash
+ *  \param[in] value the value
+ *  \param[in] h the hash of the key, as lwes_hash returns it
+ *
+ *  \see lwes_hash
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_hash_put_with_hash
+  (struct lwes_hash* hash,
+   char *key,
+   void *value,
+   unsigned int h);
+
+/*! \brief Get the value of a key from the hash, the key already being
+ *         hashed
+ *
+ *  \param[in] hash the hash to get from
+ *  \param[in] key the key
+ *  \param[in] h the hash of the key, as lwes_hash returns it
+ *
+ *  \see lwes_hash
+ *  \return the value, or NULL if the key isn't in the hash
+ */
+void *
+lwes_hash_get_with_hash
+  (struct lwes_hash* hash,
+   const char *key,
+   unsigned int h);
+
 void *
 lwes_hash_remove
   (struct lwes_hash* hash,
@@ -0,0 +1,197 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include "lwes_intern.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* names are copied into chunks of this many bytes, which are never freed */
+#define LWES_INTERN_CHUNK_SIZE 65536
+
+/* slots are filled in once and never change after that, so where atomic
+ * operations are available readers just need to see a completely written
+ * slot, and only writers take the lock */
+#if defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+#define LWES_INTERN_LOAD(p)     __atomic_load_n (&(p), __ATOMIC_ACQUIRE)
+#define LWES_INTERN_STORE(p, v) __atomic_store_n (&(p), (v), __ATOMIC_RELEASE)
+#define LWES_INTERN_LOCK_FREE_READS 1
+#else
+#define LWES_INTERN_LOAD(p)     (p)
+#define LWES_INTERN_STORE(p, v) ((p) = (v))
+#define LWES_INTERN_LOCK_FREE_READS 0
+#endif
+
+static LWES_SHORT_STRING lwes_intern_names[LWES_INTERN_SLOTS];
+static unsigned int      lwes_intern_hashes[LWES_INTERN_SLOTS];
+static LWES_BYTE         lwes_intern_lengths[LWES_INTERN_SLOTS];
+static int               lwes_intern_count = 0;
+static char *            lwes_intern_chunk = NULL;
+static size_t            lwes_intern_chunk_used = LWES_INTERN_CHUNK_SIZE;
+static pthread_mutex_t   lwes_intern_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*************************************************************************
+  PRIVATE API Prototypes, shouldn't be called outside of this file
+ *************************************************************************/
+static unsigned int
+lwes_intern_hash
+  (LWES_CONST_SHORT_STRING name,
+   size_t length);
+
+static int
+lwes_intern_find
+  (LWES_CONST_SHORT_STRING name,
+   size_t length,
+   unsigned int hash,
+   LWES_SHORT_STRING *found);
+
+/*************************************************************************
+  PUBLIC API
+ *************************************************************************/
+LWES_SHORT_STRING
+lwes_intern
+  (LWES_CONST_SHORT_STRING name,
+   size_t length)
+{
+  LWES_SHORT_STRING found = NULL;
+  LWES_SHORT_STRING copy  = NULL;
+  unsigned int hash;
+  int index;
+
+  if (name == NULL || length > SHORT_STRING_MAX)
+    {
+      return NULL;
+    }
+
+  hash = lwes_intern_hash (name, length);
+
+#if LWES_INTERN_LOCK_FREE_READS
+  lwes_intern_find (name, length, hash, &found);
+  if (found != NULL)
+    {
+      return found;
+    }
+#endif
+
+  pthread_mutex_lock (&lwes_intern_mutex);
+
+  /* look again, another thread may have added it in the meantime */
+  index = lwes_intern_find (name, length, hash, &found);
+  if (found == NULL
+      && (lwes_intern_count + 1) * 4 <= LWES_INTERN_SLOTS * 3)
+    {
+      if (LWES_INTERN_CHUNK_SIZE - lwes_intern_chunk_used < length + 1)
+        {
+          char *chunk = (char *) malloc (LWES_INTERN_CHUNK_SIZE);
+          if (chunk != NULL)
+            {
+              lwes_intern_chunk      = chunk;
+              lwes_intern_chunk_used = 0;
+            }
+        }
+      if (LWES_INTERN_CHUNK_SIZE - lwes_intern_chunk_used >= length + 1)
+        {
+          copy = lwes_intern_chunk + lwes_intern_chunk_used;
+          lwes_intern_chunk_used += length + 1;
+          memcpy (copy, name, length);
+          copy[length] = '\0';
+
+          /* the hash and length have to be visible before the name is */
+          lwes_intern_hashes[index]  = hash;
+          lwes_intern_lengths[index] = (LWES_BYTE) length;
+          LWES_INTERN_STORE (lwes_intern_names[index], copy);
+          lwes_intern_count++;
+          found = copy;
+        }
+    }
+
+  pthread_mutex_unlock (&lwes_intern_mutex);
+
+  return found;
+}
+
+LWES_SHORT_STRING
+lwes_intern_lookup
+  (LWES_CONST_SHORT_STRING name,
+   size_t length)
+{
+  LWES_SHORT_STRING found = NULL;
+  unsigned int hash;
+
+  if (name == NULL || length > SHORT_STRING_MAX)
+    {
+      return NULL;
+    }
+
+  hash = lwes_intern_hash (name, length);
+
+#if ! LWES_INTERN_LOCK_FREE_READS
+  pthread_mutex_lock (&lwes_intern_mutex);
+#endif
+  lwes_intern_find (name, length, hash, &found);
+#if ! LWES_INTERN_LOCK_FREE_READS
+  pthread_mutex_unlock (&lwes_intern_mutex);
+#endif
+
+  return found;
+}
+
+/*************************************************************************
+  PRIVATE API, shouldn't be called by a user of the library.
+ *************************************************************************/
+
+/* 32 bit FNV-1a, same as the hash of lwes_hash */
+static unsigned int
+lwes_intern_hash
+  (LWES_CONST_SHORT_STRING name,
+   size_t length)
+{
+  unsigned int h = 2166136261U;
+  size_t i;
+  for ( i = 0; i < length; i++ )
+    {
+      h ^= (unsigned char)name[i];
+      h *= 16777619U;
+    }
+  return h;
+}
+
+/* Probe for a name, setting found if it is there, and returning the
+ * index of the slot where it is or would go */
+static int
+lwes_intern_find
+  (LWES_CONST_SHORT_STRING name,
+   size_t length,
+   unsigned int hash,
+   LWES_SHORT_STRING *found)
+{
+  LWES_SHORT_STRING candidate;
+  int index = (int)(hash & (LWES_INTERN_SLOTS - 1));
+
+  /* a quarter of the slots are always empty, so this terminates */
+  while ((candidate = LWES_INTERN_LOAD (lwes_intern_names[index])) != NULL)
+    {
+      /* the length is compared first, so no more of the name is read
+       * than there is */
+      if (lwes_intern_hashes[index] == hash
+          && lwes_intern_lengths[index] == length
+          && memcmp (candidate, name, length) == 0)
+        {
+          *found = candidate;
+          break;
+        }
+      index = (index + 1) & (LWES_INTERN_SLOTS - 1);
+    }
+
+  return index;
+}
@@ -0,0 +1,69 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#ifndef __LWES_INTERN_H
+#define __LWES_INTERN_H
+
+#include <stddef.h>
+
+#include "lwes_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lwes_intern.h
+ *  \brief Functions for sharing a single copy of event and attribute names
+ */
+
+/* number of names the table has room for, a power of two, at most
+ * three quarters of them are used before interning gives up */
+#define LWES_INTERN_SLOTS 16384
+
+/*! \brief Get the shared copy of a name
+ *
+ *  Names are interned into a table shared by the whole process, so that
+ *  events hold the same pointer for the same name instead of copies, and
+ *  equal names can be compared by pointer.  Interned names live for as
+ *  long as the process and must not be modified.  This is safe to call
+ *  from multiple threads, finding a name which is already interned does
+ *  not take a lock where atomic operations are available.
+ *
+ *  \param[in] name the name to intern
+ *  \param[in] length the length of the name, not counting any terminator
+ *
+ *  \return the shared copy of the name, or NULL if the name is longer
+ *          than SHORT_STRING_MAX, the table is full or memory could not
+ *          be allocated
+ */
+LWES_SHORT_STRING
+lwes_intern
+  (LWES_CONST_SHORT_STRING name,
+   size_t length);
+
+/*! \brief Get the shared copy of a name if it has been interned
+ *
+ *  \param[in] name the name to look for
+ *  \param[in] length the length of the name, not counting any terminator
+ *
+ *  \return the shared copy of the name, or NULL if it hasn't been interned
+ */
+LWES_SHORT_STRING
+lwes_intern_lookup
+  (LWES_CONST_SHORT_STRING name,
+   size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LWES_INTERN_H */
@@ -21,11 +21,37 @@ lwes_listener_create
    LWES_SHORT_STRING iface,
    LWES_U_INT_32 port)
 {
+  return lwes_listener_create_with_batch (address, iface, port, 0);
+}
+
+struct lwes_listener *
+lwes_listener_create_with_batch
+  (LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   int batch)
+{
+  return lwes_listener_create_shard (address, iface, port, batch, 0, 1);
+}
+
+struct lwes_listener *
+lwes_listener_create_shard
+  (LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   int batch,
+   int shard,
+   int shards)
+{
+  LWES_BYTE_P slab;
+  int i;
   struct lwes_listener *listener =
     (struct lwes_listener *) malloc (sizeof (struct lwes_listener));
 
-  if ( listener == NULL )
+  if ( listener == NULL || batch < 0 )
     {
+      if ( listener != NULL )
+        free (listener);
       return NULL;
     }
 
@@ -52,9 +78,41 @@ lwes_listener_create
       return NULL;
     }
 
+  /* the packets of a batch all share one slab */
+  listener->packets      = NULL;
+  listener->packets_size = batch;
+  if ( batch > 0 )
+    {
+      listener->packets =
+        (struct lwes_net_packet *)
+          malloc (sizeof (struct lwes_net_packet)*batch);
+      slab = (listener->packets == NULL) ? NULL :
+        (LWES_BYTE_P) malloc (sizeof (LWES_BYTE)*MAX_MSG_SIZE*batch);
+      if ( slab == NULL )
+        {
+          if ( listener->packets != NULL )
+            free (listener->packets);
+          free (listener->dtmp);
+          free (listener->buffer);
+          free (listener);
+          return NULL;
+        }
+      for ( i = 0 ; i < batch ; i++ )
+        {
+          listener->packets[i].bytes  = slab + MAX_MSG_SIZE*i;
+          listener->packets[i].length = 0;
+        }
+    }
+
   if ( (lwes_net_open (&(listener->connection),address,iface,port) != 0) ||
-       (lwes_net_recv_bind (&(listener->connection)) != 0) )
+       (lwes_net_recv_bind_shard (&(listener->connection),
+                                  shard, shards) != 0) )
     {
+      if ( listener->packets != NULL )
+        {
+          free (listener->packets[0].bytes);
+          free (listener->packets);
+        }
       if ( listener->dtmp != NULL )
         free (listener->dtmp);
       if ( listener->buffer != NULL )
@@ -68,28 +126,34 @@ lwes_listener_create
 }
 
 int
-lwes_listener_add_header_fields
-  (struct lwes_listener *listener,
+lwes_listener_add_header_fields_from
+  (struct lwes_event_deserialize_tmp *dtmp,
+   struct sockaddr_in *sender,
+   LWES_INT_64 receipt_time,
    LWES_BYTE_P bytes,
    size_t max,
    size_t *len)
 {
-  size_t n = *len;
+  size_t n;
   size_t offset_to_num_attrs;
   size_t tmp_offset;
   LWES_U_INT_16 num_attrs;
-  LWES_INT_64 receipt_time;
   LWES_IP_ADDR sender_ip;
   LWES_U_INT_16 sender_port;
 
+  if (dtmp == NULL || sender == NULL || bytes == NULL || len == NULL)
+    {
+      return -1;
+    }
+  n = *len;
+
   /* grab some information from the packet and add it to the event */
-  receipt_time = currentTimeMillisLongLong();
-  sender_ip    = listener->connection.sender_ip_addr.sin_addr;
-  sender_port  = ntohs (listener->connection.sender_ip_addr.sin_port);
+  sender_ip    = sender->sin_addr;
+  sender_port  = ntohs (sender->sin_port);
 
   /* deserialize the event name */
   offset_to_num_attrs = 0;
-  if (unmarshall_SHORT_STRING (listener->dtmp->tmp_string,
+  if (unmarshall_SHORT_STRING (dtmp->tmp_string,
                                (SHORT_STRING_MAX+1),
                                bytes,
                                max,
@@ -176,6 +240,40 @@ lwes_listener_add_header_fields
   return 0;
 }
 
+int
+lwes_listener_add_header_fields
+  (struct lwes_listener *listener,
+   LWES_BYTE_P bytes,
+   size_t max,
+   size_t *len)
+{
+  return lwes_listener_add_header_fields_from
+           (listener->dtmp,
+            &(listener->connection.sender_ip_addr),
+            currentTimeMillisLongLong(),
+            bytes,
+            max,
+            len);
+}
+
+int
+lwes_listener_add_packet_header_fields
+  (struct lwes_listener *listener,
+   struct lwes_net_packet *packet)
+{
+  if (listener == NULL || packet == NULL)
+    {
+      return -1;
+    }
+
+  return lwes_listener_add_header_fields_from (listener->dtmp,
+                                               &(packet->sender),
+                                               currentTimeMillisLongLong(),
+                                               packet->bytes,
+                                               MAX_MSG_SIZE,
+                                               &(packet->length));
+}
+
 int
 lwes_listener_event_has_name
   (LWES_BYTE_P bytes,
@@ -236,6 +334,12 @@ lwes_listener_recv_process_event
       return ret;
     }
 
+  /* the event is reused from one receive to the next */
+  if ((ret = lwes_event_reset (event)) < 0)
+    {
+      return ret;
+    }
+
    return lwes_event_from_bytes
             (event, listener->buffer, n, 0, listener->dtmp );
 }
@@ -316,6 +420,87 @@ lwes_listener_recv_bytes_by
 }
 
 
+int
+lwes_listener_recv_batch
+  (struct lwes_listener *listener,
+   struct lwes_event **events,
+   int n)
+{
+  struct lwes_net_packet *packet;
+  LWES_INT_64 receipt_time;
+  int received;
+  int filled = 0;
+  int i;
+
+  if (listener == NULL || listener->packets == NULL
+      || events == NULL || n <= 0)
+    {
+      return -1;
+    }
+
+  if (n > listener->packets_size)
+    {
+      n = listener->packets_size;
+    }
+  if ((received = lwes_net_recv_bytes_batch (&(listener->connection),
+                                             listener->packets,
+                                             MAX_MSG_SIZE,
+                                             n)) < 0)
+    {
+      return -2;
+    }
+
+  /* they all arrived at once */
+  receipt_time = currentTimeMillisLongLong();
+
+  for (i = 0; i < received; i++)
+    {
+      packet = &(listener->packets[i]);
+      if (lwes_listener_add_header_fields_from (listener->dtmp,
+                                                &(packet->sender),
+                                                receipt_time,
+                                                packet->bytes,
+                                                MAX_MSG_SIZE,
+                                                &(packet->length)) < 0
+          || lwes_event_reset (events[filled]) < 0
+          || lwes_event_from_bytes (events[filled],
+                                    packet->bytes,
+                                    packet->length,
+                                    0,
+                                    listener->dtmp) < 0)
+        {
+          continue;
+        }
+      filled++;
+    }
+
+  return filled;
+}
+
+int
+lwes_listener_recv_bytes_batch
+  (struct lwes_listener *listener,
+   struct lwes_net_packet **packets)
+{
+  int n = 0;
+
+  if (listener == NULL || listener->packets == NULL || packets == NULL)
+    {
+      return -1;
+    }
+
+  if ((n = lwes_net_recv_bytes_batch (&(listener->connection),
+                                      listener->packets,
+                                      MAX_MSG_SIZE,
+                                      listener->packets_size)) < 0)
+    {
+      return -2;
+    }
+
+  *packets = listener->packets;
+  return n;
+}
+
 int
 lwes_listener_destroy
   (struct lwes_listener *listener)
@@ -328,6 +513,11 @@ lwes_listener_destroy
     free (listener->buffer);
   if ( listener->dtmp != NULL )
     free (listener->dtmp);
+  if ( listener->packets != NULL )
+    {
+      free (listener->packets[0].bytes);
+      free (listener->packets);
+    }
   if ( listener != NULL )
     free (listener);
 
@@ -36,6 +36,11 @@ struct lwes_listener
   struct lwes_event_deserialize_tmp *dtmp;
   /*! this is a temporary buffer for the packet from the socket */
   LWES_BYTE_P buffer;
+  /*! packets received at once by the batch functions, NULL unless the
+      listener was created with lwes_listener_create_with_batch */
+  struct lwes_net_packet *packets;
+  /*! number of packets which can be received at once */
+  int packets_size;
 };
 
 /*! \brief Create a Listener
@@ -56,6 +61,59 @@ lwes_listener_create
    LWES_SHORT_STRING iface,
    LWES_U_INT_32 port);
 
+/*! \brief Create a Listener which can receive many packets at once
+ *
+ *  \param[in] address The multicast ip address as a dotted quad string
+ *                     of the channel to listen on.
+ *  \param[in] iface   The dotted quad ip address of the interface to
+ *                     receive messages on, can be NULL to use default.
+ *  \param[in] port    The port of the channel to listen on.
+ *  \param[in] batch   The number of packets to keep buffers for, which is
+ *                     the most received by one call to
+ *                     lwes_listener_recv_batch or
+ *                     lwes_listener_recv_bytes_batch.
+ *
+ *  \see lwes_listener_destroy
+ *
+ *  \return A newly created listener, use lwes_listener_destroy to free
+ */
+struct lwes_listener *
+lwes_listener_create_with_batch
+  (LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   int batch);
+
+/*! \brief Create one of several Listeners sharing a channel
+ *
+ *  Each of the listeners gets a share of the events sent to the channel,
+ *  with all of those from one sender going to the same listener, so they
+ *  can each be received from on a thread of their own.
+ *
+ *  \param[in] address The multicast ip address as a dotted quad string
+ *                     of the channel to listen on.
+ *  \param[in] iface   The dotted quad ip address of the interface to
+ *                     receive messages on, can be NULL to use default.
+ *  \param[in] port    The port of the channel to listen on.
+ *  \param[in] batch   The number of packets to keep buffers for, as with
+ *                     lwes_listener_create_with_batch.
+ *  \param[in] shard   Which of the listeners this is, from 0 to shards-1.
+ *  \param[in] shards  The number of listeners sharing the channel.
+ *
+ *  \see lwes_net_recv_bind_shard
+ *  \see lwes_listener_destroy
+ *
+ *  \return A newly created listener, use lwes_listener_destroy to free
+ */
+struct lwes_listener *
+lwes_listener_create_shard
+  (LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   int batch,
+   int shard,
+   int shards);
+
 /*! \brief Copy some date from the UDP packet into the event
  *
  *  This will add the following fields to the event as additional attributes
@@ -89,6 +147,48 @@ lwes_listener_add_header_fields
    size_t max,
    size_t *len);
 
+/*! \brief Copy some data about a packet into it
+ *
+ *  This adds the same attributes as lwes_listener_add_header_fields, for
+ *  a packet from any sender received at any time, so it can be used by
+ *  whatever received the packet.
+ *
+ *  \param[in] dtmp         Temporary space for deserializing the name
+ *  \param[in] sender       The sender of the packet
+ *  \param[in] receipt_time When the packet was received, as milliseconds
+ *                          since epoch
+ *  \param[in] bytes        The serialized event to add the attributes to
+ *  \param[in] max          The maximum size of the serialzed event
+ *  \param[in,out] len      The current size of the serialized event
+ *
+ *  \return 0 upon success, a negative number upon failure
+ */
+int
+lwes_listener_add_header_fields_from
+  (struct lwes_event_deserialize_tmp *dtmp,
+   struct sockaddr_in *sender,
+   LWES_INT_64 receipt_time,
+   LWES_BYTE_P bytes,
+   size_t max,
+   size_t *len);
+
+/*! \brief Copy some data from a packet received in a batch into it
+ *
+ *  This adds the same attributes as lwes_listener_add_header_fields, with
+ *  the sender of the packet, and updates the length of the packet.
+ *
+ *  \param[in] listener The listener which received the packet
+ *  \param[in,out] packet The packet to add the attributes to
+ *
+ *  \see lwes_listener_recv_bytes_batch
+ *
+ *  \return 0 upon success, a negative number upon failure
+ */
+int
+lwes_listener_add_packet_header_fields
+  (struct lwes_listener *listener,
+   struct lwes_net_packet *packet);
+
 /*! \brief Determine if a serialized event is of a given type
  *
  *  This function will compare the name in a serialized event against a
@@ -126,6 +226,10 @@ lwes_listener_recv_process_event
    int len);
 
 /*! \brief Receive an event from the listener in a blocking manner
+ *
+ *  The event is reset before the received event is deserialized into it,
+ *  so the same event can be passed in on every call, which avoids
+ *  creating and destroying an event for each one received.
  *
  *  \param[in] listener the listener to receive the event from
  *  \param[out] event the event to fill out
@@ -138,6 +242,9 @@ lwes_listener_recv
    struct lwes_event *event);
 
 /*! \brief Receive an event from the listener with a timeout
+ *
+ *  As with lwes_listener_recv the event is reset before the received event
+ *  is deserialized into it, so it can be reused from one call to the next.
  *
  *  \param[in] listener the listener to receive the event from
  *  \param[out] event the event to fill out
@@ -189,6 +296,47 @@ lwes_listener_recv_bytes_by
    size_t max,
    unsigned int timeout_ms);
 
+/*! \brief Receive many events from the listener in a blocking manner
+ *
+ *  This blocks until there is a packet, then takes as many of those
+ *  waiting as there are events, up to the batch the listener was created
+ *  with, in as few system calls as the system allows.  Header fields are
+ *  added to each of them and they are deserialized into the events, which
+ *  are reset first.  Packets which can't be deserialized are skipped.
+ *
+ *  \param[in] listener the listener to receive the events from
+ *  \param[out] events the events to fill out
+ *  \param[in] n the number of events
+ *
+ *  \see lwes_listener_create_with_batch
+ *  \return the number of events filled out on success, a negative number on
+ *          failure
+ */
+int
+lwes_listener_recv_batch
+  (struct lwes_listener *listener,
+   struct lwes_event **events,
+   int n);
+
+/*! \brief Receive many packets from the listener in a blocking manner
+ *
+ *  As with lwes_listener_recv_bytes, header fields are not added nor are
+ *  the events deserialized.  The packets belong to the listener and are
+ *  overwritten by the next call.
+ *
+ *  \param[in] listener the listener to receive the packets from
+ *  \param[out] packets the packets received
+ *
+ *  \see lwes_listener_create_with_batch
+ *  \see lwes_listener_add_packet_header_fields
+ *  \return the number of packets received on success, a negative number on
+ *          failure
+ */
+int
+lwes_listener_recv_bytes_batch
+  (struct lwes_listener *listener,
+   struct lwes_net_packet **packets);
+
 /*! \brief Destroy a Listener
  *
  * \param[in] listener The listener to destroy by freeing all of it's used
@@ -0,0 +1,294 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include "lwes_listener_group.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* number of events each thread receives at once */
+#define LWES_LISTENER_GROUP_BATCH_SIZE 16
+
+/* milliseconds a thread waits for a packet before it looks to see if it
+   should stop, and after receiving fails before it tries again */
+#define LWES_LISTENER_GROUP_WAIT_MS 100
+
+/*************************************************************************
+  PRIVATE API prototypes, shouldn't be called by a user of the library.
+ *************************************************************************/
+int
+lwes_listener_group_shard_open
+  (struct lwes_listener_group_shard *shard,
+   LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   int index,
+   int count);
+
+void
+lwes_listener_group_free
+  (struct lwes_listener_group *group);
+
+void *
+lwes_listener_group_run
+  (void *arg);
+
+/*************************************************************************
+  PUBLIC API
+ *************************************************************************/
+struct lwes_listener_group *
+lwes_listener_group_create
+  (LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   int threads,
+   lwes_listener_group_callback callback,
+   void *arg)
+{
+  struct lwes_listener_group *group;
+  int i;
+
+  if (callback == NULL || threads < 0)
+    {
+      return NULL;
+    }
+
+  if (threads == 0)
+    {
+      threads = (int) sysconf (_SC_NPROCESSORS_ONLN);
+      if (threads <= 0)
+        {
+          threads = 1;
+        }
+    }
+
+  group = (struct lwes_listener_group *)
+    malloc (sizeof (struct lwes_listener_group));
+  if (group == NULL)
+    {
+      return NULL;
+    }
+  memset (group, 0, sizeof (struct lwes_listener_group));
+
+  group->shards =
+    (struct lwes_listener_group_shard *)
+      malloc (sizeof (struct lwes_listener_group_shard)*threads);
+  if (group->shards == NULL)
+    {
+      free (group);
+      return NULL;
+    }
+  memset (group->shards, 0, sizeof (struct lwes_listener_group_shard)*threads);
+
+  group->callback = callback;
+  group->arg      = arg;
+  group->running  = 1;
+
+  /* every shard is bound before any thread starts, so none of the events
+     sent while they are being bound go to a socket which isn't read */
+  for (i = 0; i < threads; i++)
+    {
+      group->shards[i].group = group;
+      if (lwes_listener_group_shard_open (&(group->shards[i]),
+                                          address, iface, port,
+                                          i, threads) < 0)
+        {
+          group->shards_size = i + 1;
+          lwes_listener_group_free (group);
+          return NULL;
+        }
+    }
+  group->shards_size = threads;
+
+  for (i = 0; i < threads; i++)
+    {
+      if (pthread_create (&(group->shards[i].thread), NULL,
+                          lwes_listener_group_run, &(group->shards[i])) != 0)
+        {
+          /* stop those already started */
+          __atomic_store_n (&(group->running), 0, __ATOMIC_RELEASE);
+          while (--i >= 0)
+            {
+              pthread_join (group->shards[i].thread, NULL);
+            }
+          lwes_listener_group_free (group);
+          return NULL;
+        }
+    }
+
+  return group;
+}
+
+int
+lwes_listener_group_get_errors
+  (struct lwes_listener_group *group,
+   LWES_U_INT_64 *errors)
+{
+  if (group == NULL || errors == NULL)
+    {
+      return -1;
+    }
+
+  *errors = __atomic_load_n (&(group->errors), __ATOMIC_RELAXED);
+
+  return 0;
+}
+
+int
+lwes_listener_group_destroy
+  (struct lwes_listener_group *group)
+{
+  int i;
+
+  if (group == NULL)
+    {
+      return 0;
+    }
+
+  __atomic_store_n (&(group->running), 0, __ATOMIC_RELEASE);
+  for (i = 0; i < group->shards_size; i++)
+    {
+      pthread_join (group->shards[i].thread, NULL);
+    }
+
+  lwes_listener_group_free (group);
+
+  return 0;
+}
+
+/*************************************************************************
+  PRIVATE API
+ *************************************************************************/
+int
+lwes_listener_group_shard_open
+  (struct lwes_listener_group_shard *shard,
+   LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   int index,
+   int count)
+{
+  struct timeval timeout;
+  int i;
+
+  shard->listener =
+    lwes_listener_create_shard (address, iface, port,
+                                LWES_LISTENER_GROUP_BATCH_SIZE,
+                                index, count);
+  if (shard->listener == NULL)
+    {
+      return -2;
+    }
+
+  /* so the thread can see when it should stop, even with nothing sent */
+  timeout.tv_sec  = LWES_LISTENER_GROUP_WAIT_MS / 1000;
+  timeout.tv_usec = (LWES_LISTENER_GROUP_WAIT_MS % 1000) * 1000;
+  if (setsockopt (shard->listener->connection.socketfd,
+                  SOL_SOCKET,
+                  SO_RCVTIMEO,
+                  (void*)&timeout,
+                  sizeof(timeout)) < 0)
+    {
+      return -2;
+    }
+
+  shard->events =
+    (struct lwes_event **)
+      malloc (sizeof (struct lwes_event *)*LWES_LISTENER_GROUP_BATCH_SIZE);
+  if (shard->events == NULL)
+    {
+      return -3;
+    }
+  memset (shard->events, 0,
+          sizeof (struct lwes_event *)*LWES_LISTENER_GROUP_BATCH_SIZE);
+
+  for (i = 0; i < LWES_LISTENER_GROUP_BATCH_SIZE; i++)
+    {
+      shard->events[i] = lwes_event_create_no_name (NULL);
+      if (shard->events[i] == NULL)
+        {
+          return -3;
+        }
+    }
+
+  return 0;
+}
+
+/* frees the shards opened so far, whose threads must have stopped */
+void
+lwes_listener_group_free
+  (struct lwes_listener_group *group)
+{
+  struct lwes_listener_group_shard *shard;
+  int i;
+  int j;
+
+  for (i = 0; i < group->shards_size; i++)
+    {
+      shard = &(group->shards[i]);
+      if (shard->events != NULL)
+        {
+          for (j = 0; j < LWES_LISTENER_GROUP_BATCH_SIZE; j++)
+            {
+              if (shard->events[j] != NULL)
+                {
+                  lwes_event_destroy (shard->events[j]);
+                }
+            }
+          free (shard->events);
+        }
+      if (shard->listener != NULL)
+        {
+          lwes_listener_destroy (shard->listener);
+        }
+    }
+
+  free (group->shards);
+  free (group);
+}
+
+void *
+lwes_listener_group_run
+  (void *arg)
+{
+  struct lwes_listener_group_shard *shard =
+    (struct lwes_listener_group_shard *) arg;
+  struct lwes_listener_group *group = shard->group;
+  int n;
+  int i;
+
+  while (__atomic_load_n (&(group->running), __ATOMIC_ACQUIRE))
+    {
+      n = lwes_listener_recv_batch (shard->listener,
+                                    shard->events,
+                                    LWES_LISTENER_GROUP_BATCH_SIZE);
+      if (n < 0)
+        {
+          /* nothing arriving in time is just looped on, anything else is
+             counted and waited out so a failing socket isn't spun on */
+          if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+              __atomic_add_fetch (&(group->errors), 1, __ATOMIC_RELAXED);
+              usleep (LWES_LISTENER_GROUP_WAIT_MS * 1000);
+            }
+          continue;
+        }
+      for (i = 0; i < n; i++)
+        {
+          group->callback (shard->events[i], group->arg);
+        }
+    }
+
+  return NULL;
+}
@@ -0,0 +1,147 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#ifndef __LWES_LISTENER_GROUP_H
+#define __LWES_LISTENER_GROUP_H
+
+#include "lwes_types.h"
+#include "lwes_listener.h"
+#include "lwes_event.h"
+
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lwes_listener_group.h
+ *  \brief Functions for listening to LWES events on many threads
+ */
+
+/*! \brief Called with each event a listener group receives
+ *
+ *  It is called from each of the group's threads, so may be running on
+ *  several at once.  The event belongs to the group and is reused once
+ *  this returns.
+ *
+ *  \param[in] event The event received
+ *  \param[in] arg   The argument the group was created with
+ */
+typedef void (*lwes_listener_group_callback)
+  (struct lwes_event *event,
+   void *arg);
+
+struct lwes_listener_group;
+
+/*! \struct lwes_listener_group_shard lwes_listener_group.h
+ *  \brief One of the listeners of a group, with the thread receiving on it
+ */
+struct lwes_listener_group_shard
+{
+  /*! the group this is part of */
+  struct lwes_listener_group *group;
+  /*! the listener, with its own socket, buffers and deserialize space */
+  struct lwes_listener       *listener;
+  /*! the events received into */
+  struct lwes_event         **events;
+  /*! the thread receiving on the listener */
+  pthread_t                   thread;
+};
+
+/*! \struct lwes_listener_group lwes_listener_group.h
+ *  \brief Listens for LWES events on a socket and thread per shard
+ *
+ *  Each shard has a socket of its own bound to the channel, and the
+ *  events sent to the channel are shared out between them, with all of
+ *  those from one sender going to the same shard.  So receiving and
+ *  deserializing is spread over as many threads as there are shards,
+ *  while the events of any one sender are still handled in order.
+ */
+struct lwes_listener_group
+{
+  /*! the shards */
+  struct lwes_listener_group_shard *shards;
+  /*! number of shards */
+  int                               shards_size;
+  /*! called with each event received */
+  lwes_listener_group_callback      callback;
+  /*! passed to the callback */
+  void                             *arg;
+  /*! whether the threads should keep going */
+  int                               running;
+  /*! number of times receiving failed other than for want of a packet */
+  LWES_U_INT_64                     errors;
+};
+
+/*! \brief Create a Listener Group, and start its threads
+ *
+ *  \param[in] address  The multicast ip address as a dotted quad string
+ *                      of the channel to listen on.
+ *  \param[in] iface    The dotted quad ip address of the interface to
+ *                      receive messages on, can be NULL to use default.
+ *  \param[in] port     The port of the channel to listen on.
+ *  \param[in] threads  The number of shards, each with a thread, 0 for one
+ *                      per processor.
+ *  \param[in] callback Called with each event received.
+ *  \param[in] arg      Passed to the callback.
+ *
+ *  \see lwes_listener_group_destroy
+ *  \see lwes_listener_create_shard
+ *
+ *  \return A newly created listener group, use lwes_listener_group_destroy
+ *          to free
+ */
+struct lwes_listener_group *
+lwes_listener_group_create
+  (LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port,
+   int threads,
+   lwes_listener_group_callback callback,
+   void *arg);
+
+/*! \brief Get the number of times the group failed to receive
+ *
+ *  Waiting for a packet which doesn't come, or being interrupted, is not
+ *  counted.  Any other failure is, and the thread it happened on waits a
+ *  while before it tries again, rather than spinning on a socket which
+ *  keeps failing.
+ *
+ *  \param[in] group The listener group
+ *  \param[out] errors The number of failures
+ *
+ *  \return 0 on success, a negative number on failure
+ */
+int
+lwes_listener_group_get_errors
+  (struct lwes_listener_group *group,
+   LWES_U_INT_64 *errors);
+
+/*! \brief Destroy a Listener Group
+ *
+ *  The threads are stopped, which may take as long as they wait for a
+ *  packet, and the callback is not called once this returns.
+ *
+ * \param[in] group The listener group to destroy by freeing all of it's
+ *                  used memory.
+ *
+ * \return 0 on success, negative number on failure
+ */
+int
+lwes_listener_group_destroy
+  (struct lwes_listener_group *group);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LWES_LISTENER_GROUP_H */
@@ -24,9 +24,7 @@ int marshall_BYTE         (LWES_BYTE         aByte,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 1 )
     {
-      bytes[(*offset)] = aByte;
-      (*offset)++;
-      ret = 1;
+      ret = marshall_BYTE_unchecked (aByte, bytes, offset);
     }
   return ret;
 }
@@ -39,10 +37,7 @@ int marshall_U_INT_16     (LWES_U_INT_16     anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 2 )
     {
-      bytes[(*offset)]   = (LWES_BYTE)( (anInt & (255 << 8)) >> 8);
-      bytes[(*offset)+1] = (LWES_BYTE)( (anInt & (255)) );
-      (*offset) += 2;
-      ret = 2;
+      ret = marshall_U_INT_16_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -55,10 +50,7 @@ int marshall_INT_16       (LWES_INT_16       anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 2 )
     {
-      bytes[(*offset)]   = (LWES_BYTE)( (anInt & (255 << 8)) >> 8);
-      bytes[(*offset)+1] = (LWES_BYTE)( (anInt & (255)) );
-      (*offset) += 2;
-      ret = 2;
+      ret = marshall_INT_16_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -71,12 +63,7 @@ int marshall_U_INT_32     (LWES_U_INT_32     anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 4 )
     {
-      bytes[(*offset)]   = (LWES_BYTE) ( (anInt & (255 << 24)) >> 24);
-      bytes[(*offset)+1] = (LWES_BYTE) ( (anInt & (255 << 16)) >> 16);
-      bytes[(*offset)+2] = (LWES_BYTE) ( (anInt & (255 <<  8)) >>  8);
-      bytes[(*offset)+3] = (LWES_BYTE) ( (anInt & (255)));
-      (*offset) += 4;
-      ret = 4;
+      ret = marshall_U_INT_32_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -89,12 +76,7 @@ int marshall_INT_32       (LWES_INT_32       anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 4 )
     {
-      bytes[(*offset)]   = (LWES_BYTE) ( (anInt & (255 << 24)) >> 24);
-      bytes[(*offset)+1] = (LWES_BYTE) ( (anInt & (255 << 16)) >> 16);
-      bytes[(*offset)+2] = (LWES_BYTE) ( (anInt & (255 <<  8)) >>  8);
-      bytes[(*offset)+3] = (LWES_BYTE) ( (anInt & (255)));
-      (*offset) += 4;
-      ret = 4;
+      ret = marshall_INT_32_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -107,16 +89,7 @@ int marshall_U_INT_64     (LWES_U_INT_64     anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 8 )
     {
-      bytes[(*offset)  ] = (LWES_BYTE) ( (anInt & (0xffULL << 56)) >> 56);
-      bytes[(*offset)+1] = (LWES_BYTE) ( (anInt & (0xffULL << 48)) >> 48);
-      bytes[(*offset)+2] = (LWES_BYTE) ( (anInt & (0xffULL << 40)) >> 40);
-      bytes[(*offset)+3] = (LWES_BYTE) ( (anInt & (0xffULL << 32)) >> 32);
-      bytes[(*offset)+4] = (LWES_BYTE) ( (anInt & (0xffULL << 24)) >> 24);
-      bytes[(*offset)+5] = (LWES_BYTE) ( (anInt & (0xffULL << 16)) >> 16);
-      bytes[(*offset)+6] = (LWES_BYTE) ( (anInt & (0xffULL <<  8)) >>  8);
-      bytes[(*offset)+7] = (LWES_BYTE) ( (anInt & (0xffULL <<  0)) >>  0);
-      (*offset) += 8;
-      ret = 8;
+      ret = marshall_U_INT_64_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -129,16 +102,7 @@ int marshall_INT_64       (LWES_INT_64       anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 8 )
     {
-      bytes[(*offset)  ] = (LWES_BYTE) ( (anInt & (0xffULL << 56)) >> 56);
-      bytes[(*offset)+1] = (LWES_BYTE) ( (anInt & (0xffULL << 48)) >> 48);
-      bytes[(*offset)+2] = (LWES_BYTE) ( (anInt & (0xffULL << 40)) >> 40);
-      bytes[(*offset)+3] = (LWES_BYTE) ( (anInt & (0xffULL << 32)) >> 32);
-      bytes[(*offset)+4] = (LWES_BYTE) ( (anInt & (0xffULL << 24)) >> 24);
-      bytes[(*offset)+5] = (LWES_BYTE) ( (anInt & (0xffULL << 16)) >> 16);
-      bytes[(*offset)+6] = (LWES_BYTE) ( (anInt & (0xffULL <<  8)) >>  8);
-      bytes[(*offset)+7] = (LWES_BYTE) ( (anInt & (0xffULL <<  0)) >>  0);
-      (*offset) += 8;
-      ret = 8;
+      ret = marshall_INT_64_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -151,9 +115,7 @@ int marshall_BOOLEAN      (LWES_BOOLEAN      aBoolean,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 1 )
     {
-      bytes[(*offset)] = aBoolean;
-      (*offset)++;
-      ret = 1;
+      ret = marshall_BOOLEAN_unchecked (aBoolean, bytes, offset);
     }
   return ret;
 }
@@ -166,16 +128,7 @@ int marshall_IP_ADDR      (LWES_IP_ADDR      ipAddress,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 4 )
     {
-      bytes[(*offset)+3]=
-        (LWES_BYTE) ( (htonl(ipAddress.s_addr) & (255 << 24)) >> 24);
-      bytes[(*offset)+2]=
-        (LWES_BYTE) ( (htonl(ipAddress.s_addr) & (255 << 16)) >> 16);
-      bytes[(*offset)+1]=
-        (LWES_BYTE) ( (htonl(ipAddress.s_addr) & (255 <<  8)) >>  8);
-      bytes[(*offset)  ]=
-        (LWES_BYTE) ( (htonl(ipAddress.s_addr) & (255)));
-      (*offset) += 4;
-      ret = 4;
+      ret = marshall_IP_ADDR_unchecked (ipAddress, bytes, offset);
     }
   return ret;
 }
@@ -236,9 +189,7 @@ int marshall_LONG_STRING  (LWES_LONG_STRING  aString,
        && str_length < 65535
        && (length-(*offset)) >= (str_length+2) )
     {
-      bytes[(*offset)]   = (LWES_BYTE)( (str_length & (255 << 8)) >> 8);
-      bytes[(*offset)+1] = (LWES_BYTE)( (str_length & (255)) );
-      (*offset)+=2;
+      marshall_U_INT_16_unchecked ((LWES_U_INT_16)str_length, bytes, offset);
       tmp_ptr = &(bytes[(*offset)]);
       memcpy(tmp_ptr, aString, str_length);
       (*offset) += str_length;
@@ -255,9 +206,7 @@ int unmarshall_BYTE         (LWES_BYTE *aByte,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 1 )
     {
-      *aByte = bytes[(*offset)];
-      (*offset)++;
-      ret = 1;
+      ret = unmarshall_BYTE_unchecked (aByte, bytes, offset);
     }
   return ret;
 }
@@ -270,10 +219,7 @@ int unmarshall_U_INT_16     (LWES_U_INT_16 *anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 2 )
     {
-      *anInt = (LWES_U_INT_16)( ( ( bytes[(*offset)  ] << 8 ) & (255 << 8 ))
-                              | ( ( bytes[(*offset)+1] << 0 ) & (255)) );
-      (*offset) += 2;
-      ret = 2;
+      ret = unmarshall_U_INT_16_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -286,10 +232,7 @@ int unmarshall_INT_16       (LWES_INT_16 *anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 2 )
     {
-      *anInt = (LWES_INT_16)( ( ( bytes[(*offset)  ] << 8 ) & (255 << 8 ))
-                            | ( ( bytes[(*offset)+1] << 0 ) & (255)) );
-      (*offset) += 2;
-      ret = 2;
+      ret = unmarshall_INT_16_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -302,12 +245,7 @@ int unmarshall_U_INT_32     (LWES_U_INT_32 *anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 4 )
     {
-      *anInt = (LWES_U_INT_32)( ( (bytes[(*offset)  ] << 24) & (255 << 24))
-                              | ( (bytes[(*offset)+1] << 16) & (255 << 16))
-                              | ( (bytes[(*offset)+2] << 8 ) & (255 <<  8))
-                              | ( (bytes[(*offset)+3] << 0 ) & (255)) );
-      (*offset) += 4;
-      ret = 4;
+      ret = unmarshall_U_INT_32_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -320,12 +258,7 @@ int unmarshall_INT_32       (LWES_INT_32 *anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 4 )
     {
-      *anInt = (LWES_INT_32)( ( (bytes[(*offset)  ] << 24) & (255 << 24))
-                            | ( (bytes[(*offset)+1] << 16) & (255 << 16))
-                            | ( (bytes[(*offset)+2] << 8 ) & (255 <<  8))
-                            | ( (bytes[(*offset)+3] << 0 ) & (255)) );
-      (*offset) += 4;
-      ret = 4;
+      ret = unmarshall_INT_32_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -338,17 +271,7 @@ int unmarshall_U_INT_64     (LWES_U_INT_64 *anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 8 )
     {
-      *anInt = (LWES_U_INT_64)
-          ( ( ((LWES_U_INT_64)bytes[(*offset)  ] << 56) & (0xffULL << 56))
-          | ( ((LWES_U_INT_64)bytes[(*offset)+1] << 48) & (0xffULL << 48))
-          | ( ((LWES_U_INT_64)bytes[(*offset)+2] << 40) & (0xffULL << 40))
-          | ( ((LWES_U_INT_64)bytes[(*offset)+3] << 32) & (0xffULL << 32))
-          | ( ((LWES_U_INT_64)bytes[(*offset)+4] << 24) & (0xffULL << 24))
-          | ( ((LWES_U_INT_64)bytes[(*offset)+5] << 16) & (0xffULL << 16))
-          | ( ((LWES_U_INT_64)bytes[(*offset)+6] << 8 ) & (0xffULL <<  8))
-          | ( ((LWES_U_INT_64)bytes[(*offset)+7] << 0 ) & (0xffULL <<  0)));
-      (*offset) += 8;
-      ret = 8;
+      ret = unmarshall_U_INT_64_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -361,17 +284,7 @@ int unmarshall_INT_64       (LWES_INT_64 *anInt,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 8 )
     {
-      *anInt = (LWES_INT_64)
-          ( ( ((LWES_INT_64)bytes[(*offset)  ] << 56) & (0xffULL << 56))
-          | ( ((LWES_INT_64)bytes[(*offset)+1] << 48) & (0xffULL << 48))
-          | ( ((LWES_INT_64)bytes[(*offset)+2] << 40) & (0xffULL << 40))
-          | ( ((LWES_INT_64)bytes[(*offset)+3] << 32) & (0xffULL << 32))
-          | ( ((LWES_INT_64)bytes[(*offset)+4] << 24) & (0xffULL << 24))
-          | ( ((LWES_INT_64)bytes[(*offset)+5] << 16) & (0xffULL << 16))
-          | ( ((LWES_INT_64)bytes[(*offset)+6] << 8 ) & (0xffULL <<  8))
-          | ( ((LWES_INT_64)bytes[(*offset)+7] << 0 ) & (0xffULL <<  0)));
-      (*offset) += 8;
-      ret = 8;
+      ret = unmarshall_INT_64_unchecked (anInt, bytes, offset);
     }
   return ret;
 }
@@ -384,9 +297,7 @@ int unmarshall_BOOLEAN      (LWES_BOOLEAN *aBoolean,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 1 )
     {
-      *aBoolean = bytes[(*offset)];
-      (*offset)++;
-      ret = 1;
+      ret = unmarshall_BOOLEAN_unchecked (aBoolean, bytes, offset);
     }
   return ret;
 }
@@ -399,13 +310,7 @@ int unmarshall_IP_ADDR      (LWES_IP_ADDR *ipAddress,
   int ret = 0;
   if ( bytes != NULL && (length-(*offset)) >= 4 )
     {
-      ipAddress->s_addr = 
-                    ntohl( ( ( bytes[(*offset)+3] << 24 ) & (255 << 24))
-                         | ( ( bytes[(*offset)+2] << 16 ) & (255 << 16))
-                         | ( ( bytes[(*offset)+1] <<  8 ) & (255 <<  8))
-                         | ( ( bytes[(*offset)  ] <<  0 ) & (255)));
-      (*offset) += 4;
-      ret = 4;
+      ret = unmarshall_IP_ADDR_unchecked (ipAddress, bytes, offset);
     }
   return ret;
 }
@@ -466,6 +371,7 @@ int unmarshall_LONG_STRING  (LWES_LONG_STRING aString,
                              size_t *offset)
 {
   int ret = 0;
+  LWES_U_INT_16 length_prefix;
   size_t string_length;
   size_t data_length;
 
@@ -473,10 +379,8 @@ int unmarshall_LONG_STRING  (LWES_LONG_STRING aString,
   /* check for 2 bytes of length */
   if ( bytes != NULL && (length-(*offset)) >= 2)
     {
-      string_length = (LWES_U_INT_16)
-        ( ( ( bytes[(*offset)  ] << 8 ) & (255 << 8))
-        | ( ( bytes[(*offset)+1] << 0 ) & (255)) );
-      (*offset)+=2;
+      unmarshall_U_INT_16_unchecked (&length_prefix, bytes, offset);
+      string_length = length_prefix;
 
       /* keep track of actual number of bytes in case we truncate */
       data_length = string_length;
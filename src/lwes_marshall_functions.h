@@ -15,6 +15,7 @@
 
 #include <ctype.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "lwes_types.h"
 
@@ -588,6 +589,403 @@ unmarshall_LONG_STRING
    size_t           length,
    size_t *         offset);
 
+/* The unchecked versions below are for callers which have already made
+ * sure that there is room for the value, such as when it is being
+ * written over one of the same type.  They copy a value in whole and swap
+ * its bytes where the host order differs, rather than going a byte at a
+ * time, and are inlined so the checked versions and their callers can
+ * share them. */
+
+#if defined(__GNUC__)
+#define LWES_INLINE static __inline__
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define LWES_INLINE static inline
+#else
+#define LWES_INLINE static
+#endif
+
+/* integers are serialized big endian and ip addresses little endian,
+ * these turn a value of the host into either order and back again, and
+ * are left undefined when the order of the host isn't known */
+#if (defined(__clang__) \
+     || (defined(__GNUC__) \
+         && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8)))) \
+    && defined(__BYTE_ORDER__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LWES_BIG_ENDIAN_16(x)    __builtin_bswap16 (x)
+#define LWES_BIG_ENDIAN_32(x)    __builtin_bswap32 (x)
+#define LWES_BIG_ENDIAN_64(x)    __builtin_bswap64 (x)
+#define LWES_LITTLE_ENDIAN_32(x) (x)
+#elif __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define LWES_BIG_ENDIAN_16(x)    (x)
+#define LWES_BIG_ENDIAN_32(x)    (x)
+#define LWES_BIG_ENDIAN_64(x)    (x)
+#define LWES_LITTLE_ENDIAN_32(x) __builtin_bswap32 (x)
+#endif
+#endif
+
+/*! \brief Marshall a byte into a byte array which has room for it
+ *
+ *  \see marshall_BYTE
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_BYTE_unchecked
+  (LWES_BYTE         aByte,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  bytes[(*offset)] = aByte;
+  (*offset)++;
+  return 1;
+}
+
+/*! \brief Marshall a 16 bit unsigned int into a byte array which has room
+ *         for it
+ *
+ *  \see marshall_U_INT_16
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_U_INT_16_unchecked
+  (LWES_U_INT_16     anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+#ifdef LWES_BIG_ENDIAN_16
+  anInt = LWES_BIG_ENDIAN_16 (anInt);
+  memcpy (&(bytes[(*offset)]), &anInt, 2);
+#else
+  bytes[(*offset)]   = (LWES_BYTE)(anInt >> 8);
+  bytes[(*offset)+1] = (LWES_BYTE)(anInt);
+#endif
+  (*offset) += 2;
+  return 2;
+}
+
+/*! \brief Marshall a 16 bit int into a byte array which has room for it
+ *
+ *  \see marshall_INT_16
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_INT_16_unchecked
+  (LWES_INT_16       anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  return marshall_U_INT_16_unchecked ((LWES_U_INT_16)anInt, bytes, offset);
+}
+
+/*! \brief Marshall a 32 bit unsigned int into a byte array which has room
+ *         for it
+ *
+ *  \see marshall_U_INT_32
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_U_INT_32_unchecked
+  (LWES_U_INT_32     anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+#ifdef LWES_BIG_ENDIAN_32
+  anInt = LWES_BIG_ENDIAN_32 (anInt);
+  memcpy (&(bytes[(*offset)]), &anInt, 4);
+#else
+  bytes[(*offset)]   = (LWES_BYTE)(anInt >> 24);
+  bytes[(*offset)+1] = (LWES_BYTE)(anInt >> 16);
+  bytes[(*offset)+2] = (LWES_BYTE)(anInt >>  8);
+  bytes[(*offset)+3] = (LWES_BYTE)(anInt);
+#endif
+  (*offset) += 4;
+  return 4;
+}
+
+/*! \brief Marshall a 32 bit int into a byte array which has room for it
+ *
+ *  \see marshall_INT_32
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_INT_32_unchecked
+  (LWES_INT_32       anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  return marshall_U_INT_32_unchecked ((LWES_U_INT_32)anInt, bytes, offset);
+}
+
+/*! \brief Marshall a 64 bit unsigned int into a byte array which has room
+ *         for it
+ *
+ *  \see marshall_U_INT_64
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_U_INT_64_unchecked
+  (LWES_U_INT_64     anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+#ifdef LWES_BIG_ENDIAN_64
+  anInt = LWES_BIG_ENDIAN_64 (anInt);
+  memcpy (&(bytes[(*offset)]), &anInt, 8);
+  (*offset) += 8;
+#else
+  marshall_U_INT_32_unchecked ((LWES_U_INT_32)(anInt >> 32), bytes, offset);
+  marshall_U_INT_32_unchecked ((LWES_U_INT_32)(anInt), bytes, offset);
+#endif
+  return 8;
+}
+
+/*! \brief Marshall a 64 bit int into a byte array which has room for it
+ *
+ *  \see marshall_INT_64
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_INT_64_unchecked
+  (LWES_INT_64       anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  return marshall_U_INT_64_unchecked ((LWES_U_INT_64)anInt, bytes, offset);
+}
+
+/*! \brief Marshall a boolean into a byte array which has room for it
+ *
+ *  \see marshall_BOOLEAN
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_BOOLEAN_unchecked
+  (LWES_BOOLEAN      aBoolean,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  bytes[(*offset)] = (LWES_BYTE)aBoolean;
+  (*offset)++;
+  return 1;
+}
+
+/*! \brief Marshall an ip address into a byte array which has room for it
+ *
+ *  \see marshall_IP_ADDR
+ *  \return the number of bytes written
+ */
+LWES_INLINE int
+marshall_IP_ADDR_unchecked
+  (LWES_IP_ADDR      ipAddress,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  LWES_U_INT_32 address = htonl (ipAddress.s_addr);
+
+#ifdef LWES_LITTLE_ENDIAN_32
+  address = LWES_LITTLE_ENDIAN_32 (address);
+  memcpy (&(bytes[(*offset)]), &address, 4);
+#else
+  bytes[(*offset)+3] = (LWES_BYTE)(address >> 24);
+  bytes[(*offset)+2] = (LWES_BYTE)(address >> 16);
+  bytes[(*offset)+1] = (LWES_BYTE)(address >>  8);
+  bytes[(*offset)]   = (LWES_BYTE)(address);
+#endif
+  (*offset) += 4;
+  return 4;
+}
+
+/*! \brief Unmarshall a byte from a byte array which holds it
+ *
+ *  \see unmarshall_BYTE
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_BYTE_unchecked
+  (LWES_BYTE         *aByte,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  *aByte = bytes[(*offset)];
+  (*offset)++;
+  return 1;
+}
+
+/*! \brief Unmarshall a 16 bit unsigned int from a byte array which holds it
+ *
+ *  \see unmarshall_U_INT_16
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_U_INT_16_unchecked
+  (LWES_U_INT_16     *anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+#ifdef LWES_BIG_ENDIAN_16
+  LWES_U_INT_16 value;
+
+  memcpy (&value, &(bytes[(*offset)]), 2);
+  *anInt = LWES_BIG_ENDIAN_16 (value);
+#else
+  *anInt = (LWES_U_INT_16)(((unsigned int)bytes[(*offset)] << 8)
+                           | bytes[(*offset)+1]);
+#endif
+  (*offset) += 2;
+  return 2;
+}
+
+/*! \brief Unmarshall a 16 bit int from a byte array which holds it
+ *
+ *  \see unmarshall_INT_16
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_INT_16_unchecked
+  (LWES_INT_16       *anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  LWES_U_INT_16 value;
+
+  unmarshall_U_INT_16_unchecked (&value, bytes, offset);
+  *anInt = (LWES_INT_16)value;
+  return 2;
+}
+
+/*! \brief Unmarshall a 32 bit unsigned int from a byte array which holds it
+ *
+ *  \see unmarshall_U_INT_32
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_U_INT_32_unchecked
+  (LWES_U_INT_32     *anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+#ifdef LWES_BIG_ENDIAN_32
+  LWES_U_INT_32 value;
+
+  memcpy (&value, &(bytes[(*offset)]), 4);
+  *anInt = LWES_BIG_ENDIAN_32 (value);
+#else
+  *anInt = ((LWES_U_INT_32)bytes[(*offset)]   << 24)
+         | ((LWES_U_INT_32)bytes[(*offset)+1] << 16)
+         | ((LWES_U_INT_32)bytes[(*offset)+2] <<  8)
+         | ((LWES_U_INT_32)bytes[(*offset)+3]);
+#endif
+  (*offset) += 4;
+  return 4;
+}
+
+/*! \brief Unmarshall a 32 bit int from a byte array which holds it
+ *
+ *  \see unmarshall_INT_32
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_INT_32_unchecked
+  (LWES_INT_32       *anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  LWES_U_INT_32 value;
+
+  unmarshall_U_INT_32_unchecked (&value, bytes, offset);
+  *anInt = (LWES_INT_32)value;
+  return 4;
+}
+
+/*! \brief Unmarshall a 64 bit unsigned int from a byte array which holds it
+ *
+ *  \see unmarshall_U_INT_64
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_U_INT_64_unchecked
+  (LWES_U_INT_64     *anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+#ifdef LWES_BIG_ENDIAN_64
+  LWES_U_INT_64 value;
+
+  memcpy (&value, &(bytes[(*offset)]), 8);
+  *anInt = LWES_BIG_ENDIAN_64 (value);
+  (*offset) += 8;
+#else
+  LWES_U_INT_32 high;
+  LWES_U_INT_32 low;
+
+  unmarshall_U_INT_32_unchecked (&high, bytes, offset);
+  unmarshall_U_INT_32_unchecked (&low, bytes, offset);
+  *anInt = ((LWES_U_INT_64)high << 32) | low;
+#endif
+  return 8;
+}
+
+/*! \brief Unmarshall a 64 bit int from a byte array which holds it
+ *
+ *  \see unmarshall_INT_64
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_INT_64_unchecked
+  (LWES_INT_64       *anInt,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  LWES_U_INT_64 value;
+
+  unmarshall_U_INT_64_unchecked (&value, bytes, offset);
+  *anInt = (LWES_INT_64)value;
+  return 8;
+}
+
+/*! \brief Unmarshall a boolean from a byte array which holds it
+ *
+ *  \see unmarshall_BOOLEAN
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_BOOLEAN_unchecked
+  (LWES_BOOLEAN      *aBoolean,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  *aBoolean = (LWES_BOOLEAN)bytes[(*offset)];
+  (*offset)++;
+  return 1;
+}
+
+/*! \brief Unmarshall an ip address from a byte array which holds it
+ *
+ *  \see unmarshall_IP_ADDR
+ *  \return the number of bytes consumed
+ */
+LWES_INLINE int
+unmarshall_IP_ADDR_unchecked
+  (LWES_IP_ADDR      *ipAddress,
+   LWES_BYTE_P       bytes,
+   size_t            *offset)
+{
+  LWES_U_INT_32 address;
+
+#ifdef LWES_LITTLE_ENDIAN_32
+  memcpy (&address, &(bytes[(*offset)]), 4);
+  address = LWES_LITTLE_ENDIAN_32 (address);
+#else
+  address = ((LWES_U_INT_32)bytes[(*offset)+3] << 24)
+          | ((LWES_U_INT_32)bytes[(*offset)+2] << 16)
+          | ((LWES_U_INT_32)bytes[(*offset)+1] <<  8)
+          | ((LWES_U_INT_32)bytes[(*offset)]);
+#endif
+  ipAddress->s_addr = ntohl (address);
+  (*offset) += 4;
+  return 4;
+}
+
 #ifdef __cplusplus
 }
 #endif 
@@ -0,0 +1,350 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include "lwes_multi_listener.h"
+#include "lwes_listener.h"
+#include "lwes_time_functions.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef HAVE_SYS_EPOLL_H
+# include <sys/epoll.h>
+typedef struct epoll_event lwes_multi_listener_waiting;
+#else
+# include <poll.h>
+typedef struct pollfd lwes_multi_listener_waiting;
+#endif
+
+/*************************************************************************
+  PRIVATE API prototypes, shouldn't be called by a user of the library.
+ *************************************************************************/
+void
+lwes_multi_listener_free
+  (struct lwes_multi_listener *listener);
+
+int
+lwes_multi_listener_wait
+  (struct lwes_multi_listener *listener,
+   int timeout_ms);
+
+int
+lwes_multi_listener_recv_within
+  (struct lwes_multi_listener *listener,
+   struct lwes_event **events,
+   int *channels,
+   int n,
+   int timeout_ms);
+
+/*************************************************************************
+  PUBLIC API
+ *************************************************************************/
+struct lwes_multi_listener *
+lwes_multi_listener_create
+  (int max_channels)
+{
+  struct lwes_multi_listener *listener;
+
+  if (max_channels <= 0)
+    {
+      return NULL;
+    }
+
+  listener = (struct lwes_multi_listener *)
+    malloc (sizeof (struct lwes_multi_listener));
+  if (listener == NULL)
+    {
+      return NULL;
+    }
+  memset (listener, 0, sizeof (struct lwes_multi_listener));
+  listener->channels_max = max_channels;
+  listener->epollfd      = -1;
+
+  listener->channels =
+    (struct lwes_net_connection *)
+      malloc (sizeof (struct lwes_net_connection)*max_channels);
+  listener->ready =
+    (listener->channels == NULL) ? NULL :
+      (int *) malloc (sizeof (int)*max_channels);
+  listener->waiting =
+    (listener->ready == NULL) ? NULL :
+      malloc (sizeof (lwes_multi_listener_waiting)*max_channels);
+
+  /* the buffer and deserialize space are shared by every channel */
+  listener->buffer =
+    (listener->waiting == NULL) ? NULL :
+      (LWES_BYTE_P) malloc (sizeof (LWES_BYTE)*MAX_MSG_SIZE);
+  listener->dtmp =
+    (listener->buffer == NULL) ? NULL :
+      (struct lwes_event_deserialize_tmp *)
+        malloc (sizeof (struct lwes_event_deserialize_tmp));
+  if (listener->dtmp == NULL)
+    {
+      lwes_multi_listener_free (listener);
+      return NULL;
+    }
+
+#ifdef HAVE_SYS_EPOLL_H
+  listener->epollfd = epoll_create (max_channels);
+  if (listener->epollfd < 0)
+    {
+      lwes_multi_listener_free (listener);
+      return NULL;
+    }
+#endif
+
+  return listener;
+}
+
+int
+lwes_multi_listener_add
+  (struct lwes_multi_listener *listener,
+   LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port)
+{
+  struct lwes_net_connection *connection;
+  lwes_multi_listener_waiting *waiting;
+  int channel;
+
+  if (listener == NULL || address == NULL)
+    {
+      return -1;
+    }
+
+  if (listener->channels_size >= listener->channels_max)
+    {
+      return -2;
+    }
+
+  channel    = listener->channels_size;
+  connection = &(listener->channels[channel]);
+  waiting    =
+    &(((lwes_multi_listener_waiting *) listener->waiting)[channel]);
+
+  if (lwes_net_open (connection, address, iface, port) != 0)
+    {
+      return -3;
+    }
+  if (lwes_net_recv_bind (connection) != 0)
+    {
+      lwes_net_close (connection);
+      return -3;
+    }
+
+#ifdef HAVE_SYS_EPOLL_H
+  /* the channel comes back from epoll with the event */
+  memset (waiting, 0, sizeof (lwes_multi_listener_waiting));
+  waiting->events   = EPOLLIN;
+  waiting->data.u32 = (uint32_t) channel;
+  if (epoll_ctl (listener->epollfd, EPOLL_CTL_ADD,
+                 connection->socketfd, waiting) < 0)
+    {
+      lwes_net_close (connection);
+      return -4;
+    }
+#else
+  /* the channel is where the socket is in the array given to poll */
+  waiting->fd      = connection->socketfd;
+  waiting->events  = POLLIN;
+  waiting->revents = 0;
+#endif
+
+  listener->channels_size++;
+
+  return channel;
+}
+
+int
+lwes_multi_listener_recv
+  (struct lwes_multi_listener *listener,
+   struct lwes_event **events,
+   int *channels,
+   int n)
+{
+  return lwes_multi_listener_recv_within (listener, events, channels, n, -1);
+}
+
+int
+lwes_multi_listener_recv_by
+  (struct lwes_multi_listener *listener,
+   struct lwes_event **events,
+   int *channels,
+   int n,
+   unsigned int timeout_ms)
+{
+  return lwes_multi_listener_recv_within (listener, events, channels, n,
+                                          (timeout_ms > INT_MAX)
+                                            ? INT_MAX : (int) timeout_ms);
+}
+
+int
+lwes_multi_listener_destroy
+  (struct lwes_multi_listener *listener)
+{
+  int ret = 0;
+  int i;
+
+  if (listener == NULL)
+    {
+      return 0;
+    }
+
+  for (i = 0; i < listener->channels_size; i++)
+    {
+      if (lwes_net_close (&(listener->channels[i])) < 0)
+        {
+          ret = -2;
+        }
+    }
+
+  lwes_multi_listener_free (listener);
+
+  return ret;
+}
+
+/*************************************************************************
+  PRIVATE API
+ *************************************************************************/
+void
+lwes_multi_listener_free
+  (struct lwes_multi_listener *listener)
+{
+  if (listener->epollfd >= 0)
+    close (listener->epollfd);
+  if (listener->dtmp != NULL)
+    free (listener->dtmp);
+  if (listener->buffer != NULL)
+    free (listener->buffer);
+  if (listener->waiting != NULL)
+    free (listener->waiting);
+  if (listener->ready != NULL)
+    free (listener->ready);
+  if (listener->channels != NULL)
+    free (listener->channels);
+  free (listener);
+}
+
+/* wait for any of the channels to have a packet, up to timeout_ms or for
+   ever if it is negative, and put those which do in ready */
+int
+lwes_multi_listener_wait
+  (struct lwes_multi_listener *listener,
+   int timeout_ms)
+{
+  lwes_multi_listener_waiting *waiting =
+    (lwes_multi_listener_waiting *) listener->waiting;
+  int ret;
+  int i;
+
+#ifdef HAVE_SYS_EPOLL_H
+  ret = epoll_wait (listener->epollfd, waiting,
+                    listener->channels_size, timeout_ms);
+  for (i = 0; i < ret; i++)
+    {
+      listener->ready[i] = (int) waiting[i].data.u32;
+    }
+#else
+  ret = poll (waiting, listener->channels_size, timeout_ms);
+  if (ret > 0)
+    {
+      ret = 0;
+      for (i = 0; i < listener->channels_size; i++)
+        {
+          if (waiting[i].revents != 0)
+            {
+              listener->ready[ret++] = i;
+            }
+        }
+    }
+#endif
+
+  return ret;
+}
+
+int
+lwes_multi_listener_recv_within
+  (struct lwes_multi_listener *listener,
+   struct lwes_event **events,
+   int *channels,
+   int n,
+   int timeout_ms)
+{
+  struct lwes_net_connection *connection;
+  LWES_INT_64 receipt_time;
+  size_t len;
+  int ready;
+  int channel;
+  int filled = 0;
+  int ret;
+  int i;
+
+  if (listener == NULL || events == NULL || channels == NULL || n <= 0
+      || listener->channels_size == 0)
+    {
+      return -1;
+    }
+
+  if ((ready = lwes_multi_listener_wait (listener, timeout_ms)) <= 0)
+    {
+      return -2;
+    }
+
+  /* they all arrived at once */
+  receipt_time = currentTimeMillisLongLong ();
+
+  /* take a packet from each of the ready channels in turn, dropping each
+     from the turns once it has no more */
+  while (filled < n && ready > 0)
+    {
+      for (i = 0; i < ready && filled < n; )
+        {
+          channel    = listener->ready[i];
+          connection = &(listener->channels[channel]);
+          ret = lwes_net_recv_bytes_nowait (connection,
+                                            listener->buffer,
+                                            MAX_MSG_SIZE);
+          if (ret < 0)
+            {
+              listener->ready[i] = listener->ready[--ready];
+              continue;
+            }
+          i++;
+
+          len = ret;
+          if (lwes_listener_add_header_fields_from
+                (listener->dtmp,
+                 &(connection->sender_ip_addr),
+                 receipt_time,
+                 listener->buffer,
+                 MAX_MSG_SIZE,
+                 &len) < 0
+              || lwes_event_reset (events[filled]) < 0
+              || lwes_event_from_bytes (events[filled],
+                                        listener->buffer,
+                                        len,
+                                        0,
+                                        listener->dtmp) < 0)
+            {
+              continue;
+            }
+          channels[filled] = channel;
+          filled++;
+        }
+    }
+
+  return filled;
+}
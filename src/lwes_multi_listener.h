@@ -0,0 +1,149 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#ifndef __LWES_MULTI_LISTENER_H
+#define __LWES_MULTI_LISTENER_H
+
+#include "lwes_types.h"
+#include "lwes_net_functions.h"
+#include "lwes_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lwes_multi_listener.h
+ *  \brief Functions for listening to LWES events on many channels at once
+ */
+
+/*! \struct lwes_multi_listener lwes_multi_listener.h
+ *  \brief Listens for LWES events on many channels from one thread
+ *
+ *  All of the channels are waited on at once, with epoll where the system
+ *  has it and poll where it doesn't, and share one buffer and one space
+ *  for deserializing, rather than each having a listener of its own.
+ */
+struct lwes_multi_listener
+{
+  /*! the channels listened on */
+  struct lwes_net_connection *channels;
+  /*! number of channels added */
+  int channels_size;
+  /*! most channels which can be added */
+  int channels_max;
+  /*! the channels which were ready after the last wait */
+  int *ready;
+  /*! what the channels are waited on with, epoll or poll's structures */
+  void *waiting;
+  /*! the epoll instance, -1 where poll is used */
+  int epollfd;
+  /*! this is some temporary space for deserializing strings */
+  struct lwes_event_deserialize_tmp *dtmp;
+  /*! this is a temporary buffer for the packet from the socket */
+  LWES_BYTE_P buffer;
+};
+
+/*! \brief Create a Multi Listener, listening on no channels yet
+ *
+ *  \param[in] max_channels The most channels which can be added.
+ *
+ *  \see lwes_multi_listener_add
+ *  \see lwes_multi_listener_destroy
+ *
+ *  \return A newly created listener, use lwes_multi_listener_destroy to
+ *          free
+ */
+struct lwes_multi_listener *
+lwes_multi_listener_create
+  (int max_channels);
+
+/*! \brief Add a channel to listen on
+ *
+ *  \param[in] listener The listener to add the channel to
+ *  \param[in] address  The multicast ip address as a dotted quad string
+ *                      of the channel to listen on.
+ *  \param[in] iface    The dotted quad ip address of the interface to
+ *                      receive messages on, can be NULL to use default.
+ *  \param[in] port     The port of the channel to listen on.
+ *
+ *  \return the number of the channel, counting from 0 in the order they
+ *          were added, which received events are tagged with, or a
+ *          negative number on failure, -2 if there is no room for another
+ */
+int
+lwes_multi_listener_add
+  (struct lwes_multi_listener *listener,
+   LWES_SHORT_STRING address,
+   LWES_SHORT_STRING iface,
+   LWES_U_INT_32 port);
+
+/*! \brief Receive many events from any of the channels in a blocking manner
+ *
+ *  This waits once for any of the channels to have a packet, then takes
+ *  one packet at a time from each of those which do, in turn, until there
+ *  are no more or the events are filled, so no one channel can keep the
+ *  others out.  Header fields are added to each packet and they are
+ *  deserialized into the events, which are reset first.  Packets which
+ *  can't be deserialized are skipped.
+ *
+ *  \param[in] listener the listener to receive the events from
+ *  \param[out] events the events to fill out
+ *  \param[out] channels the channel each event was received on
+ *  \param[in] n the number of events and channels
+ *
+ *  \return the number of events filled out on success, a negative number on
+ *          failure
+ */
+int
+lwes_multi_listener_recv
+  (struct lwes_multi_listener *listener,
+   struct lwes_event **events,
+   int *channels,
+   int n);
+
+/*! \brief Receive many events from any of the channels with a timeout
+ *
+ *  As lwes_multi_listener_recv, waiting no longer than the timeout.
+ *
+ *  \param[in] listener the listener to receive the events from
+ *  \param[out] events the events to fill out
+ *  \param[out] channels the channel each event was received on
+ *  \param[in] n the number of events and channels
+ *  \param[in] timeout_ms the maximum amount of time to wait for an event
+ *
+ *  \return the number of events filled out on success, a negative number on
+ *          failure, which is -2 if nothing arrived in time
+ */
+int
+lwes_multi_listener_recv_by
+  (struct lwes_multi_listener *listener,
+   struct lwes_event **events,
+   int *channels,
+   int n,
+   unsigned int timeout_ms);
+
+/*! \brief Destroy a Multi Listener, closing all of its channels
+ *
+ * \param[in] listener The listener to destroy by freeing all of it's used
+ *                     memory.
+ *
+ * \return 0 on success, negative number on failure
+ */
+int
+lwes_multi_listener_destroy
+  (struct lwes_multi_listener *listener);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LWES_MULTI_LISTENER_H */
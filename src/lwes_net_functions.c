@@ -10,12 +10,30 @@
  * limitations under the License. See accompanying LICENSE file.        *
  *======================================================================*/
 
+/* for sendmmsg and recvmmsg, which have to be asked for before any system
+   header */
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
 #include "lwes_net_functions.h"
 
 #include <string.h>
 #ifdef HAVE_CONFIG_H
 # include "config.h"
 #endif
+#ifdef HAVE_LINUX_FILTER_H
+# include <linux/filter.h>
+#endif
+
+/* multicast can only be shared out between sockets where a filter can be
+   attached to each of them */
+#if defined (HAVE_LINUX_FILTER_H) && defined (SO_ATTACH_FILTER)
+# define LWES_NET_SHARD_FILTER 1
+#endif
+
+/* at most this many messages are handed to sendmmsg or recvmmsg at once */
+#define LWES_NET_BATCH_SIZE 64
 
 int
 lwes_net_open
@@ -222,6 +240,102 @@ lwes_net_send_bytes
   return size;
 }
 
+int
+lwes_net_send_bytes_batch
+  (struct lwes_net_connection *conn,
+   LWES_BYTE_P *bytes,
+   const size_t *lens,
+   int *results,
+   int count)
+{
+#ifdef HAVE_SENDMMSG
+  struct mmsghdr msgs[LWES_NET_BATCH_SIZE];
+  struct iovec   iovs[LWES_NET_BATCH_SIZE];
+  int chunk;
+#endif
+  int done = 0;
+  int sent = 0;
+  int size;
+  int i;
+
+  if (conn == NULL || bytes == NULL || lens == NULL || count < 0)
+    {
+      return -1;
+    }
+  for (i = 0; i < count; i++)
+    {
+      if (bytes[i] == NULL)
+        {
+          return -1;
+        }
+    }
+
+#ifdef HAVE_SENDMMSG
+  while (done < count)
+    {
+      chunk = count - done;
+      if (chunk > LWES_NET_BATCH_SIZE)
+        {
+          chunk = LWES_NET_BATCH_SIZE;
+        }
+      memset (msgs, 0, sizeof (struct mmsghdr) * chunk);
+      for (i = 0; i < chunk; i++)
+        {
+          iovs[i].iov_base = bytes[done + i];
+          iovs[i].iov_len  = lens[done + i];
+          msgs[i].msg_hdr.msg_name    = &(conn->mcast_addr);
+          msgs[i].msg_hdr.msg_namelen = sizeof (conn->mcast_addr);
+          msgs[i].msg_hdr.msg_iov     = &(iovs[i]);
+          msgs[i].msg_hdr.msg_iovlen  = 1;
+        }
+
+      size = sendmmsg (conn->socketfd, msgs, chunk, 0);
+      if (size <= 0)
+        {
+          /* the first message is what failed, so send it on its own to find
+             out what became of it, which also copes with a kernel without
+             sendmmsg, then carry on with the rest */
+          size = lwes_net_send_bytes (conn, bytes[done], lens[done]);
+          if (results != NULL)
+            {
+              results[done] = (size < 0) ? -1 : size;
+            }
+          if (size >= 0)
+            {
+              sent++;
+            }
+          done++;
+          continue;
+        }
+
+      for (i = 0; i < size; i++)
+        {
+          if (results != NULL)
+            {
+              results[done + i] = (int) msgs[i].msg_len;
+            }
+        }
+      sent += size;
+      done += size;
+    }
+#else
+  for (done = 0; done < count; done++)
+    {
+      size = lwes_net_send_bytes (conn, bytes[done], lens[done]);
+      if (results != NULL)
+        {
+          results[done] = (size < 0) ? -1 : size;
+        }
+      if (size >= 0)
+        {
+          sent++;
+        }
+    }
+#endif
+
+  return sent;
+}
+
 int
 lwes_net_sendto_bytes
   (struct lwes_net_connection *conn,
@@ -333,6 +447,77 @@ lwes_net_recv_bind
   return 0;
 }
 
+int
+lwes_net_recv_bind_shard
+  (struct lwes_net_connection *conn,
+   int shard,
+   int shards)
+{
+  int arg = 1;
+#ifdef LWES_NET_SHARD_FILTER
+  /* keep a message if the sender's address plus port, modulo the number of
+     shards, is this shard; a filter on a UDP socket sees the UDP header at
+     0 and the IP header at SKF_NET_OFF */
+  struct sock_filter code[] = {
+    BPF_STMT (BPF_LD  | BPF_W   | BPF_ABS, SKF_NET_OFF + 12),
+    BPF_STMT (BPF_MISC | BPF_TAX, 0),
+    BPF_STMT (BPF_LD  | BPF_H   | BPF_ABS, 0),
+    BPF_STMT (BPF_ALU | BPF_ADD | BPF_X, 0),
+    BPF_STMT (BPF_ALU | BPF_MOD | BPF_K, 0),
+    BPF_JUMP (BPF_JMP | BPF_JEQ | BPF_K, 0, 0, 1),
+    BPF_STMT (BPF_RET | BPF_K, 0xffffffff),
+    BPF_STMT (BPF_RET | BPF_K, 0)
+  };
+  struct sock_fprog filter;
+#endif
+
+  if (conn == NULL || shards <= 0 || shard < 0 || shard >= shards)
+    {
+      return -1;
+    }
+
+  if (shards == 1 || conn->hasJoined == 1)
+    {
+      return lwes_net_recv_bind (conn);
+    }
+
+#ifdef SO_REUSEPORT
+  if (setsockopt (conn->socketfd,
+                  SOL_SOCKET,
+                  SO_REUSEPORT,
+                  (void*)&arg,
+                  sizeof(arg)) < 0)
+    {
+      return -2;
+    }
+
+  if (IN_MULTICAST (ntohl (conn->mcast_addr.sin_addr.s_addr)))
+    {
+# ifdef LWES_NET_SHARD_FILTER
+      code[4].k = shards;
+      code[5].k = shard;
+      filter.len    = sizeof (code) / sizeof (code[0]);
+      filter.filter = code;
+      if (setsockopt (conn->socketfd,
+                      SOL_SOCKET,
+                      SO_ATTACH_FILTER,
+                      (void*)&filter,
+                      sizeof(filter)) < 0)
+        {
+          return -6;
+        }
+# else
+      return -6;
+# endif
+    }
+
+  return lwes_net_recv_bind (conn);
+#else
+  (void) arg;
+  return -6;
+#endif
+}
+
 int
 lwes_net_recv_bytes
   (struct lwes_net_connection *conn,
@@ -404,3 +589,98 @@ lwes_net_recv_bytes_by
                   (socklen_t *)&(conn->sender_ip_socket_size));
   return ret;
 }
+
+int
+lwes_net_recv_bytes_nowait
+  (struct lwes_net_connection *conn,
+   LWES_BYTE_P bytes,
+   size_t len)
+{
+  int ret = 0;
+
+  if (conn == NULL || bytes == NULL)
+    {
+      return -1;
+    }
+
+  if ((ret = lwes_net_recv_bind (conn)) < 0)
+    {
+      return ret;
+    }
+
+  ret = recvfrom (conn->socketfd,
+                  bytes,
+                  len,
+                  MSG_DONTWAIT,
+                  (struct sockaddr *)&(conn->sender_ip_addr),
+                  (socklen_t *)&(conn->sender_ip_socket_size));
+  return ret;
+}
+
+int
+lwes_net_recv_bytes_batch
+  (struct lwes_net_connection *conn,
+   struct lwes_net_packet *packets,
+   size_t len,
+   int count)
+{
+#ifdef HAVE_RECVMMSG
+  struct mmsghdr msgs[LWES_NET_BATCH_SIZE];
+  struct iovec   iovs[LWES_NET_BATCH_SIZE];
+  int i;
+#endif
+  int ret = 0;
+
+  if (conn == NULL || packets == NULL || count <= 0)
+    {
+      return -1;
+    }
+
+  if ((ret = lwes_net_recv_bind (conn)) < 0)
+    {
+      return ret;
+    }
+
+#ifdef HAVE_RECVMMSG
+  if (count > LWES_NET_BATCH_SIZE)
+    {
+      count = LWES_NET_BATCH_SIZE;
+    }
+  memset (msgs, 0, sizeof (struct mmsghdr) * count);
+  for (i = 0; i < count; i++)
+    {
+      iovs[i].iov_base = packets[i].bytes;
+      iovs[i].iov_len  = len;
+      msgs[i].msg_hdr.msg_name    = &(packets[i].sender);
+      msgs[i].msg_hdr.msg_namelen = sizeof (packets[i].sender);
+      msgs[i].msg_hdr.msg_iov     = &(iovs[i]);
+      msgs[i].msg_hdr.msg_iovlen  = 1;
+    }
+
+  ret = recvmmsg (conn->socketfd, msgs, count, MSG_WAITFORONE, NULL);
+  if (ret > 0)
+    {
+      for (i = 0; i < ret; i++)
+        {
+          packets[i].length = msgs[i].msg_len;
+        }
+      /* so the sender of the last one is where lwes_net_recv_bytes leaves
+         it */
+      conn->sender_ip_addr = packets[ret - 1].sender;
+      return ret;
+    }
+  if (ret == 0 || errno != ENOSYS)
+    {
+      return -1;
+    }
+#endif
+
+  /* take the one message */
+  if ((ret = lwes_net_recv_bytes (conn, packets[0].bytes, len)) < 0)
+    {
+      return ret;
+    }
+  packets[0].length = ret;
+  packets[0].sender = conn->sender_ip_addr;
+  return 1;
+}
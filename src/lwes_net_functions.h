@@ -59,6 +59,19 @@ struct lwes_net_connection
   int hasJoined;
 };
 
+/*! \struct lwes_net_packet lwes_net_functions.h
+ *  \brief A message received by lwes_net_recv_bytes_batch
+ */
+struct lwes_net_packet
+{
+  /*! the bytes of the message */
+  LWES_BYTE_P bytes;
+  /*! the number of bytes in the message */
+  size_t length;
+  /*! inet address for the sender of the message */
+  struct sockaddr_in sender;
+};
+
 /*! \brief Open a multicast channel
  *
  *  \param[in] conn the multicast channel object to hole this connection
@@ -132,6 +145,29 @@ lwes_net_send_bytes
    LWES_BYTE_P bytes,
    size_t len);
 
+/*! \brief Send many messages to the multicast channel at once
+ *
+ *  Where the system has sendmmsg, messages are handed to the kernel many
+ *  at a time, rather than with a system call each.
+ *
+ *  \param[in] conn the multicast channel to send the messages to
+ *  \param[in] bytes the bytes of each message
+ *  \param[in] lens the number of bytes in each message
+ *  \param[out] results the number of bytes sent for each message, or -1 if
+ *                      it could not be sent, can be NULL
+ *  \param[in] count the number of messages
+ *
+ *  \return the number of messages sent on success, a negative number on
+ *          failure
+ */
+int
+lwes_net_send_bytes_batch
+  (struct lwes_net_connection *conn,
+   LWES_BYTE_P *bytes,
+   const size_t *lens,
+   int *results,
+   int count);
+
 /*! \brief Send bytes to a different multicast channel
  *
  *  This can be used to send bytes out over an alternate channel, this will
@@ -171,6 +207,29 @@ int
 lwes_net_recv_bind
   (struct lwes_net_connection *conn);
 
+/*! \brief Bind to the multicast channel as one of several sockets sharing it
+ *
+ *  Each of the sockets is bound with SO_REUSEPORT, so each gets a share of
+ *  the messages sent to the channel, and all of the messages from one
+ *  sender go to the same socket.  For unicast the system shares them out.
+ *  For multicast every socket would get every message, so a socket filter
+ *  is attached which keeps only those whose sender hashes to the shard.
+ *  All of the shards must be bound before any messages are missed.
+ *
+ *  \param[in] conn the multicast channel to bind to
+ *  \param[in] shard which of the sockets this is, from 0 to shards-1
+ *  \param[in] shards the number of sockets sharing the channel, with 1
+ *                    this is the same as lwes_net_recv_bind
+ *
+ *  \return 0 on success, a negative number on failure, which is -6 if the
+ *          channel can't be shared on this system
+ */
+int
+lwes_net_recv_bind_shard
+  (struct lwes_net_connection *conn,
+   int shard,
+   int shards);
+
 /*! \brief Receive bytes from the multicast channel in blocking mode
  *
  *  This calls lwes_net_recv_bind internally.
@@ -207,6 +266,48 @@ lwes_net_recv_bytes_by
    size_t len,
    unsigned int timeout_ms);
 
+/*! \brief Receive bytes from the multicast channel if there are any waiting
+ *
+ *  This calls lwes_net_recv_bind internally.  It never blocks, so it is
+ *  for use once something like poll or epoll has said the socket is
+ *  ready to read.
+ *
+ *  \param[in] conn the multicast channel to receive bytes from
+ *  \param[out] bytes the byte array to fill out
+ *  \param[in] len the size of the byte array to fill out
+ *
+ *  \return the number of bytes received on success, a negative number on
+ *          failure, including when nothing was waiting
+ */
+int
+lwes_net_recv_bytes_nowait
+  (struct lwes_net_connection *conn,
+   LWES_BYTE_P bytes,
+   size_t len);
+
+/*! \brief Receive many messages from the multicast channel at once
+ *
+ *  This calls lwes_net_recv_bind internally.  It blocks until there is a
+ *  message, then takes as many of those waiting as there is room for,
+ *  with a single recvmmsg where the system has it, or just the one
+ *  message where it doesn't.
+ *
+ *  \param[in] conn the multicast channel to receive bytes from
+ *  \param[in,out] packets the packets to fill out, whose bytes must each
+ *                         have room for len bytes
+ *  \param[in] len the size of the bytes of each packet
+ *  \param[in] count the number of packets
+ *
+ *  \return the number of messages received on success, a negative number
+ *          on failure
+ */
+int
+lwes_net_recv_bytes_batch
+  (struct lwes_net_connection *conn,
+   struct lwes_net_packet *packets,
+   size_t len,
+   int count);
+
 #ifdef __cplusplus
 }
 #endif 
@@ -0,0 +1,483 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "lwes_async_emitter.h"
+#include "lwes_listener.h"
+
+/* wrap malloc to cause test memory problems */
+void *my_malloc (size_t size);
+
+static size_t null_at = 0;
+static size_t malloc_count = 0;
+
+void *my_malloc (size_t size)
+{
+  void *ret = NULL;
+  malloc_count++;
+  if ( malloc_count != null_at )
+    {
+      ret = malloc (size);
+    }
+  return ret;
+}
+
+/* wrap sending so the sender thread can be held up while the queue fills */
+int my_lwes_emitter_emit_bytes_batch (struct lwes_emitter *emitter,
+                                      LWES_BYTE_P *bytes,
+                                      size_t *lens,
+                                      int n);
+
+static volatile int hold_sender = 0;
+static volatile int sender_held = 0;
+static volatile int send_error  = 0;
+
+int
+my_lwes_emitter_emit_bytes_batch
+  (struct lwes_emitter *emitter,
+   LWES_BYTE_P *bytes,
+   size_t *lens,
+   int n)
+{
+  while (hold_sender)
+    {
+      sender_held = 1;
+      usleep (1000);
+    }
+  sender_held = 0;
+  if (send_error)
+    {
+      return -1;
+    }
+  return lwes_emitter_emit_bytes_batch (emitter, bytes, lens, n);
+}
+
+/* wrap serializing so it can be made to fail */
+int my_lwes_event_to_bytes (struct lwes_event *event,
+                            LWES_BYTE_P bytes,
+                            size_t num_bytes,
+                            size_t offset);
+
+static int to_bytes_error = 0;
+
+int
+my_lwes_event_to_bytes
+  (struct lwes_event *event,
+   LWES_BYTE_P bytes,
+   size_t num_bytes,
+   size_t offset)
+{
+  if (to_bytes_error)
+    {
+      /* as though it failed part way through */
+      memset (bytes, 0, num_bytes);
+      return -2;
+    }
+  return lwes_event_to_bytes (event, bytes, num_bytes, offset);
+}
+
+#define malloc my_malloc
+#define lwes_emitter_emit_bytes_batch my_lwes_emitter_emit_bytes_batch
+#define lwes_event_to_bytes my_lwes_event_to_bytes
+
+#include "lwes_async_emitter.c"
+
+#undef malloc
+#undef lwes_emitter_emit_bytes_batch
+#undef lwes_event_to_bytes
+
+static const char *mcast_ip    = "224.0.0.254";
+static const char *mcast_iface = NULL;
+static const int   mcast_port  = 12346;
+
+static struct lwes_event *events[5];
+
+static struct lwes_async_emitter *
+create (size_t queue_size, enum lwes_async_emitter_policy policy)
+{
+  struct lwes_async_emitter *emitter =
+    lwes_async_emitter_create (mcast_ip, mcast_iface, mcast_port, 0, 60,
+                               queue_size, 1024, policy);
+  assert (emitter != NULL);
+  return emitter;
+}
+
+static struct lwes_listener *
+open_listener (void)
+{
+  struct lwes_listener *listener;
+  struct lwes_event *event;
+
+  listener = lwes_listener_create ((char *) mcast_ip,
+                                   (char *) mcast_iface,
+                                   (int) mcast_port);
+  assert (listener != NULL);
+
+  /* recv first, so we are listening */
+  event = lwes_event_create_no_name (NULL);
+  assert (event != NULL);
+  assert (lwes_listener_recv_by (listener, event, 10) != 0);
+  lwes_event_destroy (event);
+
+  return listener;
+}
+
+/* the events received are those expected, in order */
+static void
+expect (struct lwes_listener *listener, const int *values, int n)
+{
+  struct lwes_event *event;
+  LWES_INT_32 value;
+  int i;
+
+  event = lwes_event_create_no_name (NULL);
+  assert (event != NULL);
+  for (i = 0; i < n; i++)
+    {
+      assert (lwes_listener_recv_by (listener, event, 1000) > 0);
+      assert (lwes_event_get_INT_32 (event, "value", &value) == 0);
+      assert (value == values[i]);
+    }
+  /* and nothing else */
+  assert (lwes_listener_recv_by (listener, event, 100) < 0);
+  lwes_event_destroy (event);
+}
+
+/* hold the sender thread up with the first event it takes, so the rest of
+   the queue can be filled */
+static void
+hold (struct lwes_async_emitter *emitter)
+{
+  hold_sender = 1;
+  assert (lwes_async_emitter_emit (emitter, events[0]) == 0);
+  while (! sender_held)
+    {
+      usleep (1000);
+    }
+}
+
+static void
+release (void)
+{
+  hold_sender = 0;
+}
+
+static void
+test_emit (void)
+{
+  struct lwes_async_emitter *emitter;
+  struct lwes_listener *listener;
+  LWES_U_INT_64 dropped;
+  LWES_U_INT_64 failed;
+  LWES_CHAR big[2000];
+  int values[100];
+  int i;
+
+  listener = open_listener ();
+
+  /* everything emitted is sent, in order, even that still queued when
+     the emitter is destroyed */
+  emitter = create (0, LWES_ASYNC_EMITTER_DROP_NEWEST);
+  assert (emitter->pool.mask + 1 >= MAX_QUEUED_ELEMENTS);
+  for (i = 0; i < 100; i++)
+    {
+      values[i] = i;
+      assert (lwes_event_set_INT_32 (events[0], "value", i) == 1);
+      assert (lwes_async_emitter_emit (emitter, events[0]) == 0);
+    }
+  assert (lwes_async_emitter_destroy (emitter) == 0);
+  expect (listener, values, 100);
+
+  /* events which don't fit in a buffer aren't queued */
+  emitter = create (4, LWES_ASYNC_EMITTER_DROP_NEWEST);
+  memset (big, 'x', sizeof (big) - 1);
+  big[sizeof (big) - 1] = '\0';
+  assert (lwes_event_set_STRING (events[1], "big", big) == 2);
+  assert (lwes_async_emitter_emit (emitter, events[1]) == -2);
+  assert (lwes_async_emitter_emit (NULL, events[0]) == -1);
+  assert (lwes_async_emitter_emit (emitter, NULL) == -1);
+
+  /* sends which fail are counted */
+  send_error = 1;
+  assert (lwes_async_emitter_emit (emitter, events[0]) == 0);
+  assert (lwes_async_emitter_emit (emitter, events[0]) == 0);
+  assert (lwes_async_emitter_destroy (emitter) == 0);
+  send_error = 0;
+  /* so nothing arrives */
+  expect (listener, values, 0);
+
+  emitter = create (4, LWES_ASYNC_EMITTER_DROP_NEWEST);
+  send_error = 1;
+  assert (lwes_async_emitter_emit (emitter, events[0]) == 0);
+  while (lwes_async_emitter_get_dropped (emitter, &dropped, &failed) == 0
+         && failed == 0)
+    {
+      usleep (1000);
+    }
+  send_error = 0;
+  assert (dropped == 0);
+  assert (failed == 1);
+  assert (lwes_async_emitter_get_dropped (emitter, NULL, NULL) == 0);
+  assert (lwes_async_emitter_get_dropped (NULL, &dropped, &failed) == -1);
+  assert (lwes_async_emitter_destroy (emitter) == 0);
+
+  lwes_listener_destroy (listener);
+}
+
+static void
+test_drop_newest (void)
+{
+  struct lwes_async_emitter *emitter;
+  struct lwes_listener *listener;
+  LWES_U_INT_64 dropped;
+  int values[4] = { 0, 1, 2, 3 };
+  int i;
+
+  listener = open_listener ();
+  emitter = create (4, LWES_ASYNC_EMITTER_DROP_NEWEST);
+
+  /* the held cell and three more fill the queue */
+  hold (emitter);
+  for (i = 1; i < 4; i++)
+    {
+      assert (lwes_async_emitter_emit (emitter, events[i]) == 0);
+    }
+  assert (lwes_async_emitter_emit (emitter, events[4]) == -3);
+  assert (lwes_async_emitter_get_dropped (emitter, &dropped, NULL) == 0);
+  assert (dropped == 1);
+  release ();
+
+  assert (lwes_async_emitter_destroy (emitter) == 0);
+  expect (listener, values, 4);
+  lwes_listener_destroy (listener);
+}
+
+static void
+test_drop_oldest (void)
+{
+  struct lwes_async_emitter *emitter;
+  struct lwes_listener *listener;
+  LWES_U_INT_64 dropped;
+  int values[4] = { 0, 2, 3, 4 };
+  int i;
+
+  listener = open_listener ();
+  emitter = create (4, LWES_ASYNC_EMITTER_DROP_OLDEST);
+
+  hold (emitter);
+  for (i = 1; i < 5; i++)
+    {
+      assert (lwes_async_emitter_emit (emitter, events[i]) == 0);
+    }
+  assert (lwes_async_emitter_get_dropped (emitter, &dropped, NULL) == 0);
+  assert (dropped == 1);
+
+  /* an event which can't be serialized doesn't cost one which could */
+  to_bytes_error = 1;
+  assert (lwes_async_emitter_emit (emitter, events[1]) == -2);
+  to_bytes_error = 0;
+  assert (lwes_async_emitter_get_dropped (emitter, &dropped, NULL) == 0);
+  assert (dropped == 1);
+  release ();
+
+  assert (lwes_async_emitter_destroy (emitter) == 0);
+  expect (listener, values, 4);
+  lwes_listener_destroy (listener);
+
+  /* when every cell is being sent there is nothing older to drop, so
+     the newest is */
+  emitter = create (1, LWES_ASYNC_EMITTER_DROP_OLDEST);
+  hold (emitter);
+  assert (lwes_async_emitter_emit (emitter, events[1]) == -3);
+  release ();
+  assert (lwes_async_emitter_destroy (emitter) == 0);
+}
+
+static void *
+release_later (void *arg)
+{
+  (void) arg;
+  usleep (200000);
+  release ();
+  return NULL;
+}
+
+static void
+test_block (void)
+{
+  struct lwes_async_emitter *emitter;
+  struct lwes_listener *listener;
+  LWES_U_INT_64 dropped;
+  pthread_t thread;
+  int values[5] = { 0, 1, 2, 3, 4 };
+  int i;
+
+  listener = open_listener ();
+  emitter = create (4, LWES_ASYNC_EMITTER_BLOCK);
+
+  hold (emitter);
+  for (i = 1; i < 4; i++)
+    {
+      assert (lwes_async_emitter_emit (emitter, events[i]) == 0);
+    }
+  /* waits for the sender thread to make room */
+  assert (pthread_create (&thread, NULL, release_later, NULL) == 0);
+  assert (lwes_async_emitter_emit (emitter, events[4]) == 0);
+  assert (pthread_join (thread, NULL) == 0);
+  assert (lwes_async_emitter_get_dropped (emitter, &dropped, NULL) == 0);
+  assert (dropped == 0);
+
+  assert (lwes_async_emitter_destroy (emitter) == 0);
+  expect (listener, values, 5);
+  lwes_listener_destroy (listener);
+}
+
+#define PRODUCERS 4
+#define PER_PRODUCER 2000
+
+static struct lwes_async_emitter *shared;
+
+static void *
+produce (void *arg)
+{
+  struct lwes_event *event;
+  int i;
+
+  event = lwes_event_create (NULL, "Threaded");
+  assert (event != NULL);
+  for (i = 0; i < PER_PRODUCER; i++)
+    {
+      assert (lwes_event_set_INT_32 (event, "value", (int)(size_t)arg) == 1);
+      assert (lwes_async_emitter_emit (shared, event) == 0);
+    }
+  lwes_event_destroy (event);
+  return NULL;
+}
+
+/* no event is lost or duplicated when many threads emit at once */
+static void
+test_threads (void)
+{
+  pthread_t threads[PRODUCERS];
+  struct lwes_listener *listener;
+  struct lwes_event *event;
+  LWES_U_INT_64 dropped;
+  LWES_INT_32 value;
+  int counts[PRODUCERS];
+  size_t i;
+
+  listener = lwes_listener_create_with_batch ((char *) mcast_ip,
+                                              (char *) mcast_iface,
+                                              (int) mcast_port, 64);
+  assert (listener != NULL);
+  event = lwes_event_create_no_name (NULL);
+  assert (event != NULL);
+  assert (lwes_listener_recv_by (listener, event, 10) != 0);
+
+  shared = create (64, LWES_ASYNC_EMITTER_BLOCK);
+  for (i = 0; i < PRODUCERS; i++)
+    {
+      assert (pthread_create (&(threads[i]), NULL, produce, (void *)i) == 0);
+    }
+  memset (counts, 0, sizeof (counts));
+
+  /* keep up with them, so the socket doesn't overflow */
+  for (i = 0; i < PRODUCERS * PER_PRODUCER; i++)
+    {
+      assert (lwes_listener_recv_by (listener, event, 1000) > 0);
+      assert (lwes_event_get_INT_32 (event, "value", &value) == 0);
+      assert (value >= 0 && value < PRODUCERS);
+      counts[value]++;
+    }
+  for (i = 0; i < PRODUCERS; i++)
+    {
+      assert (pthread_join (threads[i], NULL) == 0);
+      assert (counts[i] == PER_PRODUCER);
+    }
+  assert (lwes_async_emitter_get_dropped (shared, &dropped, NULL) == 0);
+  assert (dropped == 0);
+  assert (lwes_async_emitter_destroy (shared) == 0);
+
+  lwes_event_destroy (event);
+  lwes_listener_destroy (listener);
+}
+
+static void
+test_create_failures (void)
+{
+  struct lwes_async_emitter *emitter;
+
+  assert (lwes_async_emitter_create (mcast_ip, mcast_iface, mcast_port, 0, 60,
+                                     4, MAX_MSG_SIZE + 1,
+                                     LWES_ASYNC_EMITTER_BLOCK) == NULL);
+  assert (lwes_async_emitter_create (mcast_ip, mcast_iface, mcast_port, 0, 60,
+                                     (size_t)-1, 1024,
+                                     LWES_ASYNC_EMITTER_BLOCK) == NULL);
+  assert (lwes_async_emitter_create (mcast_ip, mcast_iface, mcast_port, 0, 60,
+                                     4, 1024,
+                                     (enum lwes_async_emitter_policy) 3)
+          == NULL);
+  assert (lwes_async_emitter_destroy (NULL) == 0);
+
+  /* 1: the emitter, 2: the buffers, 3: their slab, 4: the pool, 5: the
+     queue */
+  for (null_at = 1; null_at <= 5; null_at++)
+    {
+      malloc_count = 0;
+      assert (lwes_async_emitter_create (mcast_ip, mcast_iface, mcast_port,
+                                         0, 60, 4, 1024,
+                                         LWES_ASYNC_EMITTER_BLOCK) == NULL);
+    }
+  null_at = 0;
+
+  /* sizes are rounded up to a power of two, and the buffers default to as
+     big as an event can be */
+  emitter = lwes_async_emitter_create (mcast_ip, mcast_iface, mcast_port,
+                                       0, 60, 5, 0,
+                                       LWES_ASYNC_EMITTER_BLOCK);
+  assert (emitter != NULL);
+  assert (emitter->pool.mask == 7);
+  assert (emitter->queued.mask == 7);
+  assert (emitter->buffer_size == MAX_MSG_SIZE);
+  assert (lwes_async_emitter_destroy (emitter) == 0);
+}
+
+int main (void)
+{
+  int i;
+
+  for (i = 0; i < 5; i++)
+    {
+      events[i] = lwes_event_create (NULL, "Async");
+      assert (events[i] != NULL);
+      assert (lwes_event_set_INT_32 (events[i], "value", i) == 1);
+    }
+
+  test_create_failures ();
+  test_drop_newest ();
+  test_drop_oldest ();
+  test_block ();
+  test_emit ();
+  test_threads ();
+
+  for (i = 0; i < 5; i++)
+    {
+      lwes_event_destroy (events[i]);
+    }
+
+  return 0;
+}
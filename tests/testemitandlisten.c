@@ -569,6 +569,303 @@ void test_event_name_peek (void)
   }
 }
 
+void test_emit_batch (void)
+{
+  struct lwes_listener *listener;
+  struct lwes_emitter *emitter;
+  struct lwes_event *events[5];
+  struct lwes_event *many[150];
+  struct lwes_event *event;
+  LWES_SHORT_STRING tmp_event_name;
+  LWES_U_INT_16 value;
+  LWES_BYTE_P bytes[2];
+  size_t lens[2];
+  int results[2];
+  LWES_LONG_STRING big;
+  int i;
+
+  emitter = lwes_emitter_create ((char *) mcast_ip,
+                                 (char *) mcast_iface,
+                                 (int) mcast_port, 0, 60);
+  assert (emitter != NULL);
+  listener = lwes_listener_create ((char *) mcast_ip,
+                                   (char *) mcast_iface,
+                                   (int) mcast_port);
+  assert (listener != NULL);
+  event = lwes_event_create_no_name (NULL);
+  assert (event != NULL);
+
+  /* recv first, so we are listening */
+  assert (lwes_listener_recv_by (listener, event, 10) != 0);
+
+  for (i = 0; i < 3; i++)
+    {
+      events[i] = lwes_event_create (NULL, eventname);
+      assert (events[i] != NULL);
+      assert (lwes_event_set_U_INT_16 (events[i], key04, i) == 1);
+    }
+  /* an event which can't be serialized is skipped, but still counted */
+  events[3] = NULL;
+  assert (lwes_emitter_emit_batch (emitter, events, 4) == 3);
+  assert (emitter->count == 4);
+  assert (emitter->count_since_last_beat == 4);
+
+  for (i = 0; i < 3; i++)
+    {
+      assert (lwes_listener_recv_by (listener, event, 1000) > 0);
+      assert (lwes_event_get_name (event, &tmp_event_name) == 0);
+      assert (strcmp (tmp_event_name, eventname) == 0);
+      assert (lwes_event_get_U_INT_16 (event, key04, &value) == 0);
+      assert (value == i);
+    }
+
+  /* more than are sent at once, which all arrive in order */
+  for (i = 0; i < 150; i++)
+    {
+      many[i] = events[i % 3];
+    }
+  assert (lwes_emitter_emit_batch (emitter, many, 150) == 150);
+  assert (emitter->count == 154);
+  for (i = 0; i < 150; i++)
+    {
+      assert (lwes_listener_recv_by (listener, event, 1000) > 0);
+      assert (lwes_event_get_U_INT_16 (event, key04, &value) == 0);
+      assert (value == i % 3);
+    }
+
+  /* the bytes of each message are sent on their own */
+  bytes[0] = emitter->batch_buffer;
+  bytes[1] = emitter->batch_buffer + 1;
+  lens[0]  = 1;
+  lens[1]  = 2;
+  assert (lwes_net_send_bytes_batch (&(emitter->connection),
+                                     bytes, lens, results, 2) == 2);
+  assert (results[0] == 1);
+  assert (results[1] == 2);
+  assert (lwes_listener_recv_bytes_by (listener, emitter->buffer,
+                                       MAX_MSG_SIZE, 1000) == 1);
+  assert (lwes_listener_recv_bytes_by (listener, emitter->buffer,
+                                       MAX_MSG_SIZE, 1000) == 2);
+
+  /* bad arguments */
+  assert (lwes_emitter_emit_batch (NULL, events, 1) == -1);
+  assert (lwes_emitter_emit_batch (emitter, NULL, 1) == -1);
+  assert (lwes_emitter_emit_batch (emitter, events, -1) == -1);
+  assert (lwes_emitter_emit_batch (emitter, events, 0) == 0);
+  assert (lwes_net_send_bytes_batch (NULL, bytes, lens, results, 2) == -1);
+  assert (lwes_net_send_bytes_batch (&(emitter->connection),
+                                     NULL, lens, results, 2) == -1);
+  assert (lwes_net_send_bytes_batch (&(emitter->connection),
+                                     bytes, NULL, results, 2) == -1);
+  assert (lwes_net_send_bytes_batch (&(emitter->connection),
+                                     bytes, lens, results, -1) == -1);
+  bytes[1] = NULL;
+  assert (lwes_net_send_bytes_batch (&(emitter->connection),
+                                     bytes, lens, results, 2) == -1);
+
+  lwes_event_to_bytes_error = 1;
+  assert (lwes_emitter_emit_batch (emitter, events, 3) == 0);
+  lwes_event_to_bytes_error = 0;
+
+  /* events which don't all fit in the slab are sent in more than one go */
+  big = (LWES_LONG_STRING) malloc (50000);
+  assert (big != NULL);
+  memset (big, 'x', 49999);
+  big[49999] = '\0';
+  for (i = 0; i < 5; i++)
+    {
+      if (i >= 3)
+        {
+          events[i] = lwes_event_create (NULL, eventname);
+          assert (events[i] != NULL);
+        }
+      assert (lwes_event_set_STRING (events[i], key01, big) > 0);
+    }
+  assert (lwes_emitter_emit_batch (emitter, events, 5) == 5);
+  free (big);
+
+  for (i = 0; i < 5; i++)
+    {
+      lwes_event_destroy (events[i]);
+    }
+  lwes_event_destroy (event);
+  lwes_listener_destroy (listener);
+  lwes_emitter_destroy (emitter);
+
+  /* malloc failure for the batch buffer */
+  emitter = lwes_emitter_create ((char *) mcast_ip,
+                                 (char *) mcast_iface,
+                                 (int) mcast_port, 0, 60);
+  assert (emitter != NULL);
+  event = lwes_event_create (NULL, eventname);
+  assert (event != NULL);
+  malloc_count = 0;
+  null_at      = 1;
+  assert (lwes_emitter_emit_batch (emitter, &event, 1) == -3);
+  null_at      = 0;
+  assert (lwes_emitter_emit_batch (emitter, &event, 1) == 1);
+  lwes_event_destroy (event);
+  lwes_emitter_destroy (emitter);
+}
+
+void test_recv_batch (void)
+{
+  struct lwes_listener *listener;
+  struct lwes_emitter *emitter;
+  struct lwes_event *events[5];
+  struct lwes_event *received[10];
+  struct lwes_net_packet *packets;
+  LWES_U_INT_16 value;
+  LWES_INT_64 receipt_time;
+  LWES_IP_ADDR sender_ip;
+  LWES_U_INT_16 sender_port;
+  LWES_BYTE garbage[3] = { 5, 'a', 'b' };
+  int total;
+  int n;
+  int i;
+
+  /* malloc failures for the packets and their slab */
+  for (null_at = 4; null_at <= 5; null_at++)
+    {
+      malloc_count = 0;
+      assert (lwes_listener_create_with_batch ((char *) mcast_ip,
+                                               (char *) mcast_iface,
+                                               (int) mcast_port, 8)
+              == NULL);
+    }
+  null_at = 0;
+  assert (lwes_listener_create_with_batch ((char *) mcast_ip,
+                                           (char *) mcast_iface,
+                                           (int) mcast_port, -1) == NULL);
+
+  emitter = lwes_emitter_create ((char *) mcast_ip,
+                                 (char *) mcast_iface,
+                                 (int) mcast_port, 0, 60);
+  assert (emitter != NULL);
+  listener = lwes_listener_create_with_batch ((char *) mcast_ip,
+                                              (char *) mcast_iface,
+                                              (int) mcast_port, 8);
+  assert (listener != NULL);
+  assert (listener->packets_size == 8);
+
+  for (i = 0; i < 10; i++)
+    {
+      received[i] = lwes_event_create_no_name (NULL);
+      assert (received[i] != NULL);
+    }
+  for (i = 0; i < 5; i++)
+    {
+      events[i] = lwes_event_create (NULL, eventname);
+      assert (events[i] != NULL);
+      assert (lwes_event_set_U_INT_16 (events[i], key04, i) == 1);
+    }
+
+  /* recv first, so we are listening */
+  assert (lwes_listener_recv_by (listener, received[0], 10) != 0);
+
+  /* events come back decoded, with the header fields of their sender */
+  assert (lwes_emitter_emit_batch (emitter, events, 5) == 5);
+  for (total = 0; total < 5; total += n)
+    {
+      n = lwes_listener_recv_batch (listener, received, 10);
+      assert (n > 0 && total + n <= 5);
+      for (i = 0; i < n; i++)
+        {
+          assert (lwes_event_get_U_INT_16 (received[i], key04, &value) == 0);
+          assert (value == total + i);
+          assert (lwes_event_get_INT_64 (received[i], "ReceiptTime",
+                                         &receipt_time) == 0);
+          assert (lwes_event_get_IP_ADDR (received[i], "SenderIP",
+                                          &sender_ip) == 0);
+          assert (lwes_event_get_U_INT_16 (received[i], "SenderPort",
+                                           &sender_port) == 0);
+        }
+    }
+
+  /* no more than the listener has room for come back at once */
+  for (i = 0; i < 4; i++)
+    {
+      assert (lwes_emitter_emit_batch (emitter, events, 5) == 5);
+    }
+  for (total = 0; total < 20; total += n)
+    {
+      n = lwes_listener_recv_batch (listener, received, 10);
+      assert (n > 0 && n <= 8 && total + n <= 20);
+      for (i = 0; i < n; i++)
+        {
+          assert (lwes_event_get_U_INT_16 (received[i], key04, &value) == 0);
+          assert (value == (total + i) % 5);
+        }
+    }
+  assert (lwes_emitter_emit_batch (emitter, events, 5) == 5);
+  for (total = 0; total < 5; total += n)
+    {
+      n = lwes_listener_recv_batch (listener, received, 2);
+      assert (n > 0 && n <= 2);
+    }
+
+  /* or as packets, which have their header fields added on request */
+  assert (lwes_emitter_emit_batch (emitter, events, 3) == 3);
+  for (total = 0; total < 3; total += n)
+    {
+      n = lwes_listener_recv_bytes_batch (listener, &packets);
+      assert (n > 0 && total + n <= 3);
+      assert (packets == listener->packets);
+      for (i = 0; i < n; i++)
+        {
+          assert (lwes_listener_event_has_name (packets[i].bytes,
+                                                packets[i].length,
+                                                eventname) == 0);
+          assert (lwes_listener_add_packet_header_fields (listener,
+                                                          &(packets[i]))
+                  == 0);
+          assert (lwes_event_reset (received[i]) == 0);
+          assert (lwes_event_from_bytes (received[i],
+                                         packets[i].bytes,
+                                         packets[i].length,
+                                         0,
+                                         listener->dtmp)
+                  == (int)packets[i].length);
+          assert (lwes_event_get_U_INT_16 (received[i], "SenderPort",
+                                           &value) == 0);
+          assert (value == ntohs (packets[i].sender.sin_port));
+        }
+    }
+
+  /* packets which aren't events are skipped */
+  assert (lwes_emitter_emit_bytes (emitter, garbage, sizeof (garbage)) == 3);
+  assert (lwes_listener_recv_batch (listener, received, 10) == 0);
+
+  /* bad arguments */
+  assert (lwes_listener_recv_batch (NULL, received, 10) == -1);
+  assert (lwes_listener_recv_batch (listener, NULL, 10) == -1);
+  assert (lwes_listener_recv_batch (listener, received, 0) == -1);
+  assert (lwes_listener_recv_bytes_batch (NULL, &packets) == -1);
+  assert (lwes_listener_recv_bytes_batch (listener, NULL) == -1);
+  assert (lwes_listener_add_packet_header_fields (NULL, packets) == -1);
+  assert (lwes_listener_add_packet_header_fields (listener, NULL) == -1);
+
+  for (i = 0; i < 5; i++)
+    {
+      lwes_event_destroy (events[i]);
+    }
+  for (i = 0; i < 10; i++)
+    {
+      lwes_event_destroy (received[i]);
+    }
+  lwes_listener_destroy (listener);
+  lwes_emitter_destroy (emitter);
+
+  /* only a listener created for batches receives them */
+  listener = lwes_listener_create ((char *) mcast_ip,
+                                   (char *) mcast_iface,
+                                   (int) mcast_port);
+  assert (listener != NULL);
+  assert (lwes_listener_recv_batch (listener, received, 10) == -1);
+  assert (lwes_listener_recv_bytes_batch (listener, &packets) == -1);
+  lwes_listener_destroy (listener);
+}
+
 void test_emitter_failures (void)
 {
   /* open failures */
@@ -748,11 +1045,13 @@ static void listener (const char *ip, const int port, const char *iface)
 
   lwes_event_destroy(event);
 
-  /* then two events as before */
+  /* then two events as before, received into the same event */
+  event  = lwes_event_create_no_name ( db );
+  assert ( event != NULL );
   for (i = 0 ; i < 2 ; i++)
     {
-      event  = lwes_event_create_no_name ( db );
-      assert ( event != NULL );
+      LWES_U_INT_16 num_attrs;
+
       ret = lwes_listener_recv (listener, event);
       assert ( ret > 0 );
 
@@ -778,8 +1077,12 @@ static void listener (const char *ip, const int port, const char *iface)
       assert ( value07 == value07_o );
       assert ( value08 == value08_o );
       assert ( value09 == value09_o );
-      lwes_event_destroy(event);
+
+      /* nothing is left over from the previous event */
+      assert (lwes_event_get_number_of_attributes (event, &num_attrs) == 0);
+      assert (num_attrs == 12);
     }
+  lwes_event_destroy(event);
 
   /* followed by a heartbeat */
   event  = lwes_event_create_no_name ( db );
@@ -1098,6 +1401,8 @@ int main (void)
   test_event_name_peek ();
   test_listener_failures ();
   test_emitter_failures ();
+  test_emit_batch ();
+  test_recv_batch ();
 
   test_emit ();
   test_emitto ();
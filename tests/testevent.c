@@ -15,6 +15,7 @@
 
 #include "lwes_event.h"
 #include "lwes_hash.h"
+#include "lwes_intern.h"
 #include "lwes_marshall_functions.h"
 
 static size_t null_at = 0;
@@ -32,115 +33,98 @@ void *my_malloc (size_t size)
 }
 #define malloc my_malloc
 
-static int hash_null = 0;
-
-struct lwes_hash *my_lwes_hash_create (void)
+/* names aren't shared while allocations are being made to fail, so that
+   they come out of the storage of the event and can fail too */
+LWES_SHORT_STRING
+my_lwes_intern
+  (LWES_CONST_SHORT_STRING name,
+   size_t length)
 {
-  struct lwes_hash * my_hash = NULL;
-  if ( ! hash_null )
+  if ( null_at != 0 )
     {
-      my_hash = lwes_hash_create ();
+      return NULL;
     }
-  return my_hash;
+  return lwes_intern (name, length);
 }
-#define lwes_hash_create my_lwes_hash_create
+#define lwes_intern my_lwes_intern
 
-static int put_null = 0;
-int my_lwes_hash_put(struct lwes_hash* hash, char *key, void *value)
+LWES_SHORT_STRING
+my_lwes_intern_lookup
+  (LWES_CONST_SHORT_STRING name,
+   size_t length)
 {
-  int ret = -3;
-  if ( ! put_null )
+  if ( null_at != 0 )
     {
-      ret = lwes_hash_put (hash, key, value);
+      return NULL;
     }
-  return ret;
+  return lwes_intern_lookup (name, length);
 }
-#define lwes_hash_put my_lwes_hash_put
+#define lwes_intern_lookup my_lwes_intern_lookup
+
+#include "lwes_event.c"
 
-static struct lwes_event_attribute null_type;
-static LWES_U_INT_16 enc = (LWES_U_INT_16)1;
+#undef malloc
+#undef lwes_intern
 
-static int lwes_hash_get_type_error = 0;
-static int lwes_hash_get_value_error = 0;
-void *
-my_lwes_hash_get
-  (struct lwes_hash* hash,
-   const char *key)
+/* use up the storage allocated with an event, leaving room for a one
+   character name, so that the next thing stored in it has to allocate */
+static void
+use_up_storage (struct lwes_event *event, size_t name_length)
 {
-  if (lwes_hash_get_type_error == 1)
+  event->arena->used = event->arena->size;
+  if (name_length > 0)
     {
-      null_type.type = LWES_U_INT_16_TOKEN;
-      null_type.value = (void*)&enc;
-      return (void *)&null_type;
-    }
-  else if (lwes_hash_get_value_error == 1)
-    {
-      null_type.type = LWES_INT_16_TOKEN;
-      null_type.value = NULL;
-      return (void *)&null_type;
-    }
-  else
-    {
-      return lwes_hash_get (hash, key);
+      event->arena->used -= LWES_EVENT_ARENA_ALIGN (name_length + 1);
     }
 }
-#define lwes_hash_get my_lwes_hash_get
-
-#include "lwes_event.c"
 
-#undef malloc
-#undef lwes_hash_create
-#undef lwes_hash_put
-#undef lwes_hash_get
-
-static LWES_BYTE ref_bytes_no_db[216] = {
-  0x0b,0x54,0x79,0x70,0x65,0x43,0x68,0x65,0x63,0x6b,0x65,0x72,0x00,0x0d,0x0b,
-  0x61,0x6e,0x49,0x50,0x41,0x64,0x64,0x72,0x65,0x73,0x73,0x06,0x64,0x00,0x00,
-  0xe0,0x07,0x61,0x55,0x49,0x6e,0x74,0x33,0x32,0x03,0xff,0xff,0xff,0xff,0x08,
-  0x61,0x42,0x6f,0x6f,0x6c,0x65,0x61,0x6e,0x09,0x01,0x08,0x61,0x42,0x6f,0x6f,
-  0x6c,0x65,0x61,0x6e,0x09,0x01,0x07,0x61,0x6e,0x49,0x6e,0x74,0x31,0x36,0x02,
-  0xff,0xff,0x07,0x61,0x53,0x74,0x72,0x69,0x6e,0x67,0x05,0x00,0x13,0x68,0x74,
-  0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x74,0x65,0x73,0x74,0x2e,0x63,
-  0x6f,0x6d,0x07,0x61,0x6e,0x49,0x6e,0x74,0x36,0x34,0x07,0xff,0xff,0xff,0xff,
-  0xff,0xff,0xff,0xff,0x07,0x61,0x6e,0x49,0x6e,0x74,0x33,0x32,0x04,0xff,0xff,
-  0xff,0xff,0x07,0x61,0x55,0x49,0x6e,0x74,0x31,0x36,0x01,0xff,0xff,0x0d,0x61,
-  0x6e,0x6f,0x74,0x68,0x65,0x72,0x55,0x49,0x6e,0x74,0x31,0x36,0x01,0xff,0xff,
-  0x08,0x53,0x65,0x6e,0x64,0x65,0x72,0x49,0x50,0x06,0x01,0x00,0x00,0x7f,0x07,
-  0x61,0x55,0x49,0x6e,0x74,0x36,0x34,0x08,0xff,0xff,0xff,0xff,0xff,0xff,0xff,
-  0xff,0x0b,0x61,0x4d,0x65,0x74,0x61,0x53,0x74,0x72,0x69,0x6e,0x67,0x05,0x00,
-  0x05,0x68,0x65,0x6c,0x6c,0x6f};
-
-static LWES_BYTE ref_bytes_encoding_no_db[223] = {
-  0x0b,0x54,0x79,0x70,0x65,0x43,0x68,0x65,0x63,0x6b,0x65,0x72,0x00,0x0e,0x03,
-  0x65,0x6e,0x63,0x02,0x00,0x01,0x0b,0x61,0x6e,0x49,0x50,0x41,0x64,0x64,0x72,
-  0x65,0x73,0x73,0x06,0x64,0x00,0x00,0xe0,0x07,0x61,0x55,0x49,0x6e,0x74,0x33,
-  0x32,0x03,0xff,0xff,0xff,0xff,0x08,0x61,0x42,0x6f,0x6f,0x6c,0x65,0x61,0x6e,
-  0x09,0x01,0x08,0x61,0x42,0x6f,0x6f,0x6c,0x65,0x61,0x6e,0x09,0x01,0x07,0x61,
-  0x6e,0x49,0x6e,0x74,0x31,0x36,0x02,0xff,0xff,0x07,0x61,0x53,0x74,0x72,0x69,
-  0x6e,0x67,0x05,0x00,0x13,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,
-  0x2e,0x74,0x65,0x73,0x74,0x2e,0x63,0x6f,0x6d,0x07,0x61,0x6e,0x49,0x6e,0x74,
-  0x36,0x34,0x07,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0x07,0x61,0x6e,0x49,
-  0x6e,0x74,0x33,0x32,0x04,0xff,0xff,0xff,0xff,0x07,0x61,0x55,0x49,0x6e,0x74,
-  0x31,0x36,0x01,0xff,0xff,0x0d,0x61,0x6e,0x6f,0x74,0x68,0x65,0x72,0x55,0x49,
-  0x6e,0x74,0x31,0x36,0x01,0xff,0xff,0x08,0x53,0x65,0x6e,0x64,0x65,0x72,0x49,
-  0x50,0x06,0x01,0x00,0x00,0x7f,0x07,0x61,0x55,0x49,0x6e,0x74,0x36,0x34,0x08,
+static LWES_BYTE ref_bytes_no_db[207] = {
+  0x0b,0x54,0x79,0x70,0x65,0x43,0x68,0x65,0x63,0x6b,0x65,0x72,0x00,0x0c,0x07,
+  0x61,0x53,0x74,0x72,0x69,0x6e,0x67,0x05,0x00,0x13,0x68,0x74,0x74,0x70,0x3a,
+  0x2f,0x2f,0x77,0x77,0x77,0x2e,0x74,0x65,0x73,0x74,0x2e,0x63,0x6f,0x6d,0x08,
+  0x61,0x42,0x6f,0x6f,0x6c,0x65,0x61,0x6e,0x05,0x00,0x01,0x31,0x0b,0x61,0x6e,
+  0x49,0x50,0x41,0x64,0x64,0x72,0x65,0x73,0x73,0x06,0x64,0x00,0x00,0xe0,0x07,
+  0x61,0x55,0x49,0x6e,0x74,0x31,0x36,0x01,0xff,0xff,0x0d,0x61,0x6e,0x6f,0x74,
+  0x68,0x65,0x72,0x55,0x49,0x6e,0x74,0x31,0x36,0x01,0xff,0xff,0x07,0x61,0x6e,
+  0x49,0x6e,0x74,0x31,0x36,0x02,0xff,0xff,0x07,0x61,0x55,0x49,0x6e,0x74,0x33,
+  0x32,0x03,0xff,0xff,0xff,0xff,0x07,0x61,0x6e,0x49,0x6e,0x74,0x33,0x32,0x04,
+  0xff,0xff,0xff,0xff,0x07,0x61,0x55,0x49,0x6e,0x74,0x36,0x34,0x08,0xff,0xff,
+  0xff,0xff,0xff,0xff,0xff,0xff,0x07,0x61,0x6e,0x49,0x6e,0x74,0x36,0x34,0x07,
   0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0x0b,0x61,0x4d,0x65,0x74,0x61,0x53,
-  0x74,0x72,0x69,0x6e,0x67,0x05,0x00,0x05,0x68,0x65,0x6c,0x6c,0x6f};
+  0x74,0x72,0x69,0x6e,0x67,0x05,0x00,0x05,0x68,0x65,0x6c,0x6c,0x6f,0x08,0x53,
+  0x65,0x6e,0x64,0x65,0x72,0x49,0x50,0x06,0x01,0x00,0x00,0x7f};
 
-static LWES_BYTE ref_bytes_db[188] = {
-  0x0b,0x54,0x79,0x70,0x65,0x43,0x68,0x65,0x63,0x6b,0x65,0x72,0x00,0x0b,0x0b,
-  0x61,0x6e,0x49,0x50,0x41,0x64,0x64,0x72,0x65,0x73,0x73,0x06,0x64,0x00,0x00,
-  0xe0,0x07,0x61,0x55,0x49,0x6e,0x74,0x33,0x32,0x03,0xff,0xff,0xff,0xff,0x08,
-  0x61,0x42,0x6f,0x6f,0x6c,0x65,0x61,0x6e,0x09,0x01,0x07,0x61,0x6e,0x49,0x6e,
-  0x74,0x31,0x36,0x02,0xff,0xff,0x07,0x61,0x53,0x74,0x72,0x69,0x6e,0x67,0x05,
+static LWES_BYTE ref_bytes_encoding_no_db[214] = {
+  0x0b,0x54,0x79,0x70,0x65,0x43,0x68,0x65,0x63,0x6b,0x65,0x72,0x00,0x0d,0x03,
+  0x65,0x6e,0x63,0x02,0x00,0x01,0x07,0x61,0x53,0x74,0x72,0x69,0x6e,0x67,0x05,
   0x00,0x13,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,0x2e,0x74,0x65,
-  0x73,0x74,0x2e,0x63,0x6f,0x6d,0x07,0x61,0x6e,0x49,0x6e,0x74,0x36,0x34,0x07,
-  0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0x07,0x61,0x6e,0x49,0x6e,0x74,0x33,
-  0x32,0x04,0xff,0xff,0xff,0xff,0x07,0x61,0x55,0x49,0x6e,0x74,0x31,0x36,0x01,
-  0xff,0xff,0x08,0x53,0x65,0x6e,0x64,0x65,0x72,0x49,0x50,0x06,0x01,0x00,0x00,
-  0x7f,0x07,0x61,0x55,0x49,0x6e,0x74,0x36,0x34,0x08,0xff,0xff,0xff,0xff,0xff,
-  0xff,0xff,0xff,0x0b,0x61,0x4d,0x65,0x74,0x61,0x53,0x74,0x72,0x69,0x6e,0x67,
-  0x05,0x00,0x05,0x68,0x65,0x6c,0x6c,0x6f};
+  0x73,0x74,0x2e,0x63,0x6f,0x6d,0x08,0x61,0x42,0x6f,0x6f,0x6c,0x65,0x61,0x6e,
+  0x05,0x00,0x01,0x31,0x0b,0x61,0x6e,0x49,0x50,0x41,0x64,0x64,0x72,0x65,0x73,
+  0x73,0x06,0x64,0x00,0x00,0xe0,0x07,0x61,0x55,0x49,0x6e,0x74,0x31,0x36,0x01,
+  0xff,0xff,0x0d,0x61,0x6e,0x6f,0x74,0x68,0x65,0x72,0x55,0x49,0x6e,0x74,0x31,
+  0x36,0x01,0xff,0xff,0x07,0x61,0x6e,0x49,0x6e,0x74,0x31,0x36,0x02,0xff,0xff,
+  0x07,0x61,0x55,0x49,0x6e,0x74,0x33,0x32,0x03,0xff,0xff,0xff,0xff,0x07,0x61,
+  0x6e,0x49,0x6e,0x74,0x33,0x32,0x04,0xff,0xff,0xff,0xff,0x07,0x61,0x55,0x49,
+  0x6e,0x74,0x36,0x34,0x08,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0x07,0x61,
+  0x6e,0x49,0x6e,0x74,0x36,0x34,0x07,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,
+  0x0b,0x61,0x4d,0x65,0x74,0x61,0x53,0x74,0x72,0x69,0x6e,0x67,0x05,0x00,0x05,
+  0x68,0x65,0x6c,0x6c,0x6f,0x08,0x53,0x65,0x6e,0x64,0x65,0x72,0x49,0x50,0x06,
+  0x01,0x00,0x00,0x7f};
+
+static LWES_BYTE ref_bytes_db[188] = {
+  0x0b,0x54,0x79,0x70,0x65,0x43,0x68,0x65,0x63,0x6b,0x65,0x72,0x00,0x0b,0x07,
+  0x61,0x53,0x74,0x72,0x69,0x6e,0x67,0x05,0x00,0x13,0x68,0x74,0x74,0x70,0x3a,
+  0x2f,0x2f,0x77,0x77,0x77,0x2e,0x74,0x65,0x73,0x74,0x2e,0x63,0x6f,0x6d,0x08,
+  0x61,0x42,0x6f,0x6f,0x6c,0x65,0x61,0x6e,0x09,0x01,0x0b,0x61,0x6e,0x49,0x50,
+  0x41,0x64,0x64,0x72,0x65,0x73,0x73,0x06,0x64,0x00,0x00,0xe0,0x07,0x61,0x55,
+  0x49,0x6e,0x74,0x31,0x36,0x01,0xff,0xff,0x07,0x61,0x6e,0x49,0x6e,0x74,0x31,
+  0x36,0x02,0xff,0xff,0x07,0x61,0x55,0x49,0x6e,0x74,0x33,0x32,0x03,0xff,0xff,
+  0xff,0xff,0x07,0x61,0x6e,0x49,0x6e,0x74,0x33,0x32,0x04,0xff,0xff,0xff,0xff,
+  0x07,0x61,0x55,0x49,0x6e,0x74,0x36,0x34,0x08,0xff,0xff,0xff,0xff,0xff,0xff,
+  0xff,0xff,0x07,0x61,0x6e,0x49,0x6e,0x74,0x36,0x34,0x07,0xff,0xff,0xff,0xff,
+  0xff,0xff,0xff,0xff,0x0b,0x61,0x4d,0x65,0x74,0x61,0x53,0x74,0x72,0x69,0x6e,
+  0x67,0x05,0x00,0x05,0x68,0x65,0x6c,0x6c,0x6f,0x08,0x53,0x65,0x6e,0x64,0x65,
+  0x72,0x49,0x50,0x06,0x01,0x00,0x00,0x7f};
 
 const char *esffile         = "testeventtypedb.esf";
 LWES_SHORT_STRING eventname = (LWES_SHORT_STRING)"TypeChecker";
@@ -181,6 +165,7 @@ test_event_with_db (void)
   LWES_BYTE bytes[MAX_MSG_SIZE];
   int size1;
   int size2;
+  size_t ser_size;
   int i;
 
   LWES_SHORT_STRING evnt_nm_o1;
@@ -255,6 +240,11 @@ test_event_with_db (void)
   size2  = lwes_event_from_bytes (event2, bytes, size1, 0, &dtmp);
 
   assert ( size1 == size2 );
+  assert ( lwes_event_get_serialized_size (event1, &ser_size) == 0 );
+  assert ( ser_size == (size_t)size1 );
+  assert ( ser_size == sizeof (ref_bytes_db) );
+  assert ( lwes_event_get_serialized_size (event2, &ser_size) == 0 );
+  assert ( ser_size == (size_t)size2 );
 
   assert ( lwes_event_get_name ( event2, &evnt_nm_o2) == 0 );
   assert ( strcmp (evnt_nm_o2, eventname) == 0 );
@@ -265,7 +255,7 @@ test_event_with_db (void)
 
   assert ( lwes_event_get_STRING   (event1, key01, &value01_o1) ==  0 );
   assert ( lwes_event_get_BOOLEAN  (event1, key02, &value02_o1) ==  0 );
-  assert ( lwes_event_get_STRING   (event1, key02, &value02s_o1)==  0 );
+  assert ( lwes_event_get_STRING   (event1, key02, &value02s_o1)== -2 );
   assert ( lwes_event_get_IP_ADDR  (event1, key03, &value03_o1) ==  0 );
   assert ( lwes_event_get_U_INT_16 (event1, key04, &value04_o1) ==  0 );
   assert ( lwes_event_get_U_INT_16 (event1, key05, &value05_o1) == -1 );
@@ -279,7 +269,7 @@ test_event_with_db (void)
 
   assert ( lwes_event_get_STRING   (event2, key01, &value01_o2) ==  0 );
   assert ( lwes_event_get_BOOLEAN  (event2, key02, &value02_o2) ==  0 );
-  assert ( lwes_event_get_STRING   (event2, key02, &value02s_o2)==  0 );
+  assert ( lwes_event_get_STRING   (event2, key02, &value02s_o2)== -2 );
   assert ( lwes_event_get_IP_ADDR  (event2, key03, &value03_o2) ==  0 );
   assert ( lwes_event_get_U_INT_16 (event2, key04, &value04_o2) ==  0 );
   assert ( lwes_event_get_U_INT_16 (event2, key05, &value05_o2) == -1 );
@@ -293,7 +283,6 @@ test_event_with_db (void)
 
   assert ( strcmp(value01_o1, value01_o2) == 0 ) ;
   assert ( value02_o1 == value02_o2 );
-  assert ( strcmp(value02s_o1, value02s_o2) == 0 ) ;
   assert ( value03_o1.s_addr == value03_o2.s_addr );
   assert ( value04_o1 == value04_o2 );
   assert ( value06_o1 == value06_o2 );
@@ -306,6 +295,21 @@ test_event_with_db (void)
 
   lwes_event_destroy (event1);
   lwes_event_destroy (event2);
+
+  /* an event not in the db only has the meta attributes, until it is
+     added to the db */
+  event1 = lwes_event_create (db, "NotYetInTheDb");
+  assert ( event1 != NULL );
+  assert ( lwes_event_set_STRING (event1, key01, value01) == -1 );
+  assert ( lwes_event_type_db_add_event
+             (db, (LWES_SHORT_STRING)"NotYetInTheDb") == 0 );
+  assert ( lwes_event_type_db_add_attribute
+             (db, (LWES_SHORT_STRING)"NotYetInTheDb", key01,
+              (LWES_SHORT_STRING)"string") == 0 );
+  assert ( lwes_event_set_STRING (event1, key01, value01) == 1 );
+  assert ( lwes_event_set_BOOLEAN (event1, key02, value02) == -1 );
+  lwes_event_destroy (event1);
+
   lwes_event_type_db_destroy (db);
 }
 
@@ -318,6 +322,7 @@ test_event_without_db (void)
   LWES_BYTE bytes[MAX_MSG_SIZE];
   int size1;
   int size2;
+  size_t ser_size;
   int i;
 
   LWES_SHORT_STRING evnt_nm_o1;
@@ -359,19 +364,19 @@ test_event_without_db (void)
   assert ( strcmp (evnt_nm_o1, eventname) == 0 );
   assert ( lwes_event_set_STRING           (event1, key01, value01) ==  1 );
   assert ( lwes_event_set_BOOLEAN          (event1, key02, value02) ==  2 );
-  assert ( lwes_event_set_STRING           (event1, key02, value02s)==  3 );
-  assert ( lwes_event_set_IP_ADDR_w_string (event1, key03, value03s)==  4 );
-  assert ( lwes_event_set_U_INT_16         (event1, key04, value04) ==  5 );
-  assert ( lwes_event_set_U_INT_16         (event1, key05, value05) ==  6 );
-  assert ( lwes_event_set_INT_16           (event1, key06, value06) ==  7 );
-  assert ( lwes_event_set_U_INT_32         (event1, key07, value07) ==  8 );
-  assert ( lwes_event_set_INT_32           (event1, key08, value08) ==  9 );
-  assert ( lwes_event_set_U_INT_64         (event1, key09, value09) == 10 );
-  assert ( lwes_event_set_INT_64           (event1, key10, value10) == 11 );
-  assert ( lwes_event_set_STRING           (event1, key11, value11) == 12 );
-  assert ( lwes_event_set_IP_ADDR          (event1, key12, value12) == 13 );
+  assert ( lwes_event_set_STRING           (event1, key02, value02s)==  2 );
+  assert ( lwes_event_set_IP_ADDR_w_string (event1, key03, value03s)==  3 );
+  assert ( lwes_event_set_U_INT_16         (event1, key04, value04) ==  4 );
+  assert ( lwes_event_set_U_INT_16         (event1, key05, value05) ==  5 );
+  assert ( lwes_event_set_INT_16           (event1, key06, value06) ==  6 );
+  assert ( lwes_event_set_U_INT_32         (event1, key07, value07) ==  7 );
+  assert ( lwes_event_set_INT_32           (event1, key08, value08) ==  8 );
+  assert ( lwes_event_set_U_INT_64         (event1, key09, value09) ==  9 );
+  assert ( lwes_event_set_INT_64           (event1, key10, value10) == 10 );
+  assert ( lwes_event_set_STRING           (event1, key11, value11) == 11 );
+  assert ( lwes_event_set_IP_ADDR          (event1, key12, value12) == 12 );
   assert ( lwes_event_get_number_of_attributes ( event1, &nm_attr_o1) == 0 );
-  assert ( nm_attr_o1 == 13 );
+  assert ( nm_attr_o1 == 12 );
 
   size1 = lwes_event_to_bytes (event1,bytes,MAX_MSG_SIZE,0);
 
@@ -389,16 +394,21 @@ test_event_without_db (void)
   size2  = lwes_event_from_bytes (event2,bytes,size1,0,&dtmp);
 
   assert ( size1 == size2 );
+  assert ( lwes_event_get_serialized_size (event1, &ser_size) == 0 );
+  assert ( ser_size == (size_t)size1 );
+  assert ( ser_size == sizeof (ref_bytes_no_db) );
+  assert ( lwes_event_get_serialized_size (event2, &ser_size) == 0 );
+  assert ( ser_size == (size_t)size2 );
 
   assert ( lwes_event_get_name ( event2, &evnt_nm_o2) == 0 );
   assert ( strcmp (evnt_nm_o2, eventname) == 0 );
   assert ( strcmp (evnt_nm_o1, evnt_nm_o2) == 0 );
   assert ( lwes_event_get_number_of_attributes ( event2, &nm_attr_o2) == 0 );
-  assert ( nm_attr_o2 == 13 );
+  assert ( nm_attr_o2 == 12 );
   assert ( nm_attr_o2 == nm_attr_o1 );
 
   assert ( lwes_event_get_STRING   (event1, key01, &value01_o1) ==  0 );
-  assert ( lwes_event_get_BOOLEAN  (event1, key02, &value02_o1) ==  0 );
+  assert ( lwes_event_get_BOOLEAN  (event1, key02, &value02_o1) == -2 );
   assert ( lwes_event_get_STRING   (event1, key02, &value02s_o1)==  0 );
   assert ( lwes_event_get_IP_ADDR  (event1, key03, &value03_o1) ==  0 );
   assert ( lwes_event_get_U_INT_16 (event1, key04, &value04_o1) ==  0 );
@@ -412,7 +422,7 @@ test_event_without_db (void)
   assert ( lwes_event_get_IP_ADDR  (event1, key12, &value12_o1) ==  0 );
 
   assert ( lwes_event_get_STRING   (event2, key01, &value01_o2) ==  0 );
-  assert ( lwes_event_get_BOOLEAN  (event2, key02, &value02_o2) ==  0 );
+  assert ( lwes_event_get_BOOLEAN  (event2, key02, &value02_o2) == -2 );
   assert ( lwes_event_get_STRING   (event2, key02, &value02s_o2)==  0 );
   assert ( lwes_event_get_IP_ADDR  (event2, key03, &value03_o2) ==  0 );
   assert ( lwes_event_get_U_INT_16 (event2, key04, &value04_o2) ==  0 );
@@ -426,8 +436,8 @@ test_event_without_db (void)
   assert ( lwes_event_get_IP_ADDR  (event2, key12, &value12_o2) ==  0 );
 
   assert ( strcmp(value01_o1, value01_o2) == 0 ) ;
-  assert ( value02_o1 == value02_o2 );
-  assert ( strcmp(value02s_o1, value02s_o2) == 0 ) ;
+  assert ( strcmp (value02s_o1, value02s_o2) == 0 );
+  assert ( strcmp (value02s_o1, value02s) == 0 );
   assert ( value03_o1.s_addr == value03_o2.s_addr );
   assert ( value04_o1 == value04_o2 );
   assert ( value05_o1 == value05_o2 );
@@ -452,6 +462,7 @@ test_event_with_encoding (void)
   LWES_BYTE bytes[MAX_MSG_SIZE];
   int size1;
   int size2;
+  size_t ser_size;
   int i;
 
   LWES_SHORT_STRING evnt_nm_o1;
@@ -498,19 +509,19 @@ test_event_with_encoding (void)
   assert ( evnt_enc_o1 == encoding );
   assert ( lwes_event_set_STRING           (event1, key01, value01) ==  2 );
   assert ( lwes_event_set_BOOLEAN          (event1, key02, value02) ==  3 );
-  assert ( lwes_event_set_STRING           (event1, key02, value02s)==  4 );
-  assert ( lwes_event_set_IP_ADDR_w_string (event1, key03, value03s)==  5 );
-  assert ( lwes_event_set_U_INT_16         (event1, key04, value04) ==  6 );
-  assert ( lwes_event_set_U_INT_16         (event1, key05, value05) ==  7 );
-  assert ( lwes_event_set_INT_16           (event1, key06, value06) ==  8 );
-  assert ( lwes_event_set_U_INT_32         (event1, key07, value07) ==  9 );
-  assert ( lwes_event_set_INT_32           (event1, key08, value08) == 10 );
-  assert ( lwes_event_set_U_INT_64         (event1, key09, value09) == 11 );
-  assert ( lwes_event_set_INT_64           (event1, key10, value10) == 12 );
-  assert ( lwes_event_set_STRING           (event1, key11, value11) == 13 );
-  assert ( lwes_event_set_IP_ADDR          (event1, key12, value12) == 14 );
+  assert ( lwes_event_set_STRING           (event1, key02, value02s)==  3 );
+  assert ( lwes_event_set_IP_ADDR_w_string (event1, key03, value03s)==  4 );
+  assert ( lwes_event_set_U_INT_16         (event1, key04, value04) ==  5 );
+  assert ( lwes_event_set_U_INT_16         (event1, key05, value05) ==  6 );
+  assert ( lwes_event_set_INT_16           (event1, key06, value06) ==  7 );
+  assert ( lwes_event_set_U_INT_32         (event1, key07, value07) ==  8 );
+  assert ( lwes_event_set_INT_32           (event1, key08, value08) ==  9 );
+  assert ( lwes_event_set_U_INT_64         (event1, key09, value09) == 10 );
+  assert ( lwes_event_set_INT_64           (event1, key10, value10) == 11 );
+  assert ( lwes_event_set_STRING           (event1, key11, value11) == 12 );
+  assert ( lwes_event_set_IP_ADDR          (event1, key12, value12) == 13 );
   assert ( lwes_event_get_number_of_attributes ( event1, &nm_attr_o1) == 0 );
-  assert ( nm_attr_o1 == 14 );
+  assert ( nm_attr_o1 == 13 );
 
   size1 = lwes_event_to_bytes (event1,bytes,MAX_MSG_SIZE,0);
 
@@ -528,6 +539,11 @@ test_event_with_encoding (void)
   size2  = lwes_event_from_bytes (event2,bytes,size1,0,&dtmp);
 
   assert ( size1 == size2 );
+  assert ( lwes_event_get_serialized_size (event1, &ser_size) == 0 );
+  assert ( ser_size == (size_t)size1 );
+  assert ( ser_size == sizeof (ref_bytes_encoding_no_db) );
+  assert ( lwes_event_get_serialized_size (event2, &ser_size) == 0 );
+  assert ( ser_size == (size_t)size2 );
 
   assert ( lwes_event_get_name ( event2, &evnt_nm_o2) == 0 );
   assert ( strcmp (evnt_nm_o2, eventname) == 0 );
@@ -536,11 +552,11 @@ test_event_with_encoding (void)
   assert ( evnt_enc_o2 == encoding );
   assert ( evnt_enc_o2 == evnt_enc_o1 );
   assert ( lwes_event_get_number_of_attributes ( event2, &nm_attr_o2) == 0 );
-  assert ( nm_attr_o2 == 14 );
+  assert ( nm_attr_o2 == 13 );
   assert ( nm_attr_o2 == nm_attr_o1 );
 
   assert ( lwes_event_get_STRING   (event1, key01, &value01_o1) ==  0 );
-  assert ( lwes_event_get_BOOLEAN  (event1, key02, &value02_o1) ==  0 );
+  assert ( lwes_event_get_BOOLEAN  (event1, key02, &value02_o1) == -2 );
   assert ( lwes_event_get_STRING   (event1, key02, &value02s_o1)==  0 );
   assert ( lwes_event_get_IP_ADDR  (event1, key03, &value03_o1) ==  0 );
   assert ( lwes_event_get_U_INT_16 (event1, key04, &value04_o1) ==  0 );
@@ -554,7 +570,7 @@ test_event_with_encoding (void)
   assert ( lwes_event_get_IP_ADDR  (event1, key12, &value12_o1) ==  0 );
 
   assert ( lwes_event_get_STRING   (event2, key01, &value01_o2) ==  0 );
-  assert ( lwes_event_get_BOOLEAN  (event2, key02, &value02_o2) ==  0 );
+  assert ( lwes_event_get_BOOLEAN  (event2, key02, &value02_o2) == -2 );
   assert ( lwes_event_get_STRING   (event2, key02, &value02s_o2)==  0 );
   assert ( lwes_event_get_IP_ADDR  (event2, key03, &value03_o2) ==  0 );
   assert ( lwes_event_get_U_INT_16 (event2, key04, &value04_o2) ==  0 );
@@ -568,8 +584,8 @@ test_event_with_encoding (void)
   assert ( lwes_event_get_IP_ADDR  (event2, key12, &value12_o2) ==  0 );
 
   assert ( strcmp(value01_o1, value01_o2) == 0 ) ;
-  assert ( value02_o1 == value02_o2 );
-  assert ( strcmp(value02s_o1, value02s_o2) == 0 ) ;
+  assert ( strcmp (value02s_o1, value02s_o2) == 0 );
+  assert ( strcmp (value02s_o1, value02s) == 0 );
   assert ( value03_o1.s_addr == value03_o2.s_addr );
   assert ( value04_o1 == value04_o2 );
   assert ( value05_o1 == value05_o2 );
@@ -616,81 +632,96 @@ test_error_and_boundary_conditions (void)
   null_at      = 1;
   assert (lwes_event_create_with_encoding (NULL, "Foo", 1) == NULL);
 
-  /* cause lwes_hash_create to fail */
-  malloc_count = 0;
-  null_at      = 0;
-  hash_null    = 1;
-  assert (lwes_event_create_no_name (NULL) == NULL);
-  assert (lwes_event_create (NULL, "Foo") == NULL);
-  assert (lwes_event_create_with_encoding (NULL, "Foo", 1) == NULL);
-  hash_null    = 0;
-
-  /* cause lwes_set_name to fail in creates */
-  malloc_count = 0;
-  null_at      = 2;
-  assert (lwes_event_create (NULL, "Foo") == NULL);
-
+  /* names and attributes are stored with the event, so once it is
+     created nothing else is allocated until that storage is used up */
   malloc_count = 0;
   null_at      = 2;
-  assert (lwes_event_create_with_encoding (NULL, "Foo", 1) == NULL);
+  assert ((event = lwes_event_create_with_encoding (NULL, "Foo", 1)) != NULL);
+  assert (malloc_count == 1);
+  assert (lwes_event_destroy (event) == 0);
 
-  /* cause lwes_set_encoding to fail in create */
-  malloc_count = 0;
-  null_at      = 3;
-  assert (lwes_event_create_with_encoding (NULL, "Foo", 1) == NULL);
   null_at      = 0;
 
   assert ((event = lwes_event_create (NULL, "Foo")) != NULL);
 
-  /* 1st round is malloc of attribute value failures */
-  /* 2nd round is malloc of attribute name failures */
-  /* 3rd round is failure to create attribute structure */
-  /* 4th round is hash put failing */
-  for ( i = 1 ; i < 5 ; i++ )
+  /* failure to grow the storage of the event */
+  for ( i = 0 ; i < 12 ; i++ )
     {
-      if ( i == 4 )
-        {
-          put_null = 1;
-          null_at  = 0;
-        }
-      else
+      use_up_storage (event, 0);
+      malloc_count = 0;
+      null_at      = 1;
+      switch (i)
         {
-          null_at      = i;
+          case 0:
+            assert (lwes_event_set_U_INT_16 (event, "Bar", 10) == -3);
+            break;
+          case 1:
+            assert (lwes_event_set_INT_16 (event, "Bar", 10) == -3);
+            break;
+          case 2:
+            assert (lwes_event_set_U_INT_32 (event, "Bar", 10) == -3);
+            break;
+          case 3:
+            assert (lwes_event_set_INT_32 (event, "Bar", 10) == -3);
+            break;
+          case 4:
+            assert (lwes_event_set_U_INT_64 (event, "Bar", 10) == -3);
+            break;
+          case 5:
+            assert (lwes_event_set_INT_64 (event, "Bar", 10) == -3);
+            break;
+          case 6:
+            assert (lwes_event_set_U_INT_64_w_string (event, "Bar",
+                                                      "feedabbadeadbeef")
+                    == -3);
+            break;
+          case 7:
+            assert (lwes_event_set_INT_64_w_string (event, "Bar",
+                                                    "feedabbadeadbeaf")
+                    == -3);
+            break;
+          case 8:
+            assert (lwes_event_set_STRING (event, "Bar", "feedabbadeadbeaf")
+                    == -3);
+            break;
+          case 9:
+            assert (lwes_event_set_IP_ADDR (event, "Bar", value12) == -3);
+            break;
+          case 10:
+            assert (lwes_event_set_IP_ADDR_w_string (event, "Bar", "127.0.0.1")
+                    == -3);
+            break;
+          case 11:
+            assert (lwes_event_set_BOOLEAN (event, "Bar", 1) == -3);
+            break;
         }
-
-      malloc_count = 0;
-      assert (lwes_event_set_U_INT_16 (event, "Bar", 10) == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_INT_16 (event, "Bar", 10) == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_U_INT_32 (event, "Bar", 10) == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_INT_32 (event, "Bar", 10) == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_U_INT_64 (event, "Bar", 10) == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_INT_64 (event, "Bar", 10) == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_U_INT_64_w_string (event, "Bar", "feedabbadeadbeef")
-              == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_INT_64_w_string (event, "Bar", "feedabbadeadbeaf")
-              == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_STRING (event, "Bar", "feedabbadeadbeaf") == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_IP_ADDR (event, "Bar", value12) == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_IP_ADDR_w_string (event, "Bar", "127.0.0.1")
-              == -3);
-      malloc_count = 0;
-      assert (lwes_event_set_BOOLEAN (event, "Bar", 1) == -3);
+      assert (malloc_count == 1);
     }
 
   /* reset error counters */
   malloc_count = 0;
   null_at = 0;
-  put_null = 0;
+
+  /* values larger than a block get a block of their own, and the
+     storage of the event carries on being used after them */
+  assert (lwes_event_destroy (event) == 0);
+  assert ((event = lwes_event_create (NULL, "Foo")) != NULL);
+  malloc_count = 0;
+  {
+    char big[LWES_EVENT_ARENA_SIZE * 3];
+    memset (big, 'x', sizeof (big) - 1);
+    big[sizeof (big) - 1] = '\0';
+    assert (lwes_event_set_STRING (event, "Big", big) == 1);
+    assert (malloc_count == 1);
+    assert (lwes_event_get_STRING (event, "Big", &value_string) == 0);
+    assert (strcmp (value_string, big) == 0);
+    assert (lwes_event_set_BOOLEAN (event, "Small", 1) == 2);
+    assert (malloc_count == 1);
+    assert (lwes_event_get_BOOLEAN (event, "Small", &value_bool) == 0);
+    assert (value_bool == 1);
+    assert (lwes_event_destroy (event) == 0);
+    assert ((event = lwes_event_create (NULL, "Foo")) != NULL);
+  }
 
   /* few remaining set cases */
   assert (lwes_event_set_U_INT_64_w_string (event, "Bar", "zzww") == -2);
@@ -784,6 +815,7 @@ test_null_args (void)
   LWES_SHORT_STRING tmp_event_name;
   LWES_U_INT_16     tmp_num_attrs;
   LWES_INT_16       tmp_encoding;
+  size_t            tmp_size;
 
   LWES_U_INT_16     value_uint16;
   LWES_INT_16       value_int16;
@@ -899,6 +931,9 @@ test_null_args (void)
   assert (lwes_event_get_BOOLEAN  (event, NULL,  &value_bool)   == -1);
   assert (lwes_event_get_BOOLEAN  (event, "Bar", NULL)          == -1);
 
+  assert (lwes_event_get_serialized_size (NULL,  &tmp_size) == -1);
+  assert (lwes_event_get_serialized_size (event, NULL)       == -1);
+
   assert (lwes_event_to_bytes (NULL,  tmp_buf, 50,  0) == -1);
   assert (lwes_event_to_bytes (event, NULL,    50,  0) == -1);
   assert (lwes_event_to_bytes (event, tmp_buf,  0,  0) == -1);
@@ -931,13 +966,10 @@ test_serialize_errors (void)
     assert (lwes_event_to_bytes (event, bytes, 5, 0) == -2);
     assert (lwes_event_to_bytes (event, bytes, 8, 0) == -2);
     assert (lwes_event_to_bytes (event, bytes, 10, 0) == -2);
-    /* test nulls at various states */
-    lwes_hash_get_type_error = 1;
+    /* test a bad type for the encoding */
+    lwes_event_get_attribute (event, LWES_ENCODING)->type =
+      LWES_U_INT_16_TOKEN;
     assert (lwes_event_to_bytes (event, bytes, 15, 0) == -3);
-    lwes_hash_get_type_error = 0;
-    lwes_hash_get_value_error = 1;
-    assert (lwes_event_to_bytes (event, bytes, 15, 0) == -4);
-    lwes_hash_get_value_error = 0;
     lwes_event_destroy (event);
   }
 
@@ -1089,8 +1121,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-2);
     malloc_count = 0;
     null_at = 0;
@@ -1114,8 +1147,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-4);
     malloc_count = 0;
     null_at = 0;
@@ -1139,8 +1173,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-6);
     malloc_count = 0;
     null_at = 0;
@@ -1164,8 +1199,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-8);
     malloc_count = 0;
     null_at = 0;
@@ -1189,8 +1225,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-10);
     malloc_count = 0;
     null_at = 0;
@@ -1214,8 +1251,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-12);
     malloc_count = 0;
     null_at = 0;
@@ -1239,8 +1277,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-14);
     malloc_count = 0;
     null_at = 0;
@@ -1264,8 +1303,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-16);
     malloc_count = 0;
     null_at = 0;
@@ -1289,8 +1329,9 @@ test_deserialize_errors (void)
 
     /* THEN fail to set a field */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, strlen (name));
     malloc_count = 0;
-    null_at = 2;
+    null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp)==-18);
     malloc_count = 0;
     null_at = 0;
@@ -1371,6 +1412,7 @@ test_deserialize_errors (void)
 
     /* fail to deserialize it */
     assert ((event = lwes_event_create_no_name (NULL)) != NULL);
+    use_up_storage (event, 0);
     malloc_count = 0;
     null_at = 1;
     assert (lwes_event_from_bytes (event, bytes, MAX_MSG_SIZE, 0, &dtmp) == -24);
@@ -1536,6 +1578,1233 @@ test_enumeration (void)
   lwes_event_destroy (event1);
 }
 
+static void
+test_reset (void)
+{
+  struct lwes_event *event1;
+  struct lwes_event *event2;
+  struct lwes_event_deserialize_tmp dtmp;
+  LWES_BYTE bytes[MAX_MSG_SIZE];
+  LWES_SHORT_STRING name_o;
+  LWES_LONG_STRING  string_o;
+  LWES_U_INT_16     uint16_o;
+  LWES_U_INT_16     num_attrs;
+  char big[LWES_EVENT_ARENA_SIZE * 3];
+  size_t ser_size;
+  int size;
+  int i;
+
+  assert (lwes_event_reset (NULL) == -1);
+
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  assert (lwes_event_set_STRING   (event1, key01, value01) == 1);
+  assert (lwes_event_set_U_INT_16 (event1, key04, value04) == 2);
+  assert ((size = lwes_event_to_bytes (event1, bytes, MAX_MSG_SIZE, 0)) > 0);
+
+  /* reset empties the event */
+  assert (lwes_event_reset (event1) == 0);
+  assert (lwes_event_get_name (event1, &name_o) == 0);
+  assert (name_o == NULL);
+  assert (lwes_event_get_serialized_size (event1, &ser_size) == 0);
+  assert (ser_size == 3);
+  assert (lwes_event_get_number_of_attributes (event1, &num_attrs) == 0);
+  assert (num_attrs == 0);
+  assert (lwes_event_get_STRING (event1, key01, &string_o) == -1);
+  assert (lwes_event_get_U_INT_16 (event1, key04, &uint16_o) == -1);
+
+  /* and it can then be filled again without allocating */
+  malloc_count = 0;
+  for (i = 0; i < 10; i++)
+    {
+      assert (lwes_event_reset (event1) == 0);
+      assert (lwes_event_from_bytes (event1, bytes, size, 0, &dtmp) == size);
+      assert (lwes_event_get_name (event1, &name_o) == 0);
+      assert (strcmp (name_o, eventname) == 0);
+      assert (lwes_event_get_STRING (event1, key01, &string_o) == 0);
+      assert (strcmp (string_o, value01) == 0);
+      assert (lwes_event_get_U_INT_16 (event1, key04, &uint16_o) == 0);
+      assert (uint16_o == value04);
+      assert (lwes_event_get_number_of_attributes (event1, &num_attrs) == 0);
+      assert (num_attrs == 2);
+      assert (lwes_event_get_serialized_size (event1, &ser_size) == 0);
+      assert (ser_size == (size_t)size);
+    }
+  assert (malloc_count == 0);
+
+  /* storage which was grown is kept across resets */
+  assert (lwes_event_reset (event1) == 0);
+  assert (lwes_event_set_name (event1, eventname) == 0);
+  for (i = 0; i < 100; i++)
+    {
+      char attr_name[16];
+      sprintf (attr_name, "attr%d", i);
+      assert (lwes_event_set_U_INT_16 (event1, attr_name, i) == i + 1);
+    }
+  assert (malloc_count > 0);
+  for (i = 0; i < 10; i++)
+    {
+      int j;
+      assert (lwes_event_reset (event1) == 0);
+      malloc_count = 0;
+      assert (lwes_event_set_name (event1, eventname) == 0);
+      for (j = 0; j < 100; j++)
+        {
+          char attr_name[16];
+          sprintf (attr_name, "attr%d", j);
+          assert (lwes_event_set_U_INT_16 (event1, attr_name, j) == j + 1);
+        }
+      /* after the first time the block kept is large enough for it all */
+      assert (i == 0 || malloc_count == 0);
+    }
+
+  /* values too large to share a block are let go of */
+  memset (big, 'x', sizeof (big) - 1);
+  big[sizeof (big) - 1] = '\0';
+  assert (lwes_event_set_STRING (event1, "Big", big) == 101);
+  assert (lwes_event_reset (event1) == 0);
+  assert (lwes_event_get_STRING (event1, "Big", &string_o) == -1);
+
+  /* the event is as good as a new one */
+  event2 = lwes_event_create_no_name (NULL);
+  assert (event2 != NULL);
+  assert (lwes_event_from_bytes (event1, bytes, size, 0, &dtmp) == size);
+  assert (lwes_event_from_bytes (event2, bytes, size, 0, &dtmp) == size);
+  assert (lwes_event_to_bytes (event1, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (lwes_event_to_bytes (event2, bytes, MAX_MSG_SIZE, 0) == size);
+
+  assert (lwes_event_destroy (event1) == 0);
+  assert (lwes_event_destroy (event2) == 0);
+}
+
+static void
+test_many_attributes (void)
+{
+  struct lwes_event *event1;
+  struct lwes_event *event2;
+  struct lwes_event_deserialize_tmp dtmp;
+  struct lwes_event_enumeration e;
+  LWES_CONST_SHORT_STRING key;
+  LWES_TYPE type;
+  LWES_BYTE bytes[MAX_MSG_SIZE];
+  LWES_U_INT_16 uint16_o;
+  LWES_BYTE bytes2[MAX_MSG_SIZE];
+  char attr_name[16];
+  size_t ser_size;
+  int size;
+  int i;
+
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+
+  /* the small attributes are scanned, names of the same length and the
+   * same first bytes are told apart */
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES; i++)
+    {
+      sprintf (attr_name, "attribute%02d", i);
+      assert (lwes_event_set_U_INT_16 (event1, attr_name, i) == i + 1);
+    }
+  assert (event1->attributes == NULL);
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES; i++)
+    {
+      sprintf (attr_name, "attribute%02d", i);
+      assert (lwes_event_get_U_INT_16 (event1, attr_name, &uint16_o) == 0);
+      assert (uint16_o == i);
+    }
+  assert (lwes_event_get_U_INT_16 (event1, "attribute99", &uint16_o) == -1);
+  assert (lwes_event_get_U_INT_16 (event1, "attribute0", &uint16_o) == -1);
+  /* as are those whose first bytes differ in just one half */
+  assert (lwes_event_get_U_INT_16 (event1, "attrXbute05", &uint16_o) == -1);
+  assert (lwes_event_get_U_INT_16 (event1, "Xttribute05", &uint16_o) == -1);
+
+  /* failing to make room for more, or to switch over to a hash, leaves
+   * the event as it was */
+  use_up_storage (event1, 12);
+  for (i = 1; i <= 2; i++)
+    {
+      malloc_count = 0;
+      null_at = i;
+      assert (lwes_event_set_U_INT_16 (event1, "attribute16", 16) == -3);
+      null_at = 0;
+      assert (event1->attributes == NULL);
+      assert (lwes_event_get_number_of_attributes (event1, &uint16_o) == 0);
+      assert (uint16_o == LWES_EVENT_SMALL_ATTRIBUTES);
+      assert (lwes_event_get_U_INT_16 (event1, "attribute15", &uint16_o) == 0);
+      assert (uint16_o == 15);
+    }
+
+  /* one more and they move into a hash */
+  for (i = LWES_EVENT_SMALL_ATTRIBUTES; i < 40; i++)
+    {
+      sprintf (attr_name, "attribute%02d", i);
+      assert (lwes_event_set_U_INT_16 (event1, attr_name, i) == i + 1);
+    }
+  assert (event1->attributes != NULL);
+  for (i = 0; i < 40; i++)
+    {
+      sprintf (attr_name, "attribute%02d", i);
+      assert (lwes_event_get_U_INT_16 (event1, attr_name, &uint16_o) == 0);
+      assert (uint16_o == i);
+    }
+
+  /* every attribute is enumerated in the order it was set */
+  assert (lwes_event_keys (event1, &e));
+  for (i = 0; lwes_event_enumeration_next_element (&e, &key, &type); i++)
+    {
+      sprintf (attr_name, "attribute%02d", i);
+      assert (type == LWES_U_INT_16_TOKEN);
+      assert (strcmp (key, attr_name) == 0);
+    }
+  assert (i == 40);
+
+  assert ((size = lwes_event_to_bytes (event1, bytes, MAX_MSG_SIZE, 0)) > 0);
+  event2 = lwes_event_create_no_name (NULL);
+  assert (event2 != NULL);
+  assert (lwes_event_from_bytes (event2, bytes, size, 0, &dtmp) == size);
+  for (i = 0; i < 40; i++)
+    {
+      sprintf (attr_name, "attribute%02d", i);
+      assert (lwes_event_get_U_INT_16 (event2, attr_name, &uint16_o) == 0);
+      assert (uint16_o == i);
+    }
+
+  /* and serialized in that order, so a copy serializes the same */
+  assert (lwes_event_to_bytes (event2, bytes2, MAX_MSG_SIZE, 0) == size);
+  assert (lwes_event_get_serialized_size (event1, &ser_size) == 0);
+  assert (ser_size == (size_t)size);
+  assert (memcmp (bytes, bytes2, size) == 0);
+
+  /* after a reset the event starts out small again */
+  assert (lwes_event_reset (event1) == 0);
+  assert (event1->attributes == NULL);
+  assert (lwes_event_get_U_INT_16 (event1, "attribute00", &uint16_o) == -1);
+  assert (lwes_event_from_bytes (event1, bytes, size, 0, &dtmp) == size);
+  assert (lwes_event_get_U_INT_16 (event1, "attribute39", &uint16_o) == 0);
+  assert (uint16_o == 39);
+
+  assert (lwes_event_destroy (event1) == 0);
+  assert (lwes_event_destroy (event2) == 0);
+}
+
+static void
+test_shared_names (void)
+{
+  struct lwes_event *event1;
+  struct lwes_event *event2;
+  struct lwes_event_deserialize_tmp dtmp;
+  struct lwes_event_enumeration e1;
+  struct lwes_event_enumeration e2;
+  LWES_CONST_SHORT_STRING key1;
+  LWES_CONST_SHORT_STRING key2;
+  LWES_SHORT_STRING name1;
+  LWES_SHORT_STRING name2;
+  LWES_TYPE type;
+  LWES_BYTE bytes[MAX_MSG_SIZE];
+  LWES_U_INT_16 uint16_o;
+  int size;
+
+  /* events hold the shared copy of their names rather than their own */
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  assert (lwes_event_set_U_INT_16 (event1, key04, value04) == 1);
+  assert ((size = lwes_event_to_bytes (event1, bytes, MAX_MSG_SIZE, 0)) > 0);
+  event2 = lwes_event_create_no_name (NULL);
+  assert (event2 != NULL);
+  assert (lwes_event_from_bytes (event2, bytes, size, 0, &dtmp) == size);
+
+  assert (lwes_event_get_name (event1, &name1) == 0);
+  assert (lwes_event_get_name (event2, &name2) == 0);
+  assert (name1 != eventname);
+  assert (name1 == name2);
+  assert (name1 == lwes_intern (eventname, strlen (eventname)));
+
+  assert (lwes_event_keys (event1, &e1));
+  assert (lwes_event_keys (event2, &e2));
+  assert (lwes_event_enumeration_next_element (&e1, &key1, &type));
+  assert (lwes_event_enumeration_next_element (&e2, &key2, &type));
+  assert (key1 == key2);
+
+  /* and can be looked up by their shared copy */
+  assert (lwes_event_get_U_INT_16 (event2, key1, &uint16_o) == 0);
+  assert (uint16_o == value04);
+
+  assert (lwes_event_destroy (event1) == 0);
+  assert (lwes_event_destroy (event2) == 0);
+}
+
+/* serialize an event the long way, without the bytes it keeps */
+static int
+serialize_afresh (struct lwes_event *event, LWES_BYTE_P bytes)
+{
+  LWES_BYTE valid = event->serialized_valid;
+  int size;
+
+  event->serialized_valid = 0;
+  size = lwes_event_marshall (event, bytes, MAX_MSG_SIZE, 0);
+  event->serialized_valid = valid;
+  return size;
+}
+
+static void
+test_serialized_bytes (void)
+{
+  struct lwes_event *event;
+  struct lwes_event *decoded;
+  union lwes_event_attribute_value value;
+  LWES_BYTE bytes[MAX_MSG_SIZE];
+  LWES_BYTE expected[MAX_MSG_SIZE];
+  struct lwes_event_deserialize_tmp dtmp;
+  LWES_INT_32 int32_o;
+  char big[5000];
+  size_t ser_size;
+  int size;
+  int i;
+
+  event = lwes_event_create (NULL, eventname);
+  assert (event != NULL);
+  assert (lwes_event_set_STRING   (event, key01, value01) == 1);
+  assert (lwes_event_set_INT_32   (event, key08, value08) == 2);
+  assert (lwes_event_set_U_INT_64 (event, key09, value09) == 3);
+  assert (lwes_event_set_IP_ADDR  (event, key12, value12) == 4);
+
+  /* the first time it is serialized nothing is kept */
+  malloc_count = 0;
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+  assert (malloc_count == 0);
+  assert (event->serialized_valid == 0);
+
+  /* the second time the bytes are kept, then reused */
+  for (i = 0; i < 3; i++)
+    {
+      memset (bytes, 0, size);
+      assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 5) == size);
+      assert (event->serialized_valid == 1);
+      assert (serialize_afresh (event, expected) == size);
+      assert (memcmp (bytes + 5, expected, size) == 0);
+    }
+  assert (malloc_count == 1);
+
+  /* a changed value is rewritten where it was */
+  value.int_32 = 12345;
+  assert (lwes_event_update (event, 1, LWES_INT_32_TOKEN, &value) == 0);
+  assert (lwes_event_update (event, 1, LWES_INT_32_TOKEN, &value) == 0);
+  assert (event->dirty_attributes == 1);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (event->dirty_attributes == 0);
+  assert (event->serialized_valid == 1);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+  assert (lwes_event_get_INT_32 (event, key08, &int32_o) == 0);
+  assert (int32_o == 12345);
+
+  /* as is a string of the same length */
+  value.string = (LWES_LONG_STRING)"http://www.best.com";
+  assert (lwes_event_update (event, 0, LWES_STRING_TOKEN, &value) == 0);
+  assert (event->serialized_valid == 1);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+
+  /* but a string of another length moves everything after it */
+  value.string = (LWES_LONG_STRING)"http://www.test.com/longer";
+  assert (lwes_event_update (event, 0, LWES_STRING_TOKEN, &value) == 0);
+  assert (event->serialized_valid == 0);
+  assert (lwes_event_get_serialized_size (event, &ser_size) == 0);
+  assert (ser_size == (size_t)size + 7);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size + 7);
+  size += 7;
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+
+  /* attributes set since are added on */
+  assert (lwes_event_set_BOOLEAN (event, key02, value02) == 5);
+  assert (event->serialized_valid == 1);
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+  assert (event->serialized_attributes == 5);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+
+  /* apart from the encoding, which goes ahead of the rest */
+  assert (lwes_event_set_encoding (event, 1) == 6);
+  assert (event->serialized_valid == 0);
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+
+  /* a changed encoding is rewritten where it was as well */
+  value.int_16 = 2;
+  assert (lwes_event_update (event, 5, LWES_INT_16_TOKEN, &value) == 0);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+
+  /* too small an array is still reported as before, and a value changed
+   * before it is still sent once there is room */
+  value.int_16 = 3;
+  assert (lwes_event_update (event, 5, LWES_INT_16_TOKEN, &value) == 0);
+  assert (event->dirty_attributes == 1);
+  assert (lwes_event_to_bytes (event, bytes, size - 1, 0) == -13);
+  assert (event->dirty_attributes == 0);
+  assert (lwes_event_to_bytes (event, bytes, 20, 0) < 0);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+  value.int_32 = 54321;
+  assert (lwes_event_update (event, 1, LWES_INT_32_TOKEN, &value) == 0);
+  assert (lwes_event_to_bytes (event, bytes, 20, 0) < 0);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (event->serialized_valid == 1);
+  decoded = lwes_event_create_no_name (NULL);
+  assert (decoded != NULL);
+  assert (lwes_event_from_bytes (decoded, bytes, size, 0, &dtmp) == size);
+  assert (lwes_event_get_INT_32 (decoded, key08, &int32_o) == 0);
+  assert (int32_o == 54321);
+  assert (lwes_event_destroy (decoded) == 0);
+  assert (lwes_event_update (event, 6, LWES_INT_16_TOKEN, &value) == -1);
+  assert (lwes_event_update (event, -1, LWES_INT_16_TOKEN, &value) == -1);
+  assert (lwes_event_update (NULL, 0, LWES_INT_16_TOKEN, &value) == -1);
+  assert (lwes_event_update (event, 0, LWES_INT_16_TOKEN, NULL) == -1);
+
+  /* failing to make room to keep the bytes just serializes them */
+  assert (lwes_event_set_STRING (event, key11, value11) == 7);
+  memset (big, 'x', sizeof (big) - 1);
+  big[sizeof (big) - 1] = '\0';
+  assert (lwes_event_set_STRING (event, "Big", big) == 8);
+  for (i = 1; i >= 0; i--)
+    {
+      malloc_count = 0;
+      null_at = i;
+      assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+      null_at = 0;
+      assert (serialize_afresh (event, expected) == size);
+      assert (memcmp (bytes, expected, size) == 0);
+    }
+
+  /* nor when the bytes kept can't grow, as the event is serialized
+   * straight into the array without them */
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (event->serialized_valid == 1);
+  value.int_32 = 7;
+  assert (lwes_event_update (event, 1, LWES_INT_32_TOKEN, &value) == 0);
+  assert (event->dirty_attributes == 1);
+  assert (lwes_event_set_STRING (event, "Bigger", big) == 9);
+  malloc_count = 0;
+  null_at = 1;
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+  null_at = 0;
+  assert (event->serialized_valid == 0);
+  assert (event->dirty_attributes == 0);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+  value.int_32 = 8;
+  assert (lwes_event_update (event, 1, LWES_INT_32_TOKEN, &value) == 0);
+  for (i = 0; i < 2; i++)
+    {
+      assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+      assert (serialize_afresh (event, expected) == size);
+      assert (memcmp (bytes, expected, size) == 0);
+    }
+  assert (event->serialized_valid == 1);
+  assert (lwes_event_get_INT_32 (event, key08, &int32_o) == 0);
+  assert (int32_o == 8);
+
+  /* the bytes are kept when the event is reset */
+  assert (lwes_event_reset (event) == 0);
+  assert (lwes_event_set_name (event, eventname) == 0);
+  assert (lwes_event_set_INT_32 (event, key08, value08) == 1);
+  malloc_count = 0;
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+  assert (event->serialized_valid == 0);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (event->serialized_valid == 1);
+  assert (malloc_count == 0);
+
+  assert (lwes_event_destroy (event) == 0);
+
+  /* exactly the room the event takes is enough, with nothing written past
+   * it, and any less is reported where it runs out */
+  event = lwes_event_create_with_encoding (NULL, eventname, 1);
+  assert (event != NULL);
+  assert (lwes_event_set_INT_32   (event, key08, value08) == 2);
+  assert (lwes_event_set_IP_ADDR  (event, key12, value12) == 3);
+  assert (lwes_event_set_STRING   (event, key01, value01) == 4);
+  assert (lwes_event_get_serialized_size (event, &ser_size) == 0);
+  memset (bytes, 0xab, ser_size + 1);
+  assert (lwes_event_to_bytes (event, bytes, ser_size, 0) == (int)ser_size);
+  assert (bytes[ser_size] == 0xab);
+  assert (lwes_event_to_bytes (event, expected, ser_size, 0)
+          == (int)ser_size);
+  assert (memcmp (bytes, expected, ser_size) == 0);
+  assert (lwes_event_destroy (event) == 0);
+  event = lwes_event_create_no_name (NULL);
+  assert (event != NULL);
+  assert (lwes_event_from_bytes (event, bytes, ser_size, 0, &dtmp)
+          == (int)ser_size);
+  assert (lwes_event_to_bytes (event, expected, ser_size - 1, 0) == -15);
+  assert (lwes_event_to_bytes (event, expected, ser_size, 0)
+          == (int)ser_size);
+  assert (memcmp (bytes, expected, ser_size) == 0);
+  assert (lwes_event_destroy (event) == 0);
+
+  /* names too long to serialize are caught without checking for room */
+  memset (big, 'x', SHORT_STRING_MAX);
+  big[SHORT_STRING_MAX] = '\0';
+  event = lwes_event_create (NULL, eventname);
+  assert (event != NULL);
+  assert (lwes_event_set_INT_32 (event, big, 1) == 1);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == -5);
+  assert (lwes_event_destroy (event) == 0);
+  event = lwes_event_create (NULL, big);
+  assert (event != NULL);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == -17);
+  assert (lwes_event_destroy (event) == 0);
+}
+
+static void
+test_projection (void)
+{
+  struct lwes_event *event;
+  struct lwes_event *projected;
+  struct lwes_event_projection *projection;
+  struct lwes_event_deserialize_tmp dtmp;
+  LWES_BYTE bytes[MAX_MSG_SIZE];
+  LWES_U_INT_16 number_o;
+  LWES_INT_32 int32_o;
+  LWES_BOOLEAN boolean_o;
+  LWES_LONG_STRING string_o;
+  LWES_IP_ADDR ip_o;
+  int size;
+  int i;
+
+  event = lwes_event_create (NULL, eventname);
+  assert (event != NULL);
+  assert (lwes_event_set_STRING   (event, key01, value01) == 1);
+  assert (lwes_event_set_BOOLEAN  (event, key02, value02) == 2);
+  assert (lwes_event_set_INT_32   (event, key08, value08) == 3);
+  assert (lwes_event_set_U_INT_64 (event, key09, value09) == 4);
+  assert (lwes_event_set_IP_ADDR  (event, key12, value12) == 5);
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+
+  malloc_count = 0;
+  null_at = 1;
+  assert (lwes_event_projection_create () == NULL);
+  null_at = 0;
+
+  projection = lwes_event_projection_create ();
+  assert (projection != NULL);
+  projected = lwes_event_create_no_name (NULL);
+  assert (projected != NULL);
+
+  assert (lwes_event_projection_add (NULL, NULL, key08) == -1);
+  assert (lwes_event_projection_add (projection, NULL, NULL) == -1);
+  assert (lwes_event_from_bytes_projected (projected, bytes, size, 0,
+                                           &dtmp, NULL) == -1);
+  assert (lwes_event_from_bytes_projected (NULL, bytes, size, 0,
+                                           &dtmp, projection) == -1);
+
+  /* wanting nothing still goes over the whole event */
+  assert (lwes_event_from_bytes_projected (projected, bytes, size, 0,
+                                           &dtmp, projection) == size);
+  assert (lwes_event_get_number_of_attributes (projected, &number_o) == 0);
+  assert (number_o == 0);
+  assert (strcmp (projected->eventName, eventname) == 0);
+
+  /* attributes wanted from every event and from events of the name */
+  assert (lwes_event_projection_add (projection, NULL, key08) == 0);
+  assert (lwes_event_projection_add (projection, NULL, key08) == 0);
+  assert (lwes_event_projection_add (projection, eventname, key12) == 0);
+  assert (lwes_event_projection_add (projection, "Other", key02) == 0);
+  assert (lwes_event_projection_add (projection, NULL, "notThere") == 0);
+  assert (lwes_event_reset (projected) == 0);
+  assert (lwes_event_from_bytes_projected (projected, bytes, size, 0,
+                                           &dtmp, projection) == size);
+  assert (lwes_event_get_number_of_attributes (projected, &number_o) == 0);
+  assert (number_o == 2);
+  assert (lwes_event_get_INT_32 (projected, key08, &int32_o) == 0);
+  assert (int32_o == value08);
+  assert (lwes_event_get_IP_ADDR (projected, key12, &ip_o) == 0);
+  assert (ip_o.s_addr == value12.s_addr);
+  assert (lwes_event_get_BOOLEAN (projected, key02, &boolean_o) == -1);
+  assert (lwes_event_get_U_INT_64 (projected, key09, NULL) == -1);
+
+  /* a skipped string isn't copied out */
+  memset (dtmp.tmp_string_long, 0, sizeof (dtmp.tmp_string_long));
+  assert (lwes_event_projection_add (projection, NULL, key02) == 0);
+  assert (lwes_event_reset (projected) == 0);
+  assert (lwes_event_from_bytes_projected (projected, bytes, size, 0,
+                                           &dtmp, projection) == size);
+  assert (dtmp.tmp_string_long[0] == '\0');
+  assert (lwes_event_get_BOOLEAN (projected, key02, &boolean_o) == 0);
+  assert (boolean_o == value02);
+  assert (lwes_event_get_STRING (projected, key01, &string_o) == -1);
+
+  /* and the event is the same as one deserialized whole with the rest
+     taken out of the projection */
+  assert (lwes_event_projection_add (projection, NULL, key01) == 0);
+  assert (lwes_event_projection_add (projection, NULL, key09) == 0);
+  assert (lwes_event_reset (projected) == 0);
+  assert (lwes_event_from_bytes_projected (projected, bytes, size, 0,
+                                           &dtmp, projection) == size);
+  assert (lwes_event_get_number_of_attributes (projected, &number_o) == 0);
+  assert (number_o == 5);
+  assert (lwes_event_get_STRING (projected, key01, &string_o) == 0);
+  assert (strcmp (string_o, value01) == 0);
+
+  /* truncated events fail the same way as when deserialized whole */
+  for (i = 1; i < size; i++)
+    {
+      assert (lwes_event_reset (projected) == 0);
+      assert (lwes_event_reset (event) == 0);
+      assert (lwes_event_from_bytes_projected (projected, bytes, i, 0,
+                                               &dtmp, projection)
+              == lwes_event_from_bytes (event, bytes, i, 0, &dtmp));
+    }
+
+  /* skipped attributes too */
+  lwes_event_projection_destroy (projection);
+  projection = lwes_event_projection_create ();
+  assert (projection != NULL);
+  for (i = 1; i < size; i++)
+    {
+      assert (lwes_event_reset (projected) == 0);
+      assert (lwes_event_reset (event) == 0);
+      assert (lwes_event_from_bytes_projected (projected, bytes, i, 0,
+                                               &dtmp, projection)
+              == lwes_event_from_bytes (event, bytes, i, 0, &dtmp));
+    }
+
+  /* wanting attributes needs their names shared */
+  malloc_count = 0;
+  null_at = 1;
+  assert (lwes_event_projection_add (projection, NULL, key08) == -3);
+  null_at = 0;
+  malloc_count = 0;
+  null_at = 1;
+  assert (lwes_event_projection_add (projection, eventname, key08) == -3);
+  null_at = 0;
+
+  assert (lwes_event_projection_destroy (projection) == 0);
+  assert (lwes_event_projection_destroy (NULL) == 0);
+  assert (lwes_event_destroy (projected) == 0);
+  assert (lwes_event_destroy (event) == 0);
+}
+
+static void
+test_direct_decode (void)
+{
+  struct lwes_event *event;
+  struct lwes_event *event2;
+  struct lwes_event_deserialize_tmp dtmp;
+  LWES_BYTE bytes[MAX_MSG_SIZE];
+  LWES_LONG_STRING string_o;
+  LWES_BYTE nul_bytes[] = {
+    4, 'T', 'e', 's', 't', 0, 1,
+    3, 'a', 0, 'b', LWES_STRING_TOKEN, 0, 3, 'x', 0, 'y'
+  };
+  struct lwes_event_enumeration e;
+  LWES_CONST_SHORT_STRING key;
+  LWES_TYPE type;
+  int size;
+
+  event = lwes_event_create (NULL, eventname);
+  assert (event != NULL);
+  assert (lwes_event_set_STRING (event, key01, value01) == 1);
+  assert (lwes_event_set_STRING (event, key11, value11) == 2);
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+
+  /* strings are copied straight into the event, names are shared */
+  event2 = lwes_event_create_no_name (NULL);
+  assert (event2 != NULL);
+  memset (&dtmp, 0, sizeof (dtmp));
+  assert (lwes_event_from_bytes (event2, bytes, size, 0, &dtmp) == size);
+  assert (dtmp.tmp_string[0] == '\0');
+  assert (dtmp.tmp_string_long[0] == '\0');
+  assert (event2->eventName == lwes_intern_lookup (eventname,
+                                                   strlen (eventname)));
+  assert (lwes_event_get_STRING (event2, key01, &string_o) == 0);
+  assert (strcmp (string_o, value01) == 0);
+  assert (lwes_event_get_STRING (event2, key11, &string_o) == 0);
+  assert (strcmp (string_o, value11) == 0);
+  assert (lwes_event_destroy (event2) == 0);
+
+  /* a nul ends a name or string, as it did when they were copied */
+  event2 = lwes_event_create_no_name (NULL);
+  assert (event2 != NULL);
+  assert (lwes_event_from_bytes (event2, nul_bytes, sizeof (nul_bytes), 0,
+                                 &dtmp) == (int)sizeof (nul_bytes));
+  assert (strcmp (event2->eventName, "Test") == 0);
+  assert (lwes_event_keys (event2, &e));
+  assert (lwes_event_enumeration_next_element (&e, &key, &type) == 1);
+  assert (strcmp (key, "a") == 0);
+  assert (type == LWES_STRING_TOKEN);
+  assert (lwes_event_get_STRING (event2, "a", &string_o) == 0);
+  assert (strcmp (string_o, "x") == 0);
+  assert (lwes_event_destroy (event2) == 0);
+
+  assert (lwes_event_destroy (event) == 0);
+}
+
+static void
+test_attr_key (void)
+{
+  struct lwes_event *event1;
+  struct lwes_event *event2;
+  struct lwes_event_type_db *db;
+  struct lwes_attr_key keys[12];
+  struct lwes_attr_key many[LWES_EVENT_SMALL_ATTRIBUTES + 4];
+  struct lwes_attr_key missing;
+  LWES_BYTE bytes1[MAX_MSG_SIZE];
+  LWES_BYTE bytes2[MAX_MSG_SIZE];
+  LWES_LONG_STRING string_o;
+  LWES_BOOLEAN boolean_o;
+  LWES_IP_ADDR ip_addr_o;
+  LWES_U_INT_16 uint16_o;
+  LWES_INT_16 int16_o;
+  LWES_U_INT_32 uint32_o;
+  LWES_INT_32 int32_o;
+  LWES_U_INT_64 uint64_o;
+  LWES_INT_64 int64_o;
+  LWES_CHAR name[300];
+  int size1;
+  int size2;
+  int i;
+
+  assert (lwes_attr_key_init (&keys[0],  key01) == 0);
+  assert (lwes_attr_key_init (&keys[1],  key02) == 0);
+  assert (lwes_attr_key_init (&keys[2],  key03) == 0);
+  assert (lwes_attr_key_init (&keys[3],  key04) == 0);
+  assert (lwes_attr_key_init (&keys[5],  key06) == 0);
+  assert (lwes_attr_key_init (&keys[6],  key07) == 0);
+  assert (lwes_attr_key_init (&keys[7],  key08) == 0);
+  assert (lwes_attr_key_init (&keys[8],  key09) == 0);
+  assert (lwes_attr_key_init (&keys[9],  key10) == 0);
+  assert (lwes_attr_key_init (&keys[11], key12) == 0);
+  assert (lwes_attr_key_init (&missing, "missing") == 0);
+  assert (keys[0].name == lwes_intern_lookup (key01, strlen (key01)));
+  assert (keys[0].length == strlen (key01));
+  assert (keys[0].hash == lwes_hash (key01));
+
+  /* setting by key is the same as setting by name, checks and all */
+  db = lwes_event_type_db_create ((char*)esffile);
+  assert (db != NULL);
+  event1 = lwes_event_create (db, eventname);
+  event2 = lwes_event_create (db, eventname);
+  assert (event1 != NULL && event2 != NULL);
+
+  assert (lwes_event_set_STRING   (event1, key01, value01) == 1);
+  assert (lwes_event_set_BOOLEAN  (event1, key02, value02) == 2);
+  assert (lwes_event_set_IP_ADDR  (event1, key03, value12) == 3);
+  assert (lwes_event_set_U_INT_16 (event1, key04, value04) == 4);
+  assert (lwes_event_set_INT_16   (event1, key06, value06) == 5);
+  assert (lwes_event_set_U_INT_32 (event1, key07, value07) == 6);
+  assert (lwes_event_set_INT_32   (event1, key08, value08) == 7);
+  assert (lwes_event_set_U_INT_64 (event1, key09, value09) == 8);
+  assert (lwes_event_set_INT_64   (event1, key10, value10) == 9);
+  assert (lwes_event_set_IP_ADDR  (event1, key12, value12) == 10);
+
+  assert (lwes_event_set_STRING_by_key   (event2, &keys[0], value01) == 1);
+  assert (lwes_event_set_BOOLEAN_by_key  (event2, &keys[1], value02) == 2);
+  assert (lwes_event_set_IP_ADDR_by_key  (event2, &keys[2], value12) == 3);
+  assert (lwes_event_set_U_INT_16_by_key (event2, &keys[3], value04) == 4);
+  assert (lwes_event_set_INT_16_by_key   (event2, &keys[5], value06) == 5);
+  assert (lwes_event_set_U_INT_32_by_key (event2, &keys[6], value07) == 6);
+  assert (lwes_event_set_INT_32_by_key   (event2, &keys[7], value08) == 7);
+  assert (lwes_event_set_U_INT_64_by_key (event2, &keys[8], value09) == 8);
+  assert (lwes_event_set_INT_64_by_key   (event2, &keys[9], value10) == 9);
+  assert (lwes_event_set_IP_ADDR_by_key  (event2, &keys[11], value12) == 10);
+  assert (lwes_event_set_INT_16_by_key   (event2, &keys[3], 1) == -2);
+  assert (lwes_event_set_INT_16_by_key   (event2, &missing, 1) == -1);
+
+  assert ((size1 = lwes_event_to_bytes (event1, bytes1, MAX_MSG_SIZE, 0)) > 0);
+  assert ((size2 = lwes_event_to_bytes (event2, bytes2, MAX_MSG_SIZE, 0)) > 0);
+  assert (size1 == size2);
+  assert (memcmp (bytes1, bytes2, size1) == 0);
+
+  /* and getting by key finds what was set by name */
+  assert (lwes_event_get_STRING_by_key   (event1, &keys[0], &string_o) == 0);
+  assert (strcmp (string_o, value01) == 0);
+  assert (lwes_event_get_BOOLEAN_by_key  (event1, &keys[1], &boolean_o) == 0);
+  assert (boolean_o == value02);
+  assert (lwes_event_get_IP_ADDR_by_key  (event1, &keys[2], &ip_addr_o) == 0);
+  assert (ip_addr_o.s_addr == value12.s_addr);
+  assert (lwes_event_get_U_INT_16_by_key (event1, &keys[3], &uint16_o) == 0);
+  assert (uint16_o == value04);
+  assert (lwes_event_get_INT_16_by_key   (event1, &keys[5], &int16_o) == 0);
+  assert (int16_o == value06);
+  assert (lwes_event_get_U_INT_32_by_key (event1, &keys[6], &uint32_o) == 0);
+  assert (uint32_o == value07);
+  assert (lwes_event_get_INT_32_by_key   (event1, &keys[7], &int32_o) == 0);
+  assert (int32_o == value08);
+  assert (lwes_event_get_U_INT_64_by_key (event1, &keys[8], &uint64_o) == 0);
+  assert (uint64_o == value09);
+  assert (lwes_event_get_INT_64_by_key   (event1, &keys[9], &int64_o) == 0);
+  assert (int64_o == value10);
+
+  /* of the right type, and only if it is there */
+  assert (lwes_event_get_INT_16_by_key   (event1, &keys[3], &int16_o) == -2);
+  assert (lwes_event_get_U_INT_16_by_key (event1, &missing, &uint16_o) == -1);
+
+  assert (lwes_event_destroy (event1) == 0);
+  assert (lwes_event_destroy (event2) == 0);
+  assert (lwes_event_type_db_destroy (db) == 0);
+
+  /* which goes for events with too many attributes to scan as well */
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES + 4; i++)
+    {
+      snprintf (name, sizeof (name), "attr%d", i);
+      assert (lwes_attr_key_init (&many[i], name) == 0);
+      assert (lwes_event_set_INT_32_by_key (event1, &many[i], i) == i + 1);
+    }
+  assert (event1->attributes != NULL);
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES + 4; i++)
+    {
+      assert (lwes_event_get_INT_32_by_key (event1, &many[i], &int32_o) == 0);
+      assert (int32_o == i);
+      snprintf (name, sizeof (name), "attr%d", i);
+      assert (lwes_event_get_INT_32 (event1, name, &int32_o) == 0);
+      assert (int32_o == i);
+    }
+  assert (lwes_event_get_INT_32_by_key (event1, &missing, &int32_o) == -1);
+  assert (lwes_event_destroy (event1) == 0);
+
+  /* bad arguments */
+  memset (name, 'a', sizeof (name));
+  name[sizeof (name) - 1] = '\0';
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  assert (lwes_attr_key_init (NULL, key01) == -1);
+  assert (lwes_attr_key_init (&missing, NULL) == -1);
+  assert (lwes_attr_key_init (&missing, name) == -3);
+  assert (lwes_event_set_INT_32_by_key (NULL, &keys[7], 1) == -1);
+  assert (lwes_event_set_INT_32_by_key (event1, NULL, 1) == -1);
+  assert (lwes_event_set_STRING_by_key (NULL, &keys[0], value01) == -1);
+  assert (lwes_event_set_STRING_by_key (event1, NULL, value01) == -1);
+  assert (lwes_event_set_STRING_by_key (event1, &keys[0], NULL) == -1);
+  assert (lwes_event_get_INT_32_by_key (NULL, &keys[7], &int32_o) == -1);
+  assert (lwes_event_get_INT_32_by_key (event1, NULL, &int32_o) == -1);
+  assert (lwes_event_get_INT_32_by_key (event1, &keys[7], NULL) == -1);
+  assert (lwes_event_destroy (event1) == 0);
+}
+
+static void
+test_upsert (void)
+{
+  struct lwes_event *event;
+  struct lwes_event *fresh;
+  struct lwes_attr_key key;
+  LWES_BYTE bytes[MAX_MSG_SIZE];
+  LWES_BYTE expected[MAX_MSG_SIZE];
+  LWES_CHAR name[20];
+  LWES_LONG_STRING string_o;
+  LWES_LONG_STRING string_before;
+  LWES_INT_32 int32_o;
+  LWES_U_INT_16 number;
+  size_t used;
+  size_t ser_size;
+  int size;
+  int i;
+
+  /* setting an attribute again replaces its value where it is */
+  event = lwes_event_create (NULL, eventname);
+  assert (event != NULL);
+  assert (lwes_event_set_STRING (event, key01, value01) == 1);
+  assert (lwes_event_set_INT_32 (event, key08, 1) == 2);
+  assert (lwes_event_set_U_INT_16 (event, key04, value04) == 3);
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+  for (i = 0; i < 3; i++)
+    {
+      assert (lwes_event_set_INT_32 (event, key08, i) == 3);
+      assert (lwes_event_get_number_of_attributes (event, &number) == 0);
+      assert (number == 3);
+      assert (lwes_event_get_INT_32 (event, key08, &int32_o) == 0);
+      assert (int32_o == i);
+      assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+      assert (serialize_afresh (event, expected) == size);
+      assert (memcmp (bytes, expected, size) == 0);
+    }
+
+  /* a string which fits is copied over the old one */
+  assert (lwes_event_get_STRING (event, key01, &string_before) == 0);
+  used = event->arena->used;
+  assert (lwes_event_set_STRING (event, key01, "http://www.a.com") == 3);
+  assert (event->arena->used == used);
+  assert (lwes_event_get_STRING (event, key01, &string_o) == 0);
+  assert (string_o == string_before);
+  assert (strcmp (string_o, "http://www.a.com") == 0);
+  assert (lwes_event_get_serialized_size (event, &ser_size) == 0);
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+  assert (ser_size == (size_t)size);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+
+  /* a longer one is stored anew */
+  assert (lwes_event_set_STRING (event, key01, "http://www.longer.com/") == 3);
+  assert (lwes_event_get_STRING (event, key01, &string_o) == 0);
+  assert (strcmp (string_o, "http://www.longer.com/") == 0);
+  assert (lwes_event_get_serialized_size (event, &ser_size) == 0);
+  assert ((size = lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0)) > 0);
+  assert (ser_size == (size_t)size);
+
+  /* the room it was stored with is kept however short it gets, so it
+     can be set back and forth without taking more storage */
+  assert (lwes_event_get_STRING (event, key01, &string_before) == 0);
+  used = event->arena->used;
+  for (i = 0; i < 3; i++)
+    {
+      assert (lwes_event_set_STRING (event, key01, "a") == 3);
+      assert (lwes_event_set_STRING (event, key01, "") == 3);
+      assert (lwes_event_get_STRING (event, key01, &string_o) == 0);
+      assert (string_o == string_before);
+      assert (strcmp (string_o, "") == 0);
+      assert (lwes_event_set_STRING (event, key01,
+                                     "http://www.longer.com/") == 3);
+      assert (lwes_event_get_STRING (event, key01, &string_o) == 0);
+      assert (string_o == string_before);
+      assert (strcmp (string_o, "http://www.longer.com/") == 0);
+    }
+  assert (event->arena->used == used);
+  assert (lwes_event_get_serialized_size (event, &ser_size) == 0);
+  assert (lwes_event_to_bytes (event, bytes, MAX_MSG_SIZE, 0) == size);
+  assert (ser_size == (size_t)size);
+  assert (serialize_afresh (event, expected) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+
+  /* it comes out the same as an event set once */
+  fresh = lwes_event_create (NULL, eventname);
+  assert (fresh != NULL);
+  assert (lwes_event_set_STRING (fresh, key01, "http://www.longer.com/") == 1);
+  assert (lwes_event_set_INT_32 (fresh, key08, 2) == 2);
+  assert (lwes_event_set_U_INT_16 (fresh, key04, value04) == 3);
+  assert (lwes_event_to_bytes (fresh, expected, MAX_MSG_SIZE, 0) == size);
+  assert (memcmp (bytes, expected, size) == 0);
+  assert (lwes_event_destroy (fresh) == 0);
+
+  /* and by key */
+  assert (lwes_attr_key_init (&key, key08) == 0);
+  assert (lwes_event_set_INT_32_by_key (event, &key, 7) == 3);
+  assert (lwes_event_get_INT_32 (event, key08, &int32_o) == 0);
+  assert (int32_o == 7);
+  assert (lwes_event_destroy (event) == 0);
+
+  /* which goes for events with too many attributes to scan as well */
+  event = lwes_event_create (NULL, eventname);
+  assert (event != NULL);
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES + 4; i++)
+    {
+      snprintf (name, sizeof (name), "attr%d", i);
+      assert (lwes_event_set_INT_32 (event, name, i) == i + 1);
+    }
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES + 4; i++)
+    {
+      snprintf (name, sizeof (name), "attr%d", i);
+      assert (lwes_event_set_INT_32 (event, name, -i)
+              == LWES_EVENT_SMALL_ATTRIBUTES + 4);
+      assert (lwes_event_get_INT_32 (event, name, &int32_o) == 0);
+      assert (int32_o == -i);
+    }
+  assert (lwes_event_destroy (event) == 0);
+}
+
+static void
+test_set_many (void)
+{
+  struct lwes_event *event1;
+  struct lwes_event *event2;
+  struct lwes_event_type_db *db;
+  struct lwes_attr_key key;
+  struct lwes_attr_desc descs[LWES_EVENT_SMALL_ATTRIBUTES + 4];
+  struct lwes_attr_desc more[2];
+  struct lwes_attr_desc *all;
+  LWES_BYTE bytes1[MAX_MSG_SIZE];
+  LWES_BYTE bytes2[MAX_MSG_SIZE];
+  LWES_CHAR names[LWES_EVENT_SMALL_ATTRIBUTES + 4][20];
+  LWES_CHAR (*all_names)[8];
+  LWES_CHAR string[30];
+  LWES_LONG_STRING string_o;
+  LWES_INT_32 int32_o;
+  LWES_U_INT_16 number;
+  int size1;
+  int size2;
+  int i;
+
+  /* setting many at once is the same as setting them one by one */
+  db = lwes_event_type_db_create ((char*)esffile);
+  assert (db != NULL);
+  event1 = lwes_event_create (db, eventname);
+  event2 = lwes_event_create (db, eventname);
+  assert (event1 != NULL && event2 != NULL);
+
+  assert (lwes_event_set_STRING   (event1, key01, value01) == 1);
+  assert (lwes_event_set_BOOLEAN  (event1, key02, value02) == 2);
+  assert (lwes_event_set_U_INT_16 (event1, key04, value04) == 3);
+  assert (lwes_event_set_INT_16   (event1, key06, value06) == 4);
+  assert (lwes_event_set_U_INT_32 (event1, key07, value07) == 5);
+  assert (lwes_event_set_INT_32   (event1, key08, value08) == 6);
+  assert (lwes_event_set_U_INT_64 (event1, key09, value09) == 7);
+  assert (lwes_event_set_INT_64   (event1, key10, value10) == 8);
+  assert (lwes_event_set_IP_ADDR  (event1, key12, value12) == 9);
+
+  memset (descs, 0, sizeof (descs));
+  assert (lwes_attr_key_init (&key, key08) == 0);
+  strcpy (string, value01);
+  descs[0].name = key01;
+  descs[0].type = LWES_STRING_TOKEN;
+  descs[0].value.string = string;
+  descs[1].name = key02;
+  descs[1].type = LWES_BOOLEAN_TOKEN;
+  descs[1].value.boolean = value02;
+  descs[2].name = key04;
+  descs[2].type = LWES_U_INT_16_TOKEN;
+  descs[2].value.u_int_16 = value04;
+  descs[3].name = key06;
+  descs[3].type = LWES_INT_16_TOKEN;
+  descs[3].value.int_16 = value06;
+  descs[4].name = key07;
+  descs[4].type = LWES_U_INT_32_TOKEN;
+  descs[4].value.u_int_32 = value07;
+  descs[5].key  = &key;
+  descs[5].type = LWES_INT_32_TOKEN;
+  descs[5].value.int_32 = value08;
+  descs[6].name = key09;
+  descs[6].type = LWES_U_INT_64_TOKEN;
+  descs[6].value.u_int_64 = value09;
+  descs[7].name = key10;
+  descs[7].type = LWES_INT_64_TOKEN;
+  descs[7].value.int_64 = value10;
+  descs[8].name = key12;
+  descs[8].type = LWES_IP_ADDR_TOKEN;
+  descs[8].value.ip_addr = value12;
+  assert (lwes_event_set_many (event2, descs, 9) == 9);
+
+  /* the string is copied, so the one given can go */
+  memset (string, 0, sizeof (string));
+  assert (lwes_event_get_STRING (event2, key01, &string_o) == 0);
+  assert (strcmp (string_o, value01) == 0);
+
+  assert ((size1 = lwes_event_to_bytes (event1, bytes1, MAX_MSG_SIZE, 0)) > 0);
+  assert ((size2 = lwes_event_to_bytes (event2, bytes2, MAX_MSG_SIZE, 0)) > 0);
+  assert (size1 == size2);
+  assert (memcmp (bytes1, bytes2, size1) == 0);
+
+  /* setting them again replaces their values */
+  strcpy (string, "http://www.a.com");
+  descs[0].value.string = string;
+  descs[5].value.int_32 = 42;
+  assert (lwes_event_set_many (event2, descs, 9) == 9);
+  assert (lwes_event_get_STRING (event2, key01, &string_o) == 0);
+  assert (strcmp (string_o, "http://www.a.com") == 0);
+  assert (lwes_event_get_INT_32 (event2, key08, &int32_o) == 0);
+  assert (int32_o == 42);
+
+  /* the type db is checked for them all before any are set */
+  strcpy (string, "http://www.b.com");
+  descs[5].value.int_32 = 43;
+  descs[8].name = "notInTheDb";
+  assert (lwes_event_set_many (event2, descs, 9) == -1);
+  descs[8].name = key12;
+  descs[8].type = LWES_INT_32_TOKEN;
+  descs[8].value.int_32 = 1;
+  assert (lwes_event_set_many (event2, descs, 9) == -2);
+  descs[8].type = LWES_IP_ADDR_TOKEN;
+  descs[8].value.ip_addr = value12;
+  assert (lwes_attr_key_init (&key, key02) == 0);
+  descs[5].type = LWES_INT_32_TOKEN;
+  assert (lwes_event_set_many (event2, descs, 9) == -2);
+  assert (lwes_attr_key_init (&key, key08) == 0);
+  assert (lwes_event_get_number_of_attributes (event2, &number) == 0);
+  assert (number == 9);
+  assert (lwes_event_get_STRING (event2, key01, &string_o) == 0);
+  assert (strcmp (string_o, "http://www.a.com") == 0);
+  assert (lwes_event_get_INT_32 (event2, key08, &int32_o) == 0);
+  assert (int32_o == 42);
+  assert (lwes_event_set_many (event2, descs, 9) == 9);
+  assert (lwes_event_get_INT_32 (event2, key08, &int32_o) == 0);
+  assert (int32_o == 43);
+
+  assert (lwes_event_destroy (event1) == 0);
+  assert (lwes_event_destroy (event2) == 0);
+  assert (lwes_event_type_db_destroy (db) == 0);
+
+  /* room is made for them all before they are added, a hash included */
+  memset (descs, 0, sizeof (descs));
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES + 4; i++)
+    {
+      snprintf (names[i], sizeof (names[i]), "attr%d", i);
+      descs[i].name = names[i];
+      descs[i].type = LWES_INT_32_TOKEN;
+      descs[i].value.int_32 = i;
+    }
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  assert (lwes_event_set_many (event1, descs, LWES_EVENT_SMALL_ATTRIBUTES + 4)
+          == LWES_EVENT_SMALL_ATTRIBUTES + 4);
+  assert (event1->attributes != NULL);
+  assert (event1->entries_size >= LWES_EVENT_SMALL_ATTRIBUTES + 4);
+  for (i = 0; i < LWES_EVENT_SMALL_ATTRIBUTES + 4; i++)
+    {
+      assert (lwes_event_get_INT_32 (event1, names[i], &int32_o) == 0);
+      assert (int32_o == i);
+    }
+  assert (serialize_afresh (event1, bytes2)
+          == lwes_event_to_bytes (event1, bytes1, MAX_MSG_SIZE, 0));
+  assert (lwes_event_destroy (event1) == 0);
+
+  /* with nothing set if that can't be done */
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  malloc_count = 0;
+  null_at      = 1;
+  assert (lwes_event_set_many (event1, descs, LWES_EVENT_SMALL_ATTRIBUTES + 4)
+          == -3);
+  null_at      = 0;
+  assert (lwes_event_get_number_of_attributes (event1, &number) == 0);
+  assert (number == 0);
+  assert (lwes_event_destroy (event1) == 0);
+
+  /* copies of names and strings included, so that no value is replaced */
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  assert (lwes_event_set_many (event1, descs, 3) == 3);
+  memset (more, 0, sizeof (more));
+  assert (lwes_attr_key_init (&key, names[0]) == 0);
+  more[0].key  = &key;
+  more[0].type = LWES_INT_32_TOKEN;
+  more[0].value.int_32 = 100;
+  more[1].name = "notSetBefore";
+  more[1].type = LWES_STRING_TOKEN;
+  more[1].value.string = (LWES_LONG_STRING)value01;
+  use_up_storage (event1, 0);
+  malloc_count = 0;
+  null_at      = 1;
+  assert (lwes_event_set_many (event1, more, 2) == -3);
+  null_at      = 0;
+  assert (lwes_event_get_number_of_attributes (event1, &number) == 0);
+  assert (number == 3);
+  assert (lwes_event_get_INT_32 (event1, names[0], &int32_o) == 0);
+  assert (int32_o == 0);
+  assert (lwes_event_set_many (event1, more, 2) == 4);
+  assert (lwes_event_get_INT_32 (event1, names[0], &int32_o) == 0);
+  assert (int32_o == 100);
+  assert (lwes_event_get_STRING (event1, "notSetBefore", &string_o) == 0);
+  assert (strcmp (string_o, value01) == 0);
+  assert (lwes_event_destroy (event1) == 0);
+
+  /* bad arguments leave the event as it was */
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  assert (lwes_event_set_many (NULL, descs, 1) == -1);
+  assert (lwes_event_set_many (event1, NULL, 1) == -1);
+  assert (lwes_event_set_many (event1, NULL, 0) == 0);
+  descs[3].name = NULL;
+  assert (lwes_event_set_many (event1, descs, 4) == -1);
+  descs[3].name = names[3];
+  descs[3].type = 42;
+  assert (lwes_event_set_many (event1, descs, 4) == -1);
+  descs[3].type = LWES_STRING_TOKEN;
+  descs[3].value.string = NULL;
+  assert (lwes_event_set_many (event1, descs, 4) == -1);
+  assert (lwes_event_get_number_of_attributes (event1, &number) == 0);
+  assert (number == 0);
+  assert (lwes_event_set_many (event1, descs, 3) == 3);
+  assert (lwes_event_destroy (event1) == 0);
+
+  /* no more attributes can be added than an event can hold, though those
+   * it has can be set again however full it is */
+  all       = (struct lwes_attr_desc *)
+                malloc ((USHRT_MAX + 1) * sizeof (struct lwes_attr_desc));
+  all_names = (LWES_CHAR (*)[8]) malloc ((USHRT_MAX + 1) * 8);
+  assert (all != NULL && all_names != NULL);
+  memset (all, 0, (USHRT_MAX + 1) * sizeof (struct lwes_attr_desc));
+  for (i = 0; i <= USHRT_MAX; i++)
+    {
+      snprintf (all_names[i], 8, "m%d", i);
+      all[i].name = all_names[i];
+      all[i].type = LWES_INT_32_TOKEN;
+      all[i].value.int_32 = i;
+    }
+  /* none of these names are shared, so as not to fill the table of them */
+  null_at = (size_t)-1;
+  event1 = lwes_event_create (NULL, eventname);
+  assert (event1 != NULL);
+  assert (lwes_event_set_many (event1, all, USHRT_MAX + 1) == -1);
+  assert (lwes_event_get_number_of_attributes (event1, &number) == 0);
+  assert (number == 0);
+  assert (lwes_event_set_many (event1, all, USHRT_MAX) == USHRT_MAX);
+  all[0].value.int_32 = 42;
+  assert (lwes_event_set_many (event1, all, 1) == USHRT_MAX);
+  assert (lwes_event_get_INT_32 (event1, all_names[0], &int32_o) == 0);
+  assert (int32_o == 42);
+  assert (lwes_event_set_many (event1, all + USHRT_MAX, 1) == -1);
+  assert (lwes_event_destroy (event1) == 0);
+  null_at = 0;
+  free (all);
+  free (all_names);
+}
+
+/* names off the network are never interned, however many of them there are,
+ * so there is always room for those the program itself uses */
+static void
+test_wire_names (void)
+{
+  struct lwes_event *event1;
+  struct lwes_event *event2;
+  struct lwes_event_deserialize_tmp dtmp;
+  struct lwes_attr_key key;
+  LWES_BYTE bytes[MAX_MSG_SIZE];
+  LWES_CHAR name[10];
+  LWES_U_INT_16 uint16_o;
+  int batches = LWES_INTERN_SLOTS / 100 + 1;
+  int size;
+  int batch;
+  int i;
+  int j;
+
+  event1 = lwes_event_create (NULL, "WireNames");
+  assert (event1 != NULL);
+  for (i = 0; i < 100; i++)
+    {
+      snprintf (name, sizeof (name), "zq%05d", i);
+      assert (lwes_event_set_U_INT_16 (event1, name, (LWES_U_INT_16) i) == i + 1);
+    }
+  assert ((size = lwes_event_to_bytes (event1, bytes, MAX_MSG_SIZE, 0)) > 0);
+
+  for (batch = 1; batch < batches; batch++)
+    {
+      /* give every attribute of the bytes a name not seen before */
+      for (j = 0; j + 7 <= size; j++)
+        {
+          if (bytes[j] == 'z' && bytes[j + 1] == 'q')
+            {
+              memcpy (name, bytes + j + 2, 5);
+              name[5] = '\0';
+              i = atoi (name) % 100;
+              snprintf (name, sizeof (name), "%05d", batch * 100 + i);
+              memcpy (bytes + j + 2, name, 5);
+            }
+        }
+
+      event2 = lwes_event_create_no_name (NULL);
+      assert (event2 != NULL);
+      assert (lwes_event_from_bytes (event2, bytes, size, 0, &dtmp) == size);
+      snprintf (name, sizeof (name), "zq%05d", batch * 100 + 99);
+      assert (lwes_event_get_U_INT_16 (event2, name, &uint16_o) == 0);
+      assert (uint16_o == 99);
+      assert (lwes_intern_lookup (name, strlen (name)) == NULL);
+      assert (lwes_event_destroy (event2) == 0);
+    }
+
+  /* more names came in than the table could ever have held */
+  assert (lwes_attr_key_init (&key, "not_off_the_wire") == 0);
+  assert (lwes_intern_lookup ("not_off_the_wire", 16) == key.name);
+
+  assert (lwes_event_destroy (event1) == 0);
+}
+
 int main (void)
 {
   value12.s_addr = inet_addr ("127.0.0.1");
@@ -1549,6 +2818,16 @@ int main (void)
   test_serialize_errors ();
   test_deserialize_errors ();
   test_enumeration ();
+  test_reset ();
+  test_many_attributes ();
+  test_shared_names ();
+  test_serialized_bytes ();
+  test_projection ();
+  test_direct_decode ();
+  test_attr_key ();
+  test_upsert ();
+  test_set_many ();
+  test_wire_names ();
 
   return 0;
 }
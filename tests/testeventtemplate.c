@@ -0,0 +1,306 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#if HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "lwes_event.h"
+
+/* wrap malloc to cause test memory problems */
+void *my_malloc (size_t size);
+
+static size_t null_at = 0;
+static size_t malloc_count = 0;
+
+void *my_malloc (size_t size)
+{
+  void *ret = NULL;
+  malloc_count++;
+  if ( malloc_count != null_at )
+    {
+      ret = malloc (size);
+    }
+  return ret;
+}
+
+#define malloc my_malloc
+
+#include "lwes_event_template.c"
+
+#undef malloc
+
+static LWES_BYTE bytes[65535];
+
+/* serialize an event with the attributes of the template, with values
+   which depend on i, or all zero if i is negative */
+static int
+make_event (int i)
+{
+  struct lwes_event *event;
+  LWES_IP_ADDR ip_addr;
+  int zero = (i < 0);
+  int size;
+
+  ip_addr.s_addr = zero ? 0 : inet_addr ("127.0.0.1");
+
+  event = lwes_event_create (NULL, "TypeChecker");
+  assert ( event != NULL );
+  assert ( lwes_event_set_STRING   (event, "aString", "hello")  == 1 );
+  assert ( lwes_event_set_BOOLEAN  (event, "aBoolean",
+                                    zero ? 0 : i % 2)           == 2 );
+  assert ( lwes_event_set_IP_ADDR  (event, "anIPAddress", ip_addr) == 3 );
+  assert ( lwes_event_set_U_INT_16 (event, "aUInt16",
+                                    zero ? 0 : 65535 - i)       == 4 );
+  assert ( lwes_event_set_INT_16   (event, "anInt16",
+                                    zero ? 0 : -1 - i)          == 5 );
+  assert ( lwes_event_set_U_INT_32 (event, "aUInt32",
+                                    zero ? 0 : 0xffffffffUL - i) == 6 );
+  assert ( lwes_event_set_INT_32   (event, "anInt32",
+                                    zero ? 0 : -2 - i)          == 7 );
+  assert ( lwes_event_set_U_INT_64 (event, "aUInt64",
+                                    zero ? 0
+                                    : 0xffffffffffffffffULL - i) == 8 );
+  assert ( lwes_event_set_INT_64   (event, "anInt64",
+                                    zero ? 0 : -3 - i)          == 9 );
+  assert ( lwes_event_set_STRING   (event, "empty", "")         == 10 );
+  size = lwes_event_to_bytes (event, bytes, sizeof (bytes), 0);
+  assert ( size > 0 );
+  assert ( lwes_event_destroy (event) == 0 );
+
+  return size;
+}
+
+/* the template writes what an event with the same attributes does */
+static void
+test_template (void)
+{
+  struct lwes_event_template *template_;
+  LWES_BYTE_P template_bytes;
+  LWES_IP_ADDR ip_addr;
+  size_t length;
+  int size;
+  int i;
+
+  template_ = lwes_event_template_create ("TypeChecker");
+  assert ( template_ != NULL );
+  assert ( lwes_event_template_add_STRING (template_, "aString", "hello")
+           == 0 );
+  assert ( lwes_event_template_add (template_, "aBoolean",
+                                    LWES_BOOLEAN_TOKEN) == 1 );
+  assert ( lwes_event_template_add (template_, "anIPAddress",
+                                    LWES_IP_ADDR_TOKEN) == 2 );
+  assert ( lwes_event_template_add (template_, "aUInt16",
+                                    LWES_U_INT_16_TOKEN) == 3 );
+  assert ( lwes_event_template_add (template_, "anInt16",
+                                    LWES_INT_16_TOKEN) == 4 );
+  assert ( lwes_event_template_add (template_, "aUInt32",
+                                    LWES_U_INT_32_TOKEN) == 5 );
+  assert ( lwes_event_template_add (template_, "anInt32",
+                                    LWES_INT_32_TOKEN) == 6 );
+  assert ( lwes_event_template_add (template_, "aUInt64",
+                                    LWES_U_INT_64_TOKEN) == 7 );
+  assert ( lwes_event_template_add (template_, "anInt64",
+                                    LWES_INT_64_TOKEN) == 8 );
+  assert ( lwes_event_template_add_STRING (template_, "empty", "") == 9 );
+
+  /* every value starts out as zero */
+  size = make_event (-1);
+  assert ( lwes_event_template_get_bytes (template_, &template_bytes,
+                                          &length) == 0 );
+  assert ( length == (size_t)size );
+  assert ( memcmp (template_bytes, bytes, length) == 0 );
+
+  /* and is patched where it is, many times over */
+  ip_addr.s_addr = inet_addr ("127.0.0.1");
+  for (i = 0; i < 3; i++)
+    {
+      assert ( lwes_event_template_set_BOOLEAN  (template_, 1, i % 2) == 0 );
+      assert ( lwes_event_template_set_IP_ADDR  (template_, 2, ip_addr)
+               == 0 );
+      assert ( lwes_event_template_set_U_INT_16 (template_, 3, 65535 - i)
+               == 0 );
+      assert ( lwes_event_template_set_INT_16   (template_, 4, -1 - i) == 0 );
+      assert ( lwes_event_template_set_U_INT_32 (template_, 5,
+                                                 0xffffffffUL - i) == 0 );
+      assert ( lwes_event_template_set_INT_32   (template_, 6, -2 - i) == 0 );
+      assert ( lwes_event_template_set_U_INT_64 (template_, 7,
+                                                 0xffffffffffffffffULL - i)
+               == 0 );
+      assert ( lwes_event_template_set_INT_64   (template_, 8, -3 - i) == 0 );
+
+      size = make_event (i);
+      assert ( lwes_event_template_get_bytes (template_, &template_bytes,
+                                              &length) == 0 );
+      assert ( length == (size_t)size );
+      assert ( memcmp (template_bytes, bytes, length) == 0 );
+    }
+
+  assert ( lwes_event_template_destroy (template_) == 0 );
+}
+
+static void
+test_bad_args (void)
+{
+  struct lwes_event_template *template_;
+  LWES_BYTE_P template_bytes;
+  LWES_CHAR name[300];
+  size_t length;
+
+  memset (name, 'a', sizeof (name));
+  name[sizeof (name) - 1] = '\0';
+
+  assert ( lwes_event_template_create (NULL) == NULL );
+  assert ( lwes_event_template_create ("") == NULL );
+  assert ( lwes_event_template_create (name) == NULL );
+
+  template_ = lwes_event_template_create ("Event");
+  assert ( template_ != NULL );
+
+  assert ( lwes_event_template_add (NULL, "a", LWES_INT_32_TOKEN) == -1 );
+  assert ( lwes_event_template_add (template_, NULL, LWES_INT_32_TOKEN)
+           == -1 );
+  assert ( lwes_event_template_add (template_, "", LWES_INT_32_TOKEN) == -1 );
+  assert ( lwes_event_template_add (template_, name, LWES_INT_32_TOKEN)
+           == -1 );
+  assert ( lwes_event_template_add (template_, "a", 42) == -1 );
+  assert ( lwes_event_template_add (template_, "a", LWES_UNDEFINED_TOKEN)
+           == -1 );
+  /* strings have to be given their value */
+  assert ( lwes_event_template_add (template_, "a", LWES_STRING_TOKEN)
+           == -1 );
+  assert ( lwes_event_template_add_STRING (template_, "a", NULL) == -1 );
+  assert ( lwes_event_template_add_STRING (NULL, "a", "b") == -1 );
+
+  assert ( lwes_event_template_add (template_, "a", LWES_INT_32_TOKEN) == 0 );
+  assert ( lwes_event_template_add (template_, "a", LWES_INT_16_TOKEN)
+           == -2 );
+  assert ( lwes_event_template_add_STRING (template_, "a", "b") == -2 );
+  assert ( lwes_event_template_add_STRING (template_, "s", "b") == 1 );
+
+  /* only slots which exist, of the type of the value */
+  assert ( lwes_event_template_set_INT_32 (NULL, 0, 1) == -1 );
+  assert ( lwes_event_template_set_INT_32 (template_, -1, 1) == -1 );
+  assert ( lwes_event_template_set_INT_32 (template_, 2, 1) == -1 );
+  assert ( lwes_event_template_set_INT_32 (template_, 1, 1) == -1 );
+  assert ( lwes_event_template_set_INT_16 (template_, 0, 1) == -1 );
+  assert ( lwes_event_template_set_INT_32 (template_, 0, 1) == 0 );
+
+  assert ( lwes_event_template_get_bytes (NULL, &template_bytes, &length)
+           == -1 );
+  assert ( lwes_event_template_get_bytes (template_, NULL, &length) == -1 );
+  assert ( lwes_event_template_get_bytes (template_, &template_bytes, NULL)
+           == -1 );
+
+  assert ( lwes_event_template_destroy (template_) == 0 );
+  assert ( lwes_event_template_destroy (NULL) == 0 );
+}
+
+/* an attribute which doesn't fit is left out entirely */
+static void
+test_too_big (void)
+{
+  struct lwes_event_template *template_;
+  struct lwes_event *event;
+  struct lwes_event_deserialize_tmp dtmp;
+  LWES_BYTE_P template_bytes;
+  LWES_LONG_STRING big;
+  LWES_U_INT_16 number;
+  LWES_CHAR name[16];
+  size_t length;
+  int i;
+
+  big = (LWES_LONG_STRING) malloc (60000);
+  assert ( big != NULL );
+  memset (big, 'x', 59999);
+  big[59999] = '\0';
+
+  template_ = lwes_event_template_create ("Event");
+  assert ( template_ != NULL );
+  assert ( lwes_event_template_add_STRING (template_, "big", big) == 0 );
+  assert ( lwes_event_template_add_STRING (template_, "big2", big) == -4 );
+
+  for (i = 1; ; i++)
+    {
+      snprintf (name, sizeof (name), "a%d", i);
+      if (lwes_event_template_add (template_, name, LWES_INT_64_TOKEN) < 0)
+        {
+          break;
+        }
+    }
+  assert ( lwes_event_template_add (template_, "b", LWES_INT_64_TOKEN)
+           == -4 );
+  assert ( template_->slots_size >= template_->number_of_attributes );
+
+  assert ( lwes_event_template_get_bytes (template_, &template_bytes,
+                                          &length) == 0 );
+  assert ( length <= MAX_MSG_SIZE );
+  event = lwes_event_create_no_name (NULL);
+  assert ( event != NULL );
+  assert ( lwes_event_from_bytes (event, template_bytes, length, 0, &dtmp)
+           == (int)length );
+  assert ( lwes_event_get_number_of_attributes (event, &number) == 0 );
+  assert ( number == template_->number_of_attributes );
+  assert ( number == i );
+
+  assert ( lwes_event_destroy (event) == 0 );
+  assert ( lwes_event_template_destroy (template_) == 0 );
+  free (big);
+}
+
+static void
+test_malloc_failures (void)
+{
+  struct lwes_event_template *template_;
+  LWES_CHAR name[16];
+  int i;
+
+  for (null_at = 1; null_at <= 3; null_at++)
+    {
+      malloc_count = 0;
+      assert ( lwes_event_template_create ("Event") == NULL );
+    }
+
+  null_at = 0;
+  template_ = lwes_event_template_create ("Event");
+  assert ( template_ != NULL );
+  for (i = 0; i < LWES_EVENT_TEMPLATE_SLOTS; i++)
+    {
+      snprintf (name, sizeof (name), "a%d", i);
+      assert ( lwes_event_template_add (template_, name, LWES_INT_32_TOKEN)
+               == i );
+    }
+  malloc_count = 0;
+  null_at = 1;
+  assert ( lwes_event_template_add (template_, "b", LWES_INT_32_TOKEN)
+           == -3 );
+  null_at = 0;
+  assert ( lwes_event_template_add (template_, "b", LWES_INT_32_TOKEN)
+           == LWES_EVENT_TEMPLATE_SLOTS );
+  assert ( lwes_event_template_destroy (template_) == 0 );
+}
+
+int main (void)
+{
+  test_template ();
+  test_bad_args ();
+  test_too_big ();
+  test_malloc_failures ();
+
+  return 0;
+}
@@ -328,6 +328,21 @@ test_db (void)
            == -3 );
   put_null = 0;
 
+  /* fail at allocating the name and then the schema of the event, which
+     leaves it out of the db */
+  malloc_count = 0;
+  null_at = 2;
+  assert ( lwes_event_type_db_add_event ( db, (LWES_SHORT_STRING)"newEvent")
+           == -3 );
+  malloc_count = 0;
+  null_at = 3;
+  assert ( lwes_event_type_db_add_event ( db, (LWES_SHORT_STRING)"newEvent")
+           == -3 );
+  null_at = 0;
+  assert (
+    ! lwes_event_type_db_check_for_event( db,
+                                          (LWES_SHORT_STRING)"newEvent") );
+
   /* fail at allocating space for the attribute name */
   malloc_count = 0;
   null_at = 1;
@@ -382,10 +397,126 @@ test_2_db (void)
   lwes_event_type_db_destroy (db2);
 }
 
+static void
+test_schema (void)
+{
+  struct lwes_event_type_db *db;
+  struct lwes_event_type_db_schema *schema;
+  struct lwes_event_type_db_schema *empty;
+  struct lwes_event_type_db_schema *meta;
+  unsigned int generation;
+  const char *esffile = "testeventtypedb.esf";
+
+  db = lwes_event_type_db_create ((char*)esffile);
+  assert ( db != NULL );
+
+  assert ( lwes_event_type_db_get_schema (NULL, "TypeChecker") == NULL );
+  assert ( lwes_event_type_db_get_schema (db, NULL) == NULL );
+  assert ( lwes_event_type_db_schema_check (NULL, LWES_STRING_TOKEN,
+                                            "aString") == -1 );
+
+  /* the schemas are all made with the db, so getting one allocates
+     nothing */
+  malloc_count = 0;
+  null_at = 1;
+  schema = lwes_event_type_db_get_schema (db, "TypeChecker");
+  assert ( schema != NULL );
+  assert ( malloc_count == 0 );
+  null_at = 0;
+
+  /* the attributes of the event and the meta event are in the schema */
+  assert ( lwes_event_type_db_get_schema (db, "TypeChecker") == schema );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_STRING_TOKEN,
+                                            "aString") == 0 );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_INT_64_TOKEN,
+                                            "anInt64") == 0 );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_IP_ADDR_TOKEN,
+                                            "SenderIP") == 0 );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_U_INT_16_TOKEN,
+                                            "aMetaString") == -2 );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_U_INT_16_TOKEN,
+                                            "random") == -1 );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_U_INT_16_TOKEN,
+                                            NULL) == -1 );
+
+  empty = lwes_event_type_db_get_schema (db, "Empty");
+  assert ( empty != NULL && empty != schema );
+  assert ( lwes_event_type_db_schema_check (empty, LWES_U_INT_16_TOKEN,
+                                            "SiteID") == 0 );
+  assert ( lwes_event_type_db_schema_check (empty, LWES_STRING_TOKEN,
+                                            "aString") == -1 );
+
+  /* events not in the db share one allowing only the meta attributes */
+  meta = lwes_event_type_db_get_schema (db, "Foo");
+  assert ( meta != NULL );
+  assert ( lwes_event_type_db_get_schema (db, "Bar") == meta );
+  assert ( lwes_event_type_db_schema_check (meta, LWES_U_INT_16_TOKEN,
+                                            "SiteID") == 0 );
+  assert ( lwes_event_type_db_schema_check (meta, LWES_STRING_TOKEN,
+                                            "aString") == -1 );
+
+  /* attributes added since are in the schemas already made */
+  assert ( lwes_event_type_db_add_attribute ( db,
+                                              (LWES_SHORT_STRING)"TypeChecker",
+                                              (LWES_SHORT_STRING)"aNewOne",
+                                              (LWES_SHORT_STRING)"int32")
+           == 0 );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_INT_32_TOKEN,
+                                            "aNewOne") == 0 );
+  assert ( lwes_event_type_db_schema_check (empty, LWES_INT_32_TOKEN,
+                                            "aNewOne") == -1 );
+  assert ( lwes_event_type_db_add_attribute ( db,
+                                       (LWES_SHORT_STRING)"MetaEventInfo",
+                                       (LWES_SHORT_STRING)"aNewMeta",
+                                       (LWES_SHORT_STRING)"boolean")
+           == 0 );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_BOOLEAN_TOKEN,
+                                            "aNewMeta") == 0 );
+  assert ( lwes_event_type_db_schema_check (empty, LWES_BOOLEAN_TOKEN,
+                                            "aNewMeta") == 0 );
+  assert ( lwes_event_type_db_schema_check (meta, LWES_BOOLEAN_TOKEN,
+                                            "aNewMeta") == 0 );
+
+  /* an event's own attribute wins over one of the meta event */
+  assert ( lwes_event_type_db_add_attribute ( db,
+                                              (LWES_SHORT_STRING)"Empty",
+                                              (LWES_SHORT_STRING)"SiteID",
+                                              (LWES_SHORT_STRING)"string")
+           == 0 );
+  assert ( lwes_event_type_db_schema_check (empty, LWES_STRING_TOKEN,
+                                            "SiteID") == 0 );
+  assert ( lwes_event_type_db_schema_check (meta, LWES_U_INT_16_TOKEN,
+                                            "SiteID") == 0 );
+
+  /* an event added since has a schema of its own, and the generation
+     changes so that those given the meta schema for it can tell */
+  generation = db->generation;
+  assert ( lwes_event_type_db_add_event ( db, (LWES_SHORT_STRING)"Foo")
+           == 0 );
+  assert ( db->generation != generation );
+  assert ( lwes_event_type_db_add_attribute ( db,
+                                              (LWES_SHORT_STRING)"Foo",
+                                              (LWES_SHORT_STRING)"aFoo",
+                                              (LWES_SHORT_STRING)"string")
+           == 0 );
+  schema = lwes_event_type_db_get_schema (db, "Foo");
+  assert ( schema != NULL && schema != meta );
+  assert ( lwes_event_type_db_get_schema (db, "Bar") == meta );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_STRING_TOKEN,
+                                            "aFoo") == 0 );
+  assert ( lwes_event_type_db_schema_check (schema, LWES_BOOLEAN_TOKEN,
+                                            "aNewMeta") == 0 );
+  assert ( lwes_event_type_db_schema_check (meta, LWES_STRING_TOKEN,
+                                            "aFoo") == -1 );
+
+  lwes_event_type_db_destroy (db);
+}
+
 int main(void)
 {
   test_db ();
   test_2_db ();
+  test_schema ();
 
   return 0;
 }
@@ -0,0 +1,304 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#if HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "lwes_event.h"
+
+/* wrap malloc to cause test memory problems */
+void *my_malloc (size_t size);
+
+static size_t null_at = 0;
+static size_t malloc_count = 0;
+
+void *my_malloc (size_t size)
+{
+  void *ret = NULL;
+  malloc_count++;
+  if ( malloc_count != null_at )
+    {
+      ret = malloc (size);
+    }
+  return ret;
+}
+
+#define malloc my_malloc
+
+#include "lwes_event_view.c"
+
+#undef malloc
+
+static LWES_BYTE bytes[65535];
+
+/* serialize an event with one attribute of each type */
+static int
+make_event (void)
+{
+  struct lwes_event *event;
+  LWES_IP_ADDR ip_addr;
+  int size;
+
+  ip_addr.s_addr = inet_addr ("127.0.0.1");
+
+  event = lwes_event_create (NULL, "TypeChecker");
+  assert ( event != NULL );
+  assert ( lwes_event_set_STRING   (event, "aString", "hello")  == 1 );
+  assert ( lwes_event_set_BOOLEAN  (event, "aBoolean", 1)       == 2 );
+  assert ( lwes_event_set_IP_ADDR  (event, "anIPAddress", ip_addr) == 3 );
+  assert ( lwes_event_set_U_INT_16 (event, "aUInt16", 65535)    == 4 );
+  assert ( lwes_event_set_INT_16   (event, "anInt16", -1)       == 5 );
+  assert ( lwes_event_set_U_INT_32 (event, "aUInt32", 0xffffffffUL) == 6 );
+  assert ( lwes_event_set_INT_32   (event, "anInt32", -2)       == 7 );
+  assert ( lwes_event_set_U_INT_64 (event, "aUInt64",
+                                    0xffffffffffffffffULL)      == 8 );
+  assert ( lwes_event_set_INT_64   (event, "anInt64", -3)       == 9 );
+  assert ( lwes_event_set_STRING   (event, "empty", "")         == 10 );
+  size = lwes_event_to_bytes (event, bytes, sizeof (bytes), 0);
+  assert ( size > 0 );
+  assert ( lwes_event_destroy (event) == 0 );
+
+  return size;
+}
+
+static void
+test_view (void)
+{
+  struct lwes_event_view *view;
+  LWES_CONST_SHORT_STRING name;
+  LWES_CONST_LONG_STRING  string;
+  LWES_U_INT_16 uint16;
+  LWES_INT_16   int16;
+  LWES_U_INT_32 uint32;
+  LWES_INT_32   int32;
+  LWES_U_INT_64 uint64;
+  LWES_INT_64   int64;
+  LWES_BOOLEAN  boolean;
+  LWES_IP_ADDR  ip_addr;
+  size_t length;
+  int size;
+
+  size = make_event ();
+
+  view = lwes_event_view_create ();
+  assert ( view != NULL );
+  assert ( lwes_event_view_from_bytes (view, bytes, size, 0) == size );
+
+  assert ( lwes_event_view_get_name (view, &name, &length) == 0 );
+  assert ( length == 11 );
+  assert ( memcmp (name, "TypeChecker", length) == 0 );
+  assert ( lwes_event_view_get_number_of_attributes (view, &uint16) == 0 );
+  assert ( uint16 == 10 );
+
+  /* strings come straight out of the bytes */
+  assert ( lwes_event_view_get_STRING (view, "aString", &string, &length)
+           == 0 );
+  assert ( length == 5 );
+  assert ( memcmp (string, "hello", length) == 0 );
+  assert ( (LWES_BYTE_P)string > bytes
+           && (LWES_BYTE_P)string < bytes + size );
+  assert ( lwes_event_view_get_STRING (view, "empty", &string, &length)
+           == 0 );
+  assert ( length == 0 );
+
+  assert ( lwes_event_view_get_BOOLEAN  (view, "aBoolean", &boolean) == 0 );
+  assert ( boolean == 1 );
+  assert ( lwes_event_view_get_IP_ADDR  (view, "anIPAddress", &ip_addr)
+           == 0 );
+  assert ( ip_addr.s_addr == inet_addr ("127.0.0.1") );
+  assert ( lwes_event_view_get_U_INT_16 (view, "aUInt16", &uint16) == 0 );
+  assert ( uint16 == 65535 );
+  assert ( lwes_event_view_get_INT_16   (view, "anInt16", &int16) == 0 );
+  assert ( int16 == -1 );
+  assert ( lwes_event_view_get_U_INT_32 (view, "aUInt32", &uint32) == 0 );
+  assert ( uint32 == 0xffffffffUL );
+  assert ( lwes_event_view_get_INT_32   (view, "anInt32", &int32) == 0 );
+  assert ( int32 == -2 );
+  assert ( lwes_event_view_get_U_INT_64 (view, "aUInt64", &uint64) == 0 );
+  assert ( uint64 == 0xffffffffffffffffULL );
+  assert ( lwes_event_view_get_INT_64   (view, "anInt64", &int64) == 0 );
+  assert ( int64 == -3 );
+
+  /* missing attributes, and attributes of another type */
+  assert ( lwes_event_view_get_INT_64 (view, "aUInt6", &int64) == -1 );
+  assert ( lwes_event_view_get_INT_64 (view, "aUInt640", &int64) == -1 );
+  assert ( lwes_event_view_get_INT_64 (view, "aUInt64", &int64) == -2 );
+  assert ( lwes_event_view_get_STRING (view, "aBoolean", &string, &length)
+           == -2 );
+
+  /* a view can be taken at an offset into the bytes */
+  memmove (bytes + 7, bytes, size);
+  assert ( lwes_event_view_from_bytes (view, bytes, size + 7, 7) == size );
+  assert ( lwes_event_view_get_INT_32 (view, "anInt32", &int32) == 0 );
+  assert ( int32 == -2 );
+
+  assert ( lwes_event_view_destroy (view) == 0 );
+  assert ( lwes_event_view_destroy (NULL) == 0 );
+}
+
+static void
+test_malformed (void)
+{
+  struct lwes_event_view *view;
+  LWES_INT_32 int32;
+  int size;
+  int i;
+
+  size = make_event ();
+  view = lwes_event_view_create ();
+  assert ( view != NULL );
+
+  /* every cut short event is caught, and leaves nothing to view */
+  for (i = 1; i < size; i++)
+    {
+      assert ( lwes_event_view_from_bytes (view, bytes, i, 0) == -2 );
+      assert ( lwes_event_view_get_INT_32 (view, "anInt32", &int32) == -1 );
+    }
+
+  /* as is an unknown type, the type of aString is at 11 + 1 + 2 + 1 + 7 */
+  bytes[22] = 0x55;
+  assert ( lwes_event_view_from_bytes (view, bytes, size, 0) == -4 );
+  bytes[22] = LWES_STRING_TOKEN;
+  assert ( lwes_event_view_from_bytes (view, bytes, size, 0) == size );
+
+  assert ( lwes_event_view_destroy (view) == 0 );
+}
+
+static void
+test_null_args (void)
+{
+  struct lwes_event_view *view;
+  LWES_CONST_SHORT_STRING name;
+  LWES_CONST_LONG_STRING  string;
+  LWES_U_INT_16 uint16;
+  LWES_INT_16   int16;
+  LWES_U_INT_32 uint32;
+  LWES_INT_32   int32;
+  LWES_U_INT_64 uint64;
+  LWES_INT_64   int64;
+  LWES_BOOLEAN  boolean;
+  LWES_IP_ADDR  ip_addr;
+  size_t length;
+  int size;
+
+  size = make_event ();
+  view = lwes_event_view_create ();
+  assert ( view != NULL );
+
+  assert ( lwes_event_view_from_bytes (NULL, bytes, size, 0)    == -1 );
+  assert ( lwes_event_view_from_bytes (view, NULL,  size, 0)    == -1 );
+  assert ( lwes_event_view_from_bytes (view, bytes, 0,    0)    == -1 );
+  assert ( lwes_event_view_from_bytes (view, bytes, size, size) == -1 );
+  assert ( lwes_event_view_from_bytes (view, bytes, size, 0)    == size );
+
+  assert ( lwes_event_view_get_name (NULL, &name, &length) == -1 );
+  assert ( lwes_event_view_get_name (view, NULL,  &length) == -1 );
+  assert ( lwes_event_view_get_name (view, &name, NULL)    == -1 );
+  assert ( lwes_event_view_get_number_of_attributes (NULL, &uint16) == -1 );
+  assert ( lwes_event_view_get_number_of_attributes (view, NULL)    == -1 );
+
+  assert ( lwes_event_view_get_U_INT_16 (NULL, "aUInt16", &uint16) == -1 );
+  assert ( lwes_event_view_get_U_INT_16 (view, NULL,      &uint16) == -1 );
+  assert ( lwes_event_view_get_U_INT_16 (view, "aUInt16", NULL)    == -1 );
+  assert ( lwes_event_view_get_INT_16   (NULL, "anInt16", &int16)  == -1 );
+  assert ( lwes_event_view_get_INT_16   (view, "anInt16", NULL)    == -1 );
+  assert ( lwes_event_view_get_U_INT_32 (NULL, "aUInt32", &uint32) == -1 );
+  assert ( lwes_event_view_get_U_INT_32 (view, "aUInt32", NULL)    == -1 );
+  assert ( lwes_event_view_get_INT_32   (NULL, "anInt32", &int32)  == -1 );
+  assert ( lwes_event_view_get_INT_32   (view, "anInt32", NULL)    == -1 );
+  assert ( lwes_event_view_get_U_INT_64 (NULL, "aUInt64", &uint64) == -1 );
+  assert ( lwes_event_view_get_U_INT_64 (view, "aUInt64", NULL)    == -1 );
+  assert ( lwes_event_view_get_INT_64   (NULL, "anInt64", &int64)  == -1 );
+  assert ( lwes_event_view_get_INT_64   (view, "anInt64", NULL)    == -1 );
+  assert ( lwes_event_view_get_BOOLEAN  (NULL, "aBoolean", &boolean) == -1 );
+  assert ( lwes_event_view_get_BOOLEAN  (view, "aBoolean", NULL)     == -1 );
+  assert ( lwes_event_view_get_IP_ADDR  (NULL, "anIPAddress", &ip_addr)
+           == -1 );
+  assert ( lwes_event_view_get_IP_ADDR  (view, "anIPAddress", NULL) == -1 );
+  assert ( lwes_event_view_get_STRING (NULL, "aString", &string, &length)
+           == -1 );
+  assert ( lwes_event_view_get_STRING (view, "aString", NULL, &length)
+           == -1 );
+  assert ( lwes_event_view_get_STRING (view, "aString", &string, NULL)
+           == -1 );
+
+  assert ( lwes_event_view_destroy (view) == 0 );
+}
+
+static void
+test_many_attributes (void)
+{
+  struct lwes_event_view *view;
+  struct lwes_event *event;
+  LWES_U_INT_16 uint16;
+  char name[16];
+  int size;
+  int i;
+
+  event = lwes_event_create (NULL, "Many");
+  assert ( event != NULL );
+  for (i = 0; i < 100; i++)
+    {
+      sprintf (name, "attribute%02d", i);
+      assert ( lwes_event_set_U_INT_16 (event, name, i) == i + 1 );
+    }
+  size = lwes_event_to_bytes (event, bytes, sizeof (bytes), 0);
+  assert ( size > 0 );
+  assert ( lwes_event_destroy (event) == 0 );
+
+  /* failing to make room for the attributes */
+  malloc_count = 0;
+  null_at = 3;
+  view = lwes_event_view_create ();
+  assert ( view != NULL );
+  assert ( lwes_event_view_from_bytes (view, bytes, size, 0) == -3 );
+  null_at = 0;
+
+  /* then making room, which is kept for the next event */
+  assert ( lwes_event_view_from_bytes (view, bytes, size, 0) == size );
+  malloc_count = 0;
+  assert ( lwes_event_view_from_bytes (view, bytes, size, 0) == size );
+  assert ( malloc_count == 0 );
+  for (i = 0; i < 100; i++)
+    {
+      sprintf (name, "attribute%02d", i);
+      assert ( lwes_event_view_get_U_INT_16 (view, name, &uint16) == 0 );
+      assert ( uint16 == i );
+    }
+  assert ( lwes_event_view_destroy (view) == 0 );
+
+  /* failing to create a view */
+  for (i = 1; i <= 2; i++)
+    {
+      malloc_count = 0;
+      null_at = i;
+      assert ( lwes_event_view_create () == NULL );
+    }
+  null_at = 0;
+}
+
+int main (void)
+{
+  test_view ();
+  test_malformed ();
+  test_null_args ();
+  test_many_attributes ();
+
+  return 0;
+}
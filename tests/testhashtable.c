@@ -129,10 +129,17 @@ int main(void)
   assert ( lwes_hash_is_empty(hash) );
   assert ( lwes_hash_size(hash) == 0 );
 
-  /* malloc failure */
-  malloc_count = 0;
-  null_at = 1;
-  assert ( lwes_hash_put (hash, (char*)key1,  &value1 ) == -3 );
+  /* malloc failure, when the hash has to grow to fit the entry */
+  {
+    struct lwes_hash *small_hash = lwes_hash_create_with_bins (1);
+    assert ( small_hash != NULL );
+    malloc_count = 0;
+    null_at = 1;
+    assert ( lwes_hash_put (small_hash, (char*)key1,  &value1 ) == -3 );
+    null_at = 0;
+    assert ( lwes_hash_is_empty (small_hash) );
+    assert ( lwes_hash_destroy (small_hash) == 0 );
+  }
 
   /* hash should still be empty */
   assert ( lwes_hash_is_empty(hash) );
@@ -306,5 +313,101 @@ int main(void)
   assert ( lwes_hash_is_empty(hash) );
   assert ( lwes_hash_destroy(hash) == 0 );
 
+  /* a hash over caller supplied storage only allocates once it grows */
+  {
+    struct lwes_hash stack_hash;
+    struct lwes_hash_slot slots[4];
+
+    assert ( lwes_hash_init_with_slots (NULL, slots, 4) == -1 );
+    assert ( lwes_hash_init_with_slots (&stack_hash, NULL, 4) == -1 );
+    assert ( lwes_hash_init_with_slots (&stack_hash, slots, 0) == -1 );
+    assert ( lwes_hash_init_with_slots (&stack_hash, slots, 3) == -1 );
+    assert ( lwes_hash_init_with_slots (&stack_hash, slots, 4) == 0 );
+    assert ( lwes_hash_is_empty (&stack_hash) );
+
+    malloc_count = 0;
+    null_at = 1;
+    assert ( lwes_hash_put (&stack_hash, (char*)key1, &value1) == 0 );
+    assert ( lwes_hash_put (&stack_hash, (char*)key2, &value2) == 0 );
+    assert ( lwes_hash_put (&stack_hash, (char*)key3, &value3) == 0 );
+    assert ( malloc_count == 0 );
+    assert ( stack_hash.slots == slots );
+
+    /* the fourth entry needs more slots */
+    assert ( lwes_hash_put (&stack_hash, (char*)key4, &value4) == -3 );
+    assert ( lwes_hash_size (&stack_hash) == 3 );
+    null_at = 0;
+    assert ( lwes_hash_put (&stack_hash, (char*)key4, &value4) == 0 );
+    assert ( stack_hash.slots != slots );
+    assert ( stack_hash.total_bins == 8 );
+
+    assert ( lwes_hash_size (&stack_hash) == 4 );
+    assert ( *((int *)lwes_hash_get (&stack_hash, key1)) == value1 );
+    assert ( *((int *)lwes_hash_get (&stack_hash, key2)) == value2 );
+    assert ( *((int *)lwes_hash_get (&stack_hash, key4)) == value4 );
+    assert ( lwes_hash_get (&stack_hash, key5) == NULL );
+
+    /* clearing keeps the grown slots */
+    lwes_hash_clear (&stack_hash);
+    assert ( lwes_hash_is_empty (&stack_hash) );
+    assert ( lwes_hash_get (&stack_hash, key1) == NULL );
+    assert ( stack_hash.total_bins == 8 );
+
+    lwes_hash_release (&stack_hash);
+  }
+
+  /* removed entries leave markers which neither break lookups of entries
+   * probed past them nor make the hash grow
+   */
+  hash = lwes_hash_create_with_bins (4);
+  assert ( hash != NULL );
+  for ( i = 0 ; i < 100 ; i++ )
+    {
+      assert ( lwes_hash_put (hash, (char*)key1, &value1) == 0 );
+      assert ( lwes_hash_put (hash, (char*)key2, &value2) == 0 );
+      assert ( lwes_hash_remove (hash, (char*)key1) == &value1 );
+      assert ( *((int *)lwes_hash_get (hash, key2)) == value2 );
+      assert ( lwes_hash_remove (hash, (char*)key2) == &value2 );
+    }
+  assert ( hash->total_bins == 4 );
+
+  /* removing while enumerating sees every entry once */
+  assert ( lwes_hash_put (hash, (char*)key1, &value1) == 0 );
+  assert ( lwes_hash_put (hash, (char*)key2, &value2) == 0 );
+  assert ( lwes_hash_put (hash, (char*)key3, &value3) == 0 );
+  assert ( lwes_hash_keys (hash, &e) );
+  i = 0;
+  while ( lwes_hash_enumeration_has_more_elements (&e) )
+    {
+      assert ( lwes_hash_remove (hash,
+                 lwes_hash_enumeration_next_element (&e)) != NULL );
+      i++;
+    }
+  assert ( i == 3 );
+  assert ( lwes_hash_destroy (hash) == 0 );
+
+  /* rehashing by hand */
+  assert ( lwes_hash_rehash (NULL) == -1 );
+
+  /* keys hashed ahead of time go in and come out the same as any other */
+  hash = lwes_hash_create ();
+  assert ( hash != NULL );
+  assert ( lwes_hash_put_with_hash (NULL, (char*)key1, &value1,
+                                    lwes_hash (key1)) == -1 );
+  assert ( lwes_hash_put_with_hash (hash, NULL, &value1, 0) == -1 );
+  assert ( lwes_hash_put_with_hash (hash, (char*)key1, &value1,
+                                    lwes_hash (key1)) == 0 );
+  assert ( lwes_hash_put (hash, (char*)key2, &value2) == 0 );
+  assert ( lwes_hash_get (hash, key1) == &value1 );
+  assert ( lwes_hash_get_with_hash (hash, key1, lwes_hash (key1))
+           == &value1 );
+  assert ( lwes_hash_get_with_hash (hash, key2, lwes_hash (key2))
+           == &value2 );
+  assert ( lwes_hash_get_with_hash (hash, key3, lwes_hash (key3)) == NULL );
+  assert ( lwes_hash_get_with_hash (NULL, key1, lwes_hash (key1)) == NULL );
+  assert ( lwes_hash_get_with_hash (hash, NULL, 0) == NULL );
+  lwes_hash_clear (hash);
+  assert ( lwes_hash_destroy (hash) == 0 );
+
   return 0;
 }
@@ -0,0 +1,168 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#if HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+
+/* wrap malloc to cause test memory problems */
+void *my_malloc (size_t size);
+
+static size_t null_at = 0;
+static size_t malloc_count = 0;
+
+void *my_malloc (size_t size)
+{
+  void *ret = NULL;
+  malloc_count++;
+  if ( malloc_count != null_at )
+    {
+      ret = malloc (size);
+    }
+  return ret;
+}
+
+#define malloc my_malloc
+
+#include "lwes_intern.c"
+
+#undef malloc
+
+#define NUM_THREADS 4
+#define NUM_NAMES   1000
+
+static LWES_SHORT_STRING thread_names[NUM_THREADS][NUM_NAMES];
+
+static void *
+intern_names (void *arg)
+{
+  LWES_SHORT_STRING *names = (LWES_SHORT_STRING *)arg;
+  char name[32];
+  int i;
+
+  for ( i = 0; i < NUM_NAMES; i++ )
+    {
+      sprintf (name, "thread%d", i);
+      names[i] = lwes_intern (name, strlen (name));
+    }
+  return NULL;
+}
+
+int main(void)
+{
+  char too_long[SHORT_STRING_MAX + 2];
+  char name[32];
+  LWES_SHORT_STRING abc;
+  LWES_SHORT_STRING shorter;
+  LWES_SHORT_STRING found;
+  unsigned int hash;
+  int index;
+  pthread_t threads[NUM_THREADS];
+  int count;
+  int i;
+  int j;
+
+  /* some boundary conditions */
+  memset (too_long, 'x', sizeof (too_long) - 1);
+  too_long[sizeof (too_long) - 1] = '\0';
+  assert ( lwes_intern (NULL, 0) == NULL );
+  assert ( lwes_intern (too_long, strlen (too_long)) == NULL );
+  assert ( lwes_intern (too_long, SHORT_STRING_MAX) != NULL );
+  assert ( lwes_intern_lookup (NULL, 0) == NULL );
+  assert ( lwes_intern_lookup (too_long, strlen (too_long)) == NULL );
+
+  /* failure to allocate room for the names */
+  malloc_count = 0;
+  null_at = 1;
+  lwes_intern_chunk_used = LWES_INTERN_CHUNK_SIZE;
+  assert ( lwes_intern ("abc", 3) == NULL );
+  assert ( lwes_intern_lookup ("abc", 3) == NULL );
+  null_at = 0;
+
+  /* the same name always gives back the same copy */
+  assert ( lwes_intern_lookup ("abc", 3) == NULL );
+  abc = lwes_intern ("abc", 3);
+  assert ( abc != NULL );
+  assert ( strcmp (abc, "abc") == 0 );
+  assert ( lwes_intern ("abc", 3) == abc );
+  assert ( lwes_intern_lookup ("abc", 3) == abc );
+
+  /* names need not be terminated, and prefixes are different names */
+  assert ( lwes_intern ("abcdef", 3) == abc );
+  assert ( lwes_intern ("ab", 2) != abc );
+  assert ( lwes_intern ("abcd", 4) != abc );
+  assert ( strcmp (lwes_intern ("abcd", 4), "abcd") == 0 );
+  assert ( strcmp (lwes_intern ("", 0), "") == 0 );
+
+  /* a name with the same hash as a shorter one isn't compared past the
+   * end of the shorter one */
+  shorter = (LWES_SHORT_STRING) malloc (2);
+  assert ( shorter != NULL );
+  strcpy (shorter, "x");
+  hash  = lwes_intern_hash ("xyz", 3);
+  found = NULL;
+  index = lwes_intern_find ("xyz", 3, hash, &found);
+  assert ( found == NULL );
+  lwes_intern_hashes[index]  = hash;
+  lwes_intern_lengths[index] = 1;
+  lwes_intern_names[index]   = shorter;
+  assert ( lwes_intern_find ("xyz", 3, hash, &found) != index );
+  assert ( found == NULL );
+  assert ( lwes_intern_find ("x", 1, hash, &found) == index );
+  assert ( found == shorter );
+  lwes_intern_names[index] = NULL;
+  free (shorter);
+
+  /* threads interning the same names end up with the same copies */
+  for ( i = 0; i < NUM_THREADS; i++ )
+    {
+      assert ( pthread_create (&threads[i], NULL, intern_names,
+                               thread_names[i]) == 0 );
+    }
+  for ( i = 0; i < NUM_THREADS; i++ )
+    {
+      assert ( pthread_join (threads[i], NULL) == 0 );
+    }
+  for ( j = 0; j < NUM_NAMES; j++ )
+    {
+      sprintf (name, "thread%d", j);
+      assert ( thread_names[0][j] != NULL );
+      assert ( strcmp (thread_names[0][j], name) == 0 );
+      for ( i = 1; i < NUM_THREADS; i++ )
+        {
+          assert ( thread_names[i][j] == thread_names[0][j] );
+        }
+    }
+
+  /* once the table is full names are no longer interned, but the ones
+   * already are still found */
+  count = lwes_intern_count;
+  for ( i = 0; ; i++ )
+    {
+      sprintf (name, "full%d", i);
+      if ( lwes_intern (name, strlen (name)) == NULL )
+        {
+          break;
+        }
+    }
+  assert ( count + i == LWES_INTERN_SLOTS * 3 / 4 );
+  assert ( lwes_intern ("abc", 3) == abc );
+  assert ( lwes_intern ("full0", 5) != NULL );
+
+  return 0;
+}
@@ -0,0 +1,248 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "lwes_listener_group.h"
+#include "lwes_emitter.h"
+
+/* wrap malloc to cause test memory problems */
+void *my_malloc (size_t size);
+
+static size_t null_at = 0;
+static size_t malloc_count = 0;
+
+void *my_malloc (size_t size)
+{
+  void *ret = NULL;
+  malloc_count++;
+  if ( malloc_count != null_at )
+    {
+      ret = malloc (size);
+    }
+  return ret;
+}
+
+#define malloc my_malloc
+
+#include "lwes_listener_group.c"
+
+#undef malloc
+
+#define EMITTERS 4
+#define EVENTS   50
+
+static const char *unicast_ip  = "127.0.0.1";
+#ifdef HAVE_LINUX_FILTER_H
+static const char *mcast_ip    = "224.0.0.254";
+#endif
+static const char *mcast_iface = NULL;
+static const int   port        = 12347;
+
+/* what the callback has been called with */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static int received = 0;
+static int counts[EMITTERS];
+static int last[EMITTERS];
+static pthread_t threads[EMITTERS];
+
+static void
+callback (struct lwes_event *event, void *arg)
+{
+  LWES_INT_32 emitter;
+  LWES_INT_32 value;
+
+  assert (arg == &received);
+  assert (lwes_event_get_INT_32 (event, "emitter", &emitter) == 0);
+  assert (lwes_event_get_INT_32 (event, "value", &value) == 0);
+  assert (emitter >= 0 && emitter < EMITTERS);
+
+  pthread_mutex_lock (&mutex);
+  /* the events of each emitter are all handled on one thread, in order */
+  if (counts[emitter] == 0)
+    {
+      threads[emitter] = pthread_self ();
+    }
+  assert (pthread_equal (threads[emitter], pthread_self ()));
+  assert (value == last[emitter] + 1);
+  last[emitter] = value;
+  counts[emitter]++;
+  received++;
+  pthread_mutex_unlock (&mutex);
+}
+
+static int
+get_received (void)
+{
+  int n;
+
+  pthread_mutex_lock (&mutex);
+  n = received;
+  pthread_mutex_unlock (&mutex);
+  return n;
+}
+
+static void
+test_receive (const char *address)
+{
+  struct lwes_listener_group *group;
+  struct lwes_emitter *emitters[EMITTERS];
+  struct lwes_event *event;
+  LWES_U_INT_64 errors;
+  int e;
+  int i;
+
+  received = 0;
+  for (e = 0; e < EMITTERS; e++)
+    {
+      counts[e] = 0;
+      last[e]   = -1;
+    }
+
+  group = lwes_listener_group_create ((char *) address, (char *) mcast_iface,
+                                      port, 4, callback, &received);
+  assert (group != NULL);
+  assert (group->shards_size == 4);
+
+  /* each emitter sends from a port of its own */
+  event = lwes_event_create (NULL, "Group");
+  assert (event != NULL);
+  for (e = 0; e < EMITTERS; e++)
+    {
+      emitters[e] = lwes_emitter_create (address, mcast_iface, port, 0, 60);
+      assert (emitters[e] != NULL);
+    }
+  for (i = 0; i < EVENTS; i++)
+    {
+      for (e = 0; e < EMITTERS; e++)
+        {
+          assert (lwes_event_set_INT_32 (event, "emitter", e) > 0);
+          assert (lwes_event_set_INT_32 (event, "value", i) > 0);
+          assert (lwes_emitter_emit (emitters[e], event) == 0);
+        }
+    }
+
+  for (i = 0; i < 500 && get_received () < EMITTERS*EVENTS; i++)
+    {
+      usleep (10000);
+    }
+  /* and no more than were sent, so none went to more than one shard */
+  usleep (100000);
+  assert (get_received () == EMITTERS*EVENTS);
+  for (e = 0; e < EMITTERS; e++)
+    {
+      assert (counts[e] == EVENTS);
+      assert (lwes_emitter_destroy (emitters[e]) == 0);
+    }
+
+  /* waiting for packets which didn't come isn't a failure */
+  assert (lwes_listener_group_get_errors (group, &errors) == 0);
+  assert (errors == 0);
+
+  lwes_event_destroy (event);
+  assert (lwes_listener_group_destroy (group) == 0);
+}
+
+static void
+test_errors (void)
+{
+  struct lwes_listener_group *group;
+  struct lwes_listener_group_shard *shard;
+  LWES_U_INT_64 errors;
+  int socketfd;
+
+  group = lwes_listener_group_create ((char *) unicast_ip,
+                                      (char *) mcast_iface,
+                                      port, 1, callback, &received);
+  assert (group != NULL);
+  assert (lwes_listener_group_get_errors (NULL, &errors) == -1);
+  assert (lwes_listener_group_get_errors (group, NULL) == -1);
+
+  /* run the shard again on something which isn't a socket, so every
+     receive fails */
+  shard = &(group->shards[0]);
+  __atomic_store_n (&(group->running), 0, __ATOMIC_RELEASE);
+  assert (pthread_join (shard->thread, NULL) == 0);
+  socketfd = shard->listener->connection.socketfd;
+  shard->listener->connection.socketfd = open ("/dev/null", O_RDONLY);
+  assert (shard->listener->connection.socketfd >= 0);
+  group->running = 1;
+  assert (pthread_create (&(shard->thread), NULL,
+                          lwes_listener_group_run, shard) == 0);
+  usleep (350000);
+
+  /* the failures are counted, and waited out rather than spun on */
+  assert (lwes_listener_group_get_errors (group, &errors) == 0);
+  assert (errors >= 1 && errors <= 5);
+
+  __atomic_store_n (&(group->running), 0, __ATOMIC_RELEASE);
+  assert (pthread_join (shard->thread, NULL) == 0);
+  close (shard->listener->connection.socketfd);
+  shard->listener->connection.socketfd = socketfd;
+  group->running = 1;
+  assert (pthread_create (&(shard->thread), NULL,
+                          lwes_listener_group_run, shard) == 0);
+  assert (lwes_listener_group_destroy (group) == 0);
+}
+
+static void
+test_create_failures (void)
+{
+  struct lwes_listener_group *group;
+
+  assert (lwes_listener_group_create ((char *) unicast_ip,
+                                      (char *) mcast_iface,
+                                      port, 2, NULL, NULL) == NULL);
+  assert (lwes_listener_group_create ((char *) unicast_ip,
+                                      (char *) mcast_iface,
+                                      port, -1, callback, NULL) == NULL);
+  assert (lwes_listener_group_destroy (NULL) == 0);
+
+  /* 1: the group, 2: the shards, 3 and 4: the events of each shard */
+  for (null_at = 1; null_at <= 4; null_at++)
+    {
+      malloc_count = 0;
+      assert (lwes_listener_group_create ((char *) unicast_ip,
+                                          (char *) mcast_iface,
+                                          port, 2, callback, NULL) == NULL);
+    }
+  null_at = 0;
+
+  /* a shard per processor */
+  group = lwes_listener_group_create ((char *) unicast_ip,
+                                      (char *) mcast_iface,
+                                      port, 0, callback, NULL);
+  assert (group != NULL);
+  assert (group->shards_size >= 1);
+  assert (lwes_listener_group_destroy (group) == 0);
+}
+
+int main (void)
+{
+  test_create_failures ();
+  test_errors ();
+  test_receive (unicast_ip);
+  /* multicast can only be shared out where sockets can be filtered */
+#ifdef HAVE_LINUX_FILTER_H
+  test_receive (mcast_ip);
+#endif
+  return 0;
+}
@@ -0,0 +1,196 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <lwes_event.h>
+
+/* generated by lwes-esf-to-c from testeventtypedb.esf */
+#include "testesftoc_gen.h"
+
+static LWES_BYTE bytes[65535];
+static LWES_BYTE bytes2[65535];
+
+static void
+fill (struct testesftoc_gen_TypeChecker *typed)
+{
+  memset (typed, 0, sizeof (*typed));
+  typed->aString            = "http://www.test.com";
+  typed->aString_length     = strlen (typed->aString);
+  typed->has_aString        = 1;
+  typed->aBoolean           = 1;
+  typed->has_aBoolean       = 1;
+  typed->anIPAddress.s_addr = inet_addr ("224.0.0.100");
+  typed->has_anIPAddress    = 1;
+  typed->aUInt16            = 65535;
+  typed->has_aUInt16        = 1;
+  typed->anInt16            = -1;
+  typed->has_anInt16        = 1;
+  typed->aUInt32            = 0xffffffffL;
+  typed->has_aUInt32        = 1;
+  typed->anInt32            = -1;
+  typed->has_anInt32        = 1;
+  typed->aUInt64            = 0xffffffffffffffffULL;
+  typed->has_aUInt64        = 1;
+  typed->anInt64            = -1;
+  typed->has_anInt64        = 1;
+  typed->SiteID             = 7;
+  typed->has_SiteID         = 1;
+}
+
+/* what the generated code writes, lwes_event_from_bytes reads */
+static void
+test_to_bytes (void)
+{
+  struct testesftoc_gen_TypeChecker typed;
+  struct lwes_event *event;
+  struct lwes_event_deserialize_tmp dtmp;
+  LWES_U_INT_16 number;
+  LWES_LONG_STRING string;
+  LWES_BOOLEAN boolean;
+  LWES_IP_ADDR ip_addr;
+  LWES_U_INT_16 uint16;
+  LWES_INT_16 int16;
+  LWES_U_INT_32 uint32;
+  LWES_INT_32 int32;
+  LWES_U_INT_64 uint64;
+  LWES_INT_64 int64;
+  size_t size;
+  int n;
+
+  fill (&typed);
+  n = testesftoc_gen_TypeChecker_to_bytes (&typed, bytes, sizeof (bytes), 3);
+  assert (n > 0);
+  assert (n <= TESTESFTOC_GEN_TYPECHECKER_MAX_SIZE);
+
+  event = lwes_event_create_no_name (NULL);
+  assert (event != NULL);
+  assert (lwes_event_from_bytes (event, bytes, n + 3, 3, &dtmp) == n);
+  assert (strcmp (event->eventName, "TypeChecker") == 0);
+  assert (lwes_event_get_number_of_attributes (event, &number) == 0);
+  assert (number == 10);
+  assert (lwes_event_get_STRING (event, "aString", &string) == 0);
+  assert (strcmp (string, "http://www.test.com") == 0);
+  assert (lwes_event_get_BOOLEAN (event, "aBoolean", &boolean) == 0);
+  assert (boolean == 1);
+  assert (lwes_event_get_IP_ADDR (event, "anIPAddress", &ip_addr) == 0);
+  assert (ip_addr.s_addr == typed.anIPAddress.s_addr);
+  assert (lwes_event_get_U_INT_16 (event, "aUInt16", &uint16) == 0);
+  assert (uint16 == 65535);
+  assert (lwes_event_get_INT_16 (event, "anInt16", &int16) == 0);
+  assert (int16 == -1);
+  assert (lwes_event_get_U_INT_32 (event, "aUInt32", &uint32) == 0);
+  assert (uint32 == 0xffffffffL);
+  assert (lwes_event_get_INT_32 (event, "anInt32", &int32) == 0);
+  assert (int32 == -1);
+  assert (lwes_event_get_U_INT_64 (event, "aUInt64", &uint64) == 0);
+  assert (uint64 == 0xffffffffffffffffULL);
+  assert (lwes_event_get_INT_64 (event, "anInt64", &int64) == 0);
+  assert (int64 == -1);
+  assert (lwes_event_get_U_INT_16 (event, "SiteID", &uint16) == 0);
+  assert (uint16 == 7);
+
+  /* and it is the size the event serializes to itself */
+  assert (lwes_event_get_serialized_size (event, &size) == 0);
+  assert (size == (size_t)n);
+  assert (lwes_event_to_bytes (event, bytes2, sizeof (bytes2), 0) == n);
+  assert (lwes_event_destroy (event) == 0);
+
+  /* the space needed is checked before anything is written */
+  memset (bytes2, 0, sizeof (bytes2));
+  assert (testesftoc_gen_TypeChecker_to_bytes (&typed, bytes2, n - 1, 0)
+          == -2);
+  assert (bytes2[0] == 0);
+  assert (testesftoc_gen_TypeChecker_to_bytes (NULL, bytes2, n, 0) == -1);
+  assert (testesftoc_gen_TypeChecker_to_bytes (&typed, NULL, n, 0) == -1);
+}
+
+/* what lwes_event_to_bytes writes, the generated code reads */
+static void
+test_from_bytes (void)
+{
+  struct testesftoc_gen_TypeChecker typed;
+  struct testesftoc_gen_Empty empty;
+  struct lwes_event *event;
+  LWES_IP_ADDR ip_addr;
+  int n;
+  int i;
+
+  ip_addr.s_addr = inet_addr ("127.0.0.1");
+
+  event = lwes_event_create (NULL, "TypeChecker");
+  assert (event != NULL);
+  assert (lwes_event_set_STRING   (event, "aString", "hello") == 1);
+  assert (lwes_event_set_STRING   (event, "notInTheFile", "skipped") == 2);
+  assert (lwes_event_set_INT_64   (event, "anInt64", -5) == 3);
+  assert (lwes_event_set_U_INT_32 (event, "aBoolean", 1) == 4);
+  assert (lwes_event_set_IP_ADDR  (event, "SenderIP", ip_addr) == 5);
+  assert (lwes_event_set_encoding (event, 1) == 6);
+  n = lwes_event_to_bytes (event, bytes, sizeof (bytes), 0);
+  assert (n > 0);
+
+  assert (testesftoc_gen_TypeChecker_from_bytes (&typed, bytes, n, 0) == n);
+  assert (typed.has_aString);
+  assert (typed.aString_length == 5);
+  assert (memcmp (typed.aString, "hello", 5) == 0);
+  assert (typed.aString >= (LWES_CONST_LONG_STRING)bytes
+          && typed.aString < (LWES_CONST_LONG_STRING)bytes + n);
+  assert (typed.has_anInt64);
+  assert (typed.anInt64 == -5);
+  assert (typed.has_SenderIP);
+  assert (typed.SenderIP.s_addr == ip_addr.s_addr);
+
+  /* attributes of another type, or not in the file, are skipped */
+  assert (! typed.has_aBoolean);
+  assert (! typed.has_aUInt16);
+
+  /* only an event of the name is read */
+  assert (testesftoc_gen_Empty_from_bytes (&empty, bytes, n, 0) == -2);
+
+  /* nor one which has been cut short */
+  for (i = 1; i < n; i++)
+    {
+      assert (testesftoc_gen_TypeChecker_from_bytes (&typed, bytes, i, 0)
+              < 0);
+    }
+  assert (testesftoc_gen_TypeChecker_from_bytes (NULL, bytes, n, 0) == -1);
+  assert (testesftoc_gen_TypeChecker_from_bytes (&typed, bytes, n, n) == -1);
+
+  /* nor one with a type which doesn't exist */
+  memcpy (bytes2, bytes, n);
+  bytes2[1 + strlen ("TypeChecker") + 2 + 1 + strlen ("enc")] = 42;
+  assert (testesftoc_gen_TypeChecker_from_bytes (&typed, bytes2, n, 0)
+          == -4);
+
+  assert (lwes_event_destroy (event) == 0);
+
+  /* an event with nothing set is just the name and no attributes */
+  memset (&empty, 0, sizeof (empty));
+  assert (testesftoc_gen_Empty_to_bytes (&empty, bytes, sizeof (bytes), 0)
+          == 1 + 5 + 2);
+  assert (testesftoc_gen_Empty_from_bytes (&empty, bytes, 1 + 5 + 2, 0)
+          == 1 + 5 + 2);
+}
+
+int main (void)
+{
+  test_to_bytes ();
+  test_from_bytes ();
+
+  return 0;
+}
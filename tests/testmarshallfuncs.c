@@ -348,6 +348,46 @@ int main(void)
   assert ( ip_addr.s_addr == ip_addr_1.s_addr );
   assert ( ip_addr2.s_addr == ip_addr2_1.s_addr );
 
+  /* the unchecked versions write and read the same bytes, wherever they
+   * are in the array */
+  for ( i=0; i< num_bytes; i++ ) bytes2[i] = 0x00;
+
+  offset = 1;
+  assert ( marshall_BYTE_unchecked     (aByte,  bytes2, &offset) == 1 );
+  assert ( marshall_BOOLEAN_unchecked  (aBool,  bytes2, &offset) == 1 );
+  assert ( marshall_U_INT_16_unchecked (uint16, bytes2, &offset) == 2 );
+  assert ( marshall_INT_16_unchecked   (int16,  bytes2, &offset) == 2 );
+  assert ( marshall_U_INT_32_unchecked (uint32, bytes2, &offset) == 4 );
+  assert ( marshall_INT_32_unchecked   (int32,  bytes2, &offset) == 4 );
+  assert ( marshall_U_INT_64_unchecked (uint64, bytes2, &offset) == 8 );
+  assert ( marshall_INT_64_unchecked   (int64,  bytes2, &offset) == 8 );
+  assert ( marshall_IP_ADDR_unchecked  (ip_addr2, bytes2, &offset) == 4 );
+  assert ( offset == 35 );
+  assert ( memcmp (bytes2 + 1, endian_data, 30) == 0 );
+  assert ( memcmp (bytes2 + 31, endian_data + 68, 4) == 0 );
+
+  offset = 1;
+  assert ( unmarshall_BYTE_unchecked     (&aByte_1,  bytes2, &offset) == 1 );
+  assert ( unmarshall_BOOLEAN_unchecked  (&aBool_1,  bytes2, &offset) == 1 );
+  assert ( unmarshall_U_INT_16_unchecked (&uint16_1, bytes2, &offset) == 2 );
+  assert ( unmarshall_INT_16_unchecked   (&int16_1,  bytes2, &offset) == 2 );
+  assert ( unmarshall_U_INT_32_unchecked (&uint32_1, bytes2, &offset) == 4 );
+  assert ( unmarshall_INT_32_unchecked   (&int32_1,  bytes2, &offset) == 4 );
+  assert ( unmarshall_U_INT_64_unchecked (&uint64_1, bytes2, &offset) == 8 );
+  assert ( unmarshall_INT_64_unchecked   (&int64_1,  bytes2, &offset) == 8 );
+  assert ( unmarshall_IP_ADDR_unchecked  (&ip_addr2_1, bytes2, &offset) == 4 );
+  assert ( offset == 35 );
+
+  assert ( aByte == aByte_1 );
+  assert ( aBool == aBool_1 );
+  assert ( uint16 == uint16_1 );
+  assert ( int16 == int16_1 );
+  assert ( uint32 == uint32_1 );
+  assert ( int32 == int32_1 );
+  assert ( uint64 == uint64_1 );
+  assert ( int64 == int64_1 );
+  assert ( ip_addr2.s_addr == ip_addr2_1.s_addr );
+
   for ( i=0; i< 500 ; i++ ) aString_1[i]   = (char)0xfe;
   for ( i=0; i< 500 ; i++ ) eventName_1[i] = (char)0xfe;
 
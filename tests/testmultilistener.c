@@ -0,0 +1,240 @@
+/*======================================================================*
+ * Copyright (c) 2008, Yahoo! Inc. All rights reserved.                 *
+ *                                                                      *
+ * Licensed under the New BSD License (the "License"); you may not use  *
+ * this file except in compliance with the License.  Unless required    *
+ * by applicable law or agreed to in writing, software distributed      *
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT        *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.     *
+ * See the License for the specific language governing permissions and  *
+ * limitations under the License. See accompanying LICENSE file.        *
+ *======================================================================*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lwes_multi_listener.h"
+#include "lwes_emitter.h"
+
+/* wrap malloc to cause test memory problems */
+void *my_malloc (size_t size);
+
+static size_t null_at = 0;
+static size_t malloc_count = 0;
+
+void *my_malloc (size_t size)
+{
+  void *ret = NULL;
+  malloc_count++;
+  if ( malloc_count != null_at )
+    {
+      ret = malloc (size);
+    }
+  return ret;
+}
+
+#define malloc my_malloc
+
+#include "lwes_multi_listener.c"
+
+#undef malloc
+
+#define CHANNELS 3
+
+static const char *addresses[CHANNELS] =
+  { "224.0.0.254", "224.0.0.254", "127.0.0.1" };
+static const int   ports[CHANNELS]     = { 12348, 12349, 12350 };
+static const char *mcast_iface         = NULL;
+
+static struct lwes_multi_listener *
+create (void)
+{
+  struct lwes_multi_listener *listener;
+  int i;
+
+  listener = lwes_multi_listener_create (CHANNELS);
+  assert (listener != NULL);
+  for (i = 0; i < CHANNELS; i++)
+    {
+      assert (lwes_multi_listener_add (listener,
+                                       (char *) addresses[i],
+                                       (char *) mcast_iface,
+                                       ports[i]) == i);
+    }
+  return listener;
+}
+
+/* send count events to each channel, with the channel and a count in
+   each */
+static void
+emit (int count)
+{
+  struct lwes_emitter *emitter;
+  struct lwes_event *event;
+  int i;
+  int j;
+
+  event = lwes_event_create (NULL, "Multi");
+  assert (event != NULL);
+  for (i = 0; i < CHANNELS; i++)
+    {
+      emitter = lwes_emitter_create (addresses[i], mcast_iface, ports[i],
+                                     0, 60);
+      assert (emitter != NULL);
+      for (j = 0; j < count; j++)
+        {
+          assert (lwes_event_set_INT_32 (event, "channel", i) > 0);
+          assert (lwes_event_set_INT_32 (event, "value", j) > 0);
+          assert (lwes_emitter_emit (emitter, event) == 0);
+        }
+      assert (lwes_emitter_destroy (emitter) == 0);
+    }
+  lwes_event_destroy (event);
+
+  /* so they have all arrived */
+  usleep (100000);
+}
+
+static void
+test_recv (void)
+{
+  struct lwes_multi_listener *listener;
+  struct lwes_event *events[10];
+  int channels[10];
+  int seen[CHANNELS];
+  LWES_INT_32 channel;
+  LWES_INT_32 value;
+  LWES_U_INT_16 port;
+  int n;
+  int i;
+
+  listener = create ();
+  for (i = 0; i < 10; i++)
+    {
+      events[i] = lwes_event_create_no_name (NULL);
+      assert (events[i] != NULL);
+    }
+
+  /* nothing sent */
+  assert (lwes_multi_listener_recv_by (listener, events, channels,
+                                       10, 10) == -2);
+
+  /* the channels take turns, so fewer events than are waiting get one
+     from each */
+  emit (2);
+  assert (lwes_multi_listener_recv_by (listener, events, channels,
+                                       CHANNELS, 1000) == CHANNELS);
+  memset (seen, 0, sizeof (seen));
+  for (i = 0; i < CHANNELS; i++)
+    {
+      assert (lwes_event_get_INT_32 (events[i], "channel", &channel) == 0);
+      assert (lwes_event_get_INT_32 (events[i], "value", &value) == 0);
+      assert (lwes_event_get_U_INT_16 (events[i], "SenderPort", &port) == 0);
+      assert (channel == channels[i]);
+      assert (value == 0);
+      seen[channel]++;
+    }
+  for (i = 0; i < CHANNELS; i++)
+    {
+      assert (seen[i] == 1);
+    }
+
+  /* and the rest come with the next */
+  assert (lwes_multi_listener_recv (listener, events, channels,
+                                    10) == CHANNELS);
+  for (i = 0; i < CHANNELS; i++)
+    {
+      assert (lwes_event_get_INT_32 (events[i], "channel", &channel) == 0);
+      assert (lwes_event_get_INT_32 (events[i], "value", &value) == 0);
+      assert (channel == channels[i]);
+      assert (value == 1);
+    }
+  assert (lwes_multi_listener_recv_by (listener, events, channels,
+                                       10, 10) == -2);
+
+  /* everything from each channel, in order */
+  emit (3);
+  memset (seen, 0, sizeof (seen));
+  while ((n = lwes_multi_listener_recv_by (listener, events, channels,
+                                           10, 100)) > 0)
+    {
+      for (i = 0; i < n; i++)
+        {
+          assert (lwes_event_get_INT_32 (events[i], "value", &value) == 0);
+          assert (value == seen[channels[i]]);
+          seen[channels[i]]++;
+        }
+    }
+  for (i = 0; i < CHANNELS; i++)
+    {
+      assert (seen[i] == 3);
+    }
+
+  for (i = 0; i < 10; i++)
+    {
+      lwes_event_destroy (events[i]);
+    }
+  assert (lwes_multi_listener_destroy (listener) == 0);
+}
+
+static void
+test_failures (void)
+{
+  struct lwes_multi_listener *listener;
+  struct lwes_event *event;
+  int channel;
+
+  assert (lwes_multi_listener_create (0) == NULL);
+  assert (lwes_multi_listener_destroy (NULL) == 0);
+
+  /* 1: the listener, 2: the channels, 3: ready, 4: waiting, 5: the buffer,
+     6: the deserialize space */
+  for (null_at = 1; null_at <= 6; null_at++)
+    {
+      malloc_count = 0;
+      assert (lwes_multi_listener_create (CHANNELS) == NULL);
+    }
+  null_at = 0;
+
+  event = lwes_event_create_no_name (NULL);
+  assert (event != NULL);
+
+  listener = lwes_multi_listener_create (CHANNELS);
+  assert (listener != NULL);
+
+  /* nothing to listen on yet */
+  assert (lwes_multi_listener_recv_by (listener, &event, &channel,
+                                       1, 10) == -1);
+
+  assert (lwes_multi_listener_add (NULL, (char *) addresses[0],
+                                   (char *) mcast_iface, ports[0]) == -1);
+  assert (lwes_multi_listener_add (listener, NULL,
+                                   (char *) mcast_iface, ports[0]) == -1);
+  lwes_multi_listener_destroy (listener);
+
+  /* no more than the most channels */
+  listener = create ();
+  assert (lwes_multi_listener_add (listener, (char *) addresses[0],
+                                   (char *) mcast_iface, ports[0]) == -2);
+
+  assert (lwes_multi_listener_recv_by (NULL, &event, &channel,
+                                       1, 10) == -1);
+  assert (lwes_multi_listener_recv_by (listener, NULL, &channel,
+                                       1, 10) == -1);
+  assert (lwes_multi_listener_recv_by (listener, &event, NULL,
+                                       1, 10) == -1);
+  assert (lwes_multi_listener_recv_by (listener, &event, &channel,
+                                       0, 10) == -1);
+  assert (lwes_multi_listener_destroy (listener) == 0);
+
+  lwes_event_destroy (event);
+}
+
+int main (void)
+{
+  test_failures ();
+  test_recv ();
+  return 0;
+}
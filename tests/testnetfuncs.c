@@ -10,6 +10,15 @@
  * limitations under the License. See accompanying LICENSE file.        *
  *======================================================================*/
 
+/* for sendmmsg, which lwes_net_functions.c below uses */
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
+#if HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
 #include <assert.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -110,11 +119,31 @@ my_sendto
   return -1;
 }
 
+#ifdef HAVE_SENDMMSG
+static int sendmmsg_error = 0;
+int
+my_sendmmsg
+  (int s,
+   struct mmsghdr *msgvec,
+   unsigned int vlen,
+   int flags)
+{
+  if (sendmmsg_error == 0)
+    {
+      return sendmmsg (s, msgvec, vlen, flags);
+    }
+  return -1;
+}
+#endif
+
 #define getsockopt my_getsockopt
 #define setsockopt my_setsockopt
 #define socket my_socket
 #define bind my_bind
 #define sendto my_sendto
+#ifdef HAVE_SENDMMSG
+#define sendmmsg my_sendmmsg
+#endif
 
 /*=====================================================================*
  * The actual file we are testing is included here                     *
@@ -226,6 +255,22 @@ void test_socket_function_failures (void)
   assert (lwes_net_recv_bind (&connection) == -5);
   setsockopt_error_when = SETSOCKOPT_NO_ERROR;
 
+  /* sharing the channel, SO_REUSEPORT and then the filter */
+  assert (lwes_net_recv_bind_shard (NULL, 0, 2) == -1);
+  assert (lwes_net_recv_bind_shard (&connection, 0, 0) == -1);
+  assert (lwes_net_recv_bind_shard (&connection, 2, 2) == -1);
+  assert (lwes_net_recv_bind_shard (&connection, -1, 2) == -1);
+#ifdef SO_REUSEPORT
+  setsockopt_error_when = SO_REUSEPORT;
+  assert (lwes_net_recv_bind_shard (&connection, 0, 2) == -2);
+  setsockopt_error_when = SETSOCKOPT_NO_ERROR;
+#endif
+#if defined (HAVE_LINUX_FILTER_H) && defined (SO_ATTACH_FILTER)
+  setsockopt_error_when = SO_ATTACH_FILTER;
+  assert (lwes_net_recv_bind_shard (&connection, 0, 2) == -6);
+  setsockopt_error_when = SETSOCKOPT_NO_ERROR;
+#endif
+
   assert (lwes_net_close (&connection) == 0);
 
   /* successful so we can test close failure */
@@ -260,6 +305,7 @@ void test_null_args (void)
   LWES_BYTE buffer[500];
   unsigned int i;
   struct lwes_net_connection connection;
+  struct lwes_net_packet packet;
 
   /* initialize to nothing */
   for (i = 0; i < 500; i++)
@@ -310,6 +356,11 @@ void test_null_args (void)
 
   assert (lwes_net_recv_bytes_by (NULL, buffer, 500, 10000) == -1);
   assert (lwes_net_recv_bytes_by (&connection, NULL, 500, 10000) == -1);
+
+  packet.bytes = buffer;
+  assert (lwes_net_recv_bytes_batch (NULL, &packet, 500, 1) == -1);
+  assert (lwes_net_recv_bytes_batch (&connection, NULL, 500, 1) == -1);
+  assert (lwes_net_recv_bytes_batch (&connection, &packet, 500, 0) == -1);
 }
 
 static void
@@ -374,6 +425,69 @@ test_sendto_bytes_failures (void)
   assert (lwes_net_close (&connection) == 0);
 }
 
+static void
+test_send_bytes_batch (void)
+{
+  LWES_BYTE buffer[500];
+  struct lwes_net_connection connection;
+  LWES_BYTE_P bytes[3];
+  size_t lens[3];
+  int results[3];
+  unsigned int i;
+
+  for (i = 0; i < 500; i++)
+    {
+      buffer[i]=(LWES_BYTE)i;
+    }
+  for (i = 0; i < 3; i++)
+    {
+      bytes[i] = buffer + 100 * i;
+      lens[i]  = 45 + i;
+    }
+
+  assert (lwes_net_open (&connection,
+                         (char*)mcast_ip,
+                         (char*)mcast_iface,
+                         (int)mcast_port) == 0);
+
+  assert (lwes_net_send_bytes_batch (&connection, bytes, lens, results, 3)
+          == 3);
+  for (i = 0; i < 3; i++)
+    {
+      assert (results[i] == (int)lens[i]);
+    }
+  assert (lwes_net_send_bytes_batch (&connection, bytes, lens, NULL, 3)
+          == 3);
+  assert (lwes_net_send_bytes_batch (&connection, bytes, lens, results, 0)
+          == 0);
+
+#ifdef HAVE_SENDMMSG
+  /* each message is sent on its own when sendmmsg fails */
+  sendmmsg_error = 1;
+  assert (lwes_net_send_bytes_batch (&connection, bytes, lens, results, 3)
+          == 3);
+  for (i = 0; i < 3; i++)
+    {
+      assert (results[i] == (int)lens[i]);
+    }
+#endif
+
+  /* and those which can't be sent are reported */
+  sendto_error = 1;
+  assert (lwes_net_send_bytes_batch (&connection, bytes, lens, results, 3)
+          == 0);
+  for (i = 0; i < 3; i++)
+    {
+      assert (results[i] == -1);
+    }
+  sendto_error = 0;
+#ifdef HAVE_SENDMMSG
+  sendmmsg_error = 0;
+#endif
+
+  assert (lwes_net_close (&connection) == 0);
+}
+
 void test_sendto (void)
 {
   pid_t pid;
@@ -767,6 +881,11 @@ int main (void)
 #endif
   test_sendto ();
 
+#if DEBUG
+  printf ("test_send_bytes_batch\n");
+#endif
+  test_send_bytes_batch ();
+
 #if DEBUG
   printf ("test_sendto_unicast\n");
 #endif